@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Framework/Mathematics.h"
+#include "Graphics/Sampler.h"
+
+class CPUScene;
+class CPUPathTracer;
+class ThreadPool;
+
+/// <summary>
+/// Runs Blaze without a window or GPU. The default scene gets rendered with the
+/// CPU path tracer and the result is written to disk.
+/// Usage: Blaze --headless [--width 1080] [--height 720] [--samples 64] [--threads 0] [--output Blaze.png]
+/// [--integrator iterative|recursive] [--min-depth 3] [--max-depth 8] [--target-error 0]
+/// [--denoise] [--reference Reference.exr] [--sampler random|sobol|bluenoise] [--convergence]
+/// [--benchmark-rays] [--no-packets] [--no-avx2] [--animate] [--check-packing] [--chi2]
+/// [--regression] [--expected-hash 0123456789abcdef] [--check-random] [--check-mips] [--check-hdr]
+/// [--check-mesh] [--check-tangents] [--check-compression] [--check-gltf]
+/// '--convergence' renders with every sampler up to '--samples', logging the PSNR against '--reference' as it goes.
+/// '--benchmark-rays' only traces '--samples' primary rays per pixel, both one by one & as packets, and logs the Mrays/s.
+/// '--animate' moves the models around, logs the time a TLAS refit takes against a rebuild & checks they find the same hits.
+/// '--chi2' tests the cosine & GGX direction sampling against their PDFs, see 'RunSamplingChiSquareTest'.
+/// '--regression' renders the default scene adaptively with fixed settings twice, on a different amount of threads. It fails
+/// when the images or their samples per pixel differ, when no tile converged early, when the average moves away from the
+/// stored one, or when the hash isn't '--expected-hash'.
+/// The other '--check-' arguments run one of the checks in 'HeadlessChecks.h'.
+/// </summary>
+class BlazeHeadless
+{
+public:
+	BlazeHeadless(int argc, char** argv);
+	~BlazeHeadless();
+
+	int Run();
+
+private:
+	int RunConvergenceTest();
+	int RunAnimationTest();
+	int RunRegressionTest();
+	std::vector<glm::vec3> RenderRegressionImage(ThreadPool* threadPool, std::vector<unsigned int>& sampleCounts);
+	void ParseArguments(int argc, char** argv);
+
+	std::string GetSamplerName(SamplerType samplerType);
+
+private:
+	unsigned int width = 1080;
+	unsigned int height = 720;
+	unsigned int sampleCount = 64;
+	unsigned int threadCount = 0;
+	std::string outputPath = "Blaze.png";
+	bool useRecursiveIntegrator = false;
+	unsigned int minDepth = 3;
+	unsigned int maxDepth = 8;
+	float targetError = 0.0f; // Relative error adaptive sampling renders towards, 0 renders every pixel
+	bool useDenoiser = false;
+	std::string referencePath; // Converged render the PSNR gets measured against, empty to skip it
+	SamplerType samplerType = SamplerType::BlueNoise;
+	bool runConvergenceTest = false;
+	bool runRayBenchmark = false;
+	bool runAnimationTest = false;
+	bool runPackingCheck = false;
+	bool runChiSquareTest = false;
+	bool runRegressionTest = false;
+	bool runRandomCheck = false;
+	bool runMipCheck = false;
+	bool runHDRCheck = false;
+	bool runMeshCheck = false;
+	bool runTangentCheck = false;
+	bool runCompressionCheck = false;
+	bool runGLTFCheck = false;
+	uint64_t expectedHash = 0; // Hash the regression render has to match, 0 to skip it
+	bool usePacketTracing = true; // Primary rays of a tile get traced together, '--no-packets' traces them one by one
+	bool usePacketAVX2 = true; // When the CPU supports it, '--no-avx2' traces packets with the scalar tests instead
+
+	CPUScene* scene = nullptr;
+	CPUPathTracer* pathTracer = nullptr;
+};
\ No newline at end of file
@@ -16,6 +16,7 @@ private:
 	void Menubar();
 	void TransformWindow();
 	void MaterialWindow();
+	void IntegratorWindow();
 
 	void ImGuiStyleSettings();
 
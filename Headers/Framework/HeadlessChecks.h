@@ -0,0 +1,53 @@
+#pragma once
+
+// Checks of single systems that don't need a scene, run through 'BlazeHeadless'.
+// Every check logs what it tested & returns the amount of failures, 0 when everything passed.
+
+/// <summary>
+/// Round-trips vertices through 'PackVertices' & 'UnpackVertex', positions, directions & UVs have to stay within
+/// the error their quantization allows. Covers the axes & diagonals, and bounds far away from the origin.
+/// </summary>
+unsigned int RunPackingCheck();
+
+/// <summary>
+/// 'RandomStream' has to reproduce the reference PCG32 output, and 'Advance(n)' has to
+/// land on the same state as drawing n numbers, for any n.
+/// </summary>
+unsigned int RunRandomCheck();
+
+/// <summary>
+/// Every level of 'GenerateMipChain' has to lie within 1 LSB of a 2x2 box filter of the previous level,
+/// evaluated in double precision with the exact sRGB curve. Covers odd sizes, 1xN & Nx1 images.
+/// </summary>
+unsigned int RunMipCheck();
+
+/// <summary>
+/// 'ConvertHDRPixels' has to match reference RGBA16F & RGB9E5 encoders bit for bit, including the clamping of
+/// NaN, infinity & negative values. 'GenerateHDRMipChain' has to average the levels like a 2x2 box filter.
+/// </summary>
+unsigned int RunHDRCheck();
+
+/// <summary>
+/// 'OptimizeMesh' on a shuffled grid of unwelded triangles has to keep every triangle with its winding,
+/// weld the grid down to its unique vertices, order them by first use & not make the ACMR any worse.
+/// </summary>
+unsigned int RunMeshCheck();
+
+/// <summary>
+/// 'GenerateTangents' on UV spheres, with & without mirrored UVs, has to match the analytic tangents & bitangent signs.
+/// The large spheres take the parallel path once there's more than one thread, both paths have to be deterministic.
+/// </summary>
+unsigned int RunTangentCheck();
+
+/// <summary>
+/// 'CompressMipChain' on a mip chain with partial blocks, decoded by reference BC1, BC5 & BC7 (mode 6) decoders
+/// written from the D3D spec. 'DecompressMipChain' has to agree with them exactly, and the PSNR of every
+/// format has to stay above its floor.
+/// </summary>
+unsigned int RunCompressionCheck();
+
+/// <summary>
+/// 'glTFLoadVertices', 'glTFLoadVertexAttribute' & 'glTFLoadIndices' on an in-memory model have to decode every
+/// component type, normalized or not, packed or strided, the same as the glTF spec does one value at a time.
+/// </summary>
+unsigned int RunGLTFCheck();
\ No newline at end of file
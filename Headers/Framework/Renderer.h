@@ -7,6 +7,7 @@ using namespace Microsoft::WRL;
 
 class Scene;
 class RayTraceStage;
+class DenoiseStage;
 
 class Renderer
 {
@@ -19,10 +20,14 @@ public:
 
 	void Resize();
 
+	RayTraceStage* GetRayTraceStage();
+	DenoiseStage* GetDenoiseStage();
+
 private:
 	void InitializeImGui();
 
 private:
 	Scene* activeScene;
 	RayTraceStage* rayTraceStage;
+	DenoiseStage* denoiseStage;
 };
\ No newline at end of file
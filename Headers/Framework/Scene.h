@@ -24,6 +24,8 @@ public:
 public:
 	bool HasGeometryMoved = false;
 	bool HasNewGeometry = false;
+	bool HasMaterialChanged = false;
+	bool HasNewTextures = false;
 
 private:
 	std::string sceneName;
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "Framework/Mathematics.h"
+#include "Graphics/TextureProcessing.h"
+
+struct SceneModelDescription
+{
+	std::string path;
+	glm::vec3 position = glm::vec3(0.0f);
+	glm::vec3 rotation = glm::vec3(0.0f);
+	glm::vec3 scale = glm::vec3(1.0f);
+
+	// Uploads the geometry in the compact 'PackedVertex' layout, only used by the DirectX
+	// backend. The CPU backend always keeps full precision vertices.
+	bool usePackedVertices = true;
+};
+
+/// <summary>
+/// Plain description of what a scene contains. Both the (DirectX) Scene and the
+/// CPU backend get build from it, which ensures they always render the same content.
+/// </summary>
+struct SceneDescription
+{
+	std::vector<SceneModelDescription> models;
+	std::string environmentMapPath;
+
+	// Storage of the environment map & its amount of prefiltered levels, only used by the DirectX
+	// backend. The CPU backend always keeps the full resolution 32-bit float image.
+	HDRFormat environmentMapFormat = HDRFormat::RGB9E5;
+	unsigned int environmentMapLevels = 1;
+};
+
+inline SceneDescription GetDefaultSceneDescription()
+{
+	SceneDescription description;
+	description.models.push_back({ "Assets/Models/Bust/marble_bust_01_4k.gltf",
+		glm::vec3(-0.79f, -0.70f, 3.65f), glm::vec3(0.0f, 37.0f, 0.0f), glm::vec3(2.25f) });
+
+	description.models.push_back({ "Assets/Models/Chess/chess_set_2k.gltf",
+		glm::vec3(0.5f, -0.707f, 3.15f), glm::vec3(0.0f, 33.0f, 0.0f), glm::vec3(3.0f) });
+
+	description.models.push_back({ "Assets/Models/Table/side_table_01_8k.gltf",
+		glm::vec3(0.08f, -4.27f, 3.24f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(6.5f) });
+
+	description.models.push_back({ "Assets/Models/FlightHelmet/FlightHelmet.gltf" });
+
+	// Environment Map //
+	description.environmentMapPath = "Assets/EXRs/wharf.exr";
+	return description;
+}
\ No newline at end of file
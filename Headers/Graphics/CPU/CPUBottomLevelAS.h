@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "Graphics/Vertex.h"
+#include "Graphics/CPU/CPUCommon.h"
+
+class ThreadPool;
+class TaskGroup;
+struct RayPacket;
+
+struct BVHNode
+{
+	glm::vec3 boundsMin;
+	unsigned int leftFirst;		// Index of left child, or first triangle when the node is a leaf
+	glm::vec3 boundsMax;
+	unsigned int triangleCount; // 0 for interior nodes
+};
+
+struct BVHBuildStats
+{
+	double buildTime = 0.0; // in milliseconds
+	unsigned int nodeCount = 0;
+	unsigned int leafCount = 0;
+	unsigned int maxDepth = 0;
+
+	// Expected cost of a random ray hitting the root, traversal & intersection cost are both 1
+	float sahCost = 0.0f;
+};
+
+/// <summary>
+/// CPU counterpart of a BLAS. A bounding volume hierarchy build over the triangles
+/// of a single mesh, traversed in object space. Splits are chosen with a binned SAH,
+/// large subtrees get build in parallel on the thread pool.
+/// </summary>
+class CPUBottomLevelAS
+{
+public:
+	// When no thread pool is given, the global pool gets used
+	CPUBottomLevelAS(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, 
+		ThreadPool* threadPool = nullptr);
+
+	// Finds the closest intersection along the ray, only updates 'hit' when it's closer than 'hit.t'.
+	// With 'acceptFirstHit' it stops at any intersection, like 'RAY_FLAG_ACCEPT_FIRST_HIT_AND_END_SEARCH'
+	bool Intersect(const Ray& ray, HitInfo& hit, bool acceptFirstHit = false);
+
+	// Finds the closest intersection for all rays of the packet at once. Returns a mask with a bit set
+	// for every ray of which the hit got updated, their 'instanceIndex' is left to the TLAS
+	uint64_t IntersectPacket(RayPacket& packet);
+
+	glm::vec3 GetBoundsMin();
+	glm::vec3 GetBoundsMax();
+	unsigned int GetNodeCount();
+	const BVHBuildStats& GetBuildStats();
+
+private:
+	void UpdateNodeBounds(BVHNode& node);
+	void Subdivide(unsigned int nodeIndex, unsigned int depth, TaskGroup& group);
+	float FindBestSplit(const BVHNode& node, int& axis, float& splitPosition);
+
+	void CalculateStats(unsigned int nodeIndex, unsigned int depth, float rootArea);
+
+	bool IntersectTriangle(const Ray& ray, unsigned int triangleIndex, HitInfo& hit);
+
+	// 'IntersectPacket' with either 'ScalarPacketTests' or 'AVX2PacketTests', picked at runtime.
+	// The AVX2 version only exists on x64
+	template<typename PacketTests> uint64_t TraversePacket(RayPacket& packet);
+	uint64_t TraversePacketAVX2(RayPacket& packet);
+
+private:
+	ThreadPool* threadPool;
+
+	// Compact copy of the triangle positions, 3 per triangle
+	std::vector<glm::vec3> positions;
+	std::vector<glm::vec3> centroids;
+
+	// Indices into the triangles, reordered during the build so that leafs point to a contiguous range
+	std::vector<unsigned int> triangleIndices;
+	std::vector<BVHNode> nodes;
+	std::atomic<unsigned int> nodesUsed{ 0 };
+
+	BVHBuildStats stats;
+};
\ No newline at end of file
@@ -0,0 +1,554 @@
+#pragma once
+
+// CPU counterpart of 'Common.hlsl'. Any change to the functions in here
+// should be mirrored in the shaders, so that both backends produce the same image.
+#include "Framework/Mathematics.h"
+#include "Graphics/Sampler.h"
+#include <algorithm>
+#include <cfloat>
+
+// Mirrors 'RayDesc' from HLSL
+struct Ray
+{
+	glm::vec3 Origin;
+	glm::vec3 Direction;
+	float TMin = 0.001f;
+	float TMax = 100000.0f;
+};
+
+// Information about the closest intersection found while traversing the scene
+struct HitInfo
+{
+	float t;
+	glm::vec2 bary;
+	unsigned int primitiveIndex = 0;
+	unsigned int instanceIndex = 0;
+	bool hasHit = false;
+};
+
+#pragma region Sampling
+// Mirrors 'PathSampler' in Common.hlsl. Every call to 'Random01' or 'Random2D' draws the next dimension of the sample
+struct PathSampler
+{
+	SamplerType type;
+	unsigned int seed;		// Scrambles the sequence, or the state of XorShift32 for 'SamplerType::Random'
+	unsigned int index;		// Sample of the pixel, starting at 0
+	unsigned int dimension;
+	unsigned int pixel;		// x | (y << 16)
+};
+
+// The camera draws dimension 0, every bounce of a path starts at its own dimension after it. 
+// Keeps the dimensions of the samples lined up, even when some draw more numbers than others.
+static const unsigned int dimensionsPerBounce = 8;
+
+inline unsigned int HashUInt(unsigned int x)
+{
+	// 'lowbias32' by Chris Wellons
+	x ^= x >> 16;
+	x *= 0x7feb352du;
+	x ^= x >> 15;
+	x *= 0x846ca68bu;
+	x ^= x >> 16;
+	return x;
+}
+
+inline unsigned int ReverseBits(unsigned int x)
+{
+	x = ((x >> 1) & 0x55555555u) | ((x & 0x55555555u) << 1);
+	x = ((x >> 2) & 0x33333333u) | ((x & 0x33333333u) << 2);
+	x = ((x >> 4) & 0x0F0F0F0Fu) | ((x & 0x0F0F0F0Fu) << 4);
+	x = ((x >> 8) & 0x00FF00FFu) | ((x & 0x00FF00FFu) << 8);
+	return (x >> 16) | (x << 16);
+}
+
+// Every bit gets flipped depending on the bits below it
+inline unsigned int LaineKarrasPermutation(unsigned int x, unsigned int seed)
+{
+	x += seed;
+	x ^= x * 0x6c50b47cu;
+	x ^= x * 0xb82f1e52u;
+	x ^= x * 0xc7afe638u;
+	x ^= x * 0x8d22f6e6u;
+	return x;
+}
+
+// Owen scrambling through hashing (Burley 2020), every bit gets flipped depending on the bits above it
+inline unsigned int NestedUniformScramble(unsigned int x, unsigned int seed)
+{
+	return ReverseBits(LaineKarrasPermutation(ReverseBits(x), seed));
+}
+
+// Second dimension of Sobol, the first is the van der Corput sequence: 'ReverseBits(index)'
+inline unsigned int SobolSecondDimension(unsigned int index)
+{
+	unsigned int result = 0;
+	for(unsigned int direction = 0x80000000u; index; index >>= 1, direction ^= direction >> 1)
+	{
+		if(index & 1)
+		{
+			result ^= direction;
+		}
+	}
+	return result;
+}
+
+// 24 bits, so the result stays below 1
+inline float ToUnitFloat(unsigned int x)
+{
+	return float(x >> 8) * 5.96046448e-8f;
+}
+
+/// <summary>
+/// Sets up the sampler for sample 'index' of pixel (x, y). 'Random' seeds XorShift32 from the pixel & sample.
+/// 'Sobol' scrambles per pixel, so every pixel gets its own well stratified sequence. 'BlueNoise' shares the
+/// scramble over a tile of 'blueNoiseSize' pixels & scrambles it further by the ranks, see 'GetBlueNoiseScramble'.
+/// </summary>
+inline PathSampler InitializeSampler(SamplerType type, unsigned int x, unsigned int y, unsigned int width, unsigned int index)
+{
+	PathSampler pathSampler;
+	pathSampler.type = type;
+	pathSampler.index = index;
+	pathSampler.dimension = 0;
+	pathSampler.pixel = x | (y << 16);
+
+	switch(type)
+	{
+	case SamplerType::Random:
+		pathSampler.seed = ((index + 1) * 26927) + ((x + y * width) * 78713);
+		break;
+	case SamplerType::Sobol:
+		pathSampler.seed = HashUInt(pathSampler.pixel);
+		break;
+	case SamplerType::BlueNoise:
+		pathSampler.seed = HashUInt((x / blueNoiseSize) | ((y / blueNoiseSize) << 16) | 0x80008000u);
+		break;
+	}
+
+	return pathSampler;
+}
+
+inline void SetBounceDimension(PathSampler& pathSampler, unsigned int depth)
+{
+	pathSampler.dimension = 1 + depth * dimensionsPerBounce;
+}
+
+// Digital shift of a dimension, the top bits of the sample get flipped by the rank of the pixel, at an offset
+// of the dimension's own. Unlike adding it, XOR keeps the pixel's own points stratified. Neighbouring pixels
+// land in different strata instead, while the dimensions stay unrelated on screen.
+inline unsigned int GetBlueNoiseScramble(const PathSampler& pathSampler, unsigned int component)
+{
+	unsigned int offset = HashUInt(pathSampler.dimension * 2 + component);
+	unsigned int x = ((pathSampler.pixel & 0xFFFF) + offset) % blueNoiseSize;
+	unsigned int y = ((pathSampler.pixel >> 16) + (offset >> 16)) % blueNoiseSize;
+
+	// The ranks have 12 bits
+	return GetBlueNoiseRanks()[x + y * blueNoiseSize] << 20;
+}
+
+inline float Random01(PathSampler& pathSampler)
+{
+	if(pathSampler.type == SamplerType::Random)
+	{
+		// XorShift32
+		pathSampler.seed ^= (pathSampler.seed << 13);
+		pathSampler.seed ^= (pathSampler.seed >> 17);
+		pathSampler.seed ^= (pathSampler.seed << 5);
+		return float(pathSampler.seed / 4294967296.0);
+	}
+
+	// Every dimension shuffles the order of the samples & scrambles them with its own seed (padding).
+	// Scrambling van der Corput 'ReverseBits(index)' is the same as permuting the index before reversing it
+	unsigned int dimensionSeed = HashUInt(pathSampler.seed ^ HashUInt(pathSampler.dimension));
+	unsigned int index = NestedUniformScramble(pathSampler.index, dimensionSeed);
+	unsigned int value = ReverseBits(LaineKarrasPermutation(index, HashUInt(dimensionSeed + 1)));
+
+	if(pathSampler.type == SamplerType::BlueNoise)
+	{
+		value ^= GetBlueNoiseScramble(pathSampler, 0);
+	}
+
+	pathSampler.dimension++;
+	return ToUnitFloat(value);
+}
+
+// Both numbers come from the same 2D Sobol points, so they're stratified together rather than each on their own
+inline glm::vec2 Random2D(PathSampler& pathSampler)
+{
+	if(pathSampler.type == SamplerType::Random)
+	{
+		float u1 = Random01(pathSampler);
+		float u2 = Random01(pathSampler);
+		return glm::vec2(u1, u2);
+	}
+
+	unsigned int dimensionSeed = HashUInt(pathSampler.seed ^ HashUInt(pathSampler.dimension));
+	unsigned int index = NestedUniformScramble(pathSampler.index, dimensionSeed);
+	unsigned int x = ReverseBits(LaineKarrasPermutation(index, HashUInt(dimensionSeed + 1)));
+	unsigned int y = NestedUniformScramble(SobolSecondDimension(index), HashUInt(dimensionSeed + 2));
+
+	if(pathSampler.type == SamplerType::BlueNoise)
+	{
+		x ^= GetBlueNoiseScramble(pathSampler, 0);
+		y ^= GetBlueNoiseScramble(pathSampler, 1);
+	}
+
+	pathSampler.dimension++;
+	return glm::vec2(ToUnitFloat(x), ToUnitFloat(y));
+}
+
+inline float RandomInRange(PathSampler& pathSampler, float min, float max)
+{
+	return min + (max - min) * Random01(pathSampler);
+}
+
+#pragma endregion
+
+#pragma region BSDF Sampling
+// Tangent & bitangent around 'normal', without any branches or singularities (Duff et al. 2017)
+inline void BuildOrthonormalBasis(const glm::vec3& normal, glm::vec3& tangent, glm::vec3& bitangent)
+{
+	float signZ = normal.z >= 0.0f ? 1.0f : -1.0f;
+	float a = -1.0f / (signZ + normal.z);
+	float b = normal.x * normal.y * a;
+
+	tangent = glm::vec3(1.0f + signZ * normal.x * normal.x * a, signZ * b, -signZ * normal.x);
+	bitangent = glm::vec3(b, signZ + normal.y * normal.y * a, -normal.y);
+}
+
+// Cosine weighted over the hemisphere around 'normal', its PDF is cos(theta) / PI.
+// With a Lambertian BRDF (albedo / PI), the sample's weight is the albedo.
+inline glm::vec3 CosineHemisphereDirection(PathSampler& pathSampler, const glm::vec3& normal)
+{
+	glm::vec2 u = Random2D(pathSampler);
+	float r = sqrtf(u.x);
+	float phi = u.y * float(2.0 * PI);
+	float z = sqrtf(std::max(1.0f - r * r, 0.0f));
+
+	glm::vec3 tangent;
+	glm::vec3 bitangent;
+	BuildOrthonormalBasis(normal, tangent, bitangent);
+
+	return glm::normalize(tangent * (r * cosf(phi)) + bitangent * (r * sinf(phi)) + normal * z);
+}
+
+// Smith's Lambda for GGX, with 'cosTheta' the angle between a direction and the normal
+inline float GGXLambda(float cosTheta, float alpha)
+{
+	float cos2 = cosTheta * cosTheta;
+	float tan2 = std::max(1.0f - cos2, 0.0f) / std::max(cos2, 1e-8f);
+	return (sqrtf(1.0f + alpha * alpha * tan2) - 1.0f) * 0.5f;
+}
+
+// Microfacet normal from the GGX normals visible from 'view' (Heitz 2018), both in the basis of the normal
+inline glm::vec3 SampleGGXVNDF(const glm::vec3& view, float alpha, float u1, float u2)
+{
+	// 1. Stretch the view, so the distribution becomes a hemisphere //
+	glm::vec3 stretchedView = glm::normalize(glm::vec3(alpha * view.x, alpha * view.y, view.z));
+
+	float lengthSquared = stretchedView.x * stretchedView.x + stretchedView.y * stretchedView.y;
+	glm::vec3 T1 = lengthSquared > 0.0f ? glm::vec3(-stretchedView.y, stretchedView.x, 0.0f) / sqrtf(lengthSquared)
+		: glm::vec3(1.0f, 0.0f, 0.0f);
+	glm::vec3 T2 = glm::cross(stretchedView, T1);
+
+	// 2. Sample the projected area of the hemisphere, a disk with the part hidden from the view folded away //
+	float r = sqrtf(u1);
+	float phi = u2 * float(2.0 * PI);
+	float t1 = r * cosf(phi);
+	float t2 = r * sinf(phi);
+	float s = 0.5f * (1.0f + stretchedView.z);
+	t2 = (1.0f - s) * sqrtf(std::max(1.0f - t1 * t1, 0.0f)) + s * t2;
+
+	glm::vec3 hemisphereNormal = t1 * T1 + t2 * T2 + sqrtf(std::max(1.0f - t1 * t1 - t2 * t2, 0.0f)) * stretchedView;
+
+	// 3. Unstretch back into the GGX distribution //
+	return glm::normalize(glm::vec3(alpha * hemisphereNormal.x, alpha * hemisphereNormal.y, 
+		std::max(hemisphereNormal.z, 0.0f)));
+}
+
+/// <summary>
+/// Reflects 'incoming' off a GGX microfacet, sampled through the normals visible to it. 'roughness' is
+/// perceptual, alpha is its square. 'weight' receives BRDF * cos / PDF without the Fresnel term, 
+/// which for this sampling is G2 / G1 (height correlated Smith). It's 0 when the reflection goes below the surface.
+/// </summary>
+inline glm::vec3 SampleGGXReflection(const glm::vec3& incoming, const glm::vec3& normal, float roughness, 
+	PathSampler& pathSampler, float& weight)
+{
+	float alpha = std::max(roughness * roughness, 1e-4f);
+
+	glm::vec3 tangent;
+	glm::vec3 bitangent;
+	BuildOrthonormalBasis(normal, tangent, bitangent);
+
+	// Normal maps can turn the shading normal away from the view, which then grazes the surface //
+	glm::vec3 view = -incoming;
+	view = glm::normalize(glm::vec3(glm::dot(view, tangent), glm::dot(view, bitangent), 
+		std::max(glm::dot(view, normal), 1e-4f)));
+
+	glm::vec2 u = Random2D(pathSampler);
+	glm::vec3 microfacetNormal = SampleGGXVNDF(view, alpha, u.x, u.y);
+	glm::vec3 light = microfacetNormal * (2.0f * glm::dot(view, microfacetNormal)) - view;
+
+	if(light.z <= 0.0f)
+	{
+		weight = 0.0f;
+		return normal;
+	}
+
+	float lambdaView = GGXLambda(view.z, alpha);
+	float lambdaLight = GGXLambda(light.z, alpha);
+	weight = (1.0f + lambdaView) / (1.0f + lambdaView + lambdaLight);
+
+	return glm::normalize(tangent * light.x + bitangent * light.y + normal * light.z);
+}
+#pragma endregion
+
+#pragma region Intersection
+// Slab test, returns the entry distance of the box or FLT_MAX when it's missed (or further than 'tMax')
+inline float IntersectAABB(const Ray& ray, const glm::vec3& inverseDirection,
+	const glm::vec3& boundsMin, const glm::vec3& boundsMax, float tMax)
+{
+	glm::vec3 t1 = (boundsMin - ray.Origin) * inverseDirection;
+	glm::vec3 t2 = (boundsMax - ray.Origin) * inverseDirection;
+
+	glm::vec3 tNear = glm::min(t1, t2);
+	glm::vec3 tFar = glm::max(t1, t2);
+
+	float entry = std::max(std::max(tNear.x, tNear.y), tNear.z);
+	float exit = std::min(std::min(tFar.x, tFar.y), tFar.z);
+
+	if(exit >= entry && exit > ray.TMin && entry < tMax)
+	{
+		return entry;
+	}
+
+	return FLT_MAX;
+}
+#pragma endregion
+
+#pragma region Utility Functions
+inline glm::vec3 Reflect(const glm::vec3& incoming, const glm::vec3& normal)
+{
+	return incoming - 2.0f * glm::dot(incoming, normal) * normal;
+}
+
+inline float Fresnel(const glm::vec3& incoming, const glm::vec3& normal, float IoR)
+{
+	float cosI = glm::dot(incoming, normal);
+	float n1 = 1.0f;
+	float n2 = IoR;
+
+	if(cosI > 0.0f)
+	{
+		float t = n1;
+		n1 = n2;
+		n2 = t;
+	}
+
+	float sinR = n1 / n2 * sqrtf(std::max(1.0f - cosI * cosI, 0.0f));
+	if(sinR >= 1.0f)
+	{
+		// TIR, aka perfect reflectance, which happens at the exact edges of a surface.
+		return 1.0f;
+	}
+
+	float cosR = sqrtf(std::max(1.0f - sinR * sinR, 0.0f));
+	cosI = fabsf(cosI);
+
+	float Fp = (n2 * cosI - n1 * cosR) / (n2 * cosI + n1 * cosR);
+	float Fr = (n1 * cosI - n2 * cosR) / (n1 * cosI + n2 * cosR);
+
+	return (Fp * Fp + Fr * Fr) * 0.5f;
+}
+
+inline glm::vec3 Refract(const glm::vec3& incoming, const glm::vec3& normal, float IoR)
+{
+	float cosI = glm::dot(incoming, normal);
+	float n1 = 1.0f;
+	float n2 = IoR;
+	glm::vec3 norm = normal;
+
+	if(cosI < 0.0f)
+	{
+		// Going from air into medium
+		cosI = -cosI;
+	}
+	else
+	{
+		// Going from medium back into air
+		float t = n1;
+		n1 = n2;
+		n2 = t;
+		norm = norm * -1.0f;
+	}
+
+	float eta = n1 / n2;
+	float k = 1.0f - eta * eta * (1.0f - cosI * cosI);
+
+	if(k < 0.0f)
+	{
+		return Reflect(incoming, norm);
+	}
+
+	glm::vec3 a = eta * (incoming + (cosI * norm));
+	glm::vec3 b = (norm * -1.0f) * sqrtf(k);
+
+	return a + b;
+}
+#pragma endregion
+
+#pragma region Texture LOD
+// Mirrors 'RayCone' in Common.hlsl. The footprint of a pixel, carried along the whole path
+struct RayCone
+{
+	float width;	   // At the origin of the ray
+	float spreadAngle; // Growth of the width per unit of distance
+};
+
+// The camera is a pinhole, every pixel starts out as a point. The screen plane is 1 unit high at a distance of 2 units
+inline RayCone GetPrimaryRayCone(float imageHeight)
+{
+	return { 0.0f, 1.0f / (2.0f * imageHeight) };
+}
+
+// The cone at the end of a segment of length 't', which is where the next segment starts
+inline RayCone PropagateRayCone(const RayCone& cone, float t)
+{
+	return { cone.width + cone.spreadAngle * t, cone.spreadAngle };
+}
+
+// Bounces scatter the footprint over the lobe they sample. Its width is about the GGX alpha, so
+// perfect mirrors & refractions keep the incoming spread, diffuse bounces (roughness 1) widen it the most
+inline RayCone ScatterRayCone(const RayCone& cone, float roughness)
+{
+	return { cone.width, cone.spreadAngle + roughness * roughness };
+}
+
+// Ray cones (Akenine-Moller et al. 2019), 'coneWidth' is the width of a pixel's footprint at the hit.
+// Returns the mip level for a texture of 1x1, 'GetTextureLOD' adds the size of the actual texture.
+inline float ComputeRayConeLOD(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2,
+	const glm::vec2& uv0, const glm::vec2& uv1, const glm::vec2& uv2, const glm::vec3& rayDirection, float coneWidth)
+{
+	glm::vec3 triangleNormal = glm::cross(p1 - p0, p2 - p0);
+	float worldArea = std::max(glm::length(triangleNormal), 1e-20f);
+	float uvArea = std::max(fabsf((uv1.x - uv0.x) * (uv2.y - uv0.y) - (uv2.x - uv0.x) * (uv1.y - uv0.y)), 1e-20f);
+
+	// Grazing angles stretch the footprint of the cone over the surface
+	float cosine = std::max(fabsf(glm::dot(rayDirection, triangleNormal)) / worldArea, 1e-4f);
+	return 0.5f * log2f(uvArea / worldArea) + log2f(coneWidth / cosine);
+}
+
+inline float GetTextureLOD(float rayConeLOD, float width, float height)
+{
+	return std::max(rayConeLOD + 0.5f * log2f(width * height), 0.0f);
+}
+#pragma endregion
+
+#pragma region Environment Sampling
+// Reads the distribution made by 'BuildEnvironmentDistribution', the environment map uses the same mapping as 'Miss'
+
+// Returns the interval of the CDF (of 'count' intervals, starting at 'offset') which contains 'u'
+inline unsigned int FindCDFInterval(const float* distribution, unsigned int offset, unsigned int count, float u)
+{
+	unsigned int low = 0;
+	unsigned int high = count - 1;
+
+	while(low < high)
+	{
+		unsigned int middle = (low + high + 1) / 2;
+		if(distribution[offset + middle] <= u)
+		{
+			low = middle;
+		}
+		else
+		{
+			high = middle - 1;
+		}
+	}
+
+	return low;
+}
+
+// Returns the direction towards a point of the environment map, proportional to its brightness
+inline glm::vec3 SampleEnvironment(const float* distribution, unsigned int width, unsigned int height, 
+	PathSampler& pathSampler, float& pdf)
+{
+	glm::vec2 random = Random2D(pathSampler);
+	float u1 = std::min(random.x, 0.99999994f);
+	float u2 = std::min(random.y, 0.99999994f);
+
+	// 1. Pick a row through the marginal CDF, then a column through the conditional CDF of that row //
+	unsigned int y = FindCDFInterval(distribution, 0, height, u2);
+	float rowPdf = distribution[y + 1] - distribution[y];
+	float v = (y + (u2 - distribution[y]) / rowPdf) / height;
+
+	unsigned int rowOffset = height + 1 + y * (width + 1);
+	unsigned int x = FindCDFInterval(distribution, rowOffset, width, u1);
+	float columnPdf = distribution[rowOffset + x + 1] - distribution[rowOffset + x];
+	float u = (x + (u1 - distribution[rowOffset + x]) / columnPdf) / width;
+
+	// 2. Convert to a direction, the PDF goes from the image to the sphere //
+	float theta = v * float(PI);
+	float phi = u * float(2.0 * PI) - float(PI);
+	float sinTheta = sinf(theta);
+
+	pdf = sinTheta > 0.0f ? (rowPdf * height * columnPdf * width) / (float(2.0 * PI * PI) * sinTheta) : 0.0f;
+	return glm::vec3(sinTheta * cosf(phi), cosf(theta), sinTheta * sinf(phi));
+}
+
+// PDF (over solid angle) of 'SampleEnvironment' returning 'direction'
+inline float GetEnvironmentPDF(const float* distribution, unsigned int width, unsigned int height, const glm::vec3& direction)
+{
+	float theta = acosf(glm::clamp(direction.y, -1.0f, 1.0f));
+	float phi = atan2f(direction.z, direction.x) + float(PI);
+	float sinTheta = sinf(theta);
+
+	if(sinTheta <= 0.0f)
+	{
+		return 0.0f;
+	}
+
+	unsigned int x = (unsigned int)(phi / float(2.0 * PI) * width) % width;
+	unsigned int y = (unsigned int)(theta / float(PI) * height) % height;
+	unsigned int rowOffset = height + 1 + y * (width + 1);
+
+	float rowPdf = distribution[y + 1] - distribution[y];
+	float columnPdf = distribution[rowOffset + x + 1] - distribution[rowOffset + x];
+	return (rowPdf * height * columnPdf * width) / (float(2.0 * PI * PI) * sinTheta);
+}
+
+// Weight of a sample with 'pdf' when another strategy could've sampled it with 'otherPdf'
+inline float PowerHeuristic(float pdf, float otherPdf)
+{
+	float a = pdf * pdf;
+	float b = otherPdf * otherPdf;
+	return a + b > 0.0f ? a / (a + b) : 0.0f;
+}
+#pragma endregion
+
+#pragma region Adaptive Sampling
+// Pixels need this many samples before their variance is trusted
+static const unsigned int minAdaptiveSampleCount = 32;
+
+inline float Luminance(const glm::vec3& color)
+{
+	return glm::dot(color, glm::vec3(0.2126f, 0.7152f, 0.0722f));
+}
+
+/// <summary>
+/// Relative standard error of a pixel's mean luminance. 'accumulated' holds the summed radiance & sample count,
+/// 'moment' the summed squared luminance. Near-black pixels are measured against a floor, otherwise their
+/// noise would never count as converged, even though it can't be seen.
+/// </summary>
+inline float GetRelativeError(const glm::vec4& accumulated, float moment)
+{
+	float sampleCount = accumulated.a;
+	if(sampleCount < float(minAdaptiveSampleCount))
+	{
+		return FLT_MAX;
+	}
+
+	float mean = Luminance(glm::vec3(accumulated)) / sampleCount;
+	float variance = std::max(moment / sampleCount - mean * mean, 0.0f) * sampleCount / (sampleCount - 1.0f);
+	return sqrtf(variance / sampleCount) / (mean + 0.01f);
+}
+#pragma endregion
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include "Graphics/Extensions/Shared_TinyglTF.h"
+
+#include "Graphics/Vertex.h"
+#include "Graphics/Material.h"
+#include "Framework/Mathematics.h"
+
+class CPUTexture;
+class CPUBottomLevelAS;
+struct CookedMesh;
+
+/// <summary>
+/// CPU counterpart of 'Mesh'. Instead of uploading the geometry, it keeps it around
+/// in system memory so it can be used for shading, and builds a BLAS over it.
+/// The geometry stays in the space of the glTF mesh, node transforms are applied by the instances.
+/// </summary>
+class CPUMesh
+{
+public:
+	// The textures are owned by the model, indexed by glTF image
+	CPUMesh(const CookedMesh& cookedMesh, const std::vector<CPUTexture*>& textures);
+	~CPUMesh();
+
+	const Vertex& GetVertex(unsigned int primitiveIndex, unsigned int corner);
+	unsigned int GetTriangleCount();
+	CPUBottomLevelAS* GetBLAS();
+
+private:
+	CPUTexture* GetTexture(int imageIndex, const std::vector<CPUTexture*>& textures);
+
+public:
+	std::string Name;
+	Material material;
+
+	CPUTexture* diffuseTexture = nullptr;
+	CPUTexture* normalTexture = nullptr;
+	CPUTexture* ORMTexture = nullptr;
+
+private:
+	std::vector<Vertex> vertices;
+	std::vector<unsigned int> indices;
+
+	CPUBottomLevelAS* blas;
+};
\ No newline at end of file
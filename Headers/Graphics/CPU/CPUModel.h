@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Graphics/Transform.h"
+
+class CPUMesh;
+class CPUTexture;
+class CookedModel;
+
+// A mesh placed by a node in the glTF hierarchy. Nodes referencing the same 
+// glTF mesh share the CPUMesh, only the transform differs.
+struct CPUMeshInstance
+{
+	CPUMesh* mesh;
+	glm::mat4 nodeTransform;
+};
+
+/// <summary>
+/// CPU counterpart of 'Model', loads a (cooked) glTF file and creates a CPUMesh for every primitive in it.
+/// Unlike 'Model' the node transforms aren't baked into the vertices, so meshes can be instanced.
+/// </summary>
+class CPUModel
+{
+public:
+	CPUModel(const std::string& filePath);
+	~CPUModel();
+
+	CPUMesh* GetMesh(int index);
+	const std::vector<CPUMesh*>& GetMeshes();
+	unsigned int GetMeshCount();
+
+	// In the same order as the meshes of 'Model', which is also the order of the DXR instances
+	const std::vector<CPUMeshInstance>& GetMeshInstances();
+
+private:
+	void LoadTextures(CookedModel& cookedModel);
+	void LoadMeshes(CookedModel& cookedModel);
+
+public:
+	Transform transform;
+	std::string Name;
+
+	// When true, all meshes use the same material,
+	// When false, each mesh uses its own material settings
+	bool useSingleMaterial = true;
+
+private:
+	std::vector<CPUMesh*> meshes;
+	std::vector<CPUMeshInstance> meshInstances;
+
+	// Indexed by glTF image, shared between all meshes of this model
+	std::vector<CPUTexture*> textures;
+};
\ No newline at end of file
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Graphics/CPU/CPUCommon.h"
+#include "Graphics/Denoiser.h"
+
+class CPUScene;
+class ThreadPool;
+struct Material;
+struct RayPacket;
+
+/// <summary>
+/// Headless path tracer that mirrors the DXR path tracing shaders ('RayGen', 'ClosestHit-PT' & 'Miss').
+/// The image gets split up in tiles which are distributed over a work-stealing thread pool.
+/// Useful as a reference for the GPU output, and to render without a GPU.
+/// </summary>
+class CPUPathTracer
+{
+public:
+	// 'Recursive' mirrors the ray trees of 'ClosestHit-PT', 'Iterative' mirrors the path loop of 'RayGen'
+	enum class Integrator
+	{
+		Recursive,
+		Iterative
+	};
+
+	// When no thread pool is given, the global pool gets used
+	CPUPathTracer(CPUScene* scene, unsigned int width, unsigned int height, ThreadPool* threadPool = nullptr);
+
+	// Adds 'sampleCount' samples per pixel to the accumulation buffer
+	void Render(unsigned int sampleCount);
+
+	// Adaptive sampling, only tiles with a relative error of at least 'targetError' get 'sampleCount' samples.
+	// Returns the number of tiles that got rendered, 0 once the whole image converged
+	unsigned int RenderAdaptive(unsigned int sampleCount, float targetError);
+
+	// Keeps rendering adaptively until every tile is below 'targetError', or got 'maxSampleCount' samples
+	void RenderUntilConverged(float targetError, unsigned int maxSampleCount);
+
+	void ClearBuffers();
+	void SetIntegrator(Integrator integrator);
+
+	// Paths of the iterative integrator trace at least 'minDepth' rays before Russian roulette can end them,
+	// and at most 'maxDepth'. Making them equal turns Russian roulette off
+	void SetDepthRange(unsigned int minDepth, unsigned int maxDepth);
+
+	// Changing it mid-render mixes the sequences, clear the buffers first
+	void SetSamplerType(SamplerType samplerType);
+
+	// The primary rays of a tile get traced together as a packet, turning it off traces them one by one.
+	// Both find the same hits, so it doesn't change the image
+	void SetPacketTracing(bool usePacketTracing);
+
+	// Traces 'sampleCount' primary rays per pixel, one by one & as packets, and logs the Mrays/s of both
+	void BenchmarkPrimaryRays(unsigned int sampleCount);
+
+	// Filters the accumulated image with the first-hit guides, the result replaces the image until more samples get rendered
+	void Denoise(const DenoiserSettings& settings = DenoiserSettings());
+
+	// '.exr' stores the linear (HDR) average, '.png' stores the tonemapped result
+	bool SaveImage(const std::string& filePath);
+
+	// Peak signal-to-noise ratio of the tonemapped image against a (converged) reference '.exr', -1 when it can't be compared
+	float GetPSNR(const std::string& referencePath);
+
+	glm::vec3 GetPixelColor(unsigned int x, unsigned int y);
+	unsigned int GetPixelSampleCount(unsigned int x, unsigned int y); // Differs per tile with adaptive sampling
+	unsigned int GetFrameCount();
+
+	// Root mean square of the relative error of the pixels in a tile, or the whole image
+	float GetTileError(unsigned int tileIndex);
+	float GetImageError();
+
+private:
+	// Mirrors the extra data the payload carries back to 'RayGen' in the iterative mode
+	struct PathSegment
+	{
+		glm::vec3 radiance;   // Emission & sampled environment light at the hit
+		glm::vec3 throughput; // Weight of the next ray, 0 ends the path
+		Ray nextRay;
+		RayCone nextCone;
+		float bsdfPdf;
+		glm::vec3 albedo;
+		glm::vec3 normal;
+	};
+
+	// First hit of a sample, summed over all samples of a pixel for the denoiser
+	struct PixelGuides
+	{
+		glm::vec3 albedo = glm::vec3(0.0f);
+		glm::vec3 normal = glm::vec3(0.0f);
+		float depth = 0.0f;
+	};
+
+	struct TileStatistics
+	{
+		unsigned long long rayCount = 0;
+		unsigned long long shadowRayCount = 0;
+		unsigned long long sampleCount = 0;
+		unsigned int maxRayCount = 0;
+	};
+
+	struct Surface
+	{
+		const Material* material;
+		glm::vec3 albedo;
+		glm::vec3 normal;
+		float roughness;
+	};
+
+	void RenderTiles(const std::vector<unsigned int>& tiles, unsigned int sampleCount);
+	void RenderTile(unsigned int tileIndex, unsigned int sampleCount);
+
+	// Finds the first hit of all rays in the packet, returns a mask with a bit set for every ray that hit something
+	uint64_t TracePrimaryRays(RayPacket& packet, bool usePacketTracing);
+	void LogStatistics(double seconds);
+
+	// Shader Mirrors //
+	PathSampler GetSampler(unsigned int x, unsigned int y, unsigned int sampleIndex);
+	glm::vec3 GetRayDirection(PathSampler& pathSampler, unsigned int x, unsigned int y, const glm::vec3& cameraPosition);
+	// 'bsdfPdf' is the PDF of the BSDF sample that spawned the ray, 0 when the environment isn't sampled as a light for it
+	// 'cone' is the footprint of the pixel at the origin of the ray, see 'PropagateRayCone' & 'ScatterRayCone'
+	glm::vec3 TraceRay(const Ray& ray, const RayCone& cone, PathSampler pathSampler, unsigned int depth, float bsdfPdf = 0.0f);
+	glm::vec3 ClosestHit(const Ray& ray, const RayCone& cone, const HitInfo& hit, PathSampler pathSampler, unsigned int depth);
+	// 'hit' is the first hit of 'ray', which got traced together with the rest of the tile
+	glm::vec3 TracePath(Ray ray, HitInfo hit, PathSampler pathSampler, PixelGuides& guides);
+	void TraceGuides(const Ray& ray, const HitInfo& hit, PixelGuides& guides);
+	void SampleSurface(const Ray& ray, const RayCone& cone, const HitInfo& hit, PathSampler& pathSampler, PathSegment& segment);
+	// 'coneWidth' is the width of the pixel's footprint at the hit, it picks the mip level of the textures
+	void GetSurface(const Ray& ray, const HitInfo& hit, float coneWidth, Surface& surface);
+	glm::vec3 Miss(const Ray& ray, float bsdfPdf);
+
+	glm::vec3 SampleEnvironmentLight(const glm::vec3& position, const glm::vec3& normal, 
+		const glm::vec3& BRDF, PathSampler& pathSampler);
+
+	// 'cone' is the footprint at the hit, the rays spawned there start from it
+	glm::vec3 ComputePureDiffuse(const Ray& ray, float t, const RayCone& cone, const glm::vec3& albedo, 
+		const glm::vec3& normal, PathSampler pathSampler, unsigned int depth);
+	glm::vec3 ComputeDielectricRadiance(const Ray& ray, float t, const RayCone& cone, const Material& material, const glm::vec3& albedo,
+		const glm::vec3& normal, float roughness, PathSampler pathSampler, unsigned int depth);
+	glm::vec3 ComputeConductorRadiance(const Ray& ray, float t, const RayCone& cone, const glm::vec3& albedo, 
+		const glm::vec3& normal, float roughness, PathSampler pathSampler, unsigned int depth);
+	glm::vec3 ComputeTransmissionRadiance(const Ray& ray, float t, const RayCone& cone, const Material& material, const glm::vec3& albedo,
+		const glm::vec3& normal, PathSampler pathSampler, unsigned int depth);
+
+	glm::vec3 Tonemap(glm::vec3 color);
+
+private:
+	CPUScene* scene;
+	ThreadPool* threadPool;
+
+	unsigned int width;
+	unsigned int height;
+	unsigned int tileCountX;
+	unsigned int tileCountY;
+
+	// rgb: summed radiance, a: sample count
+	std::vector<glm::vec4> colorBuffer;
+
+	// Summed squared luminance, the second moment which the variance of every pixel gets estimated with
+	std::vector<float> momentBuffer;
+	std::vector<PixelGuides> guideBuffer;
+
+	// Average radiance after denoising, only used while 'isDenoised' is set
+	std::vector<glm::vec3> denoisedBuffer;
+	bool isDenoised = false;
+
+	Integrator integrator = Integrator::Iterative;
+	unsigned int minDepth = 3;
+	unsigned int maxDepth = 8;
+	SamplerType samplerType = SamplerType::BlueNoise;
+	bool usePacketTracing = true;
+
+	// Rays traced by every tile since the statistics got logged
+	std::vector<TileStatistics> tileStatistics;
+
+	// Starts at 1 to match the first frame of the GPU renderer
+	unsigned int frameCount = 1;
+};
\ No newline at end of file
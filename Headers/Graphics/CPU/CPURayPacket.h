@@ -0,0 +1,482 @@
+#pragma once
+
+// Coherent rays that traverse the BVHs together, see 'CPUTopLevelAS::IntersectPacket'.
+// Every 8 rays form a group that gets tested at once. On x64 there's an AVX2 version of every test next to
+// the scalar one, the app itself isn't built for AVX2, so the traversal picks one at runtime ('UsePacketAVX2').
+#include "Graphics/CPU/CPUCommon.h"
+#include "Graphics/CPU/CPUBottomLevelAS.h"
+
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define PACKET_AVX2
+#include <immintrin.h>
+
+// Lets GCC & Clang emit AVX2 for a single function, MSVC always accepts the intrinsics.
+// 'PACKET_AVX2_KERNEL' also inlines everything it calls, so the tests end up inside of the AVX2 traversal
+#if defined(_MSC_VER) && !defined(__clang__)
+#define PACKET_AVX2_TARGET
+#define PACKET_AVX2_KERNEL
+#else
+#define PACKET_AVX2_TARGET __attribute__((target("avx2")))
+#define PACKET_AVX2_KERNEL __attribute__((target("avx2"), flatten))
+#endif
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Whether the CPU (and OS) support AVX2, always false when the AVX2 tests aren't built
+bool IsAVX2Supported();
+
+// Packets get traced with the AVX2 tests whenever the CPU supports them, turning it off forces the
+// scalar tests, e.g. to compare both. Turning it on without support does nothing
+void SetPacketAVX2(bool isEnabled);
+bool UsePacketAVX2();
+
+static const unsigned int packetGroupSize = 8;
+static const unsigned int packetGroupCount = 8;
+static const unsigned int packetSize = packetGroupSize * packetGroupCount;
+
+// Index of the lowest set bit, 'mask' can't be 0
+inline unsigned int CountTrailingZeros(uint64_t mask)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward64(&index, mask);
+	return index;
+#else
+	return __builtin_ctzll(mask);
+#endif
+}
+
+/// <summary>
+/// Up to 64 rays that share an origin, like the primary rays of an 8x8 tile. Directions & hits are stored
+/// per component, so a group of 8 rays fits a single AVX register. The directions get bounded by a frustum
+/// of 4 planes through the origin, which lets whole BVH nodes be skipped without testing any of the rays.
+/// </summary>
+struct RayPacket
+{
+	// Call once the origin, 'rayCount' and the directions are set. The unused rays get padded with
+	// a copy of the first one, which can never hit anything
+	void Prepare()
+	{
+		for(unsigned int i = rayCount; i < packetSize; i++)
+		{
+			directionX[i] = directionX[0];
+			directionY[i] = directionY[0];
+			directionZ[i] = directionZ[0];
+			t[i] = -FLT_MAX;
+		}
+
+		for(unsigned int i = 0; i < packetSize; i++)
+		{
+			inverseDirectionX[i] = 1.0f / directionX[i];
+			inverseDirectionY[i] = 1.0f / directionY[i];
+			inverseDirectionZ[i] = 1.0f / directionZ[i];
+		}
+
+		BuildFrustum();
+	}
+
+	void SetDirection(unsigned int index, const glm::vec3& direction)
+	{
+		directionX[index] = direction.x;
+		directionY[index] = direction.y;
+		directionZ[index] = direction.z;
+	}
+
+	glm::vec3 GetDirection(unsigned int index) const
+	{
+		return glm::vec3(directionX[index], directionY[index], directionZ[index]);
+	}
+
+	// Only valid for rays of which the bit is set in the mask that 'IntersectPacket' returned
+	HitInfo GetHit(unsigned int index) const
+	{
+		HitInfo hit;
+		hit.t = t[index];
+		hit.bary = glm::vec2(u[index], v[index]);
+		hit.primitiveIndex = primitiveIndex[index];
+		hit.instanceIndex = instanceIndex[index];
+		hit.hasHit = true;
+		return hit;
+	}
+
+	glm::vec3 origin;
+	float tMin = 0.001f;
+	unsigned int rayCount = packetSize;
+
+	alignas(32) float directionX[packetSize];
+	alignas(32) float directionY[packetSize];
+	alignas(32) float directionZ[packetSize];
+	alignas(32) float inverseDirectionX[packetSize];
+	alignas(32) float inverseDirectionY[packetSize];
+	alignas(32) float inverseDirectionZ[packetSize];
+
+	// Closest hit of every ray, 't' has to start at the 'TMax' of the ray
+	alignas(32) float t[packetSize];
+	alignas(32) float u[packetSize];
+	alignas(32) float v[packetSize];
+	alignas(32) unsigned int primitiveIndex[packetSize];
+	alignas(32) unsigned int instanceIndex[packetSize];
+
+	// Inward facing normals of the frustum planes, which all go through the origin
+	alignas(32) float planeX[4];
+	alignas(32) float planeY[4];
+	alignas(32) float planeZ[4];
+
+	// Average direction, children along it get visited first
+	glm::vec3 centralDirection;
+
+private:
+	void BuildFrustum()
+	{
+		// 1) Project the directions onto a plane in front of the origin //
+		centralDirection = glm::vec3(0.0f);
+		for(unsigned int i = 0; i < rayCount; i++)
+		{
+			centralDirection += glm::normalize(GetDirection(i));
+		}
+		centralDirection = glm::normalize(centralDirection);
+
+		glm::vec3 up = fabsf(centralDirection.y) < 0.99f ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+		glm::vec3 tangent = glm::normalize(glm::cross(up, centralDirection));
+		glm::vec3 bitangent = glm::cross(centralDirection, tangent);
+
+		glm::vec2 projectedMin = glm::vec2(FLT_MAX);
+		glm::vec2 projectedMax = glm::vec2(-FLT_MAX);
+		bool isBounded = true;
+
+		for(unsigned int i = 0; i < rayCount; i++)
+		{
+			glm::vec3 direction = GetDirection(i);
+			float distance = glm::dot(direction, centralDirection);
+			if(distance <= 0.0f)
+			{
+				isBounded = false;
+				break;
+			}
+
+			glm::vec2 projected = glm::vec2(glm::dot(direction, tangent), glm::dot(direction, bitangent)) / distance;
+			projectedMin = glm::min(projectedMin, projected);
+			projectedMax = glm::max(projectedMax, projected);
+		}
+
+		// Rays that spread over more than a hemisphere can't be bounded, the planes then cull nothing
+		if(!isBounded)
+		{
+			for(unsigned int i = 0; i < 4; i++)
+			{
+				planeX[i] = planeY[i] = planeZ[i] = 0.0f;
+			}
+			return;
+		}
+
+		// Widened a bit, so that rounding can't push a ray outside of the frustum
+		glm::vec2 margin = (projectedMax - projectedMin) * 1e-3f + glm::vec2(1e-5f);
+		projectedMin -= margin;
+		projectedMax += margin;
+
+		// 2) Every edge of the bounds, together with the origin, spans a plane //
+		glm::vec3 normals[4];
+		normals[0] = glm::cross(bitangent, centralDirection + tangent * projectedMin.x);
+		normals[1] = glm::cross(centralDirection + tangent * projectedMax.x, bitangent);
+		normals[2] = glm::cross(centralDirection + bitangent * projectedMin.y, tangent);
+		normals[3] = glm::cross(tangent, centralDirection + bitangent * projectedMax.y);
+
+		for(unsigned int i = 0; i < 4; i++)
+		{
+			planeX[i] = normals[i].x;
+			planeY[i] = normals[i].y;
+			planeZ[i] = normals[i].z;
+		}
+	}
+};
+
+#pragma region Packet Intersection
+/// <summary>
+/// Tests both children of a node against the frustum of the packet, a child is culled once its box
+/// lies entirely behind one of the planes. Returns a mask with bit 0 set when the left child might get hit,
+/// and bit 1 for the right child.
+/// </summary>
+inline unsigned int IntersectPacketFrustum(const RayPacket& packet, const BVHNode& left, const BVHNode& right)
+{
+	const BVHNode* children[2] = { &left, &right };
+	unsigned int mask = 0;
+
+	for(unsigned int c = 0; c < 2; c++)
+	{
+		bool isCulled = false;
+		for(unsigned int i = 0; i < 4; i++)
+		{
+			glm::vec3 corner;
+			corner.x = packet.planeX[i] > 0.0f ? children[c]->boundsMax.x : children[c]->boundsMin.x;
+			corner.y = packet.planeY[i] > 0.0f ? children[c]->boundsMax.y : children[c]->boundsMin.y;
+			corner.z = packet.planeZ[i] > 0.0f ? children[c]->boundsMax.z : children[c]->boundsMin.z;
+			corner -= packet.origin;
+
+			isCulled |= packet.planeX[i] * corner.x + packet.planeY[i] * corner.y + packet.planeZ[i] * corner.z < 0.0f;
+		}
+
+		mask |= isCulled ? 0 : (1 << c);
+	}
+
+	return mask;
+}
+
+/// <summary>
+/// Slab test of the 8 rays in 'group' against a box, the same test as 'IntersectAABB'.
+/// Returns a mask with a bit set for every ray that enters the box before its closest hit.
+/// </summary>
+inline unsigned int IntersectPacketAABB(const RayPacket& packet, unsigned int group,
+	const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+{
+	const unsigned int first = group * packetGroupSize;
+
+	unsigned int mask = 0;
+	for(unsigned int i = 0; i < packetGroupSize; i++)
+	{
+		unsigned int index = first + i;
+		glm::vec3 inverseDirection = glm::vec3(packet.inverseDirectionX[index],
+			packet.inverseDirectionY[index], packet.inverseDirectionZ[index]);
+
+		glm::vec3 t1 = (boundsMin - packet.origin) * inverseDirection;
+		glm::vec3 t2 = (boundsMax - packet.origin) * inverseDirection;
+		glm::vec3 tNear = glm::min(t1, t2);
+		glm::vec3 tFar = glm::max(t1, t2);
+
+		float entry = std::max(std::max(tNear.x, tNear.y), tNear.z);
+		float exit = std::min(std::min(tFar.x, tFar.y), tFar.z);
+
+		if(exit >= entry && exit > packet.tMin && entry < packet.t[index])
+		{
+			mask |= 1 << i;
+		}
+	}
+
+	return mask;
+}
+
+/// <summary>
+/// Moller-Trumbore for the 8 rays in 'group', in the same order of operations as the single ray version
+/// in 'CPUBottomLevelAS', so both find exactly the same hits. Rays that hit the triangle before their
+/// closest hit get it updated, returns a mask with a bit set for each of them.
+/// </summary>
+inline unsigned int IntersectPacketTriangle(RayPacket& packet, unsigned int group, const glm::vec3& v0,
+	const glm::vec3& v1, const glm::vec3& v2, unsigned int triangleIndex)
+{
+	const unsigned int first = group * packetGroupSize;
+
+	glm::vec3 edge1 = v1 - v0;
+	glm::vec3 edge2 = v2 - v0;
+
+	// Everything that only depends on the origin is shared by the rays //
+	glm::vec3 s = packet.origin - v0;
+	glm::vec3 q = glm::cross(s, edge1);
+	float edgeDistance = glm::dot(edge2, q);
+
+	unsigned int mask = 0;
+	for(unsigned int i = 0; i < packetGroupSize; i++)
+	{
+		unsigned int index = first + i;
+		glm::vec3 direction = packet.GetDirection(index);
+
+		glm::vec3 h = glm::cross(direction, edge2);
+		float a = glm::dot(edge1, h);
+		if(fabsf(a) < 1e-12f)
+		{
+			continue;
+		}
+
+		float f = 1.0f / a;
+		float u = f * glm::dot(s, h);
+		if(u < 0.0f || u > 1.0f)
+		{
+			continue;
+		}
+
+		float v = f * glm::dot(direction, q);
+		if(v < 0.0f || u + v > 1.0f)
+		{
+			continue;
+		}
+
+		float t = f * edgeDistance;
+		if(t < packet.tMin || t >= packet.t[index])
+		{
+			continue;
+		}
+
+		packet.t[index] = t;
+		packet.u[index] = u;
+		packet.v[index] = v;
+		packet.primitiveIndex[index] = triangleIndex;
+		mask |= 1 << i;
+	}
+
+	return mask;
+}
+
+/// <summary>
+/// The tests a packet traversal gets built with, see 'CPUBottomLevelAS::TraversePacket'.
+/// </summary>
+struct ScalarPacketTests
+{
+	static unsigned int Frustum(const RayPacket& packet, const BVHNode& left, const BVHNode& right)
+	{
+		return IntersectPacketFrustum(packet, left, right);
+	}
+
+	static unsigned int AABB(const RayPacket& packet, unsigned int group, const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+	{
+		return IntersectPacketAABB(packet, group, boundsMin, boundsMax);
+	}
+
+	static unsigned int Triangle(RayPacket& packet, unsigned int group, const glm::vec3& v0,
+		const glm::vec3& v1, const glm::vec3& v2, unsigned int triangleIndex)
+	{
+		return IntersectPacketTriangle(packet, group, v0, v1, v2, triangleIndex);
+	}
+};
+
+#ifdef PACKET_AVX2
+// AVX2 version of 'IntersectPacketFrustum', tests the 4 planes of both children at once
+PACKET_AVX2_TARGET inline unsigned int IntersectPacketFrustumAVX2(const RayPacket& packet, const BVHNode& left, const BVHNode& right)
+{
+	const __m256 zero = _mm256_setzero_ps();
+
+	// Lanes 0-3 hold the planes against the left child, lanes 4-7 against the right child //
+	const __m256 planeX = _mm256_broadcast_ps((const __m128*)packet.planeX);
+	const __m256 planeY = _mm256_broadcast_ps((const __m128*)packet.planeY);
+	const __m256 planeZ = _mm256_broadcast_ps((const __m128*)packet.planeZ);
+
+	const __m256 minX = _mm256_setr_m128(_mm_set1_ps(left.boundsMin.x), _mm_set1_ps(right.boundsMin.x));
+	const __m256 minY = _mm256_setr_m128(_mm_set1_ps(left.boundsMin.y), _mm_set1_ps(right.boundsMin.y));
+	const __m256 minZ = _mm256_setr_m128(_mm_set1_ps(left.boundsMin.z), _mm_set1_ps(right.boundsMin.z));
+	const __m256 maxX = _mm256_setr_m128(_mm_set1_ps(left.boundsMax.x), _mm_set1_ps(right.boundsMax.x));
+	const __m256 maxY = _mm256_setr_m128(_mm_set1_ps(left.boundsMax.y), _mm_set1_ps(right.boundsMax.y));
+	const __m256 maxZ = _mm256_setr_m128(_mm_set1_ps(left.boundsMax.z), _mm_set1_ps(right.boundsMax.z));
+
+	// The corner furthest along the normal decides whether any of the box is in front of the plane //
+	const __m256 cornerX = _mm256_sub_ps(_mm256_blendv_ps(minX, maxX, _mm256_cmp_ps(planeX, zero, _CMP_GT_OQ)), _mm256_set1_ps(packet.origin.x));
+	const __m256 cornerY = _mm256_sub_ps(_mm256_blendv_ps(minY, maxY, _mm256_cmp_ps(planeY, zero, _CMP_GT_OQ)), _mm256_set1_ps(packet.origin.y));
+	const __m256 cornerZ = _mm256_sub_ps(_mm256_blendv_ps(minZ, maxZ, _mm256_cmp_ps(planeZ, zero, _CMP_GT_OQ)), _mm256_set1_ps(packet.origin.z));
+
+	const __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(planeX, cornerX),
+		_mm256_mul_ps(planeY, cornerY)), _mm256_mul_ps(planeZ, cornerZ));
+	const unsigned int culled = _mm256_movemask_ps(_mm256_cmp_ps(distance, zero, _CMP_LT_OQ));
+
+	return ((culled & 0x0F) ? 0 : 1) | ((culled & 0xF0) ? 0 : 2);
+}
+
+// AVX2 version of 'IntersectPacketAABB', tests all 8 rays at once
+PACKET_AVX2_TARGET inline unsigned int IntersectPacketAABBAVX2(const RayPacket& packet, unsigned int group,
+	const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+{
+	const unsigned int first = group * packetGroupSize;
+
+	const __m256 inverseX = _mm256_load_ps(&packet.inverseDirectionX[first]);
+	const __m256 inverseY = _mm256_load_ps(&packet.inverseDirectionY[first]);
+	const __m256 inverseZ = _mm256_load_ps(&packet.inverseDirectionZ[first]);
+
+	// The origin is shared, so the distances to the planes only get scaled per ray //
+	const __m256 t1X = _mm256_mul_ps(_mm256_set1_ps(boundsMin.x - packet.origin.x), inverseX);
+	const __m256 t1Y = _mm256_mul_ps(_mm256_set1_ps(boundsMin.y - packet.origin.y), inverseY);
+	const __m256 t1Z = _mm256_mul_ps(_mm256_set1_ps(boundsMin.z - packet.origin.z), inverseZ);
+	const __m256 t2X = _mm256_mul_ps(_mm256_set1_ps(boundsMax.x - packet.origin.x), inverseX);
+	const __m256 t2Y = _mm256_mul_ps(_mm256_set1_ps(boundsMax.y - packet.origin.y), inverseY);
+	const __m256 t2Z = _mm256_mul_ps(_mm256_set1_ps(boundsMax.z - packet.origin.z), inverseZ);
+
+	const __m256 entry = _mm256_max_ps(_mm256_max_ps(_mm256_min_ps(t1X, t2X), _mm256_min_ps(t1Y, t2Y)), _mm256_min_ps(t1Z, t2Z));
+	const __m256 exit = _mm256_min_ps(_mm256_min_ps(_mm256_max_ps(t1X, t2X), _mm256_max_ps(t1Y, t2Y)), _mm256_max_ps(t1Z, t2Z));
+
+	__m256 isHit = _mm256_cmp_ps(exit, entry, _CMP_GE_OQ);
+	isHit = _mm256_and_ps(isHit, _mm256_cmp_ps(exit, _mm256_set1_ps(packet.tMin), _CMP_GT_OQ));
+	isHit = _mm256_and_ps(isHit, _mm256_cmp_ps(entry, _mm256_load_ps(&packet.t[first]), _CMP_LT_OQ));
+	return _mm256_movemask_ps(isHit);
+}
+
+// AVX2 version of 'IntersectPacketTriangle', tests all 8 rays at once
+PACKET_AVX2_TARGET inline unsigned int IntersectPacketTriangleAVX2(RayPacket& packet, unsigned int group, const glm::vec3& v0,
+	const glm::vec3& v1, const glm::vec3& v2, unsigned int triangleIndex)
+{
+	const unsigned int first = group * packetGroupSize;
+
+	glm::vec3 edge1 = v1 - v0;
+	glm::vec3 edge2 = v2 - v0;
+
+	// Everything that only depends on the origin is shared by the rays //
+	glm::vec3 s = packet.origin - v0;
+	glm::vec3 q = glm::cross(s, edge1);
+	float edgeDistance = glm::dot(edge2, q);
+
+	const __m256 directionX = _mm256_load_ps(&packet.directionX[first]);
+	const __m256 directionY = _mm256_load_ps(&packet.directionY[first]);
+	const __m256 directionZ = _mm256_load_ps(&packet.directionZ[first]);
+
+	// h = cross(direction, edge2) //
+	const __m256 hX = _mm256_sub_ps(_mm256_mul_ps(directionY, _mm256_set1_ps(edge2.z)), _mm256_mul_ps(_mm256_set1_ps(edge2.y), directionZ));
+	const __m256 hY = _mm256_sub_ps(_mm256_mul_ps(directionZ, _mm256_set1_ps(edge2.x)), _mm256_mul_ps(_mm256_set1_ps(edge2.z), directionX));
+	const __m256 hZ = _mm256_sub_ps(_mm256_mul_ps(directionX, _mm256_set1_ps(edge2.y)), _mm256_mul_ps(_mm256_set1_ps(edge2.x), directionY));
+
+	const __m256 a = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(edge1.x), hX),
+		_mm256_mul_ps(_mm256_set1_ps(edge1.y), hY)), _mm256_mul_ps(_mm256_set1_ps(edge1.z), hZ));
+	const __m256 absoluteA = _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a);
+	__m256 isHit = _mm256_cmp_ps(absoluteA, _mm256_set1_ps(1e-12f), _CMP_GE_OQ);
+
+	const __m256 f = _mm256_div_ps(_mm256_set1_ps(1.0f), a);
+	const __m256 u = _mm256_mul_ps(f, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(s.x), hX),
+		_mm256_mul_ps(_mm256_set1_ps(s.y), hY)), _mm256_mul_ps(_mm256_set1_ps(s.z), hZ)));
+	isHit = _mm256_and_ps(isHit, _mm256_cmp_ps(u, _mm256_setzero_ps(), _CMP_GE_OQ));
+	isHit = _mm256_and_ps(isHit, _mm256_cmp_ps(u, _mm256_set1_ps(1.0f), _CMP_LE_OQ));
+
+	const __m256 v = _mm256_mul_ps(f, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(directionX, _mm256_set1_ps(q.x)),
+		_mm256_mul_ps(directionY, _mm256_set1_ps(q.y))), _mm256_mul_ps(directionZ, _mm256_set1_ps(q.z))));
+	isHit = _mm256_and_ps(isHit, _mm256_cmp_ps(v, _mm256_setzero_ps(), _CMP_GE_OQ));
+	isHit = _mm256_and_ps(isHit, _mm256_cmp_ps(_mm256_add_ps(u, v), _mm256_set1_ps(1.0f), _CMP_LE_OQ));
+
+	const __m256 t = _mm256_mul_ps(f, _mm256_set1_ps(edgeDistance));
+	const __m256 closestT = _mm256_load_ps(&packet.t[first]);
+	isHit = _mm256_and_ps(isHit, _mm256_cmp_ps(t, _mm256_set1_ps(packet.tMin), _CMP_GE_OQ));
+	isHit = _mm256_and_ps(isHit, _mm256_cmp_ps(t, closestT, _CMP_LT_OQ));
+
+	const unsigned int mask = _mm256_movemask_ps(isHit);
+	if(mask == 0)
+	{
+		return 0;
+	}
+
+	_mm256_store_ps(&packet.t[first], _mm256_blendv_ps(closestT, t, isHit));
+	_mm256_store_ps(&packet.u[first], _mm256_blendv_ps(_mm256_load_ps(&packet.u[first]), u, isHit));
+	_mm256_store_ps(&packet.v[first], _mm256_blendv_ps(_mm256_load_ps(&packet.v[first]), v, isHit));
+
+	const __m256i primitive = _mm256_load_si256((const __m256i*)&packet.primitiveIndex[first]);
+	_mm256_store_si256((__m256i*)&packet.primitiveIndex[first], _mm256_blendv_epi8(primitive,
+		_mm256_set1_epi32(triangleIndex), _mm256_castps_si256(isHit)));
+
+	return mask;
+}
+
+// Only use them from a function marked with 'PACKET_AVX2_KERNEL', after checking 'UsePacketAVX2'
+struct AVX2PacketTests
+{
+	PACKET_AVX2_TARGET static unsigned int Frustum(const RayPacket& packet, const BVHNode& left, const BVHNode& right)
+	{
+		return IntersectPacketFrustumAVX2(packet, left, right);
+	}
+
+	PACKET_AVX2_TARGET static unsigned int AABB(const RayPacket& packet, unsigned int group, const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+	{
+		return IntersectPacketAABBAVX2(packet, group, boundsMin, boundsMax);
+	}
+
+	PACKET_AVX2_TARGET static unsigned int Triangle(RayPacket& packet, unsigned int group, const glm::vec3& v0,
+		const glm::vec3& v1, const glm::vec3& v2, unsigned int triangleIndex)
+	{
+		return IntersectPacketTriangleAVX2(packet, group, v0, v1, v2, triangleIndex);
+	}
+};
+#endif
+#pragma endregion
\ No newline at end of file
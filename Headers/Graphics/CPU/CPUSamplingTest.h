@@ -0,0 +1,10 @@
+#pragma once
+
+/// <summary>
+/// Pearson's chi-square test of the direction sampling in 'CPUCommon.h' against the analytic PDFs.
+/// Samples get binned over (cos theta, phi) and the expected count of every bin is its PDF, integrated numerically.
+/// Covers 'CosineHemisphereDirection', the GGX VNDF reflection at 4 roughnesses seen from 3 angles
+/// and 'SampleEnvironment' over both halves of the sphere, 15 cases.
+/// Returns the amount of cases in which the samples don't follow their PDF, at a 1% significance level over all cases.
+/// </summary>
+unsigned int RunSamplingChiSquareTest(unsigned int sampleCount = 1000000);
\ No newline at end of file
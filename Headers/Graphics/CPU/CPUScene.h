@@ -0,0 +1,38 @@
+#pragma once
+
+#include <vector>
+#include "Framework/SceneDescription.h"
+
+class CPUModel;
+class CPUTexture;
+class CPUTopLevelAS;
+
+/// <summary>
+/// CPU counterpart of 'Scene', owns all geometry, the environment map and the acceleration structure
+/// used by the CPU backend. It gets build from the same description as the DirectX scene.
+/// </summary>
+class CPUScene
+{
+public:
+	CPUScene(const SceneDescription& description);
+	~CPUScene();
+
+	const std::vector<CPUModel*>& GetModels();
+	CPUTopLevelAS* GetTLAS();
+
+	// Can be nullptr if the environment map failed to load
+	CPUTexture* GetEnvironmentMap();
+
+	// Importance sampling distribution of the environment map, see 'BuildEnvironmentDistribution'.
+	// Empty when there's no environment map
+	const std::vector<float>& GetEnvironmentDistribution();
+
+private:
+	void LoadEnvironmentMap(const std::string& path);
+
+private:
+	std::vector<CPUModel*> models;
+	CPUTexture* environmentMap = nullptr;
+	std::vector<float> environmentDistribution;
+	CPUTopLevelAS* tlas = nullptr;
+};
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "Framework/Mathematics.h"
+#include "Graphics/TextureProcessing.h"
+
+class CookedTexture;
+
+/// <summary>
+/// Texture that lives in system memory, used by the CPU backend. It stores either
+/// 8-bit RGBA (regular textures) or 32-bit float RGBA (HDR textures like the environment map).
+/// Like 'Texture', only 8-bit textures get a mip chain, generated by the same 'GenerateMipChain'.
+/// Cooked textures get decompressed on load, so sampling them returns what the GPU would.
+/// </summary>
+class CPUTexture
+{
+public:
+	CPUTexture(const unsigned char* data, int width, int height, MipGeneration mipGeneration = MipGeneration::None);
+	CPUTexture(const float* data, int width, int height);
+	CPUTexture(const std::string& filePath, MipGeneration mipGeneration = MipGeneration::None);
+	CPUTexture(CookedTexture& cookedTexture);
+
+	// Mirrors 'texture[uint2(x, y)]' in HLSL, returns 0 when out of bounds
+	glm::vec4 Load(int x, int y);
+
+	// Mirrors 'texture.SampleLevel(sampler, uv, lod)' in HLSL, with the trilinear wrapping sampler of the hit group
+	glm::vec4 SampleLevel(const glm::vec2& uv, float lod);
+
+	int GetWidth();
+	int GetHeight();
+	unsigned int GetMipLevels();
+	bool IsHDR();
+
+private:
+	glm::vec4 LoadTexel(unsigned int level, int x, int y);
+	glm::vec4 SampleBilinear(unsigned int level, const glm::vec2& uv);
+
+private:
+	std::vector<unsigned char> data8;
+	std::vector<float> data32;
+	std::vector<MipLevel> mipLevels;
+
+	int width = 0;
+	int height = 0;
+	bool isHDR = false;
+};
\ No newline at end of file
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "Graphics/CPU/CPUCommon.h"
+#include "Graphics/CPU/CPUBottomLevelAS.h"
+
+class CPUScene;
+class CPUMesh;
+class CPUModel;
+struct RayPacket;
+
+struct CPUInstance
+{
+	CPUMesh* mesh;
+	CPUModel* model;
+
+	// Model transform combined with the transform of the glTF node
+	glm::mat4 transform;
+	glm::mat4 inverseTransform;
+
+	// World space bounds of the BLAS
+	glm::vec3 boundsMin;
+	glm::vec3 boundsMax;
+};
+
+/// <summary>
+/// CPU counterpart of 'DXTopLevelAS'. Every mesh in the scene becomes an instance, and a BVH
+/// gets build over the world space bounds of those instances. Rays get transformed into the
+/// object space of an instance before traversing its BLAS. Rebuilding only touches the instances, 
+/// so moving models around doesn't require any of the BLASes to be rebuild.
+/// </summary>
+class CPUTopLevelAS
+{
+public:
+	CPUTopLevelAS(CPUScene* scene);
+
+	// Picks up the latest model transforms & rebuilds the top level BVH
+	void RebuildTLAS();
+
+	// Mirrors a 'PERFORM_UPDATE' build: keeps the tree topology and only refits the bounds
+	// of instances that moved (and their parents). Rebuilds instead when instances got added/removed.
+	void UpdateTLAS();
+
+	// With 'acceptFirstHit' it stops at any intersection, which is enough for shadow rays
+	bool Intersect(const Ray& ray, HitInfo& hit, bool acceptFirstHit = false);
+
+	// Traces the rays of a packet together, nodes outside of its frustum get skipped without testing any ray.
+	// Returns a mask with a bit set for every ray that hit something, finds the same hits as 'Intersect'
+	uint64_t IntersectPacket(RayPacket& packet);
+
+	CPUInstance& GetInstance(unsigned int instanceIndex);
+	unsigned int GetInstanceCount();
+
+	// Time spent in the last (re)build, in microseconds
+	double GetBuildTime();
+
+	// Time spent in the last update & the amount of instances it refitted
+	double GetUpdateTime();
+	unsigned int GetMovedInstanceCount();
+
+private:
+	void BuildTLAS();
+	void UpdateInstanceBounds(CPUInstance& instance);
+	void UpdateNodeBounds(BVHNode& node);
+	void Subdivide(unsigned int nodeIndex);
+	unsigned int GetSceneInstanceCount();
+
+	// 'IntersectPacket' with either 'ScalarPacketTests' or 'AVX2PacketTests', picked at runtime.
+	// The AVX2 version only exists on x64
+	template<typename PacketTests> uint64_t TraversePacket(RayPacket& packet);
+	uint64_t TraversePacketAVX2(RayPacket& packet);
+
+private:
+	CPUScene* activeScene;
+	std::vector<CPUInstance> instances;
+
+	// Top level BVH, leafs point to a range in 'instanceIndices'
+	std::vector<BVHNode> nodes;
+	std::vector<unsigned int> instanceIndices;
+	unsigned int nodesUsed = 0;
+
+	double buildTime = 0.0;
+	double updateTime = 0.0;
+	unsigned int movedInstanceCount = 0;
+};
\ No newline at end of file
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <tiny_gltf.h>
+
+#include "Graphics/Vertex.h"
+#include "Framework/Mathematics.h"
+
+struct glTFFile;
+class MappedFile;
+
+// Geometry of a single glTF primitive with all processing applied (e.g. tangents), still in mesh space.
+// The arrays either point into the memory mapped cache, or into data owned by the CookedModel.
+struct CookedMesh
+{
+	std::string name;
+
+	const Vertex* vertices = nullptr;
+	unsigned int vertexCount = 0;
+	const unsigned int* indices = nullptr;
+	unsigned int indexCount = 0;
+
+	// Indexed by 'glTFTextureType' (BaseColor, Normal, MetallicRoughness), -1 when unused
+	int imageIndices[3] = { -1, -1, -1 };
+};
+
+// A cooked mesh placed by a node, in the order the nodes get traversed
+struct CookedMeshInstance
+{
+	unsigned int meshIndex;
+	glm::mat4 transform;
+};
+
+/// <summary>
+/// Everything 'Model' & 'CPUModel' need from a glTF file, in its final form. The first time a file
+/// gets loaded it's parsed & processed, after which the result gets stored as a flat cache file next to it.
+/// Following loads memory map that cache instead, as long as the content hash of the glTF files still matches.
+/// </summary>
+class CookedModel
+{
+public:
+	CookedModel(const std::string& filePath, bool useCache = true);
+	~CookedModel();
+
+	bool IsValid();
+	bool IsLoadedFromCache();
+
+	const std::vector<CookedMesh>& GetMeshes();
+	const std::vector<CookedMeshInstance>& GetInstances();
+
+	// Images are referenced by their glTF uri, which is also the key used by the TextureManager
+	unsigned int GetImageCount();
+	const std::string& GetImageURI(int imageIndex);
+	std::string GetImagePath(int imageIndex);
+
+	// Decoded image data is only available when the glTF file got parsed, returns nullptr otherwise
+	const tinygltf::Image* GetDecodedImage(int imageIndex);
+
+	static std::string GetCachePath(const std::string& filePath);
+
+private:
+	bool LoadCache();
+	bool Cook();
+	void WriteCache();
+
+	void TraverseRootNodes(tinygltf::Model& model);
+	void TraverseChildNodes(tinygltf::Model& model, tinygltf::Node& node, const glm::mat4& parentMatrix);
+	void AddMeshInstances(tinygltf::Model& model, int meshIndex, const glm::mat4& transform);
+
+	bool HashDependencies(uint64_t& hash);
+
+private:
+	std::string filePath;
+	std::string baseDirectory;
+
+	std::vector<CookedMesh> meshes;
+	std::vector<CookedMeshInstance> instances;
+	std::vector<std::string> imageURIs;
+
+	// Files the cooked data was created from, relative to the base directory
+	std::vector<std::string> dependencies;
+
+	// Only used while cooking, the first cooked mesh of each glTF mesh (its primitives follow in order)
+	std::vector<int> firstCookedMesh;
+
+	// Source of the data when loaded from the cache
+	MappedFile* cacheFile = nullptr;
+
+	// Source of the data when cooked from the glTF file
+	glTFFile* gltfFile = nullptr;
+	std::vector<std::vector<Vertex>> cookedVertices;
+	std::vector<std::vector<unsigned int>> cookedIndices;
+
+	bool isValid = false;
+	bool isLoadedFromCache = false;
+};
\ No newline at end of file
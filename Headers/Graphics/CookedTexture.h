@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Graphics/TextureCompression.h"
+
+class MappedFile;
+
+/// <summary>
+/// An image in the form it gets uploaded in: a full mip chain, block compressed. The first time an image gets loaded 
+/// it's decoded, filtered & compressed, after which the result gets stored as a cache file next to it. Following loads 
+/// memory map that cache instead, as long as the content hash of the image still matches.
+/// Block compression needs the image to be a multiple of 4 in size, other images are cooked without compression.
+/// </summary>
+class CookedTexture
+{
+public:
+	CookedTexture(const std::string& imagePath, TextureCompression compression, 
+		MipGeneration mipGeneration, bool useCache = true);
+
+	// For already decoded images without a file of their own (e.g. embedded in a .glb), an empty 'cachePath' disables caching
+	CookedTexture(const unsigned char* data, int width, int height, TextureCompression compression,
+		MipGeneration mipGeneration, const std::string& cachePath = "");
+
+	~CookedTexture();
+
+	CookedTexture(const CookedTexture&) = delete;
+	CookedTexture& operator=(const CookedTexture&) = delete;
+
+	bool IsValid();
+	bool IsLoadedFromCache();
+
+	TextureCompression GetCompression();
+	unsigned int GetWidth();
+	unsigned int GetHeight();
+
+	// Offsets of the levels are relative to 'GetData'
+	const std::vector<MipLevel>& GetMipLevels();
+	const unsigned char* GetData();
+	size_t GetDataSize();
+
+	// Of the first level against the source image, 100 dB when stored without loss
+	float GetPSNR();
+
+	static std::string GetCachePath(const std::string& imagePath, TextureCompression compression);
+
+private:
+	bool LoadCache(uint64_t sourceHash);
+	void Cook(const unsigned char* pixels, int width, int height);
+	void WriteCache(uint64_t sourceHash);
+
+	uint64_t GetHashSeed();
+
+private:
+	std::string name;
+	std::string cachePath;
+
+	TextureCompression compression;
+	MipGeneration mipGeneration;
+	unsigned int width = 0;
+	unsigned int height = 0;
+	float psnr = 0.0f;
+
+	std::vector<MipLevel> mipLevels;
+	const unsigned char* data = nullptr;
+	size_t dataSize = 0;
+
+	// Source of the data when loaded from the cache
+	MappedFile* cacheFile = nullptr;
+
+	// Source of the data when cooked
+	std::vector<unsigned char> cookedData;
+
+	bool isValid = false;
+	bool isLoadedFromCache = false;
+};
\ No newline at end of file
@@ -15,6 +15,9 @@ struct DXRayTracingPipelineSettings
 	CD3DX12_ROOT_PARAMETER* hitParameters = nullptr;
 	unsigned int hitParameterCount = 0;
 
+	CD3DX12_STATIC_SAMPLER_DESC* hitSamplers = nullptr;
+	unsigned int hitSamplerCount = 0;
+
 	CD3DX12_ROOT_PARAMETER* missParameters = nullptr;
 	unsigned int missParameterCount = 0;
 
@@ -36,7 +39,8 @@ private:
 	void CreatePipeline();
 
 	void CreateRootSignature(ComPtr<ID3D12RootSignature>& rootSignature,
-		D3D12_ROOT_PARAMETER* parameterData, unsigned int parameterCount, bool isLocal);
+		D3D12_ROOT_PARAMETER* parameterData, unsigned int parameterCount, bool isLocal,
+		D3D12_STATIC_SAMPLER_DESC* samplerData = nullptr, unsigned int samplerCount = 0);
 	
 	void CompileShaderLibrary(ComPtr<IDxcBlob>& shaderLibrary, std::wstring shaderName);
 
@@ -16,8 +16,16 @@ inline void AllocateAccelerationStructureMemory(const D3D12_BUILD_RAYTRACING_ACC
 	D3D12_RAYTRACING_ACCELERATION_STRUCTURE_PREBUILD_INFO prebuildInfo = {};
 	device->GetRaytracingAccelerationStructurePrebuildInfo(&inputs, &prebuildInfo);
 
+	// Structures that allow updates reuse the same scratch buffer for those, so it needs to fit both
+	UINT64 scratchSize = prebuildInfo.ScratchDataSizeInBytes;
+	bool allowsUpdate = (inputs.Flags & D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_ALLOW_UPDATE) != 0;
+	if(allowsUpdate && prebuildInfo.UpdateScratchDataSizeInBytes > scratchSize)
+	{
+		scratchSize = prebuildInfo.UpdateScratchDataSizeInBytes;
+	}
+
 	D3D12_HEAP_PROPERTIES gpuHeap = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
-	D3D12_RESOURCE_DESC scratchDesc = CD3DX12_RESOURCE_DESC::Buffer(prebuildInfo.ScratchDataSizeInBytes, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
+	D3D12_RESOURCE_DESC scratchDesc = CD3DX12_RESOURCE_DESC::Buffer(scratchSize, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
 	D3D12_RESOURCE_DESC resultDesc = CD3DX12_RESOURCE_DESC::Buffer(prebuildInfo.ResultDataMaxSizeInBytes, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
 
 	ThrowIfFailed(device->CreateCommittedResource(&gpuHeap, D3D12_HEAP_FLAG_NONE,
@@ -27,21 +35,30 @@ inline void AllocateAccelerationStructureMemory(const D3D12_BUILD_RAYTRACING_ACC
 		&resultDesc, D3D12_RESOURCE_STATE_RAYTRACING_ACCELERATION_STRUCTURE, nullptr, IID_PPV_ARGS(result)));
 }
 
-inline void BuildAccelerationStructure(const D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS& inputs,
-	ComPtr<ID3D12Resource> scratch, ComPtr<ID3D12Resource> result)
+/// <summary>
+/// Only records the build into the given command list, which allows multiple builds to be submitted at once.
+/// </summary>
+inline void RecordAccelerationStructureBuild(ComPtr<ID3D12GraphicsCommandList4> commandList, 
+	const D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS& inputs, ComPtr<ID3D12Resource> scratch, ComPtr<ID3D12Resource> result)
 {
 	D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_DESC description = {};
 	description.Inputs = inputs;
 	description.ScratchAccelerationStructureData = scratch->GetGPUVirtualAddress();
 	description.DestAccelerationStructureData = result->GetGPUVirtualAddress();
 
+	commandList->BuildRaytracingAccelerationStructure(&description, 0, nullptr);
+}
+
+inline void BuildAccelerationStructure(const D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS& inputs,
+	ComPtr<ID3D12Resource> scratch, ComPtr<ID3D12Resource> result)
+{
 	DXCommands* commands = DXAccess::GetCommands(D3D12_COMMAND_LIST_TYPE_DIRECT);
 	ComPtr<ID3D12GraphicsCommandList4> commandList = commands->GetGraphicsCommandList();
 
 	commands->Flush();
 	commands->ResetCommandList();
 
-	commandList->BuildRaytracingAccelerationStructure(&description, 0, nullptr);
+	RecordAccelerationStructureBuild(commandList, inputs, scratch, result);
 
 	commands->ExecuteCommandList();
 	commands->Signal();
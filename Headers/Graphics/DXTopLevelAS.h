@@ -1,6 +1,8 @@
 #pragma once
 
+#include <vector>
 #include "Graphics/DXCommon.h"
+#include "Graphics/Window.h"
 
 class Scene;
 
@@ -11,16 +13,34 @@ public:
 
 	void RebuildTLAS();
 
+	// Records a refit of the TLAS with the latest model transforms. The result buffer stays the same,
+	// so the shader binding table remains valid. When instances got added/removed since the last build
+	// nothing gets recorded and false is returned, the TLAS then needs a 'RebuildTLAS' instead.
+	bool UpdateTLAS(ComPtr<ID3D12GraphicsCommandList4> commandList);
+
+	// False once the scene has a different amount of instances than the TLAS got build with
+	bool CanUpdate();
+
 	void SetScene(Scene* scene);
 	D3D12_GPU_VIRTUAL_ADDRESS GetGPUVirtualAddress();
 
+	// CPU time spent on the last update, in microseconds
+	float GetUpdateTime();
+
 private:
 	void BuildTLAS();
+	void UpdateInstanceTransforms();
+	unsigned int GetSceneInstanceCount();
 
 private:
 	Scene* activeScene;
 
-	ComPtr<ID3D12Resource> tlasInstanceDesc;
+	std::vector<D3D12_RAYTRACING_INSTANCE_DESC> instances;
+	D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS inputs = {};
+	float updateTime = 0.0f;
+
+	// One instance buffer per frame, that way an update never writes to a buffer that's still in flight
+	ComPtr<ID3D12Resource> tlasInstanceDescs[Window::BackBufferCount];
 	ComPtr<ID3D12Resource> tlasScratch;
 	ComPtr<ID3D12Resource> tlasResult;
 };
\ No newline at end of file
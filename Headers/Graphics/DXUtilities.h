@@ -76,7 +76,7 @@ inline void UpdateBufferResource(ComPtr<ID3D12GraphicsCommandList4> commandList,
 }
 
 inline void UploadPixelShaderResource(ComPtr<ID3D12Resource>& destinationResource, ComPtr<ID3D12Resource>& intermediateResource, D3D12_RESOURCE_DESC& resourceDescription, 
-	D3D12_SUBRESOURCE_DATA& subresource)
+	D3D12_SUBRESOURCE_DATA* subresources, unsigned int subresourceCount = 1)
 {
 	ComPtr<ID3D12Device5> device = DXAccess::GetDevice();
 	DXCommands* copyCommands = DXAccess::GetCommands(D3D12_COMMAND_LIST_TYPE_COPY);
@@ -90,7 +90,7 @@ inline void UploadPixelShaderResource(ComPtr<ID3D12Resource>& destinationResourc
 		&resourceDescription, D3D12_RESOURCE_STATE_COMMON, nullptr, IID_PPV_ARGS(&destinationResource)));
 
 	// 1.b Allocate heap in RAM to upload the texture to //
-	unsigned int size = GetRequiredIntermediateSize(destinationResource.Get(), 0, 1);
+	unsigned int size = GetRequiredIntermediateSize(destinationResource.Get(), 0, subresourceCount);
 	D3D12_RESOURCE_DESC bufferDescription = CD3DX12_RESOURCE_DESC::Buffer(size);
 
 	ThrowIfFailed(device->CreateCommittedResource(&uploadHeap, D3D12_HEAP_FLAG_NONE,
@@ -104,7 +104,7 @@ inline void UploadPixelShaderResource(ComPtr<ID3D12Resource>& destinationResourc
 	copyCommands->ResetCommandList();
 
 	commandList->ResourceBarrier(1, &copyBarrier);
-	UpdateSubresources(commandList.Get(), destinationResource.Get(), intermediateResource.Get(), 0, 0, 1, &subresource);
+	UpdateSubresources(commandList.Get(), destinationResource.Get(), intermediateResource.Get(), 0, 0, subresourceCount, subresources);
 	commandList->ResourceBarrier(1, &pixelBarrier);
 
 	// 3. Execute upload and wait until it's finished // 
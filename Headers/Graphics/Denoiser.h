@@ -0,0 +1,34 @@
+#pragma once
+
+// Edge-avoiding a-trous wavelet filter (as in SVGF), guided by the first hit of every pixel.
+// Shared by the CPU backend, 'Denoise.hlsl' runs the same filter on the GPU.
+
+// Noisy image & its guides, all arrays are 'width * height' pixels, row by row
+struct DenoiserInput
+{
+	unsigned int width;
+	unsigned int height;
+
+	const float* color;		// RGB, the average radiance
+	const float* variance;	// Variance of the average luminance, i.e. of the mean, not of a single sample
+	const float* albedo;	// RGB, albedo of the first hit, the environment has an albedo of 1
+	const float* normal;	// XYZ, normal of the first hit, 0 when the environment got hit
+	const float* depth;		// Distance to the first hit
+};
+
+struct DenoiserSettings
+{
+	unsigned int iterationCount = 4;	// Every iteration doubles the distance between the taps (1, 2, 4 ...)
+	float colorPhi = 2.0f;				// Luminance differences are allowed up to ~'colorPhi' standard deviations of the noise
+	float normalPhi = 4.0f;				// Weight of a tap is exp(-'normalPhi' * (1 - cos)) for the angle between both normals
+	float depthPhi = 0.05f;				// Allowed change in depth per pixel, relative to the depth of the filtered pixel
+};
+
+/// <summary>
+/// Denoises 'input' into 'output' (RGB). The albedo gets divided out before filtering, so textures stay sharp,
+/// and multiplied back in at the end. Every iteration filters with a 5x5 B3-spline kernel, of which the taps
+/// get weighted by how similar their normal, depth & luminance are. The luminance is compared against the
+/// standard deviation of the noise, which is tracked through the iterations. Pixels that only saw the environment
+/// are kept as they are. Rows are processed in parallel, with SSE2 filtering 4 pixels at once where available.
+/// </summary>
+void DenoiseImage(const DenoiserInput& input, const DenoiserSettings& settings, float* output);
\ No newline at end of file
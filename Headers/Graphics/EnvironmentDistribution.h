@@ -0,0 +1,18 @@
+#pragma once
+
+#include <vector>
+
+// The distribution holds the 'marginal' CDF over the rows, followed by the 'conditional' CDF of every row.
+// Every CDF goes from 0 to 1, so it has one entry more than the number of rows or columns it covers.
+inline unsigned int GetEnvironmentDistributionSize(unsigned int width, unsigned int height)
+{
+	return (height + 1) + height * (width + 1);
+}
+
+/// <summary>
+/// Builds a piecewise constant 2D distribution over an equirectangular environment map (32-bit float RGBA),
+/// proportional to the luminance of every pixel & the solid angle it covers. Importance sampling it picks
+/// bright regions like the sun far more often than uniform sampling would. Rows are processed in parallel.
+/// It's read by 'SampleEnvironment' & 'GetEnvironmentPDF', in both Common.hlsl and CPUCommon.h.
+/// </summary>
+void BuildEnvironmentDistribution(const float* data, unsigned int width, unsigned int height, std::vector<float>& distribution);
\ No newline at end of file
@@ -2,21 +2,33 @@
 
 #include <string>
 #include "DXCommon.h"
+#include "Graphics/TextureProcessing.h"
 
 class Texture;
+class DXStructuredBuffer;
 
+/// <summary>
+/// Equirectangular HDR environment, loaded from an EXR. On the GPU it's stored in 'format', RGB9E5 takes a quarter
+/// of the memory of the 32-bit float EXR. Levels past the first are prefiltered, downsampled copies (mips), 
+/// which rough reflections can look up instead of the full resolution image.
+/// </summary>
 class EnvironmentMap
 {
 public:
-	EnvironmentMap(const std::string& filePath);
+	EnvironmentMap(const std::string& filePath, HDRFormat format = HDRFormat::RGB9E5, unsigned int levelCount = 1);
 
 	Texture* GetTexture();
 
+	// 2D CDF of the environment's brightness, see 'BuildEnvironmentDistribution'
+	DXStructuredBuffer* GetDistributionBuffer();
+	D3D12_GPU_VIRTUAL_ADDRESS GetDistributionGPUAddress();
+
 	DXGI_FORMAT GetFormat();
 	ID3D12Resource* GetAddress();
 
 private:
 	Texture* environmentTexture;
+	DXStructuredBuffer* distributionBuffer;
 
 	int width;
 	int height;
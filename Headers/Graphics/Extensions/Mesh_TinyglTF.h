@@ -1,200 +1,109 @@
 #pragma once
 
-#include <tiny_gltf.h>
 #include <string>
-#include <vector>
 #include "Graphics/Mesh.h"
+#include "Graphics/CookedModel.h"
+#include "Graphics/TextureStreamer.h"
+#include "Graphics/Extensions/Shared_TinyglTF.h"
 #include "Utilities/Logger.h"
 #include "Graphics/TextureManager.h"
+#include "Graphics/DXAccess.h"
+#include <stb_image.h>
+#include <cstring>
 
-enum glTFTextureType
+inline bool glTFIsImageAvailable(CookedModel& model, int imageIndex)
 {
-	BaseColor,
-	Normal,
-	MetallicRoughness,
-	Occlusion, 
-};
+	const tinygltf::Image* image = model.GetDecodedImage(imageIndex);
+	if(image != nullptr)
+	{
+		return !image->image.empty();
+	}
+
+	int width, height, channels;
+	return stbi_info(model.GetImagePath(imageIndex).c_str(), &width, &height, &channels) != 0;
+}
 
 /// <summary>
-/// Able to load in a specific 'Attribute' defined by glTF. For example with 'POSITION' all
-/// position data can be loaded into a given buffer of vertices. 
+/// Shown while the actual texture streams in. Normal maps & metallic roughness get a constant texture that leaves
+/// the shading of the material as is, base color shows the framework's default texture so loading stays visible.
 /// </summary>
-inline void glTFLoadVertexAttribute(std::vector<Vertex>& vertices, const std::string& attributeType, 
-	tinygltf::Model& model, tinygltf::Primitive& primitive)
+inline Texture* glTFGetPlaceholderTexture(glTFTextureType type)
 {
-	auto attribute = primitive.attributes.find(attributeType);
+	unsigned char pixel[4];
 
-	// Check if within the primitives's attributes the type is present. For example 'Normals'
-	// If not, return here, since there is no data to load in. 
-	if(attribute == primitive.attributes.end())
+	switch(type)
 	{
-		std::string message = "Attribute Type: '" + attributeType + "' missing from this mesh.";
-		LOG(Log::MessageType::Debug, message);
-		return;
+	case glTFTextureType::Normal:
+		pixel[0] = 128; pixel[1] = 128; pixel[2] = 255; pixel[3] = 255;
+		break;
+	case glTFTextureType::MetallicRoughness:
+		// Roughness gets clamped to the material's roughness //
+		pixel[0] = 255; pixel[1] = 0; pixel[2] = 0; pixel[3] = 255;
+		break;
+	default:
+		return DXAccess::GetDefaultTexture();
 	}
 
-	// Accessor: Tells use which view we need, what type of data is in it, and the amount/count of data.
-	// BufferView: Tells which buffer we need, and where we need to be in the buffer
-	// Buffer: Binary data of our mesh
-	tinygltf::Accessor& accessor = model.accessors[primitive.attributes.at(attributeType)];
-	tinygltf::BufferView& view = model.bufferViews[accessor.bufferView];
-	tinygltf::Buffer& buffer = model.buffers[view.buffer];
-
-	// Component: default type like float, int
-	// Type: a structure made out of components, e.g VEC2 ( 2x float )
-	unsigned int componentSize = tinygltf::GetComponentSizeInBytes(accessor.componentType);
-	unsigned int objectSize = tinygltf::GetNumComponentsInType(accessor.type);
-	unsigned int dataSize = componentSize * objectSize;
-
-	if(attributeType == "TANGENT")
+	unsigned char pixels[4 * 4 * 4];
+	for(int i = 0; i < 4 * 4; i++)
 	{
-		// Tangent is something stored as float4, but in this framework we 
-		// only care about the first 3 components. 
-		dataSize = sizeof(float) * 3;
+		memcpy(&pixels[i * 4], pixel, 4);
 	}
 
-	// Accessor byteoffset: Offset to first element of type
-	// BufferView byteoffset: Offset to get to this primitives buffer data in the overall buffer
-	unsigned int bufferStart = accessor.byteOffset + view.byteOffset;
-
-	// Stride: Distance in buffer till next element occurs
-	unsigned int stride = accessor.ByteStride(view);
-
-	// In case it hasn't happened, resize the vertex buffer since we're 
-	// going to directly memcpy the data into an already existing buffer
-	if(vertices.size() < accessor.count)
+	// The first reference is kept by the placeholder itself, so it stays around //
+	uint64_t key = TextureManager::GetImageKey(pixels, 4, 4, TextureCompression::None, MipGeneration::None);
+	if(!TextureManager::IsStored(key))
 	{
-		vertices.resize(accessor.count);
+		TextureManager::AddTexture(key, new Texture(pixels, 4, 4));
 	}
 
-	// Copy data directly into vertex attribute from the glTF buffer(s)
-	for(int i = 0; i < accessor.count; i++)
-	{
-		Vertex& vertex = vertices[i];
-		size_t bufferLocation = bufferStart + (i * stride);
-
-		// TODO: Could be an option to just grab the pointer and pass an offset, saving the if-else..
-		if(attributeType == "POSITION")
-		{
-			memcpy(&vertex.Position, &buffer.data[bufferLocation], dataSize);
-		}
-		else if(attributeType == "NORMAL")
-		{
-			memcpy(&vertex.Normal, &buffer.data[bufferLocation], dataSize);
-		}
-		else if(attributeType == "TANGENT")
-		{
-			memcpy(&vertex.Tangent, &buffer.data[bufferLocation], sizeof(float) * 3);
-		}
-		else if(attributeType == "TEXCOORD_0")
-		{
-			memcpy(&vertex.TextureCoord0, &buffer.data[bufferLocation], dataSize);
-		}
-	}
+	return TextureManager::GetTexture(key);
 }
 
-void glTFLoadIndices(std::vector<unsigned int>& indices,
-	tinygltf::Model& model, tinygltf::Primitive& primitive)
+/// <summary>
+/// Able to load-in a texture referenced by a (cooked) glTF material. If the image is present it returns a texture that
+/// streams it in, cooked for its texture type through the texture cache, or from the image data decoded by tinyglTF
+/// for embedded images. Otherwise it returns the framework's default texture, the boolean indicates if the image is present.
+/// Textures are shared through the TextureManager by their contents, the caller owns one reference of the returned texture.
+/// </summary>
+inline bool glTFLoadTexture(Texture** texture, CookedModel& model, int imageIndex, glTFTextureType type)
 {
-	tinygltf::Accessor& accessor = model.accessors[primitive.indices];
-	tinygltf::BufferView& view = model.bufferViews[accessor.bufferView];
-	tinygltf::Buffer& buffer = model.buffers[view.buffer];
-
-	unsigned int componentSize = tinygltf::GetComponentSizeInBytes(accessor.componentType);
-	unsigned int objectSize = tinygltf::GetNumComponentsInType(accessor.type);
-	unsigned int dataSize = componentSize * objectSize;
-
-	unsigned int bufferStart = accessor.byteOffset + view.byteOffset;
-	unsigned int stride = accessor.ByteStride(view);
-
-	for(int i = 0; i < accessor.count; i++)
+	if(imageIndex >= 0 && !glTFIsImageAvailable(model, imageIndex))
 	{
-		size_t bufferLocation = bufferStart + (i * stride);
-
-		if(componentSize == 2)
-		{
-			short index;
-			memcpy(&index, &buffer.data[bufferLocation], dataSize);
-			indices.push_back(index);
-		}
-		else if(componentSize == 4)
-		{
-			unsigned int index;
-			memcpy(&index, &buffer.data[bufferLocation], dataSize);
-			indices.push_back(index);
-		}
+		LOG(Log::MessageType::Error, "Failed to load image: " + model.GetImageURI(imageIndex));
+		imageIndex = -1;
 	}
-}
 
-/// <summary>
-/// Once a model is loaded in, it requires to be transformed with the matrix it was stored with.\
-/// This goes over all the model data and transforms the relevant components.
-/// </summary>
-inline void glTFApplyNodeTransform(std::vector<Vertex>& vertices, const glm::mat4& transform)
-{
-	for(Vertex& vertex : vertices)
+	if(imageIndex < 0)
 	{
-		glm::vec4 vert = glm::vec4(vertex.Position.x, vertex.Position.y, vertex.Position.z, 1.0f);
-		vertex.Position = transform * vert;
+		*texture = DXAccess::GetDefaultTexture();
+		TextureManager::AddReference(*texture);
+		return false;
+	}
 
-		glm::vec4 norm = glm::vec4(vertex.Normal.x, vertex.Normal.y, vertex.Normal.z, 0.0f);
-		vertex.Normal = glm::normalize(transform * norm);
+	TextureCompression compression;
+	MipGeneration mipGeneration;
+	glTFGetTextureCooking(type, compression, mipGeneration);
 
-		glm::vec4 tang = glm::vec4(vertex.Tangent.x, vertex.Tangent.y, vertex.Tangent.z, 0.0f);
-		vertex.Tangent = glm::normalize(transform * tang);
-	}
-}
+	// Embedded images can't be referenced by the cache, like with the mesh cache //
+	const tinygltf::Image* image = model.GetDecodedImage(imageIndex);
+	bool isEmbedded = model.GetImageURI(imageIndex).empty();
 
-/// <summary>
-/// Able to load-in a texture with the glTF data. It checks if the texture type is present.
-/// If so, it will load it in, otherwise return the framework's default texture.
-/// It will also return a boolean indicating if loading the texture was succesful.
-/// </summary>
-inline bool glTFLoadTextureByType(Texture** texture, glTFTextureType type, tinygltf::Model& model, tinygltf::Primitive& primitive)
-{
-	// If it doesn't contain any materials, no textures to load
-	if(model.materials.size() > 0)
+	uint64_t key = isEmbedded ? 
+		TextureManager::GetImageKey(image->image.data(), image->width, image->height, compression, mipGeneration) :
+		TextureManager::GetImageKey(model.GetImagePath(imageIndex), compression, mipGeneration);
+
+	*texture = TextureManager::AcquireTexture(key);
+	if(*texture == nullptr)
 	{
-		tinygltf::Material& mat = model.materials[primitive.material];
-		int textureIndex = -1;
-
-		switch(type)
-		{
-		case glTFTextureType::BaseColor:
-			textureIndex = mat.pbrMetallicRoughness.baseColorTexture.index;
-			break;
-		case glTFTextureType::Normal:
-			textureIndex = mat.normalTexture.index;
-			break;
-		case glTFTextureType::MetallicRoughness:
-			textureIndex = mat.pbrMetallicRoughness.metallicRoughnessTexture.index;
-			break;
-		case glTFTextureType::Occlusion:
-			textureIndex = mat.occlusionTexture.index;
-			break;
-		}
-
-		if(textureIndex != -1)
-		{
-			tinygltf::Image& image = model.images[textureIndex];
-
-			// Load or Store textures into teh TextureManager
-			if(TextureManager::IsStored(image.uri))
-			{
-				*texture = TextureManager::GetTexture(image.uri);
-			}
-			else
-			{
-				Texture* imageTexture = new Texture(image.image.data(), image.width, image.height);
-				TextureManager::AddTexture(image.uri, imageTexture);
-				*texture = imageTexture;
-			}
-
-			return true;
-		}
+		Texture* placeholder = glTFGetPlaceholderTexture(type);
+
+		*texture = isEmbedded ? 
+			TextureStreamer::StreamTexture(image->image.data(), image->width, image->height, compression, mipGeneration, placeholder) :
+			TextureStreamer::StreamTexture(model.GetImagePath(imageIndex), compression, mipGeneration, placeholder);
+
+		TextureManager::AddTexture(key, *texture);
 	}
 
-	// TODO: replace hardcoded path with Texture Database 'default'
-	*texture = new Texture("Assets/Textures/missing.png");
-	return false;
+	return true;
 }
\ No newline at end of file
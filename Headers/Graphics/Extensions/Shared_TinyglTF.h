@@ -0,0 +1,212 @@
+#pragma once
+
+#include <tiny_gltf.h>
+#include <string>
+#include <vector>
+#include "Graphics/Vertex.h"
+#include "Graphics/Transform.h"
+#include "Graphics/TextureCompression.h"
+#include "Framework/Mathematics.h"
+#include "Utilities/Logger.h"
+#include "Utilities/MappedFile.h"
+
+// DirectX independent half of the glTF extension. It only depends on 'Vertex' & tinyglTF,
+// which allows it to be shared between the DirectX Mesh and the CPU backend.
+
+enum glTFTextureType
+{
+	BaseColor,
+	Normal,
+	MetallicRoughness,
+	Occlusion, 
+};
+
+/// <summary>
+/// A parsed .gltf or .glb file. When loaded with 'mapBuffers' the binary buffers are memory mapped
+/// instead of copied into 'tinygltf::Buffer::data', so buffer data should be accessed through 'glTFGetBufferData'.
+/// </summary>
+struct glTFFile
+{
+	tinygltf::Model model;
+
+	// Per buffer, points into one of the mapped files, or is nullptr when tinyglTF owns the data
+	std::vector<const unsigned char*> mappedBuffers;
+	std::vector<MappedFile*> mappedFiles;
+
+	// External buffer files that got mapped, relative to the glTF file. Their 'uri' got replaced for tinyglTF
+	std::vector<std::string> mappedBufferURIs;
+
+	~glTFFile()
+	{
+		for(MappedFile* mappedFile : mappedFiles)
+		{
+			delete mappedFile;
+		}
+	}
+};
+
+/// <summary>
+/// Parses a .gltf or .glb file, based on its extension. With 'mapBuffers' external .bin files and
+/// the binary chunk of a .glb get memory mapped, geometry is then read straight from the mapping.
+/// Buffers that images get decoded from are always loaded by tinyglTF itself.
+/// </summary>
+bool glTFLoadFile(glTFFile& file, const std::string& filePath, bool mapBuffers = true);
+
+inline const unsigned char* glTFGetBufferData(glTFFile& file, int bufferIndex)
+{
+	if(bufferIndex >= 0 && size_t(bufferIndex) < file.mappedBuffers.size() && file.mappedBuffers[bufferIndex] != nullptr)
+	{
+		return file.mappedBuffers[bufferIndex];
+	}
+
+	return file.model.buffers[bufferIndex].data.data();
+}
+
+/// <summary>
+/// Able to load in a specific 'Attribute' defined by glTF. For example with 'POSITION' all
+/// position data can be loaded into a given buffer of vertices. Besides floats, (normalized) integer
+/// components get converted as well, e.g. quantized texture coordinates.
+/// </summary>
+void glTFLoadVertexAttribute(std::vector<Vertex>& vertices, const std::string& attributeType, 
+	glTFFile& file, tinygltf::Primitive& primitive);
+
+/// <summary>
+/// Loads all attributes of a primitive used by 'Vertex', with a single allocation for the vertices.
+/// </summary>
+void glTFLoadVertices(std::vector<Vertex>& vertices, glTFFile& file, tinygltf::Primitive& primitive);
+
+/// <summary>
+/// Appends the indices of a primitive, which can be stored as 8, 16 or 32-bit unsigned integers.
+/// Primitives without indices get sequential indices, one per vertex.
+/// </summary>
+void glTFLoadIndices(std::vector<unsigned int>& indices, glTFFile& file, tinygltf::Primitive& primitive);
+
+/// <summary>
+/// Once a model is loaded in, it requires to be transformed with the matrix it was stored with.
+/// This goes over all the model data and transforms the relevant components.
+/// </summary>
+inline void glTFApplyNodeTransform(std::vector<Vertex>& vertices, const glm::mat4& transform)
+{
+	// Mirroring transforms flip the handedness of the tangent frame
+	float bitangentSign = glm::determinant(glm::mat3(transform)) < 0.0f ? -1.0f : 1.0f;
+
+	for(Vertex& vertex : vertices)
+	{
+		glm::vec4 vert = glm::vec4(vertex.Position.x, vertex.Position.y, vertex.Position.z, 1.0f);
+		vertex.Position = transform * vert;
+
+		glm::vec4 norm = glm::vec4(vertex.Normal.x, vertex.Normal.y, vertex.Normal.z, 0.0f);
+		vertex.Normal = glm::normalize(transform * norm);
+
+		glm::vec4 tang = glm::vec4(vertex.Tangent.x, vertex.Tangent.y, vertex.Tangent.z, 0.0f);
+		glm::vec3 tangent = glm::normalize(transform * tang);
+		vertex.Tangent = glm::vec4(tangent, vertex.Tangent.w * bitangentSign);
+	}
+}
+
+/// <summary>
+/// Retrieves the local transform of a node. Nodes either store a full matrix, or
+/// the transform data as vectors (Position, Rotation, Scale). When neither is present it's Identity.
+/// </summary>
+inline glm::mat4 glTFGetNodeTransform(tinygltf::Node& node)
+{
+	if(node.matrix.size() > 0)
+	{
+		std::vector<float> matrix;
+		for(int i = 0; i < 16; i++)
+		{
+			matrix.push_back(static_cast<float>(node.matrix[i]));
+		}
+
+		return glm::make_mat4(matrix.data());
+	}
+
+	::Transform transform;
+
+	// The size of any type of transformation data defaults to 0.
+	// When a vector isn't 0, it means it contains data
+	if(node.translation.size() > 0)
+	{
+		transform.Position.x = node.translation[0];
+		transform.Position.y = node.translation[1];
+		transform.Position.z = node.translation[2];
+	}
+
+	if(node.rotation.size() > 0)
+	{
+		glm::quat rotation;
+		rotation.x = node.rotation[0];
+		rotation.y = node.rotation[1];
+		rotation.z = node.rotation[2];
+		rotation.w = node.rotation[3];
+
+		glm::vec3 euler = glm::eulerAngles(rotation) * 180.0f / 3.14159265f;
+		transform.Rotation = euler;
+	}
+
+	if(node.scale.size() > 0)
+	{
+		transform.Scale.x = node.scale[0];
+		transform.Scale.y = node.scale[1];
+		transform.Scale.z = node.scale[2];
+	}
+
+	return transform.GetModelMatrix();
+}
+
+/// <summary>
+/// Returns the index of the image used by the primitive's material for the given texture type.
+/// Returns -1 when the primitive doesn't have a texture of that type.
+/// </summary>
+inline int glTFGetImageIndex(glTFTextureType type, tinygltf::Model& model, tinygltf::Primitive& primitive)
+{
+	// If it doesn't contain any materials, no textures to load
+	if(model.materials.size() == 0 || primitive.material < 0)
+	{
+		return -1;
+	}
+
+	tinygltf::Material& mat = model.materials[primitive.material];
+	int textureIndex = -1;
+
+	switch(type)
+	{
+	case glTFTextureType::BaseColor:
+		textureIndex = mat.pbrMetallicRoughness.baseColorTexture.index;
+		break;
+	case glTFTextureType::Normal:
+		textureIndex = mat.normalTexture.index;
+		break;
+	case glTFTextureType::MetallicRoughness:
+		textureIndex = mat.pbrMetallicRoughness.metallicRoughnessTexture.index;
+		break;
+	case glTFTextureType::Occlusion:
+		textureIndex = mat.occlusionTexture.index;
+		break;
+	}
+
+	return textureIndex;
+}
+
+/// <summary>
+/// How the images of each texture type get cooked, shared by the Mesh & the CPU backend so both sample the same data.
+/// Base color gets BC7 with its mips filtered in linear space, normal maps only keep X & Y in BC5, the rest uses BC1.
+/// </summary>
+inline void glTFGetTextureCooking(glTFTextureType type, TextureCompression& compression, MipGeneration& mipGeneration)
+{
+	switch(type)
+	{
+	case glTFTextureType::BaseColor:
+		compression = TextureCompression::BC7;
+		mipGeneration = MipGeneration::SRGB;
+		break;
+	case glTFTextureType::Normal:
+		compression = TextureCompression::BC5;
+		mipGeneration = MipGeneration::Linear;
+		break;
+	default:
+		compression = TextureCompression::BC1;
+		mipGeneration = MipGeneration::Linear;
+		break;
+	}
+}
\ No newline at end of file
@@ -5,12 +5,12 @@
 struct Material
 {
 	float color[3] = { 1.0f, 1.0f, 1.0f };
-	int materialType;
-	float specularity;
+	int materialType = 0;
+	float specularity = 0.0f;
 	float IOR = 1.0f;
 	float roughness = 0.0f;
-	BOOL hasDiffuse = false;
-	BOOL hasNormal = false;
-	BOOL hasORM = false;
+	int hasDiffuse = false; // 4-byte bools to match HLSL
+	int hasNormal = false;
+	int hasORM = false;
 	float stubs[54];
 };
\ No newline at end of file
@@ -5,19 +5,22 @@
 
 #include "Graphics/DXCommon.h"
 #include "Framework/Mathematics.h"
+#include "Graphics/Vertex.h"
 #include "Material.h"
 
-#include <tiny_gltf.h>
-
 class Texture;
 class DXUploadBuffer;
+struct CookedMesh;
+class CookedModel;
 
-struct Vertex
+// Per mesh constants for the hit shader, which tell it how to decode the vertex & index buffers.
+// The transform doubles as the 'Transform3x4' of the BLAS, which dequantizes packed positions.
+struct GeometryInfo
 {
-	glm::vec3 Position;
-	glm::vec3 Normal;
-	glm::vec3 Tangent;
-	glm::vec2 TextureCoord0;
+	float positionTransform[12] = { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f };
+	int isPacked = false; // 4-byte bools to match HLSL
+	int hasShortIndices = false;
+	float stubs[50];
 };
 
 class Mesh
@@ -26,11 +29,22 @@ public:
 	Mesh(Vertex* vertices, unsigned int vertexCount, unsigned int* indices, 
 		unsigned int indexCount, bool isRayTracingGeometry = false);
 
-	Mesh(tinygltf::Model& model, tinygltf::Primitive& primitive,
-		glm::mat4& transform, bool isRayTracingGeometry = false);
+	// Only copies the cooked geometry with the node transform applied, which is safe to do from any thread.
+	// The GPU resources then have to be created on the main thread, see 'Model::CreateGPUResources'
+	Mesh(const CookedMesh& cookedMesh, const glm::mat4& transform, bool isRayTracingGeometry = false, 
+		bool usePackedVertices = false);
+
+	// Releases the textures of the mesh, the GPU can't be using it anymore
+	~Mesh();
 
 	void UpdateMaterial();
 
+	// Deferred GPU Resource Creation //
+	void RecordGeometryUpload(ComPtr<ID3D12GraphicsCommandList4> commandList, 
+		std::vector<ComPtr<ID3D12Resource>>& intermediateBuffers);
+	void RecordBLASBuild(ComPtr<ID3D12GraphicsCommandList4> commandList);
+	void LoadMaterial(CookedModel& model, const CookedMesh& cookedMesh);
+
 	const D3D12_VERTEX_BUFFER_VIEW& GetVertexBufferView();
 	const D3D12_INDEX_BUFFER_VIEW& GetIndexBufferView();
 	const unsigned int GetIndicesCount();
@@ -38,21 +52,22 @@ public:
 	ID3D12Resource* GetVertexBuffer();
 	ID3D12Resource* GetIndexBuffer();
 	D3D12_GPU_VIRTUAL_ADDRESS GetMaterialGPUAddress();
+	D3D12_GPU_VIRTUAL_ADDRESS GetGeometryInfoGPUAddress();
 
 	// Ray Tracing //
 	D3D12_RAYTRACING_GEOMETRY_DESC GetGeometryDescription();
 	ID3D12Resource* GetBLAS();
 
 	// TEMP //
-	Texture* diffuseTexture;
-	Texture* normalTexture;
-	Texture* ORMTexture;
+	Texture* diffuseTexture = nullptr;
+	Texture* normalTexture = nullptr;
+	Texture* ORMTexture = nullptr;
 
 private:
-	void GenerateTangents();
 	void UploadGeometryBuffers();
 	void SetupGeometryDescription();
 	void BuildBLAS();
+	D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS GetBLASInputs();
 
 public:
 	std::string Name;
@@ -72,8 +87,15 @@ private:
 	unsigned int verticesCount = 0;
 	unsigned int indicesCount = 0;
 
+	// Packed geometry uses 'PackedVertex', and 16-bit indices when there are few enough vertices
+	bool usePackedVertices = false;
+	unsigned int vertexStride = sizeof(Vertex);
+	DXGI_FORMAT indexFormat = DXGI_FORMAT_R32_UINT;
+	GeometryInfo geometryInfo;
+	DXUploadBuffer* geometryInfoBuffer = nullptr;
+
 	// Texture & Material Data //
-	DXUploadBuffer* materialBuffer;
+	DXUploadBuffer* materialBuffer = nullptr;
 
 	// Ray Tracing //
 	bool isRayTracingGeometry;
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <vector>
+#include "Graphics/Vertex.h"
+
+// Processing steps that run on the CPU-side geometry of a mesh, before it gets uploaded.
+// None of these depend on DirectX, so both the Mesh and the CPU backend can use them.
+
+/// <summary>
+/// Generates tangents for the given geometry, but only if the mesh didn't come with them.
+/// Like MikkTSpace, each vertex gets the sum of its face tangents weighted by the corner angle, which is then
+/// orthonormalized against the normal, with the bitangent sign in 'w'. Runs in parallel over the triangles,
+/// while the result stays deterministic, since every vertex sums its triangles in index order.
+/// </summary>
+void GenerateTangents(std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices);
+
+// Vertex count & post-transform cache behaviour of a mesh, before & after 'OptimizeMesh'
+struct MeshOptimizationStats
+{
+	unsigned int triangleCount = 0;
+	unsigned int vertexCountBefore = 0;
+	unsigned int vertexCountAfter = 0;
+
+	// Vertices that missed a simulated FIFO cache, divided by the triangle count this gives the ACMR
+	unsigned int cacheMissesBefore = 0;
+	unsigned int cacheMissesAfter = 0;
+
+	void Add(const MeshOptimizationStats& stats);
+	float GetACMRBefore() const;
+	float GetACMRAfter() const;
+};
+
+/// <summary>
+/// Merges vertices that are bitwise identical, and rewrites the indices to use the remaining ones.
+/// </summary>
+void WeldVertices(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
+
+/// <summary>
+/// Reorders the triangles so consecutive triangles reuse recently used vertices, using Tom Forsyth's
+/// 'Linear-Speed Vertex Cache Optimisation'. The triangles themselves, and their winding, don't change.
+/// </summary>
+void OptimizeVertexCache(std::vector<unsigned int>& indices, unsigned int vertexCount);
+
+/// <summary>
+/// Reorders the vertices in the order they're first used by the indices, so that traversing the triangles
+/// fetches the vertices (mostly) sequentially. Vertices that aren't used by any triangle get removed.
+/// </summary>
+void OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
+
+/// <summary>
+/// Amount of vertices that miss a FIFO post-transform cache of the given size while drawing the indices.
+/// </summary>
+unsigned int SimulateVertexCacheMisses(const std::vector<unsigned int>& indices, unsigned int vertexCount, unsigned int cacheSize = 32);
+
+/// <summary>
+/// Runs the full processing chain on freshly loaded geometry: welding, tangent generation,
+/// vertex cache & vertex fetch optimization. Returns the before/after statistics.
+/// </summary>
+MeshOptimizationStats OptimizeMesh(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
+
+/// <summary>
+/// Bounds based quantization for 'PackVertices', the snorm positions span the bounds of the vertices.
+/// </summary>
+PackedVertexQuantization ComputePackedVertexQuantization(const std::vector<Vertex>& vertices);
+
+/// <summary>
+/// Encodes vertices into the compact 'PackedVertex' layout: positions get quantized to 16 bits within the bounds,
+/// normals & tangents get octahedral encoded into 2x 16 bits, and UVs get stored as halfs.
+/// </summary>
+void PackVertices(const std::vector<Vertex>& vertices, const PackedVertexQuantization& quantization, 
+	std::vector<PackedVertex>& packedVertices);
+
+/// <summary>
+/// CPU counterpart of the decode in the shaders, mostly useful to validate the precision of the encoding.
+/// </summary>
+Vertex UnpackVertex(const PackedVertex& packedVertex, const PackedVertexQuantization& quantization);
\ No newline at end of file
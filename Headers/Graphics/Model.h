@@ -2,7 +2,6 @@
 
 #include <string>
 #include <vector>
-#include <tiny_gltf.h>
 
 #include "Graphics/Transform.h"
 #include <wrl.h>
@@ -11,26 +10,33 @@ using namespace Microsoft::WRL;
 
 class Mesh;
 struct Vertex;
+class CookedModel;
 
 class Model
 {
 public:
-	Model(const std::string& filePath, bool isRayTracingGeometry = false);
+	// With 'deferGPUResources' the model only gets parsed & decoded, which is safe to do from any thread.
+	// Its GPU resources then have to be created through 'CreateGPUResources' on the main thread.
+	// With 'usePackedVertices' the geometry gets uploaded in the compact 'PackedVertex' layout.
+	Model(const std::string& filePath, bool isRayTracingGeometry = false, bool deferGPUResources = false, 
+		bool usePackedVertices = false);
 
 	Model(Vertex* vertices, unsigned int vertexCount, unsigned int* indices,
 		unsigned int indexCount, bool isRayTracingGeometry = false);
 
+	~Model();
+
 	Mesh* GetMesh(int index);
 	const std::vector<Mesh*>& GetMeshes();
 	unsigned int GetMeshCount();
 
+	/// <summary>
+	/// Creates the GPU resources for all meshes of the given (deferred) models in one go.
+	/// All geometry gets uploaded in a single copy submission, and all BLASes
+	/// get built in a single submission, instead of waiting on the GPU for each mesh.
+	/// </summary>
+	static void CreateGPUResources(const std::vector<Model*>& models);
 
-private:
-	void TraverseRootNodes(tinygltf::Model& model);
-	void TraverseChildNodes(tinygltf::Model& model, tinygltf::Node& node, const glm::mat4& parentMatrix);
-
-	glm::mat4 GetTransformFromNode(tinygltf::Node& node);
-	
 public:
 	Transform transform;
 	std::string Name;
@@ -42,5 +48,9 @@ public:
 private:
 	std::vector<Mesh*> meshes;
 
+	// Only kept alive until the GPU resources have been created, the materials are loaded from it
+	CookedModel* cookedModel = nullptr;
+	std::vector<unsigned int> cookedMeshIndices;
+
 	bool isRayTracingGeometry;
 };
\ No newline at end of file
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Graphics/RenderStage.h"
+#include "Graphics/Denoiser.h"
+
+class RayTraceStage;
+class Texture;
+
+/// <summary>
+/// Runs the a-trous denoiser of 'Denoise.hlsl' over the samples the RayTraceStage accumulated so far,
+/// guided by the albedo, normal & distance of their first hits. The filtered & tonemapped result replaces
+/// what the RayTraceStage copied to the screen, the accumulation itself is left untouched.
+/// </summary>
+class DenoiseStage : public RenderStage
+{
+public:
+	DenoiseStage(RayTraceStage* rayTraceStage);
+
+	void RecordStage(ComPtr<ID3D12GraphicsCommandList4> commandList) override;
+
+	bool IsEnabled();
+	void SetEnabled(bool isEnabled);
+
+	const DenoiserSettings& GetSettings();
+	void SetSettings(const DenoiserSettings& settings);
+
+private:
+	// Root constants of a single dispatch, matches 'DenoiseSettings' in Denoise.hlsl
+	struct DenoisePass
+	{
+		unsigned int pass;
+		int step;
+		float colorPhi;
+		float normalPhi;
+		float depthPhi;
+	};
+
+	void CreateShaderResources();
+	void InitializePipeline();
+
+	void DispatchPass(ComPtr<ID3D12GraphicsCommandList4> commandList, unsigned int pass, int step,
+		Texture* source, Texture* destination);
+
+private:
+	RayTraceStage* rayTraceStage;
+	DenoiserSettings settings;
+	bool isEnabled = false;
+
+	// RGB: irradiance, A: variance of its luminance. Every iteration filters one into the other //
+	Texture* irradianceBuffers[2];
+	Texture* outputBuffer;
+};
\ No newline at end of file
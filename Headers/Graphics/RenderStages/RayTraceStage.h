@@ -1,10 +1,12 @@
 #pragma once
 
 #include "Graphics/RenderStage.h"
+#include "Graphics/Sampler.h"
 
 class DXRayTracingPipeline;
 class DXTopLevelAS;
 class DXShaderBindingTable;
+class DXStructuredBuffer;
 class DXUploadBuffer;
 class Mesh;
 class Texture;
@@ -17,7 +19,18 @@ struct PipelineSettings
 	bool clearBuffers = false;
 	float time = 1.0f;
 	unsigned int frameCount = 0;
-	float stub[61];
+	int useIterativeIntegrator = true; // 4-byte bool to match HLSL, otherwise 'ClosestHit' traces ray trees
+
+	// Paths of the iterative integrator trace at least 'minDepth' rays before Russian roulette can end them,
+	// and at most 'maxDepth'. Making them equal turns Russian roulette off
+	unsigned int minDepth = 3;
+	unsigned int maxDepth = 8;
+
+	// Pixels with a relative error below the target stop sampling, 0 keeps sampling every pixel
+	float adaptiveTargetError = 0.0f;
+
+	SamplerType samplerType = SamplerType::BlueNoise; // 4 bytes, matches the 'uint' in HLSL
+	float stub[56];
 };
 
 class RayTraceStage : public RenderStage
@@ -28,6 +41,20 @@ public:
 	void Update(float deltaTime);
 
 	void RecordStage(ComPtr<ID3D12GraphicsCommandList4> commandList) override;
+
+	DXTopLevelAS* GetTLAS();
+
+	// Accumulated samples & first-hit guides, which the 'DenoiseStage' filters
+	Texture* GetAccumulationBuffer();
+	Texture* GetMomentBuffer();
+	Texture* GetAlbedoBuffer();
+	Texture* GetNormalBuffer();
+
+	// Changing the integrator restarts the accumulation
+	const PipelineSettings& GetSettings();
+	void SetIntegratorSettings(bool useIterativeIntegrator, unsigned int minDepth, unsigned int maxDepth);
+	void SetAdaptiveTargetError(float targetError);
+	void SetSamplerType(SamplerType samplerType);
 	
 private:
 	void CreateShaderResources();
@@ -39,17 +66,25 @@ private:
 private:
 	PipelineSettings settings;
 	DXUploadBuffer* settingsBuffer;
+	bool resetAccumulation = false;
 
 	unsigned int rayGenTableIndex = 0;
 
 	// Ray Tracing Components //
 	DXTopLevelAS* TLAS;
+	bool updateTLAS = false;
 	DXRayTracingPipeline* rayTracePipeline;
 	DXShaderBindingTable* shaderTable;
 
 	// Buffers for screen //
 	Texture* outputBuffer;
 	Texture* accumalationBuffer;
+	Texture* momentBuffer;
+	Texture* albedoBuffer; // RGB: summed albedo of the first hits, A: summed distance to them
+	Texture* normalBuffer;
+
+	// Ranks of 'GetBlueNoiseRanks', for the blue-noise sampler //
+	DXStructuredBuffer* blueNoiseBuffer;
 
 	Scene* activeScene;
 };
\ No newline at end of file
@@ -0,0 +1,20 @@
+#pragma once
+
+// Where the random numbers of a sample come from, the values match 'SAMPLER_' in Common.hlsl
+enum class SamplerType : unsigned int
+{
+	Random,		// XorShift32, white noise
+	Sobol,		// Owen-scrambled Sobol, every pixel gets its own scramble
+	BlueNoise	// Owen-scrambled Sobol shared by the pixels of a tile, scrambled further by their blue-noise rank
+};
+
+// The ranks tile the screen in blocks of 'blueNoiseSize' x 'blueNoiseSize' pixels
+static const unsigned int blueNoiseSize = 64;
+
+/// <summary>
+/// Ranks (0 .. blueNoiseSize^2 - 1) of a blue-noise mask, built through void-and-cluster (Ulichney 1993) on a torus.
+/// Any threshold of the ranks gives evenly spread pixels without low frequencies, so the error of samples that
+/// get scrambled by them looks like blue noise on screen. Built once on first use, with a fixed seed.
+/// Read by the samplers of both CPUCommon.h & Common.hlsl, the 'RayTraceStage' uploads them for the latter.
+/// </summary>
+const unsigned int* GetBlueNoiseRanks();
\ No newline at end of file
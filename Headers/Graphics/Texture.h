@@ -1,20 +1,35 @@
 #pragma once
 
 #include "Graphics/DXCommon.h"
+#include "Graphics/TextureCompression.h"
 #include <string>
+#include <vector>
+
+class CookedTexture;
 
 class Texture
 {
 public:
 	Texture(int width, int height, DXGI_FORMAT format);
-	Texture(void* data, int width, int height, 
-		DXGI_FORMAT format = DXGI_FORMAT_R8G8B8A8_UNORM, unsigned int formatSizeInBytes = 4);
-	Texture(const std::string& filePath);
+	Texture(void* data, int width, int height, DXGI_FORMAT format = DXGI_FORMAT_R8G8B8A8_UNORM, 
+		unsigned int formatSizeInBytes = 4, MipGeneration mipGeneration = MipGeneration::None);
+	Texture(const std::string& filePath, MipGeneration mipGeneration = MipGeneration::SRGB);
+
+	// Uploads the cooked mip chain as is, block compressed textures only get an SRV
+	Texture(CookedTexture& cookedTexture);
+
+	// Uploads an uncompressed mip chain that's already been generated (e.g. of an HDR image)
+	Texture(const unsigned char* mipChain, const std::vector<MipLevel>& levels, DXGI_FORMAT format, 
+		unsigned int formatSizeInBytes);
+
+	// Only gets its own SRV, which views 'placeholder' until the actual data gets swapped in through 'Refine'
+	Texture(Texture& placeholder);
 
 	~Texture();
 
 	int GetWidth();
 	int GetHeight();
+	unsigned int GetMipLevels();
 	DXGI_FORMAT GetFormat();
 
 	int GetSRVIndex();
@@ -26,11 +41,21 @@ public:
 	ComPtr<ID3D12Resource> GetResource();
 	D3D12_GPU_VIRTUAL_ADDRESS GetGPUVirtualAddress();
 
+	/// <summary>
+	/// Replaces the resource with the cooked mip chain, and rewrites the SRV in place. Its descriptor handle stays
+	/// the same, so shader tables that point to it stay valid. The GPU can't be using the texture while this happens.
+	/// </summary>
+	void Refine(CookedTexture& cookedTexture);
+
 private:
 	void AllocateTexture();
-	void UploadData(void* data);
+	void UploadData(void* data, MipGeneration mipGeneration);
+	void UploadMipChain(const unsigned char* data, const std::vector<MipLevel>& levels);
 
 	void CreateDescriptors();
+	void CreateSRV();
+
+	bool IsWritable();
 
 private:
 	ComPtr<ID3D12Resource> textureResource;
@@ -39,6 +64,8 @@ private:
 	unsigned int formatSizeInBytes;
 	int width;
 	int height;
+	unsigned int mipLevels = 1;
+	TextureCompression compression = TextureCompression::None;
 
 	int srvIndex = 0;
 	int uavIndex = 0;
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "Graphics/TextureProcessing.h"
+
+// Formats a texture can be cooked into, all block compressed formats encode blocks of 4x4 pixels
+enum class TextureCompression
+{
+	None,	// 8-bit RGBA, 4 bytes per pixel
+	BC1,	// RGB in 8 bytes per block, used for metallic roughness
+	BC5,	// RG in 16 bytes per block, used for normal maps
+	BC7		// RGBA in 16 bytes per block, used for base color
+};
+
+const char* GetCompressionName(TextureCompression compression);
+
+// Bytes of a single row of blocks (or pixels, when uncompressed), and of a whole level
+size_t GetCompressedRowPitch(TextureCompression compression, unsigned int width);
+size_t GetCompressedLevelSize(TextureCompression compression, unsigned int width, unsigned int height);
+
+/// <summary>
+/// Compresses every level of an 8-bit RGBA mip chain (e.g. from 'GenerateMipChain'), in parallel over rows of blocks.
+/// Partial blocks at the edges repeat the last row & column. 'compressedLevels' keeps the size of every level,
+/// with the offsets into 'compressedData'. When 'psnr' is given, it receives the PSNR of the first level.
+/// BC7 only uses mode 6 (one subset, 7-bit RGBA endpoints with p-bits, 4-bit indices), which suits most color data.
+/// </summary>
+void CompressMipChain(const unsigned char* mipChain, const std::vector<MipLevel>& mipLevels, TextureCompression compression,
+	std::vector<unsigned char>& compressedData, std::vector<MipLevel>& compressedLevels, float* psnr = nullptr);
+
+/// <summary>
+/// Decompresses every level of a chain made by 'CompressMipChain' back into 8-bit RGBA. Channels missing
+/// from the format read like they do on the GPU, BC5 returns 0 for blue and BC1 & BC5 return 255 for alpha.
+/// </summary>
+void DecompressMipChain(const unsigned char* compressedData, const std::vector<MipLevel>& compressedLevels,
+	TextureCompression compression, std::vector<unsigned char>& mipChain, std::vector<MipLevel>& mipLevels);
\ No newline at end of file
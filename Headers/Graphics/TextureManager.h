@@ -1,19 +1,50 @@
 #pragma once
 
+#include <cstdint>
 #include <unordered_map>
 #include <string>
+#include "Graphics/TextureCompression.h"
 
 class Texture;
 
+/// <summary>
+/// Registry of all loaded textures, keyed by a hash of their source data & the way they got cooked.
+/// Identical images are therefore shared, even when different models reference them through different paths.
+/// Textures are reference counted, they get deleted once the last user released them.
+/// </summary>
 class TextureManager
 {
 public:
-	static void AddTexture(const std::string& path, Texture* texture);
+	// Keys of an image file (hashing its contents, 0 if it can't be read), or of 8-bit RGBA pixels
+	static uint64_t GetImageKey(const std::string& imagePath, TextureCompression compression, MipGeneration mipGeneration);
+	static uint64_t GetImageKey(const unsigned char* pixels, int width, int height, TextureCompression compression,
+		MipGeneration mipGeneration);
+
+	// Stores a new texture, its single reference belongs to the caller
+	static void AddTexture(uint64_t key, Texture* texture);
+
+	// Returns a stored texture with a new reference for the caller, nullptr when the key isn't stored
+	static Texture* AcquireTexture(uint64_t key);
+	static void AddReference(Texture* texture);
+	static void ReleaseTexture(Texture* texture);
+
+	// Looks up a stored texture, without adding a reference
+	static Texture* GetTexture(uint64_t key);
+	static bool IsStored(uint64_t key);
+
+	// Loads an image file (uncompressed, with sRGB mips) or returns it when an identical image is stored, with a new reference
 	static Texture* LoadTexture(const std::string& path);
-	static Texture* GetTexture(const std::string& path);
-	static bool IsStored(const std::string& path);
+
+	static unsigned int GetTextureCount();
 
 private:
-	static std::unordered_map<std::string, Texture*> textureAssets;
-};
+	struct TextureEntry
+	{
+		Texture* texture;
+		unsigned int referenceCount;
+	};
 
+	static std::unordered_map<uint64_t, TextureEntry> textureAssets;
+	static std::unordered_map<Texture*, uint64_t> textureKeys;
+	static std::unordered_map<std::string, uint64_t> fileHashes;
+};
\ No newline at end of file
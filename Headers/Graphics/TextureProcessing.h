@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Processing steps that run on the CPU-side pixels of a texture, before it gets uploaded.
+// None of these depend on DirectX, so both the Texture and the CPU backend can use them.
+
+// How the mip chain of an 8-bit RGBA texture gets generated
+enum class MipGeneration
+{
+	None,	// Only the original image
+	SRGB,	// Color data, averaged in linear space (e.g. base color)
+	Linear	// Non-color data, averaged as is (e.g. normal & metallic roughness)
+};
+
+// A single level within a mip chain, 'offset' is in bytes from the start of the chain
+struct MipLevel
+{
+	unsigned int width;
+	unsigned int height;
+	size_t offset;
+};
+
+// Amount of levels down to 1x1, including the original
+unsigned int GetMipLevelCount(unsigned int width, unsigned int height);
+
+/// <summary>
+/// Generates the full mip chain of an 8-bit RGBA image. Every level halves the previous one (rounded down) 
+/// with a 2x2 box filter. For 'SRGB' the color channels get decoded to linear before they're averaged,
+/// alpha is always averaged as is. 'mipChain' receives all levels tightly packed, including the original one.
+/// </summary>
+void GenerateMipChain(const unsigned char* data, unsigned int width, unsigned int height, MipGeneration generation,
+	std::vector<unsigned char>& mipChain, std::vector<MipLevel>& levels);
+
+// How an HDR image (32-bit float RGBA) gets stored
+enum class HDRFormat
+{
+	RGBA32F,	// 16 bytes per pixel, the image as is
+	RGBA16F,	// 8 bytes per pixel, half floats (clamped to +-65504)
+	RGB9E5		// 4 bytes per pixel, three 9-bit mantissas sharing a 5-bit exponent (0 to 65408, no alpha)
+};
+
+const char* GetHDRFormatName(HDRFormat format);
+unsigned int GetHDRPixelSize(HDRFormat format);
+
+/// <summary>
+/// Generates the first 'levelCount' levels of the mip chain of a 32-bit float RGBA image, with the same 2x2 box filter
+/// as 'GenerateMipChain'. HDR data is already linear, so it's averaged as is. Every level is a prefiltered, 
+/// downsampled copy, which suits lookups of blurry (e.g. rough) reflections. The offsets of 'levels' are in bytes.
+/// </summary>
+void GenerateHDRMipChain(const float* data, unsigned int width, unsigned int height, unsigned int levelCount,
+	std::vector<float>& mipChain, std::vector<MipLevel>& levels);
+
+/// <summary>
+/// Converts 32-bit float RGBA pixels into 'format', rounding to the nearest value. 'destination' needs room for
+/// 'pixelCount' pixels of 'GetHDRPixelSize'. Four pixels get converted at a time with SSE2, in parallel over blocks.
+/// </summary>
+void ConvertHDRPixels(const float* pixels, size_t pixelCount, HDRFormat format, void* destination);
\ No newline at end of file
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "Graphics/TextureCompression.h"
+#include "Utilities/ThreadPool.h"
+
+class Texture;
+class CookedTexture;
+
+/// <summary>
+/// Loads textures in the background, so a scene can be shown before its images have been decoded & cooked.
+/// Streamed textures view a placeholder at first, worker threads cook the actual images. Once done they get
+/// uploaded & swapped in on the main thread through 'Update', in the same descriptor slot as the placeholder.
+/// </summary>
+class TextureStreamer
+{
+public:
+	static Texture* StreamTexture(const std::string& imagePath, TextureCompression compression,
+		MipGeneration mipGeneration, Texture* placeholder);
+
+	// Used for images embedded in a glTF file, the pixels get copied so they don't have to outlive the model
+	static Texture* StreamTexture(const unsigned char* pixels, int width, int height, TextureCompression compression,
+		MipGeneration mipGeneration, Texture* placeholder);
+
+	/// <summary>
+	/// Uploads the textures that finished cooking & swaps them in, this has to happen on the main thread.
+	/// At least one texture gets uploaded per call, after that it stops once 'uploadBudget' bytes have been uploaded.
+	/// Swapping rewrites descriptors that frames in flight might read, so it has to wait for the GPU. To not stall
+	/// every frame in which a texture finished, swaps are batched: they wait till a batch of textures is ready,
+	/// nothing else is cooking anymore, or the oldest finished texture has waited long enough.
+	/// Returns true if any texture changed, which means accumulated frames are outdated.
+	/// </summary>
+	static bool Update(size_t uploadBudget = 64 * 1024 * 1024);
+
+	// Blocks until every requested texture has been cooked & swapped in
+	static void Flush();
+
+	// Deletes the texture, or once its cooking finished when it's still streaming in
+	static void DeleteTexture(Texture* texture);
+
+	static unsigned int GetPendingCount();
+
+private:
+	struct StreamRequest
+	{
+		Texture* texture;
+		CookedTexture* cookedTexture;
+		std::chrono::high_resolution_clock::time_point finishTime;
+	};
+
+	static void Submit(Texture* texture, std::function<CookedTexture*()> cook);
+
+private:
+	static TaskGroup streamingTasks;
+	static std::mutex finishedLock;
+	static std::vector<StreamRequest> finishedRequests;
+	static std::atomic<unsigned int> pendingCount;
+
+	// Only used from the main thread //
+	static std::unordered_set<Texture*> streamingTextures;
+	static std::unordered_set<Texture*> deletedTextures;
+	static std::chrono::high_resolution_clock::time_point streamStart;
+};
\ No newline at end of file
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <glm.hpp>
+
+// Kept separate from Mesh.h so that systems without a DirectX device,
+// such as the CPU backend, can share the exact same vertex layout.
+struct Vertex
+{
+	glm::vec3 Position;
+	glm::vec3 Normal;
+	glm::vec4 Tangent; // 'w' holds the sign of the bitangent: cross(Normal, Tangent) * w
+	glm::vec2 TextureCoord0;
+};
+
+// Compact GPU layout of 'Vertex', 20 instead of 48 bytes. See 'PackVertices' for the encoding,
+// the matching decode lives in 'ClosestHit-PT.hlsl'. Positions can be read as R16G16B16A16_SNORM.
+struct PackedVertex
+{
+	int16_t Position[4];	 // xyz: snorm, relative to the mesh bounds, w: bitangent sign
+	int16_t Normal[2];		 // Octahedral encoded, snorm
+	int16_t Tangent[2];		 // Octahedral encoded, snorm
+	uint32_t TextureCoord0;	 // Two halfs
+};
+
+// Maps the snorm positions of packed vertices back to their original space: position = offset + scale * snorm
+struct PackedVertexQuantization
+{
+	glm::vec3 offset = glm::vec3(0.0f);
+	glm::vec3 scale = glm::vec3(1.0f);
+};
\ No newline at end of file
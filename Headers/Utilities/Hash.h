@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// Non-cryptographic 64-bit hashing, meant for detecting changes to files & data (e.g. asset caches).
+// Processes 8 bytes per step so hashing large buffers stays in the order of GB/s.
+
+inline uint64_t HashMix(uint64_t value)
+{
+	value ^= value >> 32;
+	value *= 0xD6E8FEB86659FD93ull;
+	value ^= value >> 32;
+	value *= 0xD6E8FEB86659FD93ull;
+	value ^= value >> 32;
+	return value;
+}
+
+inline uint64_t HashBytes(const void* data, size_t size, uint64_t seed = 0)
+{
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	uint64_t hash = HashMix(seed ^ (size * 0x9E3779B97F4A7C15ull));
+
+	size_t i = 0;
+	for(; i + 8 <= size; i += 8)
+	{
+		uint64_t word;
+		memcpy(&word, bytes + i, sizeof(uint64_t));
+		hash = (hash ^ (word * 0x9E3779B97F4A7C15ull)) * 0xBF58476D1CE4E5B9ull;
+		hash ^= hash >> 29;
+	}
+
+	// Remaining tail, padded with zeros //
+	if(i < size)
+	{
+		uint64_t word = 0;
+		memcpy(&word, bytes + i, size - i);
+		hash = (hash ^ (word * 0x9E3779B97F4A7C15ull)) * 0xBF58476D1CE4E5B9ull;
+	}
+
+	return HashMix(hash);
+}
+
+inline uint64_t HashString(const std::string& string, uint64_t seed = 0)
+{
+	return HashBytes(string.data(), string.size(), seed);
+}
\ No newline at end of file
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+
+/// <summary>
+/// Read-only view of a file that is memory mapped instead of read into memory.
+/// Pages only get loaded once they are touched, and are shared with the OS file cache.
+/// The data stays valid for as long as the MappedFile exists.
+/// </summary>
+class MappedFile
+{
+public:
+	MappedFile(const std::string& filePath);
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool IsValid();
+	const unsigned char* GetData();
+	size_t GetSize();
+
+private:
+	const unsigned char* data = nullptr;
+	size_t size = 0;
+
+#ifdef _WIN32
+	void* fileHandle = nullptr;
+	void* mappingHandle = nullptr;
+#endif
+};
\ No newline at end of file
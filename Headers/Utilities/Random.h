@@ -1,21 +1,80 @@
 #pragma once
-#include <random>
 
-static unsigned int state = time(NULL);
-inline unsigned int xorshift32()
-{
-	state ^= state << 13;
-	state ^= state >> 17;
-	state ^= state << 5;
-	return state;
-}
+#include <cstdint>
 
-inline float Random01()
+/// <summary>
+/// PCG32 (O'Neill 2014), a 64-bit LCG of which the output gets permuted down to 32 bits.
+/// Every stream picks its own LCG increment, so generators with different streams never overlap,
+/// give one to every thread, pixel or asset. All state lives inside the object, nothing is shared,
+/// so a seed & stream produce the same numbers regardless of which (or how many) threads draw them.
+/// Jumping ahead with 'Advance' is O(log n), e.g. to give every sample its own part of a pixel's stream.
+/// </summary>
+class RandomStream
 {
-	return xorshift32() * 2.3283064365387e-10f;
-}
+public:
+	RandomStream(uint64_t seed = defaultSeed, uint64_t stream = 0)
+	{
+		increment = (stream << 1) | 1;
+		state = 0;
+		NextUInt();
+		state += seed;
+		NextUInt();
+	}
 
-inline float RandomInRange(float min, float max)
-{
-	return min + (max - min) * Random01();
-}
\ No newline at end of file
+	unsigned int NextUInt()
+	{
+		uint64_t oldState = state;
+		state = oldState * multiplier + increment;
+
+		// XSH-RR: xorshift the high bits down, then rotate by the top 5 bits //
+		unsigned int xorShifted = (unsigned int)(((oldState >> 18) ^ oldState) >> 27);
+		unsigned int rotation = (unsigned int)(oldState >> 59);
+		return (xorShifted >> rotation) | (xorShifted << ((32 - rotation) & 31));
+	}
+
+	// [0, 1), only the top 24 bits are used so the result never rounds up to 1
+	float Random01()
+	{
+		return (NextUInt() >> 8) * (1.0f / 16777216.0f);
+	}
+
+	float RandomInRange(float min, float max)
+	{
+		return min + (max - min) * Random01();
+	}
+
+	/// <summary>
+	/// Skips the next 'delta' numbers, as if 'NextUInt' got called 'delta' times (Brown 1994).
+	/// Repeatedly squares the LCG step, so it only takes log2(delta) iterations.
+	/// </summary>
+	void Advance(uint64_t delta)
+	{
+		uint64_t accumulatedMultiplier = 1;
+		uint64_t accumulatedIncrement = 0;
+		uint64_t stepMultiplier = multiplier;
+		uint64_t stepIncrement = increment;
+
+		while(delta > 0)
+		{
+			if(delta & 1)
+			{
+				accumulatedMultiplier *= stepMultiplier;
+				accumulatedIncrement = accumulatedIncrement * stepMultiplier + stepIncrement;
+			}
+
+			stepIncrement = (stepMultiplier + 1) * stepIncrement;
+			stepMultiplier *= stepMultiplier;
+			delta >>= 1;
+		}
+
+		state = accumulatedMultiplier * state + accumulatedIncrement;
+	}
+
+	static const uint64_t defaultSeed = 0x853C49E6748FEA9Bull;
+
+private:
+	static const uint64_t multiplier = 6364136223846793005ull;
+
+	uint64_t state;
+	uint64_t increment;
+};
\ No newline at end of file
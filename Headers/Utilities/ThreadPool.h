@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// <summary>
+/// Keeps track of a batch of submitted tasks, so that they can be waited on together.
+/// </summary>
+class TaskGroup
+{
+public:
+	bool IsFinished();
+
+private:
+	std::atomic<unsigned int> pendingTasks{ 0 };
+
+	friend class ThreadPool;
+};
+
+/// <summary>
+/// Work-stealing thread pool. Every worker owns a queue which it processes in LIFO order,
+/// once it runs dry it will steal the oldest task from another worker. Tasks are allowed to
+/// submit (and wait on) other tasks, threads that are waiting help out with the remaining work.
+/// Workers help with any task, other threads (like the main thread) only with tasks of the group they wait on.
+/// </summary>
+class ThreadPool
+{
+public:
+	// When 'threadCount' is 0, one worker per core gets created
+	ThreadPool(unsigned int threadCount = 0);
+	~ThreadPool();
+
+	void Submit(TaskGroup& group, std::function<void()> task);
+	void Wait(TaskGroup& group);
+
+	// Runs 'task' for all indices in [0, count), 'batchSize' indices are grouped per submitted task
+	void ParallelFor(unsigned int count, const std::function<void(unsigned int index)>& task, unsigned int batchSize = 1);
+
+	unsigned int GetThreadCount();
+
+	// Shared pool used by systems that don't get one passed in. The thread count
+	// can only be changed before the pool gets used for the first time.
+	static ThreadPool& GetGlobalPool();
+	static void SetGlobalThreadCount(unsigned int threadCount);
+
+private:
+	struct Task
+	{
+		std::function<void()> function;
+		TaskGroup* group = nullptr;
+	};
+
+	struct WorkQueue
+	{
+		std::mutex lock;
+		std::deque<Task> tasks;
+	};
+
+	void WorkerLoop(unsigned int workerIndex);
+	bool TryRunTask(int workerIndex, TaskGroup* group = nullptr);
+	bool PopTask(unsigned int queueIndex, Task& task);
+	bool StealTask(unsigned int queueIndex, Task& task, TaskGroup* group);
+
+private:
+	std::vector<std::thread> workers;
+	std::vector<WorkQueue*> queues;
+
+	std::mutex sleepLock;
+	std::condition_variable sleepCondition;
+	std::atomic<unsigned int> queuedTaskCount{ 0 };
+	std::atomic<unsigned int> nextQueue{ 0 };
+	bool isRunning = true;
+};
\ No newline at end of file
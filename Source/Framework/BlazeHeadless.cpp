@@ -0,0 +1,596 @@
+#include "Framework/BlazeHeadless.h"
+#include "Framework/SceneDescription.h"
+#include "Framework/HeadlessChecks.h"
+#include "Graphics/CPU/CPUScene.h"
+#include "Graphics/CPU/CPUPathTracer.h"
+#include "Graphics/CPU/CPUModel.h"
+#include "Graphics/CPU/CPUTopLevelAS.h"
+#include "Graphics/CPU/CPURayPacket.h"
+#include "Graphics/CPU/CPUSamplingTest.h"
+#include "Utilities/ThreadPool.h"
+#include "Utilities/Hash.h"
+#include "Utilities/Logger.h"
+#include "Utilities/Random.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include <vector>
+
+// Frames the animation test moves the models for, every frame traces this many rays through both TLASes
+static const unsigned int animationFrameCount = 64;
+static const unsigned int animationRayCount = 4096;
+
+
+// Fixed render of the regression test, adaptive so that the tile scheduling gets covered as well. Tiles only
+// get skipped once they have 'minAdaptiveSampleCount' samples, the cap leaves the noisy ones room to go past that.
+// The expected average is of the default scene lit by the gradient sky, it has to be updated along
+// with intended changes to the image. Other compilers can round differently, so it has a tolerance.
+static const unsigned int regressionWidth = 160;
+static const unsigned int regressionHeight = 90;
+static const unsigned int regressionSampleCount = 128;
+static const float regressionTargetError = 0.05f;
+static const glm::vec3 regressionExpectedAverage = glm::vec3(0.535062f, 0.532867f, 0.528779f);
+static const float regressionTolerance = 0.005f;
+
+BlazeHeadless::BlazeHeadless(int argc, char** argv)
+{
+	ParseArguments(argc, argv);
+
+	// Loading & building the acceleration structures uses the same pool as rendering
+	ThreadPool::SetGlobalThreadCount(threadCount);
+	SetPacketAVX2(usePacketAVX2);
+
+	// Checks of a single system don't render, so there's no need to load the scene
+	if(runPackingCheck || runChiSquareTest || runRandomCheck || runMipCheck || runHDRCheck || runMeshCheck || 
+		runTangentCheck || runCompressionCheck || runGLTFCheck)
+	{
+		LOG("Successfully initialized - Blaze (Headless), without a scene");
+		return;
+	}
+
+	// The regression test shouldn't depend on whether the environment map is on disk
+	SceneDescription description = GetDefaultSceneDescription();
+	if(runRegressionTest)
+	{
+		description.environmentMapPath.clear();
+	}
+
+	scene = new CPUScene(description);
+	pathTracer = new CPUPathTracer(scene, width, height);
+	pathTracer->SetIntegrator(useRecursiveIntegrator ? CPUPathTracer::Integrator::Recursive : CPUPathTracer::Integrator::Iterative);
+	pathTracer->SetDepthRange(minDepth, maxDepth);
+	pathTracer->SetSamplerType(samplerType);
+	pathTracer->SetPacketTracing(usePacketTracing);
+
+	LOG("Successfully initialized - Blaze (Headless)");
+}
+
+BlazeHeadless::~BlazeHeadless()
+{
+	delete pathTracer;
+	delete scene;
+}
+
+int BlazeHeadless::Run()
+{
+	if(runConvergenceTest)
+	{
+		return RunConvergenceTest();
+	}
+
+	if(runPackingCheck)
+	{
+		return RunPackingCheck() > 0 ? 1 : 0;
+	}
+
+	if(runChiSquareTest)
+	{
+		return RunSamplingChiSquareTest() > 0 ? 1 : 0;
+	}
+
+	if(runRandomCheck)
+	{
+		return RunRandomCheck() > 0 ? 1 : 0;
+	}
+
+	if(runMipCheck)
+	{
+		return RunMipCheck() > 0 ? 1 : 0;
+	}
+
+	if(runHDRCheck)
+	{
+		return RunHDRCheck() > 0 ? 1 : 0;
+	}
+
+	if(runMeshCheck)
+	{
+		return RunMeshCheck() > 0 ? 1 : 0;
+	}
+
+	if(runTangentCheck)
+	{
+		return RunTangentCheck() > 0 ? 1 : 0;
+	}
+
+	if(runCompressionCheck)
+	{
+		return RunCompressionCheck() > 0 ? 1 : 0;
+	}
+
+	if(runGLTFCheck)
+	{
+		return RunGLTFCheck() > 0 ? 1 : 0;
+	}
+
+	if(runAnimationTest)
+	{
+		return RunAnimationTest();
+	}
+
+	if(runRegressionTest)
+	{
+		return RunRegressionTest();
+	}
+
+	if(runRayBenchmark)
+	{
+		pathTracer->BenchmarkPrimaryRays(sampleCount);
+		return 0;
+	}
+
+	// With a target error, '--samples' is the most a pixel gets
+	if(targetError > 0.0f)
+	{
+		pathTracer->RenderUntilConverged(targetError, sampleCount);
+	}
+	else
+	{
+		pathTracer->Render(sampleCount);
+	}
+
+	if(!referencePath.empty())
+	{
+		LOG("PSNR against the reference: " + std::to_string(pathTracer->GetPSNR(referencePath)) + "dB");
+	}
+
+	if(useDenoiser)
+	{
+		pathTracer->Denoise();
+
+		if(!referencePath.empty())
+		{
+			LOG("PSNR against the reference after denoising: " + std::to_string(pathTracer->GetPSNR(referencePath)) + "dB");
+		}
+	}
+
+	if(!pathTracer->SaveImage(outputPath))
+	{
+		return 1;
+	}
+
+	LOG("Saved render to: " + outputPath);
+	return 0;
+}
+
+int BlazeHeadless::RunConvergenceTest()
+{
+	if(referencePath.empty())
+	{
+		LOG(Log::MessageType::Error, "The convergence test needs a '--reference' to compare against");
+		return 1;
+	}
+
+	// Every sampler renders the same image, doubling its samples up to '--samples' //
+	const std::vector<SamplerType> samplerTypes = { SamplerType::Random, SamplerType::Sobol, SamplerType::BlueNoise };
+	std::vector<std::vector<float>> results(samplerTypes.size());
+	std::vector<unsigned int> sampleCounts;
+
+	for(unsigned int i = 0; i < samplerTypes.size(); i++)
+	{
+		pathTracer->ClearBuffers();
+		pathTracer->SetSamplerType(samplerTypes[i]);
+
+		unsigned int renderedCount = 0;
+		for(unsigned int count = 1; count <= sampleCount; count *= 2)
+		{
+			pathTracer->Render(count - renderedCount);
+			renderedCount = count;
+
+			results[i].push_back(pathTracer->GetPSNR(referencePath));
+			if(i == 0)
+			{
+				sampleCounts.push_back(count);
+			}
+		}
+	}
+
+	LOG("Convergence against " + referencePath + " (PSNR):");
+	for(unsigned int j = 0; j < sampleCounts.size(); j++)
+	{
+		std::string line = std::to_string(sampleCounts[j]) + " spp:";
+		for(unsigned int i = 0; i < samplerTypes.size(); i++)
+		{
+			line += " " + GetSamplerName(samplerTypes[i]) + " " + std::to_string(results[i][j]) + "dB";
+		}
+		LOG(line);
+	}
+
+	// The blue-noise render is what's left in the buffers //
+	if(!pathTracer->SaveImage(outputPath))
+	{
+		return 1;
+	}
+
+	LOG("Saved render to: " + outputPath);
+	return 0;
+}
+
+int BlazeHeadless::RunAnimationTest()
+{
+	CPUTopLevelAS* tlas = scene->GetTLAS();
+	const std::vector<CPUModel*>& models = scene->GetModels();
+
+	if(models.empty() || tlas->GetInstanceCount() == 0)
+	{
+		LOG(Log::MessageType::Error, "The animation test needs a scene with at least one instance");
+		return 1;
+	}
+
+	// Gets rebuild from scratch every frame, the refitted TLAS of the scene should find the same hits //
+	CPUTopLevelAS rebuiltTLAS(scene);
+
+	glm::vec3 sceneMin = glm::vec3(FLT_MAX);
+	glm::vec3 sceneMax = glm::vec3(-FLT_MAX);
+	for(unsigned int i = 0; i < tlas->GetInstanceCount(); i++)
+	{
+		sceneMin = glm::min(sceneMin, tlas->GetInstance(i).boundsMin);
+		sceneMax = glm::max(sceneMax, tlas->GetInstance(i).boundsMax);
+	}
+
+	std::vector<glm::vec3> basePositions;
+	std::vector<glm::vec3> baseRotations;
+	for(CPUModel* model : models)
+	{
+		basePositions.push_back(model->transform.Position);
+		baseRotations.push_back(model->transform.Rotation);
+	}
+
+	RandomStream random;
+	unsigned int mismatchCount = 0;
+
+	// 1) Moves a single model per frame, like dragging it around in the editor, 2) moves every model //
+	for(unsigned int phase = 0; phase < 2; phase++)
+	{
+		double updateTime = 0.0;
+		double rebuildTime = 0.0;
+		unsigned int movedInstanceCount = 0;
+
+		for(unsigned int frame = 0; frame < animationFrameCount; frame++)
+		{
+			for(unsigned int i = 0; i < models.size(); i++)
+			{
+				if(phase == 0 && i != frame % models.size())
+				{
+					continue;
+				}
+
+				float time = float(frame + 1) * 0.1f;
+				models[i]->transform.Position = basePositions[i] + glm::vec3(sinf(time), 0.0f, cosf(time) - 1.0f) * 0.25f;
+				models[i]->transform.Rotation = baseRotations[i] + glm::vec3(0.0f, float(frame + 1) * 5.0f, 0.0f);
+			}
+
+			tlas->UpdateTLAS();
+			updateTime += tlas->GetUpdateTime();
+			movedInstanceCount += tlas->GetMovedInstanceCount();
+
+			rebuiltTLAS.RebuildTLAS();
+			rebuildTime += rebuiltTLAS.GetBuildTime();
+
+			for(unsigned int i = 0; i < animationRayCount; i++)
+			{
+				glm::vec3 from = glm::mix(sceneMin, sceneMax, glm::vec3(random.Random01(), random.Random01(), random.Random01()));
+				glm::vec3 to = glm::mix(sceneMin, sceneMax, glm::vec3(random.Random01(), random.Random01(), random.Random01()));
+
+				Ray ray;
+				ray.Origin = from;
+				ray.Direction = glm::normalize(to - from + glm::vec3(1e-4f));
+
+				HitInfo refitHit;
+				refitHit.t = ray.TMax;
+				HitInfo rebuiltHit;
+				rebuiltHit.t = ray.TMax;
+
+				bool refitHasHit = tlas->Intersect(ray, refitHit);
+				bool rebuiltHasHit = rebuiltTLAS.Intersect(ray, rebuiltHit);
+
+				if(refitHasHit != rebuiltHasHit || (refitHasHit && (refitHit.t != rebuiltHit.t ||
+					refitHit.instanceIndex != rebuiltHit.instanceIndex || refitHit.primitiveIndex != rebuiltHit.primitiveIndex)))
+				{
+					mismatchCount++;
+				}
+			}
+		}
+
+		LOG(std::string(phase == 0 ? "Moving one model" : "Moving all models") + ": refit " 
+			+ std::to_string(updateTime / animationFrameCount) + "us (" 
+			+ std::to_string(movedInstanceCount / animationFrameCount) + "/" + std::to_string(tlas->GetInstanceCount()) 
+			+ " instances), rebuild " + std::to_string(rebuildTime / animationFrameCount) + "us per frame");
+	}
+
+	LOG("Refitted against rebuilt TLAS: " + std::to_string(mismatchCount) + " mismatches in " 
+		+ std::to_string(2 * animationFrameCount * animationRayCount) + " rays");
+
+	if(mismatchCount > 0)
+	{
+		LOG(Log::MessageType::Error, "The refitted TLAS found different hits than a rebuild");
+		return 1;
+	}
+
+	return 0;
+}
+
+int BlazeHeadless::RunRegressionTest()
+{
+	// 1) Render on pools with a different amount of threads, tiles finish in another order but the image has to be identical //
+	ThreadPool& globalPool = ThreadPool::GetGlobalPool();
+	ThreadPool otherPool(globalPool.GetThreadCount() == 1 ? 4 : 1);
+
+	std::vector<unsigned int> sampleCounts;
+	std::vector<unsigned int> otherSampleCounts;
+	std::vector<glm::vec3> image = RenderRegressionImage(&globalPool, sampleCounts);
+	std::vector<glm::vec3> otherImage = RenderRegressionImage(&otherPool, otherSampleCounts);
+
+	uint64_t hash = HashBytes(image.data(), image.size() * sizeof(glm::vec3));
+	uint64_t otherHash = HashBytes(otherImage.data(), otherImage.size() * sizeof(glm::vec3));
+
+	char hashText[32];
+	snprintf(hashText, sizeof(hashText), "%016llx", (unsigned long long)hash);
+	LOG("Regression render hash: " + std::string(hashText) + " with " + std::to_string(globalPool.GetThreadCount()) 
+		+ " threads, " + (hash == otherHash ? "identical" : "different") + " with " + std::to_string(otherPool.GetThreadCount()));
+
+	bool hasPassed = true;
+	if(hash != otherHash)
+	{
+		LOG(Log::MessageType::Error, "The regression render depends on the amount of threads");
+		hasPassed = false;
+	}
+
+	// 2) Adaptive sampling has to stop some tiles before others, at the same sample for any amount of threads //
+	auto sampleCountRange = std::minmax_element(sampleCounts.begin(), sampleCounts.end());
+	LOG("Regression render samples per pixel: " + std::to_string(*sampleCountRange.first) + " to " 
+		+ std::to_string(*sampleCountRange.second));
+
+	if(*sampleCountRange.first == *sampleCountRange.second)
+	{
+		LOG(Log::MessageType::Error, "Adaptive sampling gave every pixel the same amount of samples, no tile got skipped");
+		hasPassed = false;
+	}
+
+	if(sampleCounts != otherSampleCounts)
+	{
+		LOG(Log::MessageType::Error, "The samples per pixel of the regression render depend on the amount of threads");
+		hasPassed = false;
+	}
+
+	// 3) Exact comparison, only meaningful with the compiler & flags the hash got taken with //
+	if(expectedHash != 0 && hash != expectedHash)
+	{
+		LOG(Log::MessageType::Error, "The regression render doesn't match the expected hash");
+		hasPassed = false;
+	}
+
+	// 4) The average has to stay within the tolerance of the stored one, regardless of the build //
+	glm::dvec3 sum = glm::dvec3(0.0);
+	for(const glm::vec3& color : image)
+	{
+		sum += glm::dvec3(color);
+	}
+
+	glm::vec3 average = glm::vec3(sum / double(image.size()));
+	glm::vec3 relativeError = glm::abs(average - regressionExpectedAverage) / regressionExpectedAverage;
+	float maxRelativeError = glm::max(relativeError.x, glm::max(relativeError.y, relativeError.z));
+
+	LOG("Regression render average: " + std::to_string(average.x) + ", " + std::to_string(average.y) + ", " 
+		+ std::to_string(average.z) + ", " + std::to_string(maxRelativeError * 100.0f) + "% from the expected average");
+
+	if(!(maxRelativeError <= regressionTolerance))
+	{
+		LOG(Log::MessageType::Error, "The regression render moved away from the expected average");
+		hasPassed = false;
+	}
+
+	return hasPassed ? 0 : 1;
+}
+
+std::vector<glm::vec3> BlazeHeadless::RenderRegressionImage(ThreadPool* threadPool, std::vector<unsigned int>& sampleCounts)
+{
+	CPUPathTracer regressionTracer(scene, regressionWidth, regressionHeight, threadPool);
+	regressionTracer.SetIntegrator(CPUPathTracer::Integrator::Iterative);
+	regressionTracer.SetDepthRange(3, 8);
+	regressionTracer.SetSamplerType(SamplerType::BlueNoise);
+	regressionTracer.SetPacketTracing(usePacketTracing);
+	regressionTracer.RenderUntilConverged(regressionTargetError, regressionSampleCount);
+
+	std::vector<glm::vec3> image;
+	for(unsigned int y = 0; y < regressionHeight; y++)
+	{
+		for(unsigned int x = 0; x < regressionWidth; x++)
+		{
+			image.push_back(regressionTracer.GetPixelColor(x, y));
+			sampleCounts.push_back(regressionTracer.GetPixelSampleCount(x, y));
+		}
+	}
+
+	return image;
+}
+
+std::string BlazeHeadless::GetSamplerName(SamplerType samplerType)
+{
+	switch(samplerType)
+	{
+	case SamplerType::Random:
+		return "random";
+	case SamplerType::Sobol:
+		return "sobol";
+	case SamplerType::BlueNoise:
+		return "bluenoise";
+	}
+
+	return "unknown";
+}
+
+void BlazeHeadless::ParseArguments(int argc, char** argv)
+{
+	for(int i = 1; i < argc; i++)
+	{
+		std::string argument = argv[i];
+		bool hasValue = i + 1 < argc;
+
+		if(argument == "--headless")
+		{
+			continue;
+		}
+		else if(argument == "--width" && hasValue)
+		{
+			width = std::max(atoi(argv[++i]), 1);
+		}
+		else if(argument == "--height" && hasValue)
+		{
+			height = std::max(atoi(argv[++i]), 1);
+		}
+		else if(argument == "--samples" && hasValue)
+		{
+			sampleCount = std::max(atoi(argv[++i]), 1);
+		}
+		else if(argument == "--threads" && hasValue)
+		{
+			threadCount = std::max(atoi(argv[++i]), 0);
+		}
+		else if(argument == "--output" && hasValue)
+		{
+			outputPath = argv[++i];
+		}
+		else if(argument == "--min-depth" && hasValue)
+		{
+			minDepth = std::max(atoi(argv[++i]), 1);
+		}
+		else if(argument == "--max-depth" && hasValue)
+		{
+			maxDepth = std::max(atoi(argv[++i]), 1);
+		}
+		else if(argument == "--target-error" && hasValue)
+		{
+			targetError = std::max(float(atof(argv[++i])), 0.0f);
+		}
+		else if(argument == "--denoise")
+		{
+			useDenoiser = true;
+		}
+		else if(argument == "--reference" && hasValue)
+		{
+			referencePath = argv[++i];
+		}
+		else if(argument == "--sampler" && hasValue)
+		{
+			std::string sampler = argv[++i];
+			if(sampler == GetSamplerName(SamplerType::Random))
+			{
+				samplerType = SamplerType::Random;
+			}
+			else if(sampler == GetSamplerName(SamplerType::Sobol))
+			{
+				samplerType = SamplerType::Sobol;
+			}
+			else if(sampler == GetSamplerName(SamplerType::BlueNoise))
+			{
+				samplerType = SamplerType::BlueNoise;
+			}
+			else
+			{
+				LOG(Log::MessageType::Error, "Unknown sampler: " + sampler);
+			}
+		}
+		else if(argument == "--convergence")
+		{
+			runConvergenceTest = true;
+		}
+		else if(argument == "--benchmark-rays")
+		{
+			runRayBenchmark = true;
+		}
+		else if(argument == "--regression")
+		{
+			runRegressionTest = true;
+		}
+		else if(argument == "--expected-hash" && hasValue)
+		{
+			expectedHash = strtoull(argv[++i], nullptr, 16);
+		}
+		else if(argument == "--chi2")
+		{
+			runChiSquareTest = true;
+		}
+		else if(argument == "--check-packing")
+		{
+			runPackingCheck = true;
+		}
+		else if(argument == "--check-random")
+		{
+			runRandomCheck = true;
+		}
+		else if(argument == "--check-mips")
+		{
+			runMipCheck = true;
+		}
+		else if(argument == "--check-hdr")
+		{
+			runHDRCheck = true;
+		}
+		else if(argument == "--check-mesh")
+		{
+			runMeshCheck = true;
+		}
+		else if(argument == "--check-tangents")
+		{
+			runTangentCheck = true;
+		}
+		else if(argument == "--check-compression")
+		{
+			runCompressionCheck = true;
+		}
+		else if(argument == "--check-gltf")
+		{
+			runGLTFCheck = true;
+		}
+		else if(argument == "--animate")
+		{
+			runAnimationTest = true;
+		}
+		else if(argument == "--no-packets")
+		{
+			usePacketTracing = false;
+		}
+		else if(argument == "--no-avx2")
+		{
+			usePacketAVX2 = false;
+		}
+		else if(argument == "--integrator" && hasValue)
+		{
+			std::string integrator = argv[++i];
+			if(integrator != "iterative" && integrator != "recursive")
+			{
+				LOG(Log::MessageType::Error, "Unknown integrator: " + integrator);
+			}
+
+			useRecursiveIntegrator = integrator == "recursive";
+		}
+		else
+		{
+			LOG(Log::MessageType::Error, "Unknown or incomplete argument: " + argument);
+		}
+	}
+}
\ No newline at end of file
@@ -1,6 +1,10 @@
 #include "Framework/Editor.h"
 #include "Framework/Blaze.h"
 #include "Framework/Scene.h"
+#include "Framework/Renderer.h"
+#include "Graphics/RenderStages/RayTraceStage.h"
+#include "Graphics/RenderStages/DenoiseStage.h"
+#include "Graphics/DXTopLevelAS.h"
 #include "Graphics/Model.h"
 #include "Graphics/Mesh.h"
 
@@ -24,6 +28,7 @@ void Editor::Update(float deltaTime)
 	Menubar();
 	TransformWindow();
 	MaterialWindow();
+	IntegratorWindow();
 }
 
 void Editor::Menubar()
@@ -54,6 +59,15 @@ void Editor::Menubar()
 		ImGui::Text(frames.c_str());
 		ImGui::Separator();
 
+		ImGui::PushFont(boldFont);
+		ImGui::Text("TLAS update:");
+		ImGui::PopFont();
+
+		float updateTime = application->renderer->GetRayTraceStage()->GetTLAS()->GetUpdateTime();
+		std::string tlasUpdate = std::to_string(int(updateTime)) + "us";
+		ImGui::Text(tlasUpdate.c_str());
+		ImGui::Separator();
+
 		ImGui::EndMainMenuBar();
 	}
 }
@@ -166,7 +180,76 @@ void Editor::MaterialWindow()
 		// TODO: Again, similar to other stuff. There needs to be some 'reset scene'
 		// function similar to 'Resize', this should be reset along side it
 		frameCount = 0;
-		activeScene->HasGeometryMoved = true;
+		activeScene->HasMaterialChanged = true;
+	}
+}
+
+void Editor::IntegratorWindow()
+{
+	RayTraceStage* rayTraceStage = application->renderer->GetRayTraceStage();
+	const PipelineSettings& settings = rayTraceStage->GetSettings();
+
+	bool useIterativeIntegrator = settings.useIterativeIntegrator;
+	int minDepth = settings.minDepth;
+	int maxDepth = settings.maxDepth;
+	float targetError = settings.adaptiveTargetError;
+	bool updateSettings = false;
+
+	ImGui::Begin("Integrator");
+
+	if(ImGui::Checkbox("Iterative Integrator", &useIterativeIntegrator)) { updateSettings = true; }
+
+	// The recursive ray trees have a fixed depth //
+	if(useIterativeIntegrator)
+	{
+		if(ImGui::SliderInt("Min Depth", &minDepth, 1, maxDepth)) { updateSettings = true; }
+		if(ImGui::SliderInt("Max Depth", &maxDepth, 1, 32)) { updateSettings = true; }
+	}
+
+	// Matches the order of 'SamplerType' //
+	const char* samplerNames[] = { "Random", "Sobol", "Blue Noise" };
+	int samplerIndex = int(settings.samplerType);
+	if(ImGui::Combo("Sampler", &samplerIndex, samplerNames, IM_ARRAYSIZE(samplerNames)))
+	{
+		rayTraceStage->SetSamplerType(SamplerType(samplerIndex));
+		frameCount = 0;
+	}
+
+	// Converged pixels stop sampling, 0 keeps sampling every pixel //
+	if(ImGui::DragFloat("Adaptive Target Error", &targetError, 0.001f, 0.0f, 1.0f))
+	{
+		rayTraceStage->SetAdaptiveTargetError(targetError);
+	}
+
+	// Only changes what's shown, the accumulated samples stay as they are //
+	DenoiseStage* denoiseStage = application->renderer->GetDenoiseStage();
+	DenoiserSettings denoiserSettings = denoiseStage->GetSettings();
+	bool useDenoiser = denoiseStage->IsEnabled();
+	int iterationCount = denoiserSettings.iterationCount;
+
+	if(ImGui::Checkbox("Denoiser", &useDenoiser)) { denoiseStage->SetEnabled(useDenoiser); }
+
+	if(useDenoiser)
+	{
+		bool updateDenoiser = false;
+		if(ImGui::SliderInt("Denoiser Iterations", &iterationCount, 1, 8)) { updateDenoiser = true; }
+		if(ImGui::DragFloat("Color Phi", &denoiserSettings.colorPhi, 0.05f, 0.1f, 64.0f)) { updateDenoiser = true; }
+		if(ImGui::DragFloat("Normal Phi", &denoiserSettings.normalPhi, 1.0f, 1.0f, 512.0f)) { updateDenoiser = true; }
+		if(ImGui::DragFloat("Depth Phi", &denoiserSettings.depthPhi, 0.001f, 0.001f, 1.0f)) { updateDenoiser = true; }
+
+		if(updateDenoiser)
+		{
+			denoiserSettings.iterationCount = iterationCount;
+			denoiseStage->SetSettings(denoiserSettings);
+		}
+	}
+
+	ImGui::End();
+
+	if(updateSettings)
+	{
+		rayTraceStage->SetIntegratorSettings(useIterativeIntegrator, minDepth, maxDepth);
+		frameCount = 0;
 	}
 }
 
@@ -0,0 +1,1243 @@
+#include "Framework/HeadlessChecks.h"
+#include "Framework/Mathematics.h"
+#include "Graphics/TextureProcessing.h"
+#include "Graphics/TextureCompression.h"
+#include "Graphics/MeshProcessing.h"
+#include "Graphics/Extensions/Shared_TinyglTF.h"
+#include "Utilities/Logger.h"
+#include "Utilities/Random.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <array>
+#include <string>
+#include <vector>
+
+#pragma region Packing
+// Random vertices the packing check encodes, on top of the directions along the axes & diagonals
+static const unsigned int packingVertexCount = 1 << 16;
+
+// Unlike 'acos' of the dot product, it stays precise for nearly parallel directions
+static float AngleBetween(const glm::vec3& a, const glm::vec3& b)
+{
+	return atan2f(glm::length(glm::cross(a, b)), glm::dot(a, b));
+}
+
+unsigned int RunPackingCheck()
+{
+	RandomStream random;
+	std::vector<glm::vec3> directions;
+
+	// Axes & diagonals, they end up on the edges & corners of the octahedral square //
+	for(int x = -1; x <= 1; x++)
+	{
+		for(int y = -1; y <= 1; y++)
+		{
+			for(int z = -1; z <= 1; z++)
+			{
+				if(x != 0 || y != 0 || z != 0)
+				{
+					directions.push_back(glm::normalize(glm::vec3(float(x), float(y), float(z))));
+				}
+			}
+		}
+	}
+
+	// Uniformly distributed over the sphere //
+	while(directions.size() < packingVertexCount)
+	{
+		float z = random.RandomInRange(-1.0f, 1.0f);
+		float phi = random.RandomInRange(0.0f, 2.0f * glm::pi<float>());
+		float radius = sqrtf(std::max(1.0f - z * z, 0.0f));
+		directions.push_back(glm::vec3(radius * cosf(phi), radius * sinf(phi), z));
+	}
+
+	// Bounds that are far from the origin & stretched, the quantization has to follow them //
+	std::vector<Vertex> vertices(directions.size());
+	for(unsigned int i = 0; i < vertices.size(); i++)
+	{
+		Vertex& vertex = vertices[i];
+		vertex.Position = glm::vec3(random.RandomInRange(-250.0f, -150.0f), random.RandomInRange(-0.5f, 0.5f), 
+			random.RandomInRange(10.0f, 12.0f));
+		vertex.Normal = directions[i];
+		vertex.Tangent = glm::vec4(directions[(i * 7919) % directions.size()], i % 2 == 0 ? 1.0f : -1.0f);
+		vertex.TextureCoord0 = glm::vec2(random.RandomInRange(-4.0f, 4.0f), random.Random01() * 1e-3f);
+	}
+
+	PackedVertexQuantization quantization = ComputePackedVertexQuantization(vertices);
+	std::vector<PackedVertex> packedVertices;
+	PackVertices(vertices, quantization, packedVertices);
+
+	// Positions snap to the nearest of 65535 steps across the bounds, so they're off by half a step at most.
+	// Directions pick the closest of the 4 surrounding points on the octahedral grid, which are 1/32767 apart,
+	// even where the mapping stretches the most that keeps them within 0.005 degrees.
+	// UVs are rounded to the nearest half, which has 11 significant bits.
+	const glm::vec3 maxPositionError = quantization.scale * (0.5f / 32767.0f) + glm::vec3(1e-5f);
+	const float maxDirectionError = glm::radians(0.005f);
+	const float maxUVRelativeError = 1.0f / 2048.0f;
+	const float minHalf = 1.0f / 16384.0f;
+
+	glm::vec3 positionError = glm::vec3(0.0f);
+	float directionError = 0.0f;
+	float uvRelativeError = 0.0f;
+	unsigned int failureCount = 0;
+
+	for(unsigned int i = 0; i < vertices.size(); i++)
+	{
+		const Vertex& vertex = vertices[i];
+		Vertex unpacked = UnpackVertex(packedVertices[i], quantization);
+
+		glm::vec3 vertexPositionError = glm::abs(unpacked.Position - vertex.Position);
+		float normalError = AngleBetween(unpacked.Normal, vertex.Normal);
+		float tangentError = AngleBetween(glm::vec3(unpacked.Tangent), glm::vec3(vertex.Tangent));
+
+		// Below the smallest normal half the spacing of the subnormals is fixed instead
+		glm::vec2 uvMagnitude = glm::max(glm::abs(vertex.TextureCoord0), glm::vec2(minHalf));
+		glm::vec2 vertexUVError = glm::abs(unpacked.TextureCoord0 - vertex.TextureCoord0) / uvMagnitude;
+
+		positionError = glm::max(positionError, vertexPositionError);
+		directionError = std::max(directionError, std::max(normalError, tangentError));
+		uvRelativeError = std::max(uvRelativeError, std::max(vertexUVError.x, vertexUVError.y));
+
+		if(glm::any(glm::greaterThan(vertexPositionError, maxPositionError)) || normalError > maxDirectionError || 
+			tangentError > maxDirectionError || vertexUVError.x > maxUVRelativeError || vertexUVError.y > maxUVRelativeError ||
+			unpacked.Tangent.w != vertex.Tangent.w)
+		{
+			failureCount++;
+		}
+	}
+
+	LOG("Packed " + std::to_string(vertices.size()) + " vertices into " + std::to_string(sizeof(PackedVertex)) + " bytes each:");
+	LOG("Position error: " + std::to_string(glm::max(positionError.x / maxPositionError.x, 
+		glm::max(positionError.y / maxPositionError.y, positionError.z / maxPositionError.z))) + " of half a step");
+	LOG("Direction error: " + std::to_string(glm::degrees(directionError)) + " degrees, at most " 
+		+ std::to_string(glm::degrees(maxDirectionError)));
+	LOG("UV error: " + std::to_string(uvRelativeError / maxUVRelativeError) + " of the half precision rounding");
+
+	if(failureCount > 0)
+	{
+		LOG(Log::MessageType::Error, std::to_string(failureCount) + " vertices didn't survive packing within the bounds");
+	}
+
+	return failureCount;
+}
+#pragma endregion
+
+#pragma region Random
+unsigned int RunRandomCheck()
+{
+	unsigned int failureCount = 0;
+
+	// 1) First numbers of 'pcg32_srandom_r(42, 54)', from the reference implementation //
+	const unsigned int reference[] = { 0xa15c02b7, 0x7b47f409, 0xba1d3330, 0x83d2f293, 0xbfa4784b, 0xcbed606e };
+
+	RandomStream random(42, 54);
+	for(unsigned int expected : reference)
+	{
+		unsigned int value = random.NextUInt();
+		if(value != expected)
+		{
+			char message[64];
+			snprintf(message, sizeof(message), "PCG32 returned 0x%08x instead of 0x%08x", value, expected);
+			LOG(Log::MessageType::Error, message);
+			failureCount++;
+		}
+	}
+
+	// 2) Skipping ahead, including 0 & distances that aren't a power of 2 //
+	const uint64_t distances[] = { 0, 1, 2, 3, 7, 64, 1000, 4097, 65535, 1000003 };
+	for(uint64_t distance : distances)
+	{
+		RandomStream stepped(7, distance);
+		RandomStream advanced(7, distance);
+
+		for(uint64_t i = 0; i < distance; i++)
+		{
+			stepped.NextUInt();
+		}
+		advanced.Advance(distance);
+
+		for(unsigned int i = 0; i < 4; i++)
+		{
+			if(stepped.NextUInt() != advanced.NextUInt())
+			{
+				LOG(Log::MessageType::Error, "Advancing by " + std::to_string(distance) + " doesn't match drawing as many numbers");
+				failureCount++;
+				break;
+			}
+		}
+	}
+
+	// 3) Streams with the same seed have to differ //
+	RandomStream first(42, 0);
+	RandomStream second(42, 1);
+	unsigned int equalCount = 0;
+	for(unsigned int i = 0; i < 1024; i++)
+	{
+		equalCount += first.NextUInt() == second.NextUInt() ? 1 : 0;
+	}
+
+	if(equalCount > 4)
+	{
+		LOG(Log::MessageType::Error, "Streams 0 & 1 drew " + std::to_string(equalCount) + " of 1024 equal numbers");
+		failureCount++;
+	}
+
+	LOG("Random: " + std::to_string(failureCount) + " failures");
+	return failureCount;
+}
+#pragma endregion
+
+#pragma region Mips
+static double DecodeSRGB(double value)
+{
+	return value <= 0.04045 ? value / 12.92 : pow((value + 0.055) / 1.055, 2.4);
+}
+
+static double EncodeSRGB(double value)
+{
+	return value <= 0.0031308 ? value * 12.92 : 1.055 * pow(value, 1.0 / 2.4) - 0.055;
+}
+
+// Checks a single image, returns whether all of its levels were within bounds
+static bool CheckMipChain(unsigned int width, unsigned int height, MipGeneration generation, RandomStream& random)
+{
+	std::vector<unsigned char> image(size_t(width) * height * 4);
+	for(unsigned char& value : image)
+	{
+		value = (unsigned char)(random.NextUInt() >> 24);
+	}
+
+	std::vector<unsigned char> mipChain;
+	std::vector<MipLevel> levels;
+	GenerateMipChain(image.data(), width, height, generation, mipChain, levels);
+
+	std::string name = std::to_string(width) + "x" + std::to_string(height) + 
+		(generation == MipGeneration::SRGB ? " sRGB" : generation == MipGeneration::Linear ? " linear" : "");
+
+	// 1) Layout, the first level has to be the image itself //
+	bool isLayoutValid = levels.size() == (generation == MipGeneration::None ? 1 : GetMipLevelCount(width, height)) &&
+		memcmp(mipChain.data(), image.data(), image.size()) == 0;
+
+	for(unsigned int i = 0; i < levels.size(); i++)
+	{
+		isLayoutValid &= levels[i].width == std::max(width >> i, 1u) && levels[i].height == std::max(height >> i, 1u);
+	}
+
+	if(!isLayoutValid)
+	{
+		LOG(Log::MessageType::Error, name + ": wrong mip chain layout");
+		return false;
+	}
+
+	// 2) Every level against a box filter of the previous one, so errors don't add up over the chain //
+	unsigned int maxError = 0;
+	for(unsigned int i = 1; i < levels.size(); i++)
+	{
+		const MipLevel& source = levels[i - 1];
+		const MipLevel& level = levels[i];
+		const unsigned char* sourceData = &mipChain[source.offset];
+		const unsigned char* levelData = &mipChain[level.offset];
+
+		for(unsigned int y = 0; y < level.height; y++)
+		{
+			for(unsigned int x = 0; x < level.width; x++)
+			{
+				unsigned int xs[2] = { x * 2, std::min(x * 2 + 1, source.width - 1) };
+				unsigned int ys[2] = { y * 2, std::min(y * 2 + 1, source.height - 1) };
+
+				for(unsigned int c = 0; c < 4; c++)
+				{
+					bool isSRGB = generation == MipGeneration::SRGB && c < 3;
+
+					double sum = 0.0;
+					for(unsigned int j = 0; j < 4; j++)
+					{
+						double value = sourceData[(size_t(ys[j / 2]) * source.width + xs[j % 2]) * 4 + c] / 255.0;
+						sum += isSRGB ? DecodeSRGB(value) : value;
+					}
+
+					double average = sum * 0.25;
+					int expected = int((isSRGB ? EncodeSRGB(average) : average) * 255.0 + 0.5);
+					int actual = levelData[(size_t(y) * level.width + x) * 4 + c];
+					maxError = std::max(maxError, (unsigned int)abs(actual - expected));
+				}
+			}
+		}
+	}
+
+	if(maxError > 1)
+	{
+		LOG(Log::MessageType::Error, name + ": mips are up to " + std::to_string(maxError) + " LSB off");
+		return false;
+	}
+
+	return true;
+}
+
+unsigned int RunMipCheck()
+{
+	const unsigned int sizes[][2] = { { 256, 256 }, { 512, 128 }, { 45, 17 }, { 3, 3 }, { 1, 37 }, { 37, 1 }, { 1, 1 } };
+	const MipGeneration generations[] = { MipGeneration::None, MipGeneration::SRGB, MipGeneration::Linear };
+
+	RandomStream random(12);
+	unsigned int failureCount = 0;
+	unsigned int caseCount = 0;
+
+	for(const unsigned int* size : sizes)
+	{
+		for(MipGeneration generation : generations)
+		{
+			failureCount += CheckMipChain(size[0], size[1], generation, random) ? 0 : 1;
+			caseCount++;
+		}
+	}
+
+	LOG("Mips: " + std::to_string(failureCount) + "/" + std::to_string(caseCount) + " images out of bounds");
+	return failureCount;
+}
+#pragma endregion
+
+#pragma region HDR
+// Nearest half, ties to even, written against the format instead of the bit tricks in 'TextureProcessing.cpp'
+static uint16_t ReferenceHalf(float value)
+{
+	if(value != value)
+	{
+		return 0;
+	}
+
+	double clamped = std::min(std::max(double(value), -65504.0), 65504.0);
+	uint16_t sign = std::signbit(clamped) ? 0x8000 : 0;
+	double magnitude = fabs(clamped);
+
+	// Denormals are multiples of 2^-24, normals have 10 mantissa bits below the leading one //
+	if(magnitude < ldexp(1.0, -14))
+	{
+		return uint16_t(sign | uint16_t(nearbyint(ldexp(magnitude, 24))));
+	}
+
+	int exponent;
+	frexp(magnitude, &exponent);
+	exponent -= 1;
+
+	double mantissa = nearbyint(ldexp(magnitude, 10 - exponent));
+	if(mantissa == 2048.0)
+	{
+		mantissa = 1024.0;
+		exponent++;
+	}
+
+	return uint16_t(sign | ((exponent + 15) << 10) | (uint16_t(mantissa) - 1024));
+}
+
+// Shared exponent encoding as the D3D spec describes it, with the exponent from log2 of the largest channel
+static uint32_t ReferenceRGB9E5(const float* pixel)
+{
+	double rgb[3];
+	for(int c = 0; c < 3; c++)
+	{
+		rgb[c] = pixel[c] > 0.0f ? std::min(double(pixel[c]), 65408.0) : 0.0;
+	}
+
+	double maxChannel = std::max(std::max(rgb[0], rgb[1]), rgb[2]);
+	int exponent = std::max(-16, maxChannel > 0.0 ? int(floor(log2(maxChannel))) : -16) + 1 + 15;
+
+	double step = ldexp(1.0, exponent - 15 - 9);
+	if(floor(maxChannel / step + 0.5) == 512.0)
+	{
+		step *= 2.0;
+		exponent++;
+	}
+
+	uint32_t packed = uint32_t(exponent) << 27;
+	for(int c = 0; c < 3; c++)
+	{
+		packed |= uint32_t(floor(rgb[c] / step + 0.5)) << (9 * c);
+	}
+
+	return packed;
+}
+
+unsigned int RunHDRCheck()
+{
+	unsigned int failureCount = 0;
+	RandomStream random(17);
+
+	// 1) Values over the whole range of both formats, plus the edge cases & ties. 1023 pixels,
+	// so the conversion also runs its scalar tail //
+	std::vector<float> pixels;
+	const float specialValues[] = { 0.0f, -0.0f, 1.0f, -1.0f, 65504.0f, 65519.0f, 65520.0f, 1e9f, -1e9f, 6.1035156e-5f, 
+		5.9604645e-8f, 2.9802322e-8f, 8.9406967e-8f, 1.00048828f, 1.00146484f, 1e-30f, 65408.0f, 65535.0f, std::numeric_limits<float>::infinity(), 
+		-std::numeric_limits<float>::infinity(), std::numeric_limits<float>::quiet_NaN() };
+
+	for(float value : specialValues)
+	{
+		pixels.insert(pixels.end(), { value, value, value, value });
+		pixels.insert(pixels.end(), { value, 0.5f, 0.25f, 1.0f });
+	}
+
+	while(pixels.size() < 1023 * 4)
+	{
+		// Random sign & mantissa, with an exponent between 2^-30 & 2^20 //
+		float value = ldexpf(random.RandomInRange(1.0f, 2.0f), int(random.NextUInt() % 51) - 30);
+
+		// Every fourth value lies exactly halfway between two halfs, which have 13 fewer mantissa bits //
+		if(random.NextUInt() % 4 == 0)
+		{
+			uint32_t bits;
+			memcpy(&bits, &value, sizeof(float));
+			bits = (bits & ~0x1FFFu) | 0x1000u;
+			memcpy(&value, &bits, sizeof(float));
+		}
+
+		pixels.push_back(random.NextUInt() & 1 ? -value : value);
+	}
+
+	const size_t pixelCount = pixels.size() / 4;
+
+	std::vector<uint16_t> halfs(pixelCount * 4);
+	ConvertHDRPixels(pixels.data(), pixelCount, HDRFormat::RGBA16F, halfs.data());
+
+	unsigned int halfMismatches = 0;
+	for(size_t i = 0; i < pixels.size(); i++)
+	{
+		if(halfs[i] != ReferenceHalf(pixels[i]))
+		{
+			if(halfMismatches++ == 0)
+			{
+				char message[96];
+				snprintf(message, sizeof(message), "RGBA16F: %g became 0x%04x instead of 0x%04x", pixels[i], halfs[i], ReferenceHalf(pixels[i]));
+				LOG(Log::MessageType::Error, message);
+			}
+		}
+	}
+
+	std::vector<uint32_t> packed(pixelCount);
+	ConvertHDRPixels(pixels.data(), pixelCount, HDRFormat::RGB9E5, packed.data());
+
+	unsigned int sharedExponentMismatches = 0;
+	for(size_t i = 0; i < pixelCount; i++)
+	{
+		uint32_t expected = ReferenceRGB9E5(&pixels[i * 4]);
+		if(packed[i] != expected)
+		{
+			if(sharedExponentMismatches++ == 0)
+			{
+				char message[128];
+				snprintf(message, sizeof(message), "RGB9E5: (%g, %g, %g) became 0x%08x instead of 0x%08x",
+					pixels[i * 4], pixels[i * 4 + 1], pixels[i * 4 + 2], packed[i], expected);
+				LOG(Log::MessageType::Error, message);
+			}
+		}
+	}
+
+	failureCount += halfMismatches > 0 ? 1 : 0;
+	failureCount += sharedExponentMismatches > 0 ? 1 : 0;
+	LOG("HDR: " + std::to_string(halfMismatches) + " RGBA16F & " + std::to_string(sharedExponentMismatches) + 
+		" RGB9E5 mismatches in " + std::to_string(pixelCount) + " pixels");
+
+	// 2) Prefiltered levels of an odd sized image //
+	const unsigned int width = 37;
+	const unsigned int height = 20;
+	std::vector<float> image(width * height * 4);
+	for(float& value : image)
+	{
+		value = random.RandomInRange(0.0f, 100.0f);
+	}
+
+	std::vector<float> mipChain;
+	std::vector<MipLevel> levels;
+	GenerateHDRMipChain(image.data(), width, height, 4, mipChain, levels);
+
+	double maxError = 0.0;
+	for(unsigned int i = 1; i < levels.size(); i++)
+	{
+		const MipLevel& source = levels[i - 1];
+		const MipLevel& level = levels[i];
+		const float* sourceData = &mipChain[source.offset / sizeof(float)];
+		const float* levelData = &mipChain[level.offset / sizeof(float)];
+
+		for(unsigned int y = 0; y < level.height; y++)
+		{
+			for(unsigned int x = 0; x < level.width; x++)
+			{
+				unsigned int xs[2] = { x * 2, std::min(x * 2 + 1, source.width - 1) };
+				unsigned int ys[2] = { y * 2, std::min(y * 2 + 1, source.height - 1) };
+
+				for(unsigned int c = 0; c < 4; c++)
+				{
+					double sum = 0.0;
+					for(unsigned int j = 0; j < 4; j++)
+					{
+						sum += sourceData[(size_t(ys[j / 2]) * source.width + xs[j % 2]) * 4 + c];
+					}
+
+					double expected = sum * 0.25;
+					double actual = levelData[(size_t(y) * level.width + x) * 4 + c];
+					maxError = std::max(maxError, fabs(actual - expected) / std::max(expected, 1e-6));
+				}
+			}
+		}
+	}
+
+	if(levels.size() != 4 || maxError > 1e-6)
+	{
+		LOG(Log::MessageType::Error, "HDR mips: " + std::to_string(levels.size()) + " levels, up to " + 
+			std::to_string(maxError) + " relative error");
+		failureCount++;
+	}
+
+	return failureCount;
+}
+#pragma endregion
+
+#pragma region Mesh
+// Position, normal & UV of the corners, rotated so the smallest corner comes first, which keeps the winding
+static std::array<float, 24> GetTriangleKey(const std::vector<Vertex>& vertices, const unsigned int* indices)
+{
+	std::array<float, 8> corners[3];
+	for(unsigned int i = 0; i < 3; i++)
+	{
+		const Vertex& vertex = vertices[indices[i]];
+		corners[i] = { vertex.Position.x, vertex.Position.y, vertex.Position.z, vertex.Normal.x, 
+			vertex.Normal.y, vertex.Normal.z, vertex.TextureCoord0.x, vertex.TextureCoord0.y };
+	}
+
+	unsigned int first = 0;
+	for(unsigned int i = 1; i < 3; i++)
+	{
+		first = corners[i] < corners[first] ? i : first;
+	}
+
+	std::array<float, 24> key;
+	for(unsigned int i = 0; i < 3; i++)
+	{
+		std::copy(corners[(first + i) % 3].begin(), corners[(first + i) % 3].end(), key.begin() + i * 8);
+	}
+
+	return key;
+}
+
+static std::vector<std::array<float, 24>> GetTriangleKeys(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices)
+{
+	std::vector<std::array<float, 24>> keys;
+	for(size_t i = 0; i + 2 < indices.size(); i += 3)
+	{
+		keys.push_back(GetTriangleKey(vertices, &indices[i]));
+	}
+
+	std::sort(keys.begin(), keys.end());
+	return keys;
+}
+
+unsigned int RunMeshCheck()
+{
+	// 1) A grid in which every triangle has its own vertices, in a random order //
+	const unsigned int gridSize = 64;
+	std::vector<Vertex> vertices;
+	std::vector<unsigned int> indices;
+
+	for(unsigned int y = 0; y < gridSize; y++)
+	{
+		for(unsigned int x = 0; x < gridSize; x++)
+		{
+			const unsigned int corners[6][2] = { { x, y }, { x + 1, y }, { x + 1, y + 1 }, { x, y }, { x + 1, y + 1 }, { x, y + 1 } };
+			for(const unsigned int* corner : corners)
+			{
+				Vertex vertex = {};
+				vertex.Position = glm::vec3(float(corner[0]), float(corner[1]), float((corner[0] * corner[1]) % 3));
+				vertex.Normal = glm::vec3(0.0f, 0.0f, 1.0f);
+				vertex.TextureCoord0 = glm::vec2(corner[0], corner[1]) / float(gridSize);
+
+				indices.push_back(vertices.size());
+				vertices.push_back(vertex);
+			}
+		}
+	}
+
+	RandomStream random(10);
+	const unsigned int triangleCount = indices.size() / 3;
+	for(unsigned int i = triangleCount - 1; i > 0; i--)
+	{
+		unsigned int j = random.NextUInt() % (i + 1);
+		std::swap_ranges(&indices[i * 3], &indices[i * 3 + 3], &indices[j * 3]);
+	}
+
+	std::vector<std::array<float, 24>> trianglesBefore = GetTriangleKeys(vertices, indices);
+	MeshOptimizationStats stats = OptimizeMesh(vertices, indices);
+	unsigned int failureCount = 0;
+
+	// 2) The same triangles, facing the same way //
+	if(indices.size() != triangleCount * 3 || GetTriangleKeys(vertices, indices) != trianglesBefore)
+	{
+		LOG(Log::MessageType::Error, "Optimizing the mesh changed its triangles");
+		failureCount++;
+	}
+
+	// 3) Only the unique corners are left, every one of them in the order they're first used //
+	unsigned int uniqueCount = (gridSize + 1) * (gridSize + 1);
+	unsigned int nextVertex = 0;
+	bool isFetchOrdered = true;
+	for(unsigned int index : indices)
+	{
+		isFetchOrdered &= index <= nextVertex;
+		nextVertex = std::max(nextVertex, index + 1);
+	}
+
+	if(vertices.size() != uniqueCount || nextVertex != uniqueCount || !isFetchOrdered)
+	{
+		LOG(Log::MessageType::Error, "Expected " + std::to_string(uniqueCount) + " vertices in order of first use, got " + 
+			std::to_string(vertices.size()) + (isFetchOrdered ? "" : " out of order"));
+		failureCount++;
+	}
+
+	// 4) A shuffled grid misses the cache on nearly every vertex, a good order gets close to 0.5 //
+	if(stats.GetACMRAfter() > stats.GetACMRBefore() || stats.GetACMRAfter() > 0.8f)
+	{
+		LOG(Log::MessageType::Error, "The ACMR went from " + std::to_string(stats.GetACMRBefore()) + " to " + std::to_string(stats.GetACMRAfter()));
+		failureCount++;
+	}
+
+	LOG("Mesh: " + std::to_string(stats.vertexCountBefore) + " -> " + std::to_string(stats.vertexCountAfter) + " vertices, ACMR " +
+		std::to_string(stats.GetACMRBefore()) + " -> " + std::to_string(stats.GetACMRAfter()) + ", " + std::to_string(failureCount) + " failures");
+	return failureCount;
+}
+#pragma endregion
+
+#pragma region Tangents
+// Worst angle between a generated tangent & dP/du, in degrees. Returns -1 when a bitangent sign is wrong
+static float CheckSphereTangents(unsigned int segmentCount, unsigned int ringCount, bool isMirrored, unsigned int& failureCount)
+{
+	std::vector<Vertex> vertices;
+	std::vector<unsigned int> indices;
+
+	// Seam & poles get their own vertices, like most exported UV spheres //
+	for(unsigned int ring = 0; ring <= ringCount; ring++)
+	{
+		for(unsigned int segment = 0; segment <= segmentCount; segment++)
+		{
+			float u = float(segment) / segmentCount;
+			float v = float(ring) / ringCount;
+			float theta = float(PI) * v;
+			float phi = 2.0f * float(PI) * u;
+
+			Vertex vertex = {};
+			vertex.Position = glm::vec3(sinf(theta) * cosf(phi), cosf(theta), sinf(theta) * sinf(phi));
+			vertex.Normal = vertex.Position;
+			vertex.TextureCoord0 = glm::vec2(isMirrored ? 1.0f - u : u, v);
+			vertices.push_back(vertex);
+		}
+	}
+
+	for(unsigned int ring = 0; ring < ringCount; ring++)
+	{
+		for(unsigned int segment = 0; segment < segmentCount; segment++)
+		{
+			unsigned int a = ring * (segmentCount + 1) + segment;
+			unsigned int b = a + 1;
+			unsigned int c = a + segmentCount + 2;
+			unsigned int d = a + segmentCount + 1;
+
+			// Wound so the faces point outwards, like the normals //
+			indices.insert(indices.end(), { a, b, c, a, c, d });
+		}
+	}
+
+	std::vector<Vertex> repeated = vertices;
+	GenerateTangents(vertices, indices);
+	GenerateTangents(repeated, indices);
+
+	if(memcmp(vertices.data(), repeated.data(), vertices.size() * sizeof(Vertex)) != 0)
+	{
+		LOG(Log::MessageType::Error, "Generating the tangents twice gave different results");
+		failureCount++;
+	}
+
+	// The poles have no well defined dP/du //
+	float maxAngle = 0.0f;
+	for(unsigned int ring = 1; ring < ringCount; ring++)
+	{
+		for(unsigned int segment = 0; segment <= segmentCount; segment++)
+		{
+			const Vertex& vertex = vertices[ring * (segmentCount + 1) + segment];
+			float theta = float(PI) * ring / ringCount;
+			float phi = 2.0f * float(PI) * segment / segmentCount;
+
+			glm::vec3 expectedTangent = glm::vec3(-sinf(phi), 0.0f, cosf(phi)) * (isMirrored ? -1.0f : 1.0f);
+			glm::vec3 expectedBitangent = glm::vec3(cosf(theta) * cosf(phi), -sinf(theta), cosf(theta) * sinf(phi));
+
+			glm::vec3 tangent = glm::vec3(vertex.Tangent);
+			glm::vec3 bitangent = glm::cross(vertex.Normal, tangent) * vertex.Tangent.w;
+
+			if(fabsf(glm::length(tangent) - 1.0f) > 1e-4f || fabsf(glm::dot(tangent, vertex.Normal)) > 1e-4f || 
+				glm::dot(bitangent, expectedBitangent) <= 0.0f)
+			{
+				return -1.0f;
+			}
+
+			float angle = atan2f(glm::length(glm::cross(tangent, expectedTangent)), glm::dot(tangent, expectedTangent));
+			maxAngle = std::max(maxAngle, angle * 180.0f / float(PI));
+		}
+	}
+
+	return maxAngle;
+}
+
+unsigned int RunTangentCheck()
+{
+	// Face tangents follow the chords of the sphere. Next to the poles a vertex only has triangles on one side
+	// of it, which puts it off by up to half a segment, a bit more is allowed for the slant of the triangles //
+	const unsigned int sizes[][2] = { { 32, 16 }, { 128, 64 } };
+	unsigned int failureCount = 0;
+
+	for(const unsigned int* size : sizes)
+	{
+		for(unsigned int mirrored = 0; mirrored < 2; mirrored++)
+		{
+			float maxAngle = CheckSphereTangents(size[0], size[1], mirrored == 1, failureCount);
+			float allowedAngle = 0.6f * 360.0f / size[0];
+
+			std::string name = std::to_string(size[0]) + "x" + std::to_string(size[1]) + (mirrored ? " mirrored" : "") + " sphere";
+			if(maxAngle < 0.0f || maxAngle > allowedAngle)
+			{
+				LOG(Log::MessageType::Error, name + (maxAngle < 0.0f ? ": invalid tangent frame" : 
+					": tangents up to " + std::to_string(maxAngle) + " degrees off"));
+				failureCount++;
+			}
+			else
+			{
+				LOG(name + ": tangents up to " + std::to_string(maxAngle) + " degrees off");
+			}
+		}
+	}
+
+	// Tangents that came with the mesh are left alone //
+	std::vector<Vertex> vertices(3);
+	vertices[0].Tangent = glm::vec4(0.0f, 0.0f, 1.0f, -1.0f);
+	vertices[1].Position = glm::vec3(1.0f, 0.0f, 0.0f);
+	vertices[2].Position = glm::vec3(0.0f, 1.0f, 0.0f);
+	vertices[1].TextureCoord0 = glm::vec2(1.0f, 0.0f);
+	GenerateTangents(vertices, { 0, 1, 2 });
+
+	if(vertices[0].Tangent != glm::vec4(0.0f, 0.0f, 1.0f, -1.0f))
+	{
+		LOG(Log::MessageType::Error, "The tangents of the mesh got overwritten");
+		failureCount++;
+	}
+
+	LOG("Tangents: " + std::to_string(failureCount) + " failures");
+	return failureCount;
+}
+#pragma endregion
+
+#pragma region Compression
+static int RoundToByte(float value)
+{
+	return std::min(std::max(int(value + 0.5f), 0), 255);
+}
+
+static void ReferenceDecodeBC1(const unsigned char* block, int pixels[16][4])
+{
+	unsigned int c0 = block[0] | (block[1] << 8);
+	unsigned int c1 = block[2] | (block[3] << 8);
+
+	float palette[4][4];
+	const unsigned int colors[2] = { c0, c1 };
+	// Endpoints get expanded to 8 bits by repeating their highest bits, like GPUs do //
+	for(int i = 0; i < 2; i++)
+	{
+		unsigned int r = (colors[i] >> 11) & 31;
+		unsigned int g = (colors[i] >> 5) & 63;
+		unsigned int b = colors[i] & 31;
+
+		palette[i][0] = float((r << 3) | (r >> 2));
+		palette[i][1] = float((g << 2) | (g >> 4));
+		palette[i][2] = float((b << 3) | (b >> 2));
+		palette[i][3] = 255.0f;
+	}
+
+	for(int c = 0; c < 4; c++)
+	{
+		palette[2][c] = c0 > c1 ? (2.0f * palette[0][c] + palette[1][c]) / 3.0f : (palette[0][c] + palette[1][c]) / 2.0f;
+		palette[3][c] = c0 > c1 ? (palette[0][c] + 2.0f * palette[1][c]) / 3.0f : 0.0f;
+	}
+
+	for(int i = 0; i < 16; i++)
+	{
+		int index = (block[4 + i / 4] >> ((i % 4) * 2)) & 3;
+		for(int c = 0; c < 4; c++)
+		{
+			pixels[i][c] = RoundToByte(palette[index][c]);
+		}
+	}
+}
+
+static void ReferenceDecodeBC4(const unsigned char* block, int channel, int pixels[16][4])
+{
+	float r0 = block[0];
+	float r1 = block[1];
+
+	float palette[8] = { r0, r1 };
+	for(int i = 2; i < 8; i++)
+	{
+		palette[i] = r0 > r1 ? ((8 - i) * r0 + (i - 1) * r1) / 7.0f : i < 6 ? ((6 - i) * r0 + (i - 1) * r1) / 5.0f : (i == 6 ? 0.0f : 255.0f);
+	}
+
+	for(int i = 0; i < 16; i++)
+	{
+		int bit = 16 + i * 3;
+		int index = ((block[bit / 8] | (block[bit / 8 + 1] << 8)) >> (bit % 8)) & 7;
+		pixels[i][channel] = RoundToByte(palette[index]);
+	}
+}
+
+// Fields of a BC7 block get stored from the lowest bit up
+static unsigned int ReadBits(const unsigned char* block, int& bit, int count)
+{
+	unsigned int value = 0;
+	for(int i = 0; i < count; i++, bit++)
+	{
+		value |= ((block[bit / 8] >> (bit % 8)) & 1u) << i;
+	}
+
+	return value;
+}
+
+// Only mode 6, returns false for any other mode
+static bool ReferenceDecodeBC7(const unsigned char* block, int pixels[16][4])
+{
+	int bit = 0;
+	if(ReadBits(block, bit, 7) != 64)
+	{
+		return false;
+	}
+
+	int endpoints[2][4];
+	for(int c = 0; c < 4; c++)
+	{
+		endpoints[0][c] = ReadBits(block, bit, 7) << 1;
+		endpoints[1][c] = ReadBits(block, bit, 7) << 1;
+	}
+
+	int pBits[2];
+	pBits[0] = ReadBits(block, bit, 1);
+	pBits[1] = ReadBits(block, bit, 1);
+
+	const int weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+	for(int i = 0; i < 16; i++)
+	{
+		int weight = weights[ReadBits(block, bit, i == 0 ? 3 : 4)];
+		for(int c = 0; c < 4; c++)
+		{
+			int e0 = endpoints[0][c] | pBits[0];
+			int e1 = endpoints[1][c] | pBits[1];
+			pixels[i][c] = ((64 - weight) * e0 + weight * e1 + 32) >> 6;
+		}
+	}
+
+	return true;
+}
+
+unsigned int RunCompressionCheck()
+{
+	// 1) Smooth gradients with some noise, not a multiple of 4 so the edges get partial blocks //
+	const unsigned int width = 70;
+	const unsigned int height = 37;
+	RandomStream random(13);
+
+	std::vector<unsigned char> image(width * height * 4);
+	for(unsigned int y = 0; y < height; y++)
+	{
+		for(unsigned int x = 0; x < width; x++)
+		{
+			float gradients[4] = { x * 255.0f / width, y * 255.0f / height, (x + y) * 127.0f / (width + height), 
+				255.0f - x * 64.0f / width };
+
+			for(int c = 0; c < 4; c++)
+			{
+				image[(y * width + x) * 4 + c] = (unsigned char)RoundToByte(gradients[c] + random.RandomInRange(-2.0f, 2.0f));
+			}
+		}
+	}
+
+	std::vector<unsigned char> mipChain;
+	std::vector<MipLevel> mipLevels;
+	GenerateMipChain(image.data(), width, height, MipGeneration::Linear, mipChain, mipLevels);
+
+	// Floors are a few dB below what the encoders reach, BC1 has the fewest bits //
+	const TextureCompression compressions[] = { TextureCompression::BC1, TextureCompression::BC5, TextureCompression::BC7 };
+	const float minPSNR[] = { 35.0f, 48.0f, 38.0f };
+	const int channelCounts[] = { 3, 2, 4 };
+	unsigned int failureCount = 0;
+
+	for(unsigned int f = 0; f < 3; f++)
+	{
+		TextureCompression compression = compressions[f];
+		const char* name = GetCompressionName(compression);
+
+		std::vector<unsigned char> compressedData;
+		std::vector<MipLevel> compressedLevels;
+		CompressMipChain(mipChain.data(), mipLevels, compression, compressedData, compressedLevels);
+
+		std::vector<unsigned char> decompressed;
+		std::vector<MipLevel> decompressedLevels;
+		DecompressMipChain(compressedData.data(), compressedLevels, compression, decompressed, decompressedLevels);
+
+		if(compressedLevels.size() != mipLevels.size() || decompressed.size() != mipChain.size())
+		{
+			LOG(Log::MessageType::Error, std::string(name) + ": the compressed chain has the wrong layout");
+			failureCount++;
+			continue;
+		}
+
+		// 2) Every block through the reference decoder, against both the original & 'DecompressMipChain' //
+		unsigned int maxDifference = 0;
+		bool isModeValid = true;
+		double squaredError = 0.0;
+		const size_t blockSize = compression == TextureCompression::BC1 ? 8 : 16;
+
+		for(unsigned int l = 0; l < mipLevels.size(); l++)
+		{
+			const MipLevel& level = mipLevels[l];
+			const unsigned int blockCountX = (level.width + 3) / 4;
+			const unsigned int blockCountY = (level.height + 3) / 4;
+
+			if(compressedLevels[l].width != level.width || compressedLevels[l].height != level.height ||
+				(l + 1 < mipLevels.size() && compressedLevels[l + 1].offset - compressedLevels[l].offset != blockCountX * blockCountY * blockSize))
+			{
+				LOG(Log::MessageType::Error, std::string(name) + ": level " + std::to_string(l) + " has the wrong size");
+				failureCount++;
+			}
+
+			for(unsigned int blockY = 0; blockY < blockCountY; blockY++)
+			{
+				for(unsigned int blockX = 0; blockX < blockCountX; blockX++)
+				{
+					const unsigned char* block = &compressedData[compressedLevels[l].offset + (blockY * blockCountX + blockX) * blockSize];
+					int pixels[16][4];
+
+					if(compression == TextureCompression::BC1)
+					{
+						ReferenceDecodeBC1(block, pixels);
+					}
+					else if(compression == TextureCompression::BC5)
+					{
+						ReferenceDecodeBC4(block, 0, pixels);
+						ReferenceDecodeBC4(block + 8, 1, pixels);
+						for(int i = 0; i < 16; i++)
+						{
+							pixels[i][2] = 0;
+							pixels[i][3] = 255;
+						}
+					}
+					else
+					{
+						isModeValid &= ReferenceDecodeBC7(block, pixels);
+					}
+
+					for(unsigned int i = 0; i < 16; i++)
+					{
+						unsigned int x = blockX * 4 + i % 4;
+						unsigned int y = blockY * 4 + i / 4;
+						if(x >= level.width || y >= level.height)
+						{
+							continue;
+						}
+
+						size_t index = level.offset + (size_t(y) * level.width + x) * 4;
+						for(int c = 0; c < 4; c++)
+						{
+							maxDifference = std::max(maxDifference, (unsigned int)abs(pixels[i][c] - decompressed[index + c]));
+
+							if(l == 0 && c < channelCounts[f])
+							{
+								double error = double(pixels[i][c]) - mipChain[index + c];
+								squaredError += error * error;
+							}
+						}
+					}
+				}
+			}
+		}
+
+		double meanSquaredError = squaredError / (double(width) * height * channelCounts[f]);
+		float psnr = float(10.0 * log10(255.0 * 255.0 / std::max(meanSquaredError, 1e-10)));
+
+		bool isValid = isModeValid && maxDifference == 0 && psnr >= minPSNR[f];
+		failureCount += isValid ? 0 : 1;
+
+		LOG(isValid ? Log::MessageType::Default : Log::MessageType::Error, std::string(name) + ": " + std::to_string(psnr) + 
+			"dB (at least " + std::to_string(minPSNR[f]) + "dB), decoders differ by up to " + std::to_string(maxDifference) + 
+			(isModeValid ? "" : ", not every BC7 block uses mode 6"));
+	}
+
+	return failureCount;
+}
+#pragma endregion
+
+#pragma region glTF
+// One component read the way the glTF spec describes it, normalized integers map to [0, 1] or [-1, 1]
+static float ReferenceGLTFComponent(const unsigned char* data, int componentType, bool normalized)
+{
+	switch(componentType)
+	{
+	case TINYGLTF_COMPONENT_TYPE_FLOAT:
+	{
+		float value;
+		memcpy(&value, data, sizeof(value));
+		return value;
+	}
+
+	case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+	{
+		uint8_t value = data[0];
+		return normalized ? value / 255.0f : float(value);
+	}
+
+	case TINYGLTF_COMPONENT_TYPE_BYTE:
+	{
+		int8_t value;
+		memcpy(&value, data, sizeof(value));
+		return normalized ? std::max(value / 127.0f, -1.0f) : float(value);
+	}
+
+	case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+	{
+		uint16_t value;
+		memcpy(&value, data, sizeof(value));
+		return normalized ? value / 65535.0f : float(value);
+	}
+
+	case TINYGLTF_COMPONENT_TYPE_SHORT:
+	{
+		int16_t value;
+		memcpy(&value, data, sizeof(value));
+		return normalized ? std::max(value / 32767.0f, -1.0f) : float(value);
+	}
+	}
+
+	return 0.0f;
+}
+
+// Adds a buffer view & accessor over 'count' random elements to the model, returns the accessor
+static int AddTestAccessor(tinygltf::Model& model, int componentType, int type, bool normalized, 
+	size_t count, size_t padding, RandomStream& random)
+{
+	const size_t componentSize = tinygltf::GetComponentSizeInBytes(componentType);
+	const size_t elementSize = componentSize * tinygltf::GetNumComponentsInType(type);
+	const size_t stride = elementSize + padding;
+
+	// Offsets in both the view & accessor, so neither gets ignored
+	tinygltf::BufferView view;
+	view.buffer = 0;
+	view.byteOffset = model.buffers[0].data.size() + 4;
+	view.byteLength = componentSize + count * stride;
+	view.byteStride = padding > 0 ? stride : 0;
+
+	// Whole words of random bits for integers, floats stay finite so they can be compared. A quarter of the words
+	// hold the most negative 8 & 16-bit values, which normalized signed components have to clamp to -1
+	std::vector<unsigned char>& data = model.buffers[0].data;
+	data.resize((view.byteOffset + view.byteLength + 3) & ~size_t(3));
+
+	for(size_t i = view.byteOffset; i < data.size(); i += 4)
+	{
+		unsigned int bits = random.NextUInt();
+		if(bits % 4 == 0)
+		{
+			bits = 0x80008000;
+		}
+
+		if(componentType == TINYGLTF_COMPONENT_TYPE_FLOAT)
+		{
+			float value = random.RandomInRange(-100.0f, 100.0f);
+			memcpy(&bits, &value, sizeof(bits));
+		}
+
+		memcpy(&data[i], &bits, sizeof(bits));
+	}
+
+	tinygltf::Accessor accessor;
+	accessor.bufferView = int(model.bufferViews.size());
+	accessor.byteOffset = componentSize;
+	accessor.componentType = componentType;
+	accessor.type = type;
+	accessor.normalized = normalized;
+	accessor.count = count;
+
+	model.bufferViews.push_back(view);
+	model.accessors.push_back(accessor);
+	return int(model.accessors.size() - 1);
+}
+
+// Compares a decoded attribute against the reference, one component at a time, returns the amount of mismatches
+static unsigned int CompareGLTFAttribute(const std::vector<Vertex>& vertices, size_t destinationOffset, 
+	const tinygltf::Model& model, int accessorIndex)
+{
+	const tinygltf::Accessor& accessor = model.accessors[accessorIndex];
+	const tinygltf::BufferView& view = model.bufferViews[accessor.bufferView];
+	const unsigned char* source = model.buffers[0].data.data() + view.byteOffset + accessor.byteOffset;
+
+	const size_t stride = accessor.ByteStride(view);
+	const size_t componentSize = tinygltf::GetComponentSizeInBytes(accessor.componentType);
+	const int componentCount = tinygltf::GetNumComponentsInType(accessor.type);
+	unsigned int mismatchCount = 0;
+
+	if(vertices.size() != accessor.count)
+	{
+		return (unsigned int)accessor.count;
+	}
+
+	for(size_t i = 0; i < accessor.count; i++)
+	{
+		const float* decoded = reinterpret_cast<const float*>(reinterpret_cast<const unsigned char*>(&vertices[i]) + destinationOffset);
+		for(int c = 0; c < componentCount; c++)
+		{
+			float expected = ReferenceGLTFComponent(source + i * stride + c * componentSize, accessor.componentType, accessor.normalized);
+
+			// Decoders may multiply by the reciprocal instead of dividing, that's within an ulp
+			if(fabsf(decoded[c] - expected) > 1e-6f * std::max(1.0f, fabsf(expected)))
+			{
+				mismatchCount++;
+			}
+		}
+	}
+
+	return mismatchCount;
+}
+
+unsigned int RunGLTFCheck()
+{
+	const char* attributeTypes[] = { "POSITION", "NORMAL", "TANGENT", "TEXCOORD_0" };
+	const int attributeTypeSizes[] = { TINYGLTF_TYPE_VEC3, TINYGLTF_TYPE_VEC3, TINYGLTF_TYPE_VEC4, TINYGLTF_TYPE_VEC2 };
+	const size_t attributeOffsets[] = { offsetof(Vertex, Position), offsetof(Vertex, Normal), offsetof(Vertex, Tangent), 
+		offsetof(Vertex, TextureCoord0) };
+
+	const int componentTypes[] = { TINYGLTF_COMPONENT_TYPE_FLOAT, TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE, TINYGLTF_COMPONENT_TYPE_BYTE,
+		TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT, TINYGLTF_COMPONENT_TYPE_SHORT };
+	const char* componentNames[] = { "float", "uint8", "int8", "uint16", "int16" };
+
+	// More than one block of 'glTFLoadVertices', and not a multiple of it
+	const size_t vertexCount = 2 * 2048 + 37;
+	RandomStream random(8);
+	unsigned int failureCount = 0;
+
+	// 1) Every component type, (un)normalized, packed & interleaved with padding //
+	for(unsigned int t = 0; t < 5; t++)
+	{
+		for(int normalized = 0; normalized < 2; normalized++)
+		{
+			if(normalized && componentTypes[t] == TINYGLTF_COMPONENT_TYPE_FLOAT)
+			{
+				continue;
+			}
+
+			for(size_t padding : { size_t(0), size_t(4) })
+			{
+				glTFFile file;
+				tinygltf::Model& model = file.model;
+				model.buffers.resize(1);
+
+				tinygltf::Primitive primitive;
+				for(unsigned int a = 0; a < 4; a++)
+				{
+					primitive.attributes[attributeTypes[a]] = AddTestAccessor(model, componentTypes[t], attributeTypeSizes[a], 
+						normalized != 0, vertexCount, padding, random);
+				}
+
+				std::vector<Vertex> vertices;
+				glTFLoadVertices(vertices, file, primitive);
+
+				unsigned int mismatchCount = 0;
+				for(unsigned int a = 0; a < 4; a++)
+				{
+					std::vector<Vertex> attributeVertices;
+					glTFLoadVertexAttribute(attributeVertices, attributeTypes[a], file, primitive);
+
+					mismatchCount += CompareGLTFAttribute(vertices, attributeOffsets[a], model, primitive.attributes[attributeTypes[a]]);
+					mismatchCount += CompareGLTFAttribute(attributeVertices, attributeOffsets[a], model, primitive.attributes[attributeTypes[a]]);
+				}
+
+				if(mismatchCount > 0)
+				{
+					LOG(Log::MessageType::Error, std::string(normalized ? "Normalized " : "") + componentNames[t] + " attributes" + 
+						(padding > 0 ? " with a stride" : "") + ": " + std::to_string(mismatchCount) + " components differ from the spec");
+					failureCount++;
+				}
+			}
+		}
+	}
+
+	// 2) Indices of every size, appended to existing ones. Strided 16-bit indices skip the SIMD path //
+	const int indexTypes[] = { TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE, TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT, 
+		TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT, TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT };
+	const size_t indexSizes[] = { 1, 2, 2, 4 };
+	const size_t indexPaddings[] = { 0, 0, 2, 0 };
+	const size_t indexCount = 1003;
+	const std::vector<unsigned int> existingIndices = { 5, 4, 3, 2, 1 };
+
+	for(unsigned int t = 0; t < 4; t++)
+	{
+		glTFFile file;
+		tinygltf::Model& model = file.model;
+		model.buffers.resize(1);
+
+		tinygltf::Primitive primitive;
+		primitive.indices = AddTestAccessor(model, indexTypes[t], TINYGLTF_TYPE_SCALAR, false, indexCount, indexPaddings[t], random);
+
+		std::vector<unsigned int> indices = existingIndices;
+		glTFLoadIndices(indices, file, primitive);
+
+		const tinygltf::Accessor& accessor = model.accessors[primitive.indices];
+		const tinygltf::BufferView& view = model.bufferViews[accessor.bufferView];
+		const unsigned char* source = model.buffers[0].data.data() + view.byteOffset + accessor.byteOffset;
+		const size_t stride = accessor.ByteStride(view);
+
+		unsigned int mismatchCount = indices.size() == existingIndices.size() + indexCount ? 0 : 1;
+		for(size_t i = 0; mismatchCount == 0 && i < indexCount; i++)
+		{
+			unsigned int expected = 0;
+			memcpy(&expected, source + i * stride, indexSizes[t]);
+			mismatchCount += indices[existingIndices.size() + i] == expected ? 0 : 1;
+		}
+
+		if(mismatchCount > 0 || !std::equal(existingIndices.begin(), existingIndices.end(), indices.begin()))
+		{
+			LOG(Log::MessageType::Error, std::to_string(indexSizes[t] * 8) + "-bit indices" + 
+				(indexPaddings[t] > 0 ? " with a stride" : "") + " weren't appended as they're stored");
+			failureCount++;
+		}
+	}
+
+	// 3) Geometry without indices uses every vertex once, in order //
+	glTFFile file;
+	file.model.buffers.resize(1);
+
+	tinygltf::Primitive primitive;
+	primitive.attributes["POSITION"] = AddTestAccessor(file.model, TINYGLTF_COMPONENT_TYPE_FLOAT, TINYGLTF_TYPE_VEC3, false, 37, 0, random);
+
+	std::vector<unsigned int> indices = existingIndices;
+	glTFLoadIndices(indices, file, primitive);
+
+	bool isSequential = indices.size() == existingIndices.size() + 37;
+	for(size_t i = 0; isSequential && i < 37; i++)
+	{
+		isSequential = indices[existingIndices.size() + i] == i;
+	}
+
+	if(!isSequential)
+	{
+		LOG(Log::MessageType::Error, "A primitive without indices didn't get sequential indices");
+		failureCount++;
+	}
+
+	LOG("glTF: " + std::to_string(failureCount) + " failures");
+	return failureCount;
+}
+#pragma endregion
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "Framework/Scene.h"
 #include "Graphics/DXRayTracingPipeline.h"
 #include "Graphics/RenderStages/RayTraceStage.h"
+#include "Graphics/RenderStages/DenoiseStage.h"
 
 // DirectX Components //
 #include "Graphics/DXAccess.h"
@@ -13,6 +14,8 @@
 // Renderer Components //
 #include "Graphics/Window.h"
 #include "Graphics/Texture.h"
+#include "Graphics/TextureStreamer.h"
+#include "Graphics/TextureManager.h"
 #include "Graphics/Model.h"  
 #include "Graphics/Mesh.h"  
 
@@ -52,6 +55,9 @@ Renderer::Renderer(const std::wstring& applicationName, unsigned int windowWidth
 	directCommands = new DXCommands(D3D12_COMMAND_LIST_TYPE_DIRECT, Window::BackBufferCount);
 	copyCommands = new DXCommands(D3D12_COMMAND_LIST_TYPE_DIRECT, 1);
 
+	// Shared by everything that's missing a texture, the renderer keeps its reference //
+	defaultTexture = TextureManager::LoadTexture("Assets/Textures/missing.png");
+
 	window = new Window(applicationName, windowWidth, windowHeight);
 
 	InitializeImGui();
@@ -61,10 +67,17 @@ void Renderer::InitializeStage(Scene* activeScene)
 {
 	this->activeScene = activeScene;
 	rayTraceStage = new RayTraceStage(activeScene);
+	denoiseStage = new DenoiseStage(rayTraceStage);
 }
 
 void Renderer::Update(float deltaTime)
 {
+	// Textures that finished streaming get swapped in before anything gets recorded //
+	if(TextureStreamer::Update())
+	{
+		activeScene->HasNewTextures = true;
+	}
+
 	rayTraceStage->Update(deltaTime);
 }
 
@@ -88,6 +101,7 @@ void Renderer::Render()
 
 	// 3) Run custom render stages //
 	rayTraceStage->RecordStage(commandList);
+	denoiseStage->RecordStage(commandList);
 
 	// 4) Draw UI (ImGui) and prepare render target for presenting //
 	ImGui_ImplDX12_RenderDrawData(ImGui::GetDrawData(), commandList.Get());
@@ -105,6 +119,16 @@ void Renderer::Resize()
 	window->Resize();
 }
 
+RayTraceStage* Renderer::GetRayTraceStage()
+{
+	return rayTraceStage;
+}
+
+DenoiseStage* Renderer::GetDenoiseStage()
+{
+	return denoiseStage;
+}
+
 void Renderer::InitializeImGui()
 {
 	IMGUI_CHECKVERSION();
@@ -1,35 +1,53 @@
 #include "Framework/Scene.h"
+#include "Framework/SceneDescription.h"
 #include "Graphics/Model.h"
 #include "Graphics/EnvironmentMap.h"
+#include "Graphics/TextureManager.h"
+#include "Utilities/ThreadPool.h"
+#include "Utilities/Logger.h"
+
+#include <chrono>
 
 Scene::Scene()
 {
-	AddModel("Assets/Models/Bust/marble_bust_01_4k.gltf");
-	models[0]->transform.Position = glm::vec3(-0.79f, -0.70f, 3.65f);
-	models[0]->transform.Rotation = glm::vec3(0.0f, 37.0f, 0.0f);
-	models[0]->transform.Scale = glm::vec3(2.25f);
-	
-	AddModel("Assets/Models/Chess/chess_set_2k.gltf");
-	models[1]->transform.Position = glm::vec3(0.5f, -0.707f, 3.15f);
-	models[1]->transform.Rotation = glm::vec3(0.0f, 33.0f, 0.0f);
-	models[1]->transform.Scale = glm::vec3(3.0f);
-	
-	AddModel("Assets/Models/Table/side_table_01_8k.gltf");
-	models[2]->transform.Position = glm::vec3(0.08f, -4.27f, 3.24f);
-	models[2]->transform.Rotation = glm::vec3(0.0f, 0.0f, 0.0f);
-	models[2]->transform.Scale = glm::vec3(6.5f);
-
-	AddModel("Assets/Models/FlightHelmet/FlightHelmet.gltf");
+	SceneDescription description = GetDefaultSceneDescription();
+	auto loadStart = std::chrono::high_resolution_clock::now();
+
+	// Parsing & decoding of the models happens in parallel, after which all GPU resources get created at once //
+	std::vector<Model*> loadedModels(description.models.size());
+	ThreadPool::GetGlobalPool().ParallelFor(description.models.size(), [&](unsigned int index)
+	{
+		SceneModelDescription& modelDescription = description.models[index];
+		loadedModels[index] = new Model(modelDescription.path, true, true, modelDescription.usePackedVertices);
+	});
+
+	Model::CreateGPUResources(loadedModels);
+
+	for(unsigned int i = 0; i < loadedModels.size(); i++)
+	{
+		SceneModelDescription& modelDescription = description.models[i];
+
+		Model* model = loadedModels[i];
+		model->transform.Position = modelDescription.position;
+		model->transform.Rotation = modelDescription.rotation;
+		model->transform.Scale = modelDescription.scale;
+		models.push_back(model);
+	}
 
+	auto loadEnd = std::chrono::high_resolution_clock::now();
+	float loadTime = std::chrono::duration<float, std::milli>(loadEnd - loadStart).count();
+	LOG("Loaded " + std::to_string(models.size()) + " models in " + std::to_string(loadTime) + "ms, using " 
+		+ std::to_string(TextureManager::GetTextureCount()) + " unique textures");
 
 	// Environment Map //
-	std::string exrPath = "Assets/EXRs/wharf.exr";
-	environmentMap = new EnvironmentMap(exrPath);
+	environmentMap = new EnvironmentMap(description.environmentMapPath, description.environmentMapFormat, 
+		description.environmentMapLevels);
 }
 
 void Scene::AddModel(const std::string& path)
 {
 	models.push_back(new Model(path, true));
+	HasNewGeometry = true;
 }
 
 const std::vector<Model*>& Scene::GetModels()
@@ -0,0 +1,538 @@
+#include "Graphics/CPU/CPUBottomLevelAS.h"
+#include "Graphics/CPU/CPURayPacket.h"
+#include "Utilities/ThreadPool.h"
+#include "Utilities/Logger.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <chrono>
+
+// Amount of buckets the centroids get sorted into when evaluating splits
+static const int binCount = 16;
+
+// Subtrees with fewer triangles are build on the current thread, 
+// splitting them off as a task costs more than it gains
+static const unsigned int parallelBuildThreshold = 4096;
+
+// Traversal pushes at most one node per level on its fixed size stack, so nodes 
+// at the maximum depth become leafs no matter how many triangles they contain
+static const unsigned int traversalStackSize = 64;
+static const unsigned int maxTreeDepth = 60;
+
+static float SurfaceArea(const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+{
+	glm::vec3 extent = boundsMax - boundsMin;
+	return 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+}
+
+struct BVHBin
+{
+	glm::vec3 boundsMin = glm::vec3(FLT_MAX);
+	glm::vec3 boundsMax = glm::vec3(-FLT_MAX);
+	unsigned int triangleCount = 0;
+};
+
+CPUBottomLevelAS::CPUBottomLevelAS(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, 
+	ThreadPool* threadPool) : threadPool(threadPool)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	if(!threadPool)
+	{
+		this->threadPool = &ThreadPool::GetGlobalPool();
+	}
+
+	unsigned int triangleCount = indices.size() / 3;
+
+	positions.resize(triangleCount * 3);
+	centroids.resize(triangleCount);
+	triangleIndices.resize(triangleCount);
+
+	for(unsigned int i = 0; i < triangleCount; i++)
+	{
+		positions[i * 3] = vertices[indices[i * 3]].Position;
+		positions[i * 3 + 1] = vertices[indices[i * 3 + 1]].Position;
+		positions[i * 3 + 2] = vertices[indices[i * 3 + 2]].Position;
+
+		centroids[i] = (positions[i * 3] + positions[i * 3 + 1] + positions[i * 3 + 2]) * (1.0f / 3.0f);
+		triangleIndices[i] = i;
+	}
+
+	// A binary tree with N leafs has at most 2N - 1 nodes
+	nodes.resize(std::max(triangleCount * 2, 1u));
+
+	BVHNode& root = nodes[0];
+	root.leftFirst = 0;
+	root.triangleCount = triangleCount;
+	nodesUsed = 1;
+
+	if(triangleCount == 0)
+	{
+		root.boundsMin = glm::vec3(FLT_MAX);
+		root.boundsMax = glm::vec3(-FLT_MAX);
+		return;
+	}
+
+	UpdateNodeBounds(root);
+
+	TaskGroup group;
+	Subdivide(0, 1, group);
+	this->threadPool->Wait(group);
+
+	nodes.resize(nodesUsed);
+
+	auto end = std::chrono::high_resolution_clock::now();
+	stats.buildTime = std::chrono::duration<double, std::milli>(end - start).count();
+	stats.nodeCount = nodesUsed;
+
+	CalculateStats(0, 1, SurfaceArea(root.boundsMin, root.boundsMax));
+
+	LOG(Log::MessageType::Debug, "Built BLAS: " + std::to_string(triangleCount) + " triangles, " 
+		+ std::to_string(stats.nodeCount) + " nodes, depth " + std::to_string(stats.maxDepth) + "/" 
+		+ std::to_string(maxTreeDepth) + ", SAH cost " + std::to_string(stats.sahCost) 
+		+ " in " + std::to_string(stats.buildTime) + "ms");
+}
+
+bool CPUBottomLevelAS::Intersect(const Ray& ray, HitInfo& hit, bool acceptFirstHit)
+{
+	if(nodes[0].triangleCount == 0 && nodes.size() == 1)
+	{
+		return false;
+	}
+
+	glm::vec3 inverseDirection = 1.0f / ray.Direction;
+	bool hasHit = false;
+
+	unsigned int stack[traversalStackSize];
+	unsigned int stackPointer = 0;
+	stack[stackPointer++] = 0;
+
+	while(stackPointer > 0)
+	{
+		BVHNode& node = nodes[stack[--stackPointer]];
+
+		if(node.triangleCount > 0)
+		{
+			for(unsigned int i = 0; i < node.triangleCount; i++)
+			{
+				hasHit |= IntersectTriangle(ray, triangleIndices[node.leftFirst + i], hit);
+			}
+
+			if(hasHit && acceptFirstHit)
+			{
+				return true;
+			}
+			continue;
+		}
+
+		// Visit the nearest child first, so that the far one can be culled more often
+		BVHNode& left = nodes[node.leftFirst];
+		BVHNode& right = nodes[node.leftFirst + 1];
+		float distanceLeft = IntersectAABB(ray, inverseDirection, left.boundsMin, left.boundsMax, hit.t);
+		float distanceRight = IntersectAABB(ray, inverseDirection, right.boundsMin, right.boundsMax, hit.t);
+
+		unsigned int nearIndex = node.leftFirst;
+		unsigned int farIndex = node.leftFirst + 1;
+		if(distanceLeft > distanceRight)
+		{
+			std::swap(distanceLeft, distanceRight);
+			std::swap(nearIndex, farIndex);
+		}
+
+		if(distanceRight != FLT_MAX)
+		{
+			assert(stackPointer < traversalStackSize);
+			stack[stackPointer++] = farIndex;
+		}
+
+		if(distanceLeft != FLT_MAX)
+		{
+			assert(stackPointer < traversalStackSize);
+			stack[stackPointer++] = nearIndex;
+		}
+	}
+
+	return hasHit;
+}
+
+uint64_t CPUBottomLevelAS::IntersectPacket(RayPacket& packet)
+{
+#ifdef PACKET_AVX2
+	if(UsePacketAVX2())
+	{
+		return TraversePacketAVX2(packet);
+	}
+#endif
+
+	return TraversePacket<ScalarPacketTests>(packet);
+}
+
+#ifdef PACKET_AVX2
+PACKET_AVX2_KERNEL uint64_t CPUBottomLevelAS::TraversePacketAVX2(RayPacket& packet)
+{
+	return TraversePacket<AVX2PacketTests>(packet);
+}
+#endif
+
+template<typename PacketTests>
+uint64_t CPUBottomLevelAS::TraversePacket(RayPacket& packet)
+{
+	if(nodes[0].triangleCount == 0 && nodes.size() == 1)
+	{
+		return 0;
+	}
+
+	const unsigned int groupCount = (packet.rayCount + packetGroupSize - 1) / packetGroupSize;
+	uint64_t hitMask = 0;
+
+	unsigned int stack[traversalStackSize];
+	unsigned int stackPointer = 0;
+	stack[stackPointer++] = 0;
+
+	while(stackPointer > 0)
+	{
+		BVHNode& node = nodes[stack[--stackPointer]];
+
+		if(node.triangleCount > 0)
+		{
+			// Only groups with a ray that enters the leaf test its triangles //
+			unsigned int groupMasks[packetGroupCount];
+			unsigned int activeMask = 0;
+			for(unsigned int group = 0; group < groupCount; group++)
+			{
+				groupMasks[group] = PacketTests::AABB(packet, group, node.boundsMin, node.boundsMax);
+				activeMask |= groupMasks[group];
+			}
+
+			if(activeMask == 0)
+			{
+				continue;
+			}
+
+			for(unsigned int i = 0; i < node.triangleCount; i++)
+			{
+				unsigned int triangle = triangleIndices[node.leftFirst + i];
+				const glm::vec3* vertices = &positions[triangle * 3];
+
+				for(unsigned int group = 0; group < groupCount; group++)
+				{
+					if(groupMasks[group] != 0)
+					{
+						uint64_t mask = PacketTests::Triangle(packet, group, vertices[0], vertices[1], vertices[2], triangle);
+						hitMask |= mask << (group * packetGroupSize);
+					}
+				}
+			}
+			continue;
+		}
+
+		// The node only has to be entered by a single ray of the packet to be traversed //
+		bool isEntered = false;
+		for(unsigned int group = 0; group < groupCount && !isEntered; group++)
+		{
+			isEntered = PacketTests::AABB(packet, group, node.boundsMin, node.boundsMax) != 0;
+		}
+
+		if(!isEntered)
+		{
+			continue;
+		}
+
+		// Children outside of the frustum can't be hit by any ray, the nearest one along the packet gets visited first
+		BVHNode& left = nodes[node.leftFirst];
+		BVHNode& right = nodes[node.leftFirst + 1];
+		unsigned int childMask = PacketTests::Frustum(packet, left, right);
+
+		unsigned int nearIndex = node.leftFirst;
+		unsigned int farIndex = node.leftFirst + 1;
+		unsigned int nearBit = 1;
+		unsigned int farBit = 2;
+		if(glm::dot(left.boundsMin + left.boundsMax, packet.centralDirection) >
+			glm::dot(right.boundsMin + right.boundsMax, packet.centralDirection))
+		{
+			std::swap(nearIndex, farIndex);
+			std::swap(nearBit, farBit);
+		}
+
+		if(childMask & farBit)
+		{
+			assert(stackPointer < traversalStackSize);
+			stack[stackPointer++] = farIndex;
+		}
+
+		if(childMask & nearBit)
+		{
+			assert(stackPointer < traversalStackSize);
+			stack[stackPointer++] = nearIndex;
+		}
+	}
+
+	return hitMask;
+}
+
+glm::vec3 CPUBottomLevelAS::GetBoundsMin()
+{
+	return nodes[0].boundsMin;
+}
+
+glm::vec3 CPUBottomLevelAS::GetBoundsMax()
+{
+	return nodes[0].boundsMax;
+}
+
+unsigned int CPUBottomLevelAS::GetNodeCount()
+{
+	return nodes.size();
+}
+
+const BVHBuildStats& CPUBottomLevelAS::GetBuildStats()
+{
+	return stats;
+}
+
+void CPUBottomLevelAS::UpdateNodeBounds(BVHNode& node)
+{
+	node.boundsMin = glm::vec3(FLT_MAX);
+	node.boundsMax = glm::vec3(-FLT_MAX);
+
+	for(unsigned int i = 0; i < node.triangleCount; i++)
+	{
+		unsigned int triangle = triangleIndices[node.leftFirst + i];
+
+		for(unsigned int v = 0; v < 3; v++)
+		{
+			node.boundsMin = glm::min(node.boundsMin, positions[triangle * 3 + v]);
+			node.boundsMax = glm::max(node.boundsMax, positions[triangle * 3 + v]);
+		}
+	}
+}
+
+void CPUBottomLevelAS::Subdivide(unsigned int nodeIndex, unsigned int depth, TaskGroup& group)
+{
+	BVHNode& node = nodes[nodeIndex];
+	if(node.triangleCount <= 1 || depth >= maxTreeDepth)
+	{
+		return;
+	}
+
+	// 1) Only split when it's cheaper than intersecting all triangles in the node //
+	int axis;
+	float splitPosition;
+	float splitCost = FindBestSplit(node, axis, splitPosition);
+	float leafCost = float(node.triangleCount);
+
+	if(splitCost >= leafCost)
+	{
+		return;
+	}
+
+	// 2) Partition the triangles in place //
+	int i = node.leftFirst;
+	int j = i + node.triangleCount - 1;
+	while(i <= j)
+	{
+		if(centroids[triangleIndices[i]][axis] < splitPosition)
+		{
+			i++;
+		}
+		else
+		{
+			std::swap(triangleIndices[i], triangleIndices[j--]);
+		}
+	}
+
+	// Can happen due to floating point imprecision at the bin borders
+	unsigned int leftCount = i - node.leftFirst;
+	if(leftCount == 0 || leftCount == node.triangleCount)
+	{
+		return;
+	}
+
+	// 3) Create child nodes, children are always allocated as a pair //
+	unsigned int leftChildIndex = nodesUsed.fetch_add(2);
+	unsigned int rightChildIndex = leftChildIndex + 1;
+
+	nodes[leftChildIndex].leftFirst = node.leftFirst;
+	nodes[leftChildIndex].triangleCount = leftCount;
+	nodes[rightChildIndex].leftFirst = i;
+	nodes[rightChildIndex].triangleCount = node.triangleCount - leftCount;
+
+	node.leftFirst = leftChildIndex;
+	node.triangleCount = 0;
+
+	UpdateNodeBounds(nodes[leftChildIndex]);
+	UpdateNodeBounds(nodes[rightChildIndex]);
+
+	// 4) Recurse, both children touch disjoint ranges of triangles so they can be build in parallel //
+	if(nodes[leftChildIndex].triangleCount >= parallelBuildThreshold)
+	{
+		threadPool->Submit(group, [this, leftChildIndex, depth, &group]()
+		{
+			Subdivide(leftChildIndex, depth + 1, group);
+		});
+	}
+	else
+	{
+		Subdivide(leftChildIndex, depth + 1, group);
+	}
+
+	Subdivide(rightChildIndex, depth + 1, group);
+}
+
+float CPUBottomLevelAS::FindBestSplit(const BVHNode& node, int& axis, float& splitPosition)
+{
+	float bestCost = FLT_MAX;
+
+	// Bins are spread over the bounds of the centroids instead of the triangles,
+	// that way every bin can end up with triangles in it
+	glm::vec3 centroidMin = glm::vec3(FLT_MAX);
+	glm::vec3 centroidMax = glm::vec3(-FLT_MAX);
+	for(unsigned int i = 0; i < node.triangleCount; i++)
+	{
+		const glm::vec3& centroid = centroids[triangleIndices[node.leftFirst + i]];
+		centroidMin = glm::min(centroidMin, centroid);
+		centroidMax = glm::max(centroidMax, centroid);
+	}
+
+	float nodeArea = SurfaceArea(node.boundsMin, node.boundsMax);
+
+	for(int a = 0; a < 3; a++)
+	{
+		float boundsMin = centroidMin[a];
+		float boundsMax = centroidMax[a];
+		if(boundsMin == boundsMax)
+		{
+			continue;
+		}
+
+		// 1) Sort triangles into bins //
+		BVHBin bins[binCount];
+		float scale = binCount / (boundsMax - boundsMin);
+
+		for(unsigned int i = 0; i < node.triangleCount; i++)
+		{
+			unsigned int triangle = triangleIndices[node.leftFirst + i];
+			int binIndex = std::min(binCount - 1, int((centroids[triangle][a] - boundsMin) * scale));
+
+			BVHBin& bin = bins[binIndex];
+			bin.triangleCount++;
+
+			for(unsigned int v = 0; v < 3; v++)
+			{
+				bin.boundsMin = glm::min(bin.boundsMin, positions[triangle * 3 + v]);
+				bin.boundsMax = glm::max(bin.boundsMax, positions[triangle * 3 + v]);
+			}
+		}
+
+		// 2) Sweep from both sides to get the area & count left/right of every plane //
+		float leftArea[binCount - 1];
+		float rightArea[binCount - 1];
+		unsigned int leftCount[binCount - 1];
+		unsigned int rightCount[binCount - 1];
+
+		BVHBin leftBox;
+		BVHBin rightBox;
+		unsigned int leftSum = 0;
+		unsigned int rightSum = 0;
+
+		for(int i = 0; i < binCount - 1; i++)
+		{
+			leftSum += bins[i].triangleCount;
+			leftCount[i] = leftSum;
+			leftBox.boundsMin = glm::min(leftBox.boundsMin, bins[i].boundsMin);
+			leftBox.boundsMax = glm::max(leftBox.boundsMax, bins[i].boundsMax);
+			leftArea[i] = leftSum > 0 ? SurfaceArea(leftBox.boundsMin, leftBox.boundsMax) : 0.0f;
+
+			rightSum += bins[binCount - 1 - i].triangleCount;
+			rightCount[binCount - 2 - i] = rightSum;
+			rightBox.boundsMin = glm::min(rightBox.boundsMin, bins[binCount - 1 - i].boundsMin);
+			rightBox.boundsMax = glm::max(rightBox.boundsMax, bins[binCount - 1 - i].boundsMax);
+			rightArea[binCount - 2 - i] = rightSum > 0 ? SurfaceArea(rightBox.boundsMin, rightBox.boundsMax) : 0.0f;
+		}
+
+		// 3) Evaluate the SAH for every plane in between bins //
+		float binWidth = (boundsMax - boundsMin) / binCount;
+		for(int i = 0; i < binCount - 1; i++)
+		{
+			if(leftCount[i] == 0 || rightCount[i] == 0)
+			{
+				continue;
+			}
+
+			float cost = 1.0f + (leftCount[i] * leftArea[i] + rightCount[i] * rightArea[i]) / nodeArea;
+			if(cost < bestCost)
+			{
+				bestCost = cost;
+				axis = a;
+				splitPosition = boundsMin + binWidth * (i + 1);
+			}
+		}
+	}
+
+	return bestCost;
+}
+
+void CPUBottomLevelAS::CalculateStats(unsigned int nodeIndex, unsigned int depth, float rootArea)
+{
+	BVHNode& node = nodes[nodeIndex];
+	float relativeArea = rootArea > 0.0f ? SurfaceArea(node.boundsMin, node.boundsMax) / rootArea : 1.0f;
+
+	stats.maxDepth = std::max(stats.maxDepth, depth);
+
+	if(node.triangleCount > 0)
+	{
+		stats.leafCount++;
+		stats.sahCost += relativeArea * node.triangleCount;
+		return;
+	}
+
+	stats.sahCost += relativeArea;
+	CalculateStats(node.leftFirst, depth + 1, rootArea);
+	CalculateStats(node.leftFirst + 1, depth + 1, rootArea);
+}
+
+bool CPUBottomLevelAS::IntersectTriangle(const Ray& ray, unsigned int triangleIndex, HitInfo& hit)
+{
+	// Moller-Trumbore, no backface culling since DXR doesn't cull by default either
+	const glm::vec3& v0 = positions[triangleIndex * 3];
+	const glm::vec3& v1 = positions[triangleIndex * 3 + 1];
+	const glm::vec3& v2 = positions[triangleIndex * 3 + 2];
+
+	glm::vec3 edge1 = v1 - v0;
+	glm::vec3 edge2 = v2 - v0;
+	glm::vec3 h = glm::cross(ray.Direction, edge2);
+	float a = glm::dot(edge1, h);
+
+	if(fabsf(a) < 1e-12f)
+	{
+		return false;
+	}
+
+	float f = 1.0f / a;
+	glm::vec3 s = ray.Origin - v0;
+	float u = f * glm::dot(s, h);
+	if(u < 0.0f || u > 1.0f)
+	{
+		return false;
+	}
+
+	glm::vec3 q = glm::cross(s, edge1);
+	float v = f * glm::dot(ray.Direction, q);
+	if(v < 0.0f || u + v > 1.0f)
+	{
+		return false;
+	}
+
+	float t = f * glm::dot(edge2, q);
+	if(t < ray.TMin || t >= hit.t)
+	{
+		return false;
+	}
+
+	hit.t = t;
+	hit.bary = glm::vec2(u, v);
+	hit.primitiveIndex = triangleIndex;
+	hit.hasHit = true;
+	return true;
+}
\ No newline at end of file
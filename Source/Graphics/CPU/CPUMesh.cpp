@@ -0,0 +1,54 @@
+#include "Graphics/CPU/CPUMesh.h"
+#include "Graphics/CPU/CPUTexture.h"
+#include "Graphics/CPU/CPUBottomLevelAS.h"
+#include "Graphics/CookedModel.h"
+
+CPUMesh::CPUMesh(const CookedMesh& cookedMesh, const std::vector<CPUTexture*>& textures)
+{
+	// Geometry Data //
+	vertices.assign(cookedMesh.vertices, cookedMesh.vertices + cookedMesh.vertexCount);
+	indices.assign(cookedMesh.indices, cookedMesh.indices + cookedMesh.indexCount);
+
+	blas = new CPUBottomLevelAS(vertices, indices);
+
+	// Material & Texture Data //
+	diffuseTexture = GetTexture(cookedMesh.imageIndices[glTFTextureType::BaseColor], textures);
+	normalTexture = GetTexture(cookedMesh.imageIndices[glTFTextureType::Normal], textures);
+	ORMTexture = GetTexture(cookedMesh.imageIndices[glTFTextureType::MetallicRoughness], textures);
+
+	material.hasDiffuse = diffuseTexture != nullptr;
+	material.hasNormal = normalTexture != nullptr;
+	material.hasORM = ORMTexture != nullptr;
+}
+
+CPUMesh::~CPUMesh()
+{
+	// Textures are owned by the model's texture cache
+	delete blas;
+}
+
+const Vertex& CPUMesh::GetVertex(unsigned int primitiveIndex, unsigned int corner)
+{
+	return vertices[indices[primitiveIndex * 3 + corner]];
+}
+
+unsigned int CPUMesh::GetTriangleCount()
+{
+	return indices.size() / 3;
+}
+
+CPUBottomLevelAS* CPUMesh::GetBLAS()
+{
+	return blas;
+}
+
+CPUTexture* CPUMesh::GetTexture(int imageIndex, const std::vector<CPUTexture*>& textures)
+{
+	// Same image index as the DirectX path uses, so both backends sample the same data
+	if(imageIndex < 0 || imageIndex >= int(textures.size()))
+	{
+		return nullptr;
+	}
+
+	return textures[imageIndex];
+}
\ No newline at end of file
@@ -0,0 +1,139 @@
+#include "Graphics/CPU/CPUModel.h"
+#include "Graphics/CPU/CPUMesh.h"
+#include "Graphics/CPU/CPUTexture.h"
+#include "Graphics/CookedModel.h"
+#include "Graphics/CookedTexture.h"
+
+#include "Utilities/Logger.h"
+#include "Utilities/ThreadPool.h"
+#include <cassert>
+
+CPUModel::CPUModel(const std::string& filePath)
+{
+	Name = filePath.substr(filePath.find_last_of("\\/") + 1);
+
+	CookedModel cookedModel(filePath);
+	if(!cookedModel.IsValid())
+	{
+		assert(false && "Failed to parse model.");
+		return;
+	}
+
+	LoadTextures(cookedModel);
+	LoadMeshes(cookedModel);
+}
+
+CPUModel::~CPUModel()
+{
+	for(CPUMesh* mesh : meshes)
+	{
+		delete mesh;
+	}
+
+	for(CPUTexture* texture : textures)
+	{
+		delete texture;
+	}
+}
+
+CPUMesh* CPUModel::GetMesh(int index)
+{
+	return meshes[index];
+}
+
+const std::vector<CPUMesh*>& CPUModel::GetMeshes()
+{
+	return meshes;
+}
+
+unsigned int CPUModel::GetMeshCount()
+{
+	return meshes.size();
+}
+
+const std::vector<CPUMeshInstance>& CPUModel::GetMeshInstances()
+{
+	return meshInstances;
+}
+
+void CPUModel::LoadTextures(CookedModel& cookedModel)
+{
+	// Every image gets cooked on its own, so meshes only have to look them up //
+	textures.resize(cookedModel.GetImageCount(), nullptr);
+
+	// Like the TextureManager does for 'Mesh', the first texture type an image is used as decides how it gets cooked
+	std::vector<int> textureTypes(cookedModel.GetImageCount(), -1);
+	for(const CookedMesh& cookedMesh : cookedModel.GetMeshes())
+	{
+		for(int type : { glTFTextureType::BaseColor, glTFTextureType::Normal, glTFTextureType::MetallicRoughness })
+		{
+			int imageIndex = cookedMesh.imageIndices[type];
+			if(imageIndex >= 0 && textureTypes[imageIndex] < 0)
+			{
+				textureTypes[imageIndex] = type;
+			}
+		}
+	}
+
+	ThreadPool::GetGlobalPool().ParallelFor(cookedModel.GetImageCount(), [&](unsigned int index)
+	{
+		if(textureTypes[index] < 0)
+		{
+			return;
+		}
+
+		TextureCompression compression;
+		MipGeneration mipGeneration;
+		glTFGetTextureCooking(glTFTextureType(textureTypes[index]), compression, mipGeneration);
+
+		CookedTexture* cookedTexture = nullptr;
+		const tinygltf::Image* image = cookedModel.GetDecodedImage(index);
+
+		if(cookedModel.GetImageURI(index).empty() && image != nullptr)
+		{
+			// Embedded images can't be referenced by the cache //
+			if(image->image.empty() || image->component != 4 || image->bits != 8)
+			{
+				LOG(Log::MessageType::Error, "Unsupported image format for: " + image->name);
+				return;
+			}
+
+			cookedTexture = new CookedTexture(image->image.data(), image->width, image->height, compression, mipGeneration);
+		}
+		else
+		{
+			cookedTexture = new CookedTexture(cookedModel.GetImagePath(index), compression, mipGeneration);
+		}
+
+		if(cookedTexture->IsValid())
+		{
+			textures[index] = new CPUTexture(*cookedTexture);
+		}
+		else
+		{
+			LOG(Log::MessageType::Error, "Failed to load image: " + cookedModel.GetImageURI(index));
+		}
+
+		delete cookedTexture;
+	});
+}
+
+void CPUModel::LoadMeshes(CookedModel& cookedModel)
+{
+	// Copying the geometry & BLAS building happens in parallel, each mesh has its own slot so the order stays the same //
+	const std::vector<CookedMesh>& cookedMeshes = cookedModel.GetMeshes();
+	meshes.resize(cookedMeshes.size());
+
+	ThreadPool::GetGlobalPool().ParallelFor(cookedMeshes.size(), [&](unsigned int index)
+	{
+		CPUMesh* mesh = new CPUMesh(cookedMeshes[index], textures);
+		mesh->Name = cookedMeshes[index].name;
+		meshes[index] = mesh;
+	});
+
+	// Nodes referencing the same glTF mesh share the geometry & BLAS //
+	for(const CookedMeshInstance& instance : cookedModel.GetInstances())
+	{
+		meshInstances.push_back({ meshes[instance.meshIndex], instance.transform });
+	}
+}
\ No newline at end of file
@@ -0,0 +1,1200 @@
+#include "Graphics/CPU/CPUPathTracer.h"
+#include "Graphics/CPU/CPUScene.h"
+#include "Graphics/CPU/CPUModel.h"
+#include "Graphics/CPU/CPUMesh.h"
+#include "Graphics/CPU/CPUTexture.h"
+#include "Graphics/CPU/CPUTopLevelAS.h"
+#include "Graphics/CPU/CPURayPacket.h"
+#include "Graphics/Material.h"
+#include "Utilities/ThreadPool.h"
+#include "Utilities/Logger.h"
+
+#include <chrono>
+#include <numeric>
+#include <tinyexr.h>
+#include <stb_image_write.h>
+
+// Tiles are square, small enough to balance the load & for adaptive sampling to skip the converged
+// parts of the image, big enough to keep the scheduling overhead low
+static const unsigned int tileSize = 8;
+static_assert(tileSize * tileSize <= packetSize, "The primary rays of a tile have to fit in a single packet");
+
+// Depth of the ray trees traced by the recursive integrator, the iterative one uses 'minDepth' & 'maxDepth'
+static const unsigned int maxTreeDepth = 6;
+
+// Rays traced by the calling thread, its tiles add them to the statistics of the render
+static thread_local unsigned long long traceCount = 0;
+static thread_local unsigned long long shadowTraceCount = 0;
+
+CPUPathTracer::CPUPathTracer(CPUScene* scene, unsigned int width, unsigned int height, ThreadPool* threadPool) 
+	: scene(scene), threadPool(threadPool), width(width), height(height)
+{
+	if(!threadPool)
+	{
+		this->threadPool = &ThreadPool::GetGlobalPool();
+	}
+
+	tileCountX = (width + tileSize - 1) / tileSize;
+	tileCountY = (height + tileSize - 1) / tileSize;
+
+	colorBuffer.resize(width * height, glm::vec4(0.0f));
+	momentBuffer.resize(width * height, 0.0f);
+	guideBuffer.resize(width * height);
+	tileStatistics.resize(tileCountX * tileCountY);
+
+	LOG("CPU Path Tracer: packets get traced with the " + std::string(UsePacketAVX2() ? "AVX2" : "scalar") + " tests");
+}
+
+void CPUPathTracer::Render(unsigned int sampleCount)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	std::vector<unsigned int> tiles(tileCountX * tileCountY);
+	std::iota(tiles.begin(), tiles.end(), 0);
+	RenderTiles(tiles, sampleCount);
+
+	frameCount += sampleCount;
+
+	auto end = std::chrono::high_resolution_clock::now();
+	double seconds = std::chrono::duration<double>(end - start).count();
+
+	LOG("CPU Path Tracer: " + std::to_string(sampleCount) + " spp in " + std::to_string(seconds) + "s");
+	LogStatistics(seconds);
+}
+
+unsigned int CPUPathTracer::RenderAdaptive(unsigned int sampleCount, float targetError)
+{
+	// Converged tiles never get new samples, so their error stays below the target from then on //
+	std::vector<unsigned int> tiles;
+	for(unsigned int tileIndex = 0; tileIndex < tileCountX * tileCountY; tileIndex++)
+	{
+		if(GetTileError(tileIndex) >= targetError)
+		{
+			tiles.push_back(tileIndex);
+		}
+	}
+
+	if(!tiles.empty())
+	{
+		RenderTiles(tiles, sampleCount);
+		frameCount += sampleCount;
+	}
+
+	return tiles.size();
+}
+
+void CPUPathTracer::RenderUntilConverged(float targetError, unsigned int maxSampleCount)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	// Every pass adds a few samples to the tiles that are still noisy //
+	const unsigned int passSampleCount = 8;
+	unsigned int renderedSampleCount = 0;
+	unsigned int passCount = 0;
+
+	while(renderedSampleCount < maxSampleCount)
+	{
+		unsigned int sampleCount = std::min(passSampleCount, maxSampleCount - renderedSampleCount);
+		if(RenderAdaptive(sampleCount, targetError) == 0)
+		{
+			break;
+		}
+
+		renderedSampleCount += sampleCount;
+		passCount++;
+	}
+
+	auto end = std::chrono::high_resolution_clock::now();
+	double seconds = std::chrono::duration<double>(end - start).count();
+
+	unsigned int convergedCount = 0;
+	for(unsigned int tileIndex = 0; tileIndex < tileCountX * tileCountY; tileIndex++)
+	{
+		convergedCount += GetTileError(tileIndex) < targetError ? 1 : 0;
+	}
+
+	double totalSampleCount = 0.0;
+	for(const glm::vec4& accumulated : colorBuffer)
+	{
+		totalSampleCount += accumulated.a;
+	}
+
+	LOG("CPU Path Tracer: " + std::to_string(passCount) + " adaptive passes in " + std::to_string(seconds) + "s, " 
+		+ std::to_string(totalSampleCount / (double(width) * height)) + " spp on average, " + std::to_string(convergedCount) + "/"
+		+ std::to_string(tileCountX * tileCountY) + " tiles below a relative error of " + std::to_string(targetError) 
+		+ ", image error: " + std::to_string(GetImageError()));
+	LogStatistics(seconds);
+}
+
+void CPUPathTracer::ClearBuffers()
+{
+	std::fill(colorBuffer.begin(), colorBuffer.end(), glm::vec4(0.0f));
+	std::fill(momentBuffer.begin(), momentBuffer.end(), 0.0f);
+	std::fill(guideBuffer.begin(), guideBuffer.end(), PixelGuides());
+	isDenoised = false;
+	frameCount = 1;
+}
+
+void CPUPathTracer::Denoise(const DenoiserSettings& settings)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	// The denoiser works on averages, the variance is the one of the mean luminance //
+	std::vector<float> color(width * height * 3);
+	std::vector<float> variance(width * height);
+	std::vector<float> albedo(width * height * 3);
+	std::vector<float> normal(width * height * 3);
+	std::vector<float> depth(width * height);
+
+	for(unsigned int i = 0; i < width * height; i++)
+	{
+		float sampleCount = std::max(colorBuffer[i].a, 1.0f);
+		glm::vec3 mean = glm::vec3(colorBuffer[i]) / sampleCount;
+		const PixelGuides& guides = guideBuffer[i];
+
+		float luminance = Luminance(mean);
+		variance[i] = FLT_MAX;
+		if(sampleCount > 1.0f)
+		{
+			variance[i] = std::max(momentBuffer[i] / sampleCount - luminance * luminance, 0.0f) / (sampleCount - 1.0f);
+		}
+
+		for(unsigned int c = 0; c < 3; c++)
+		{
+			color[i * 3 + c] = mean[c];
+			albedo[i * 3 + c] = guides.albedo[c] / sampleCount;
+			normal[i * 3 + c] = guides.normal[c] / sampleCount;
+		}
+		depth[i] = guides.depth / sampleCount;
+	}
+
+	DenoiserInput input;
+	input.width = width;
+	input.height = height;
+	input.color = color.data();
+	input.variance = variance.data();
+	input.albedo = albedo.data();
+	input.normal = normal.data();
+	input.depth = depth.data();
+
+	denoisedBuffer.resize(width * height);
+	DenoiseImage(input, settings, &denoisedBuffer[0].x);
+	isDenoised = true;
+
+	auto end = std::chrono::high_resolution_clock::now();
+	double milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+	LOG("CPU Path Tracer: denoised with " + std::to_string(settings.iterationCount) + " iterations in " 
+		+ std::to_string(milliseconds) + "ms");
+}
+
+bool CPUPathTracer::SaveImage(const std::string& filePath)
+{
+	std::string extension = filePath.substr(filePath.find_last_of('.') + 1);
+
+	if(extension == "exr")
+	{
+		std::vector<float> pixels(width * height * 3);
+		for(unsigned int i = 0; i < width * height; i++)
+		{
+			glm::vec3 color = GetPixelColor(i % width, i / width);
+			pixels[i * 3] = color.x;
+			pixels[i * 3 + 1] = color.y;
+			pixels[i * 3 + 2] = color.z;
+		}
+
+		const char* err = nullptr;
+		int result = SaveEXR(pixels.data(), width, height, 3, 0, filePath.c_str(), &err);
+		if(result != TINYEXR_SUCCESS)
+		{
+			LOG(Log::MessageType::Error, "Failed to save EXR: " + filePath);
+			if(err)
+			{
+				LOG(Log::MessageType::Error, err);
+				FreeEXRErrorMessage(err);
+			}
+
+			return false;
+		}
+
+		return true;
+	}
+
+	if(extension == "png")
+	{
+		std::vector<unsigned char> pixels(width * height * 3);
+		for(unsigned int i = 0; i < width * height; i++)
+		{
+			glm::vec3 color = Tonemap(GetPixelColor(i % width, i / width));
+			pixels[i * 3] = (unsigned char)(color.x * 255.0f + 0.5f);
+			pixels[i * 3 + 1] = (unsigned char)(color.y * 255.0f + 0.5f);
+			pixels[i * 3 + 2] = (unsigned char)(color.z * 255.0f + 0.5f);
+		}
+
+		if(!stbi_write_png(filePath.c_str(), width, height, 3, pixels.data(), width * 3))
+		{
+			LOG(Log::MessageType::Error, "Failed to save PNG: " + filePath);
+			return false;
+		}
+
+		return true;
+	}
+
+	LOG(Log::MessageType::Error, "Unsupported image extension: " + filePath);
+	return false;
+}
+
+float CPUPathTracer::GetPSNR(const std::string& referencePath)
+{
+	float* reference = nullptr;
+	int referenceWidth = 0;
+	int referenceHeight = 0;
+	const char* err = nullptr;
+
+	if(LoadEXR(&reference, &referenceWidth, &referenceHeight, referencePath.c_str(), &err) != TINYEXR_SUCCESS)
+	{
+		LOG(Log::MessageType::Error, "Failed to load reference EXR: " + referencePath);
+		if(err)
+		{
+			LOG(Log::MessageType::Error, err);
+			FreeEXRErrorMessage(err);
+		}
+
+		return -1.0f;
+	}
+
+	if(referenceWidth != int(width) || referenceHeight != int(height))
+	{
+		LOG(Log::MessageType::Error, "Reference EXR doesn't match the size of the render: " + referencePath);
+		free(reference);
+		return -1.0f;
+	}
+
+	// Compared after tonemapping, the way the image is actually seen //
+	double squaredErrorSum = 0.0;
+	for(unsigned int i = 0; i < width * height; i++)
+	{
+		glm::vec3 color = Tonemap(GetPixelColor(i % width, i / width));
+		glm::vec3 expected = Tonemap(glm::make_vec3(&reference[i * 4]));
+		glm::vec3 difference = color - expected;
+
+		squaredErrorSum += glm::dot(difference, difference);
+	}
+	free(reference);
+
+	double meanSquaredError = squaredErrorSum / (double(width) * height * 3.0);
+	return float(10.0 * log10(1.0 / std::max(meanSquaredError, 1e-12)));
+}
+
+glm::vec3 CPUPathTracer::GetPixelColor(unsigned int x, unsigned int y)
+{
+	if(isDenoised)
+	{
+		return denoisedBuffer[y * width + x];
+	}
+
+	const glm::vec4& accumulated = colorBuffer[y * width + x];
+	if(accumulated.a == 0.0f)
+	{
+		return glm::vec3(0.0f);
+	}
+
+	return glm::vec3(accumulated) / accumulated.a;
+}
+
+unsigned int CPUPathTracer::GetPixelSampleCount(unsigned int x, unsigned int y)
+{
+	return (unsigned int)colorBuffer[y * width + x].a;
+}
+
+void CPUPathTracer::SetIntegrator(Integrator integrator)
+{
+	this->integrator = integrator;
+}
+
+void CPUPathTracer::SetDepthRange(unsigned int minDepth, unsigned int maxDepth)
+{
+	this->maxDepth = std::max(maxDepth, 1u);
+	this->minDepth = std::min(std::max(minDepth, 1u), this->maxDepth);
+}
+
+void CPUPathTracer::SetSamplerType(SamplerType samplerType)
+{
+	this->samplerType = samplerType;
+}
+
+void CPUPathTracer::SetPacketTracing(bool usePacketTracing)
+{
+	this->usePacketTracing = usePacketTracing;
+}
+
+void CPUPathTracer::BenchmarkPrimaryRays(unsigned int sampleCount)
+{
+	const glm::vec3 position = glm::vec3(0.0f, 0.0f, 7.5f);
+	const unsigned int tileCount = tileCountX * tileCountY;
+
+	std::vector<glm::vec3> directions(width * height);
+	std::vector<HitInfo> hits[2] = { std::vector<HitInfo>(width * height), std::vector<HitInfo>(width * height) };
+	double seconds[2] = { 0.0, 0.0 };
+	unsigned long long mismatchCount = 0;
+
+	for(unsigned int sample = 0; sample < sampleCount; sample++)
+	{
+		// 1) Rays get generated up front, so only tracing them is timed //
+		threadPool->ParallelFor(height, [this, &directions, &position, sample](unsigned int y)
+		{
+			for(unsigned int x = 0; x < width; x++)
+			{
+				PathSampler pathSampler = GetSampler(x, y, sample);
+				directions[y * width + x] = GetRayDirection(pathSampler, x, y, position);
+			}
+		});
+
+		// 2) Trace all tiles one ray at a time, then as packets //
+		for(unsigned int mode = 0; mode < 2; mode++)
+		{
+			auto start = std::chrono::high_resolution_clock::now();
+
+			std::vector<HitInfo>& modeHits = hits[mode];
+			threadPool->ParallelFor(tileCount, [this, &directions, &modeHits, &position, mode](unsigned int tileIndex)
+			{
+				unsigned int startX = (tileIndex % tileCountX) * tileSize;
+				unsigned int startY = (tileIndex / tileCountX) * tileSize;
+				unsigned int tileWidth = std::min(startX + tileSize, width) - startX;
+				unsigned int tileHeight = std::min(startY + tileSize, height) - startY;
+
+				RayPacket packet;
+				packet.origin = position;
+				packet.rayCount = tileWidth * tileHeight;
+
+				for(unsigned int i = 0; i < packet.rayCount; i++)
+				{
+					packet.SetDirection(i, directions[(startY + i / tileWidth) * width + startX + i % tileWidth]);
+					packet.t[i] = Ray().TMax;
+				}
+
+				uint64_t hitMask = TracePrimaryRays(packet, mode == 1);
+
+				for(unsigned int i = 0; i < packet.rayCount; i++)
+				{
+					HitInfo& hit = modeHits[(startY + i / tileWidth) * width + startX + i % tileWidth];
+					hit = (hitMask & (1ull << i)) ? packet.GetHit(i) : HitInfo();
+				}
+			});
+
+			auto end = std::chrono::high_resolution_clock::now();
+			seconds[mode] += std::chrono::duration<double>(end - start).count();
+		}
+
+		// 3) Packets are only an optimization, they should find exactly the same hits //
+		for(unsigned int i = 0; i < width * height; i++)
+		{
+			const HitInfo& single = hits[0][i];
+			const HitInfo& packet = hits[1][i];
+
+			if(single.hasHit != packet.hasHit || (single.hasHit && (single.t != packet.t || 
+				single.primitiveIndex != packet.primitiveIndex || single.instanceIndex != packet.instanceIndex)))
+			{
+				mismatchCount++;
+			}
+		}
+	}
+
+	double rayCount = double(width) * height * sampleCount;
+	double singleRate = rayCount / std::max(seconds[0], 1e-9) / 1e6;
+	double packetRate = rayCount / std::max(seconds[1], 1e-9) / 1e6;
+
+	LOG("CPU Path Tracer: primary rays at " + std::to_string(width) + "x" + std::to_string(height) + ", "
+		+ std::to_string(sampleCount) + " spp on " + std::to_string(threadPool->GetThreadCount()) + " threads");
+	LOG("CPU Path Tracer: single rays " + std::to_string(singleRate) + " Mrays/s, packets " + std::to_string(packetRate)
+		+ " Mrays/s (" + std::to_string(packetRate / singleRate) + "x, " + (UsePacketAVX2() ? "AVX2" : "scalar") + ")");
+	LOG("CPU Path Tracer: " + std::to_string(mismatchCount) + " of " + std::to_string((unsigned long long)rayCount) 
+		+ " rays found a different hit as part of a packet");
+}
+
+unsigned int CPUPathTracer::GetFrameCount()
+{
+	return frameCount;
+}
+
+float CPUPathTracer::GetTileError(unsigned int tileIndex)
+{
+	unsigned int startX = (tileIndex % tileCountX) * tileSize;
+	unsigned int startY = (tileIndex / tileCountX) * tileSize;
+	unsigned int endX = std::min(startX + tileSize, width);
+	unsigned int endY = std::min(startY + tileSize, height);
+
+	double errorSum = 0.0;
+	for(unsigned int y = startY; y < endY; y++)
+	{
+		for(unsigned int x = startX; x < endX; x++)
+		{
+			float error = GetRelativeError(colorBuffer[y * width + x], momentBuffer[y * width + x]);
+			if(error == FLT_MAX)
+			{
+				return FLT_MAX;
+			}
+
+			errorSum += double(error) * error;
+		}
+	}
+
+	return float(sqrt(errorSum / ((endX - startX) * (endY - startY))));
+}
+
+float CPUPathTracer::GetImageError()
+{
+	double errorSum = 0.0;
+	for(unsigned int i = 0; i < width * height; i++)
+	{
+		float error = GetRelativeError(colorBuffer[i], momentBuffer[i]);
+		if(error == FLT_MAX)
+		{
+			return FLT_MAX;
+		}
+
+		errorSum += double(error) * error;
+	}
+
+	return float(sqrt(errorSum / (double(width) * height)));
+}
+
+void CPUPathTracer::RenderTiles(const std::vector<unsigned int>& tiles, unsigned int sampleCount)
+{
+	isDenoised = false;
+
+	// Every tile renders all the requested samples for its pixels, which keeps the 
+	// the accumulation buffer free of data races and the tasks reasonably long-lived
+	threadPool->ParallelFor(tiles.size(), [this, &tiles, sampleCount](unsigned int i)
+	{
+		RenderTile(tiles[i], sampleCount);
+	});
+}
+
+void CPUPathTracer::RenderTile(unsigned int tileIndex, unsigned int sampleCount)
+{
+	unsigned int startX = (tileIndex % tileCountX) * tileSize;
+	unsigned int startY = (tileIndex / tileCountX) * tileSize;
+	unsigned int endX = std::min(startX + tileSize, width);
+	unsigned int endY = std::min(startY + tileSize, height);
+	unsigned int tileWidth = endX - startX;
+	unsigned int pixelCount = tileWidth * (endY - startY);
+
+	const glm::vec3 position = glm::vec3(0.0f, 0.0f, 7.5f);
+
+	TileStatistics& statistics = tileStatistics[tileIndex];
+	unsigned long long tileStartCount = traceCount;
+	unsigned long long tileStartShadowCount = shadowTraceCount;
+
+	// Pixels count their own samples, since adaptive sampling skips converged tiles
+	unsigned int sampleIndices[tileSize * tileSize];
+	for(unsigned int i = 0; i < pixelCount; i++)
+	{
+		sampleIndices[i] = (unsigned int)colorBuffer[(startY + i / tileWidth) * width + startX + i % tileWidth].a;
+	}
+
+	RayPacket packet;
+	PathSampler pathSamplers[tileSize * tileSize];
+
+	for(unsigned int sample = 0; sample < sampleCount; sample++)
+	{
+		// 1) The primary rays of the tile all start at the camera, so they get traced together //
+		packet.origin = position;
+		packet.rayCount = pixelCount;
+
+		for(unsigned int i = 0; i < pixelCount; i++)
+		{
+			unsigned int x = startX + i % tileWidth;
+			unsigned int y = startY + i / tileWidth;
+
+			pathSamplers[i] = GetSampler(x, y, sampleIndices[i] + sample);
+			packet.SetDirection(i, GetRayDirection(pathSamplers[i], x, y, position));
+			packet.t[i] = Ray().TMax;
+		}
+
+		uint64_t hitMask = TracePrimaryRays(packet, usePacketTracing);
+
+		// 2) Every pixel continues its own path from the first hit //
+		for(unsigned int i = 0; i < pixelCount; i++)
+		{
+			unsigned int pixelIndex = (startY + i / tileWidth) * width + startX + i % tileWidth;
+			glm::vec4& accumulated = colorBuffer[pixelIndex];
+			float& moment = momentBuffer[pixelIndex];
+			PixelGuides& guides = guideBuffer[pixelIndex];
+
+			Ray ray;
+			ray.Origin = position;
+			ray.Direction = packet.GetDirection(i);
+
+			HitInfo hit;
+			hit.t = ray.TMax;
+			if(hitMask & (1ull << i))
+			{
+				hit = packet.GetHit(i);
+			}
+
+			unsigned long long sampleStartCount = traceCount;
+			traceCount++;
+
+			glm::vec3 color = glm::vec3(0.0f);
+			if(integrator == Integrator::Iterative)
+			{
+				color = TracePath(ray, hit, pathSamplers[i], guides);
+			}
+			else
+			{
+				color = hit.hasHit ? ClosestHit(ray, GetPrimaryRayCone(float(height)), hit, pathSamplers[i], 0) : Miss(ray, 0.0f);
+				TraceGuides(ray, hit, guides);
+			}
+
+			float luminance = Luminance(color);
+			accumulated += glm::vec4(color, 1.0f);
+			moment += luminance * luminance;
+			statistics.maxRayCount = std::max(statistics.maxRayCount, (unsigned int)(traceCount - sampleStartCount));
+		}
+	}
+
+	statistics.rayCount += traceCount - tileStartCount;
+	statistics.shadowRayCount += shadowTraceCount - tileStartShadowCount;
+	statistics.sampleCount += (unsigned long long)pixelCount * sampleCount;
+}
+
+uint64_t CPUPathTracer::TracePrimaryRays(RayPacket& packet, bool usePacketTracing)
+{
+	if(usePacketTracing)
+	{
+		packet.Prepare();
+		return scene->GetTLAS()->IntersectPacket(packet);
+	}
+
+	uint64_t hitMask = 0;
+	for(unsigned int i = 0; i < packet.rayCount; i++)
+	{
+		Ray ray;
+		ray.Origin = packet.origin;
+		ray.Direction = packet.GetDirection(i);
+		ray.TMin = packet.tMin;
+
+		HitInfo hit;
+		hit.t = packet.t[i];
+
+		if(scene->GetTLAS()->Intersect(ray, hit))
+		{
+			packet.t[i] = hit.t;
+			packet.u[i] = hit.bary.x;
+			packet.v[i] = hit.bary.y;
+			packet.primitiveIndex[i] = hit.primitiveIndex;
+			packet.instanceIndex[i] = hit.instanceIndex;
+			hitMask |= 1ull << i;
+		}
+	}
+
+	return hitMask;
+}
+
+void CPUPathTracer::LogStatistics(double seconds)
+{
+	TileStatistics total;
+	for(TileStatistics& statistics : tileStatistics)
+	{
+		total.rayCount += statistics.rayCount;
+		total.shadowRayCount += statistics.shadowRayCount;
+		total.sampleCount += statistics.sampleCount;
+		total.maxRayCount = std::max(total.maxRayCount, statistics.maxRayCount);
+		statistics = TileStatistics();
+	}
+
+	double samples = double(std::max(total.sampleCount, 1ull));
+	double samplesPerSecond = samples / std::max(seconds, 1e-9);
+	double raysPerSample = double(total.rayCount) / samples;
+	double pathLength = double(total.rayCount - total.shadowRayCount) / samples;
+
+	LOG("CPU Path Tracer: " + std::to_string(samplesPerSecond / 1e6) + " Msamples/s on " 
+		+ std::to_string(threadPool->GetThreadCount()) + " threads");
+	LOG("CPU Path Tracer: " + std::string(integrator == Integrator::Iterative ? "iterative" : "recursive") + " integrator, "
+		+ std::to_string(raysPerSample) + " rays per sample on average, " + std::to_string(total.maxRayCount) + " at most, "
+		+ "average path length of " + std::to_string(pathLength) + " rays");
+}
+
+#pragma region Shader Mirrors
+PathSampler CPUPathTracer::GetSampler(unsigned int x, unsigned int y, unsigned int sampleIndex)
+{
+	return InitializeSampler(samplerType, x, y, width, sampleIndex);
+}
+
+glm::vec3 CPUPathTracer::GetRayDirection(PathSampler& pathSampler, unsigned int x, unsigned int y, const glm::vec3& cameraPosition)
+{
+	// 1) Get a random location within a given pixel //
+	glm::vec2 stochastic = Random2D(pathSampler);
+
+	glm::vec2 dimensions = glm::vec2(width, height);
+	glm::vec2 uv = (glm::vec2(x, y) + stochastic) / dimensions;
+
+	// 2) Setup virtual screen plane //
+	float aspectRatio = dimensions.x / dimensions.y;
+	float xOffset = (aspectRatio - 1.0f) * 0.5f;
+
+	glm::vec3 direction = glm::vec3(0.0f, 0.0f, -1.0f);
+	float planeOffset = 2.0f;
+
+	glm::vec3 screenCenter = cameraPosition + (direction * planeOffset);
+
+	glm::vec3 screenP0 = screenCenter + glm::vec3(-0.5f - xOffset, 0.5f, 0.0f);
+	glm::vec3 screenP1 = screenCenter + glm::vec3(0.5f + xOffset, 0.5f, 0.0f);
+	glm::vec3 screenP2 = screenCenter + glm::vec3(-0.5f - xOffset, -0.5f, 0.0f);
+
+	glm::vec3 screenU = screenP1 - screenP0;
+	glm::vec3 screenV = screenP2 - screenP0;
+
+	// 3) Use the plane to find our given ray direction //
+	glm::vec3 screenPoint = screenP0 + (screenU * uv.x) + (screenV * uv.y);
+	return glm::normalize(screenPoint - cameraPosition);
+}
+
+glm::vec3 CPUPathTracer::TraceRay(const Ray& ray, const RayCone& cone, PathSampler pathSampler, unsigned int depth, float bsdfPdf)
+{
+	HitInfo hit;
+	hit.t = ray.TMax;
+	traceCount++;
+
+	if(scene->GetTLAS()->Intersect(ray, hit))
+	{
+		return ClosestHit(ray, cone, hit, pathSampler, depth);
+	}
+
+	return Miss(ray, bsdfPdf);
+}
+
+glm::vec3 CPUPathTracer::TracePath(Ray ray, HitInfo hit, PathSampler pathSampler, PixelGuides& guides)
+{
+	glm::vec3 radiance = glm::vec3(0.0f);
+	glm::vec3 throughput = glm::vec3(1.0f);
+	float bsdfPdf = 0.0f;
+	RayCone cone = GetPrimaryRayCone(float(height));
+
+	// Every hit samples a single lobe & hands back the next ray, so a path traces at most 'maxDepth' rays //
+	for(unsigned int depth = 0; depth < maxDepth; depth++)
+	{
+		if(depth > 0)
+		{
+			hit = HitInfo();
+			hit.t = ray.TMax;
+			traceCount++;
+
+			scene->GetTLAS()->Intersect(ray, hit);
+		}
+
+		if(!hit.hasHit)
+		{
+			radiance += throughput * Miss(ray, bsdfPdf);
+
+			// The environment has no surface, the denoiser leaves it as it is //
+			if(depth == 0)
+			{
+				guides.albedo += glm::vec3(1.0f);
+				guides.depth += ray.TMax;
+			}
+			break;
+		}
+
+		// The last ray of a path only looks for the environment, like the deepest rays of the ray trees //
+		if(depth + 1 >= maxDepth)
+		{
+			break;
+		}
+
+		PathSegment segment;
+		SetBounceDimension(pathSampler, depth);
+		SampleSurface(ray, cone, hit, pathSampler, segment);
+
+		if(depth == 0)
+		{
+			guides.albedo += segment.albedo;
+			guides.normal += segment.normal;
+			guides.depth += hit.t;
+		}
+
+		radiance += throughput * segment.radiance;
+		throughput *= segment.throughput;
+
+		float survivalProbability = std::min(std::max(throughput.x, std::max(throughput.y, throughput.z)), 1.0f);
+		if(survivalProbability <= 0.0f)
+		{
+			break;
+		}
+
+		// Russian roulette, dim paths get ended early once they traced 'minDepth' rays. 
+		// The survivors make up for them through a higher weight //
+		if(depth + 1 >= minDepth)
+		{
+			if(Random01(pathSampler) >= survivalProbability)
+			{
+				break;
+			}
+
+			throughput /= survivalProbability;
+		}
+
+		ray = segment.nextRay;
+		cone = segment.nextCone;
+		bsdfPdf = segment.bsdfPdf;
+	}
+
+	return radiance;
+}
+
+void CPUPathTracer::TraceGuides(const Ray& ray, const HitInfo& hit, PixelGuides& guides)
+{
+	// The environment has no surface, the denoiser leaves it as it is //
+	if(!hit.hasHit)
+	{
+		guides.albedo += glm::vec3(1.0f);
+		guides.depth += ray.TMax;
+		return;
+	}
+
+	Surface surface;
+	GetSurface(ray, hit, PropagateRayCone(GetPrimaryRayCone(float(height)), hit.t).width, surface);
+
+	guides.albedo += surface.albedo;
+	guides.normal += surface.normal;
+	guides.depth += hit.t;
+}
+
+glm::vec3 CPUPathTracer::ClosestHit(const Ray& ray, const RayCone& cone, const HitInfo& hit, PathSampler pathSampler, unsigned int depth)
+{
+	// Handle ray-tree depth //
+	depth += 1;
+	if(depth >= maxTreeDepth)
+	{
+		return glm::vec3(0.0f);
+	}
+
+	// The footprint of the path at this hit, the rays spawned here start from it //
+	RayCone hitCone = PropagateRayCone(cone, hit.t);
+
+	Surface surface;
+	GetSurface(ray, hit, hitCone.width, surface);
+
+	const Material& material = *surface.material;
+	const glm::vec3& albedo = surface.albedo;
+	const glm::vec3& normal = surface.normal;
+	float roughness = surface.roughness;
+
+	// Calculate Radiance //
+	glm::vec3 colorOutput = glm::vec3(0.0f);
+	switch(material.materialType)
+	{
+	case 0: // Pure Diffuse
+		colorOutput = ComputePureDiffuse(ray, hit.t, hitCone, albedo, normal, pathSampler, depth);
+		break;
+	case 1: // Dielectric 
+		colorOutput = ComputeDielectricRadiance(ray, hit.t, hitCone, material, albedo, normal, roughness, pathSampler, depth);
+		break;
+	case 2: // Conductor
+		colorOutput = ComputeConductorRadiance(ray, hit.t, hitCone, albedo, normal, roughness, pathSampler, depth);
+		break;
+	case 3: // Transmissive (Glass)
+		colorOutput = ComputeTransmissionRadiance(ray, hit.t, hitCone, material, albedo, normal, pathSampler, depth);
+		break;
+	case 4: // Emissive 
+		colorOutput = albedo;
+		break;
+	}
+
+	return colorOutput;
+}
+
+void CPUPathTracer::SampleSurface(const Ray& ray, const RayCone& cone, const HitInfo& hit, PathSampler& pathSampler, PathSegment& segment)
+{
+	segment.radiance = glm::vec3(0.0f);
+	segment.throughput = glm::vec3(0.0f);
+	segment.bsdfPdf = 0.0f;
+
+	// The footprint of the path at this hit, the next ray starts from it //
+	segment.nextCone = PropagateRayCone(cone, hit.t);
+
+	Surface surface;
+	GetSurface(ray, hit, segment.nextCone.width, surface);
+
+	const Material& material = *surface.material;
+	const glm::vec3& albedo = surface.albedo;
+	const glm::vec3& normal = surface.normal;
+	segment.albedo = albedo;
+	segment.normal = normal;
+
+	glm::vec3 intersection = ray.Origin + ray.Direction * hit.t;
+	segment.nextRay.Origin = intersection;
+
+	// Instead of tracing every lobe, one gets picked. Dividing by the odds of picking it keeps the estimate unbiased //
+	switch(material.materialType)
+	{
+	case 0: // Pure Diffuse
+	{
+		segment.radiance = SampleEnvironmentLight(intersection, normal, albedo / float(PI), pathSampler);
+
+		segment.nextRay.Direction = CosineHemisphereDirection(pathSampler, normal);
+		segment.bsdfPdf = glm::dot(normal, segment.nextRay.Direction) / float(PI);
+		segment.throughput = albedo;
+		segment.nextCone = ScatterRayCone(segment.nextCone, 1.0f);
+		break;
+	}
+	case 1: // Dielectric
+	{
+		float fresnel = Fresnel(ray.Direction, normal, material.IOR);
+		float specularFactor = glm::clamp(material.specularity + fresnel, material.specularity, 1.0f);
+		float diffuseFactor = 1.0f - specularFactor;
+
+		// Lobes the ray trees skip are never picked either //
+		float diffuseWeight = diffuseFactor > 0.01f ? diffuseFactor : 0.0f;
+		float specularWeight = specularFactor > 0.01f ? specularFactor : 0.0f;
+		if(diffuseWeight + specularWeight <= 0.0f)
+		{
+			break;
+		}
+
+		float diffuseProbability = diffuseWeight / (diffuseWeight + specularWeight);
+		if(diffuseWeight > 0.0f)
+		{
+			segment.radiance = SampleEnvironmentLight(intersection, normal, albedo / float(PI), pathSampler) * diffuseFactor;
+		}
+
+		if(Random01(pathSampler) < diffuseProbability)
+		{
+			segment.nextRay.Direction = CosineHemisphereDirection(pathSampler, normal);
+			segment.bsdfPdf = glm::clamp(glm::dot(normal, segment.nextRay.Direction), 0.0f, 1.0f) / float(PI);
+			segment.throughput = albedo * diffuseFactor / diffuseProbability;
+			segment.nextCone = ScatterRayCone(segment.nextCone, 1.0f);
+		}
+		else
+		{
+			float weight = 1.0f;
+			segment.nextRay.Direction = Reflect(ray.Direction, normal);
+
+			if(surface.roughness > 0.0f)
+			{
+				segment.nextRay.Direction = SampleGGXReflection(ray.Direction, normal, surface.roughness, pathSampler, weight);
+			}
+
+			segment.throughput = albedo * specularFactor * weight / (1.0f - diffuseProbability);
+			segment.nextCone = ScatterRayCone(segment.nextCone, surface.roughness);
+		}
+		break;
+	}
+	case 2: // Conductor
+	{
+		float weight = 1.0f;
+		segment.nextRay.Direction = Reflect(ray.Direction, normal);
+
+		if(surface.roughness > 0.0f)
+		{
+			segment.nextRay.Direction = SampleGGXReflection(ray.Direction, normal, surface.roughness, pathSampler, weight);
+		}
+
+		segment.throughput = albedo * weight;
+		segment.nextCone = ScatterRayCone(segment.nextCone, surface.roughness);
+		break;
+	}
+	case 3: // Transmissive (Glass)
+	{
+		float reflectance = Fresnel(ray.Direction, normal, material.IOR);
+		if(reflectance >= 1.0f || Random01(pathSampler) < reflectance)
+		{
+			segment.nextRay.Direction = Reflect(ray.Direction, normal);
+		}
+		else
+		{
+			segment.nextRay.Direction = Refract(ray.Direction, normal, material.IOR);
+			segment.nextRay.TMin = 0.01f;
+		}
+
+		segment.throughput = albedo;
+		break;
+	}
+	case 4: // Emissive
+		segment.radiance = albedo;
+		break;
+	}
+}
+
+void CPUPathTracer::GetSurface(const Ray& ray, const HitInfo& hit, float coneWidth, Surface& surface)
+{
+	CPUInstance& instance = scene->GetTLAS()->GetInstance(hit.instanceIndex);
+	CPUMesh* mesh = instance.mesh;
+
+	// Same binding rules as the shader table in 'RayTraceStage'
+	const Material& material = instance.model->useSingleMaterial ? instance.model->GetMesh(0)->material : mesh->material;
+
+	// Vertex Data //
+	const Vertex& a = mesh->GetVertex(hit.primitiveIndex, 0);
+	const Vertex& b = mesh->GetVertex(hit.primitiveIndex, 1);
+	const Vertex& c = mesh->GetVertex(hit.primitiveIndex, 2);
+
+	glm::vec3 baryCoords = glm::vec3(1.0f - hit.bary.x - hit.bary.y, hit.bary.x, hit.bary.y);
+
+	glm::vec3 normal = a.Normal * baryCoords.x + b.Normal * baryCoords.y + c.Normal * baryCoords.z;
+	glm::vec3 tangent = glm::vec3(a.Tangent * baryCoords.x + b.Tangent * baryCoords.y + c.Tangent * baryCoords.z);
+	float bitangentSign = a.Tangent.w;
+	glm::vec2 uv = a.TextureCoord0 * baryCoords.x + b.TextureCoord0 * baryCoords.y + c.TextureCoord0 * baryCoords.z;
+
+	normal = glm::normalize(glm::vec3(instance.transform * glm::vec4(normal, 0.0f)));
+	tangent = glm::normalize(glm::vec3(instance.transform * glm::vec4(tangent, 0.0f)));
+
+	// Texture LOD //
+	float rayConeLOD = ComputeRayConeLOD(glm::vec3(instance.transform * glm::vec4(a.Position, 1.0f)),
+		glm::vec3(instance.transform * glm::vec4(b.Position, 1.0f)), glm::vec3(instance.transform * glm::vec4(c.Position, 1.0f)),
+		a.TextureCoord0, b.TextureCoord0, c.TextureCoord0, ray.Direction, coneWidth);
+
+	glm::vec3 albedo = glm::make_vec3(material.color);
+	if(material.hasDiffuse && mesh->diffuseTexture)
+	{
+		CPUTexture* texture = mesh->diffuseTexture;
+		float lod = GetTextureLOD(rayConeLOD, float(texture->GetWidth()), float(texture->GetHeight()));
+		albedo = glm::vec3(texture->SampleLevel(uv, lod)) * albedo;
+	}
+
+	if(material.hasNormal && mesh->normalTexture)
+	{
+		glm::vec3 biTangent = glm::cross(normal, tangent) * bitangentSign;
+		glm::mat3 TBN = glm::mat3(tangent, biTangent, normal);
+
+		// Normal maps are stored as BC5, which only keeps X & Y //
+		CPUTexture* texture = mesh->normalTexture;
+		float lod = GetTextureLOD(rayConeLOD, float(texture->GetWidth()), float(texture->GetHeight()));
+		glm::vec2 xy = (glm::vec2(texture->SampleLevel(uv, lod)) * 2.0f) - glm::vec2(1.0f);
+		glm::vec3 n = glm::vec3(xy, sqrtf(glm::clamp(1.0f - glm::dot(xy, xy), 0.0f, 1.0f)));
+		normal = glm::normalize(TBN * n);
+	}
+
+	float roughness = material.roughness;
+	if(material.hasORM && mesh->ORMTexture)
+	{
+		CPUTexture* texture = mesh->ORMTexture;
+		float lod = GetTextureLOD(rayConeLOD, float(texture->GetWidth()), float(texture->GetHeight()));
+		roughness = glm::clamp(texture->SampleLevel(uv, lod).g, material.roughness, 1.0f);
+	}
+
+	surface.material = &material;
+	surface.albedo = albedo;
+	surface.normal = normal;
+	surface.roughness = roughness;
+}
+
+glm::vec3 CPUPathTracer::Miss(const Ray& ray, float bsdfPdf)
+{
+	CPUTexture* environmentMap = scene->GetEnvironmentMap();
+
+	// Without an environment map, fall back on the gradient the shader has as well
+	if(!environmentMap)
+	{
+		float y = (ray.Direction.y + 1.0f) * 0.5f;
+		return glm::vec3(y);
+	}
+
+	// Use environment map //
+	float theta = acosf(ray.Direction.y);
+	float phi = atan2f(ray.Direction.z, ray.Direction.x) + float(PI);
+
+	float u = phi / float(2.0 * PI);
+	float v = theta / float(PI);
+
+	unsigned int width = environmentMap->GetWidth();
+	unsigned int height = environmentMap->GetHeight();
+
+	int i = int(u * width);
+	int j = int(v * height);
+
+	i = i % width;
+	j = j % height;
+	glm::vec3 environmentSample = environmentMap->Load(i, j);
+	environmentSample = glm::clamp(environmentSample, glm::vec3(0.0f), glm::vec3(100.0f));
+
+	// BSDF samples share the environment with 'SampleEnvironmentLight', so they get weighted through MIS //
+	const std::vector<float>& distribution = scene->GetEnvironmentDistribution();
+	if(bsdfPdf > 0.0f && !distribution.empty())
+	{
+		float lightPdf = GetEnvironmentPDF(distribution.data(), width, height, ray.Direction);
+		environmentSample *= PowerHeuristic(bsdfPdf, lightPdf);
+	}
+
+	return environmentSample;
+}
+
+glm::vec3 CPUPathTracer::SampleEnvironmentLight(const glm::vec3& position, const glm::vec3& normal,
+	const glm::vec3& BRDF, PathSampler& pathSampler)
+{
+	// Next event estimation, a shadow ray goes towards a point on the environment map picked by its brightness //
+	const std::vector<float>& distribution = scene->GetEnvironmentDistribution();
+	if(distribution.empty())
+	{
+		return glm::vec3(0.0f);
+	}
+
+	CPUTexture* environmentMap = scene->GetEnvironmentMap();
+
+	float lightPdf;
+	glm::vec3 direction = SampleEnvironment(distribution.data(), environmentMap->GetWidth(), 
+		environmentMap->GetHeight(), pathSampler, lightPdf);
+
+	float cosI = glm::dot(normal, direction);
+	if(cosI <= 0.0f || lightPdf <= 0.0f)
+	{
+		return glm::vec3(0.0f);
+	}
+
+	Ray shadowRay;
+	shadowRay.Origin = position;
+	shadowRay.Direction = direction;
+
+	HitInfo hit;
+	hit.t = shadowRay.TMax;
+	traceCount++;
+	shadowTraceCount++;
+
+	if(scene->GetTLAS()->Intersect(shadowRay, hit, true))
+	{
+		return glm::vec3(0.0f);
+	}
+
+	// The cosine weighted sampling of the diffuse BSDF could've picked this direction as well //
+	float weight = PowerHeuristic(lightPdf, cosI / float(PI));
+	return Miss(shadowRay, 0.0f) * BRDF * cosI * weight / lightPdf;
+}
+
+glm::vec3 CPUPathTracer::ComputePureDiffuse(const Ray& ray, float t, const RayCone& cone, const glm::vec3& albedo,
+	const glm::vec3& normal, PathSampler pathSampler, unsigned int depth)
+{
+	glm::vec3 BRDF = albedo / float(PI);
+	glm::vec3 intersection = ray.Origin + ray.Direction * t;
+	glm::vec3 radiance = SampleEnvironmentLight(intersection, normal, BRDF, pathSampler);
+
+	// The PDF of cosine weighted sampling cancels the BRDF & cosine, only the albedo is left //
+	glm::vec3 direction = CosineHemisphereDirection(pathSampler, normal);
+	float cosI = glm::dot(normal, direction);
+
+	Ray diffuseRay;
+	diffuseRay.Origin = intersection;
+	diffuseRay.Direction = direction;
+
+	return radiance + TraceRay(diffuseRay, ScatterRayCone(cone, 1.0f), pathSampler, depth, cosI / float(PI)) * albedo;
+}
+
+glm::vec3 CPUPathTracer::ComputeDielectricRadiance(const Ray& ray, float t, const RayCone& cone, const Material& material, const glm::vec3& albedo,
+	const glm::vec3& normal, float roughness, PathSampler pathSampler, unsigned int depth)
+{
+	glm::vec3 radiance = glm::vec3(0.0f);
+	glm::vec3 intersection = ray.Origin + ray.Direction * t;
+
+	float fresnel = Fresnel(ray.Direction, normal, material.IOR);
+	float specularFactor = glm::clamp(material.specularity + fresnel, material.specularity, 1.0f);
+	float diffuseFactor = 1.0f - specularFactor;
+
+	if(diffuseFactor > 0.01f)
+	{
+		glm::vec3 BRDF = albedo / float(PI);
+		radiance += SampleEnvironmentLight(intersection, normal, BRDF, pathSampler) * diffuseFactor;
+
+		glm::vec3 direction = CosineHemisphereDirection(pathSampler, normal);
+		float cosI = glm::clamp(glm::dot(normal, direction), 0.0f, 1.0f);
+
+		Ray diffuseRay;
+		diffuseRay.Origin = intersection;
+		diffuseRay.Direction = direction;
+
+		radiance += TraceRay(diffuseRay, ScatterRayCone(cone, 1.0f), pathSampler, depth, cosI / float(PI)) * albedo * diffuseFactor;
+	}
+
+	if(specularFactor > 0.01f)
+	{
+		glm::vec3 direction = Reflect(ray.Direction, normal);
+		float weight = 1.0f;
+
+		if(roughness > 0.0f)
+		{
+			direction = SampleGGXReflection(ray.Direction, normal, roughness, pathSampler, weight);
+		}
+
+		if(weight > 0.0f)
+		{
+			Ray reflectRay;
+			reflectRay.Origin = intersection;
+			reflectRay.Direction = direction;
+
+			radiance += TraceRay(reflectRay, ScatterRayCone(cone, roughness), pathSampler, depth) * albedo * specularFactor * weight;
+		}
+	}
+
+	return radiance;
+}
+
+glm::vec3 CPUPathTracer::ComputeConductorRadiance(const Ray& ray, float t, const RayCone& cone, const glm::vec3& albedo,
+	const glm::vec3& normal, float roughness, PathSampler pathSampler, unsigned int depth)
+{
+	glm::vec3 direction = Reflect(ray.Direction, normal);
+	float weight = 1.0f;
+
+	if(roughness > 0.0f)
+	{
+		direction = SampleGGXReflection(ray.Direction, normal, roughness, pathSampler, weight);
+		if(weight <= 0.0f)
+		{
+			return glm::vec3(0.0f);
+		}
+	}
+
+	Ray reflectRay;
+	reflectRay.Origin = ray.Origin + ray.Direction * t;
+	reflectRay.Direction = direction;
+
+	return TraceRay(reflectRay, ScatterRayCone(cone, roughness), pathSampler, depth) * albedo * weight;
+}
+
+glm::vec3 CPUPathTracer::ComputeTransmissionRadiance(const Ray& ray, float t, const RayCone& cone, const Material& material, const glm::vec3& albedo,
+	const glm::vec3& normal, PathSampler pathSampler, unsigned int depth)
+{
+	glm::vec3 radiance = glm::vec3(0.0f);
+
+	float reflectance = Fresnel(ray.Direction, normal, material.IOR);
+	float transmittance = 1.0f - reflectance;
+	glm::vec3 intersection = ray.Origin + ray.Direction * t;
+
+	if(reflectance > 0.0f)
+	{
+		Ray reflectRay;
+		reflectRay.Origin = intersection;
+		reflectRay.Direction = Reflect(ray.Direction, normal);
+
+		radiance += TraceRay(reflectRay, cone, pathSampler, depth) * albedo * reflectance;
+	}
+
+	if(transmittance > 0.0f)
+	{
+		Ray refractRay;
+		refractRay.Origin = intersection;
+		refractRay.Direction = Refract(ray.Direction, normal, material.IOR);
+		refractRay.TMin = 0.01f;
+
+		radiance += TraceRay(refractRay, cone, pathSampler, depth) * albedo * transmittance;
+	}
+
+	return radiance;
+}
+#pragma endregion
+
+glm::vec3 CPUPathTracer::Tonemap(glm::vec3 color)
+{
+	// Matches the tonemapping & gamma correction at the end of 'RayGen'
+	color *= 0.545f;
+	float a = 2.51f;
+	float b = 0.03f;
+	float c = 2.43f;
+	float d = 0.59f;
+	float e = 0.14f;
+	color = (color * (a * color + b)) / (color * (c * color + d) + e);
+
+	float gammaInverse = 1.0f / 2.4f;
+	color.x = powf(glm::clamp(color.x, 0.0f, 1.0f), gammaInverse);
+	color.y = powf(glm::clamp(color.y, 0.0f, 1.0f), gammaInverse);
+	color.z = powf(glm::clamp(color.z, 0.0f, 1.0f), gammaInverse);
+
+	return color;
+}
\ No newline at end of file
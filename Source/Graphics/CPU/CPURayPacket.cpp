@@ -0,0 +1,36 @@
+#include "Graphics/CPU/CPURayPacket.h"
+
+#if defined(_WIN32)
+#include <Windows.h>
+
+// Older SDKs don't know the flag yet
+#ifndef PF_AVX2_INSTRUCTIONS_AVAILABLE
+#define PF_AVX2_INSTRUCTIONS_AVAILABLE 40
+#endif
+#endif
+
+// Checked once, the answer can't change while running //
+static bool isPacketAVX2Enabled = IsAVX2Supported();
+
+bool IsAVX2Supported()
+{
+#if !defined(PACKET_AVX2)
+	return false;
+#elif defined(_WIN32)
+	// Also checks whether the OS saves the AVX registers
+	return IsProcessorFeaturePresent(PF_AVX2_INSTRUCTIONS_AVAILABLE) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+
+void SetPacketAVX2(bool isEnabled)
+{
+	isPacketAVX2Enabled = isEnabled && IsAVX2Supported();
+}
+
+bool UsePacketAVX2()
+{
+	return isPacketAVX2Enabled;
+}
\ No newline at end of file
@@ -0,0 +1,330 @@
+#include "Graphics/CPU/CPUSamplingTest.h"
+#include "Graphics/CPU/CPUCommon.h"
+#include "Graphics/EnvironmentDistribution.h"
+#include "Utilities/Logger.h"
+
+#include <cmath>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Bins over cos(theta) in [0, 1] & phi, directions below the horizon get a bin of their own
+static const int thetaBinCount = 20;
+static const int phiBinCount = 40;
+
+// Points per axis the PDF gets evaluated at, to integrate it over a bin. The reflection of a smooth 
+// surface seen at a grazing angle is a narrow lobe, fewer points underestimate it by several percent
+static const int integrationResolution = 48;
+
+// Bins that expect fewer samples are merged, below that the chi-square distribution is a poor approximation
+static const double minExpectedCount = 5.0;
+
+// Regularized upper incomplete gamma function Q(a, x), with a series below a + 1 & a continued fraction above it
+static double IncompleteGammaQ(double a, double x)
+{
+	if(x <= 0.0)
+	{
+		return 1.0;
+	}
+
+	double logPrefix = -x + a * log(x) - lgamma(a);
+
+	if(x < a + 1.0)
+	{
+		double term = 1.0 / a;
+		double sum = term;
+		for(int n = 1; n < 1000 && fabs(term) > fabs(sum) * 1e-14; n++)
+		{
+			term *= x / (a + n);
+			sum += term;
+		}
+
+		return 1.0 - sum * exp(logPrefix);
+	}
+
+	// Modified Lentz's method //
+	double b = x + 1.0 - a;
+	double c = 1e300;
+	double d = 1.0 / b;
+	double result = d;
+	for(int i = 1; i < 1000; i++)
+	{
+		double an = -i * (i - a);
+		b += 2.0;
+		d = an * d + b;
+		d = 1.0 / (fabs(d) < 1e-300 ? 1e-300 : d);
+		c = b + an / c;
+		c = fabs(c) < 1e-300 ? 1e-300 : c;
+
+		double delta = d * c;
+		result *= delta;
+		if(fabs(delta - 1.0) < 1e-14)
+		{
+			break;
+		}
+	}
+
+	return exp(logPrefix) * result;
+}
+
+// 'sample' returns false for samples that have no direction (weight 0), they count as below the horizon.
+// Returns the p-value, the chance of a deviation at least this large when the samples do follow the PDF
+static double ChiSquareTest(const std::string& name, unsigned int sampleCount, 
+	const std::function<bool(PathSampler&, glm::vec3&)>& sample, const std::function<double(const glm::vec3&)>& pdf)
+{
+	const int binCount = thetaBinCount * phiBinCount;
+	std::vector<double> observed(binCount + 1, 0.0);
+	std::vector<double> expected(binCount + 1, 0.0);
+
+	// 1) Bin the samples //
+	PathSampler pathSampler = InitializeSampler(SamplerType::Random, 0, 0, 1, 0);
+	for(unsigned int i = 0; i < sampleCount; i++)
+	{
+		glm::vec3 direction;
+		if(!sample(pathSampler, direction) || direction.z <= 0.0f)
+		{
+			observed[binCount]++;
+			continue;
+		}
+
+		double phi = atan2(direction.y, direction.x);
+		phi = phi < 0.0 ? phi + 2.0 * PI : phi;
+
+		int thetaBin = std::min(int(direction.z * thetaBinCount), thetaBinCount - 1);
+		int phiBin = std::min(int(phi / (2.0 * PI) * phiBinCount), phiBinCount - 1);
+		observed[thetaBin * phiBinCount + phiBin]++;
+	}
+
+	// 2) Integrate the PDF over every bin, since the bins are uniform in cos(theta) & phi they all have the same solid angle //
+	const double binArea = (1.0 / thetaBinCount) * (2.0 * PI / phiBinCount);
+	double expectedTotal = 0.0;
+
+	for(int thetaBin = 0; thetaBin < thetaBinCount; thetaBin++)
+	{
+		for(int phiBin = 0; phiBin < phiBinCount; phiBin++)
+		{
+			double pdfSum = 0.0;
+			for(int i = 0; i < integrationResolution; i++)
+			{
+				for(int j = 0; j < integrationResolution; j++)
+				{
+					double z = (thetaBin + (i + 0.5) / integrationResolution) / thetaBinCount;
+					double phi = (phiBin + (j + 0.5) / integrationResolution) / phiBinCount * 2.0 * PI;
+					double r = sqrt(std::max(1.0 - z * z, 0.0));
+					pdfSum += pdf(glm::vec3(r * cos(phi), r * sin(phi), z));
+				}
+			}
+
+			double binExpected = pdfSum / (integrationResolution * integrationResolution) * binArea * sampleCount;
+			expected[thetaBin * phiBinCount + phiBin] = binExpected;
+			expectedTotal += binExpected;
+		}
+	}
+
+	// Whatever the PDF doesn't cover ends up below the horizon
+	expected[binCount] = std::max(double(sampleCount) - expectedTotal, 0.0);
+
+	// 3) Pearson's statistic, sparse bins get pooled together //
+	double chiSquare = 0.0;
+	double pooledObserved = 0.0;
+	double pooledExpected = 0.0;
+	int degreesOfFreedom = -1;
+
+	for(int i = 0; i <= binCount; i++)
+	{
+		if(expected[i] < minExpectedCount)
+		{
+			pooledObserved += observed[i];
+			pooledExpected += expected[i];
+			continue;
+		}
+
+		chiSquare += (observed[i] - expected[i]) * (observed[i] - expected[i]) / expected[i];
+		degreesOfFreedom++;
+	}
+
+	if(pooledExpected >= minExpectedCount)
+	{
+		chiSquare += (pooledObserved - pooledExpected) * (pooledObserved - pooledExpected) / pooledExpected;
+		degreesOfFreedom++;
+	}
+
+	double pValue = IncompleteGammaQ(degreesOfFreedom * 0.5, chiSquare * 0.5);
+
+	LOG(name + ": chi-square " + std::to_string(chiSquare) + " with " + std::to_string(degreesOfFreedom) 
+		+ " degrees of freedom, p-value " + std::to_string(pValue) + ", PDF integrates to " 
+		+ std::to_string(expectedTotal / sampleCount));
+
+	return pValue;
+}
+
+// Environment map with a gradient sky, a black band below the horizon, a bright spot & a pixel beyond the clamp
+static std::vector<float> CreateTestEnvironment(unsigned int width, unsigned int height)
+{
+	std::vector<float> environment(size_t(width) * height * 4, 0.0f);
+	for(unsigned int y = 0; y < height; y++)
+	{
+		for(unsigned int x = 0; x < width; x++)
+		{
+			float* pixel = &environment[(size_t(y) * width + x) * 4];
+			float sky = y >= height * 5 / 8 && y < height * 6 / 8 ? 0.0f : 1.0f + float(x) / width;
+			float spot = x >= width / 2 && x < width / 2 + 4 && y >= height / 4 && y < height / 4 + 3 ? 40.0f : 0.0f;
+
+			pixel[0] = sky * 0.5f + spot;
+			pixel[1] = sky * 0.8f + spot;
+			pixel[2] = sky + spot;
+			pixel[3] = 1.0f;
+		}
+	}
+
+	float* clampedPixel = &environment[(size_t(height / 2) * width + width / 4) * 4];
+	clampedPixel[0] = clampedPixel[1] = clampedPixel[2] = 1000.0f;
+	return environment;
+}
+
+// Chance of picking every pixel: its luminance times the solid angle it covers, straight from the image
+// instead of through the CDFs of 'BuildEnvironmentDistribution'
+static std::vector<double> GetTestEnvironmentProbabilities(const std::vector<float>& environment, unsigned int width, unsigned int height)
+{
+	std::vector<double> probabilities(size_t(width) * height);
+	double total = 0.0;
+
+	for(unsigned int y = 0; y < height; y++)
+	{
+		for(unsigned int x = 0; x < width; x++)
+		{
+			const float* pixel = &environment[(size_t(y) * width + x) * 4];
+			double luminance = 0.2126 * std::min(pixel[0], 100.0f) + 0.7152 * std::min(pixel[1], 100.0f) + 0.0722 * std::min(pixel[2], 100.0f);
+
+			probabilities[size_t(y) * width + x] = luminance * sin((y + 0.5) / height * PI);
+			total += probabilities[size_t(y) * width + x];
+		}
+	}
+
+	for(double& probability : probabilities)
+	{
+		probability /= total;
+	}
+
+	return probabilities;
+}
+
+static double GetTestEnvironmentPDF(const std::vector<double>& probabilities, unsigned int width, unsigned int height, 
+	const glm::vec3& direction)
+{
+	double theta = acos(glm::clamp(double(direction.y), -1.0, 1.0));
+	double phi = atan2(double(direction.z), double(direction.x)) + PI;
+	unsigned int x = std::min((unsigned int)(phi / (2.0 * PI) * width), width - 1);
+	unsigned int y = std::min((unsigned int)(theta / PI * height), height - 1);
+
+	// Every pixel spans 2pi / width by pi / height of the (phi, theta) rectangle //
+	return probabilities[size_t(y) * width + x] * width * height / (2.0 * PI * PI * std::max(sin(theta), 1e-9));
+}
+
+// GGX normal distribution, with 'cosTheta' the angle between the microfacet normal & the normal
+static double GGXDistribution(double cosTheta, double alpha)
+{
+	double alpha2 = alpha * alpha;
+	double denominator = cosTheta * cosTheta * (alpha2 - 1.0) + 1.0;
+	return alpha2 / (PI * denominator * denominator);
+}
+
+unsigned int RunSamplingChiSquareTest(unsigned int sampleCount)
+{
+	const glm::vec3 normal = glm::vec3(0.0f, 0.0f, 1.0f);
+	const float roughnesses[] = { 0.2f, 0.5f, 0.8f, 1.0f };
+	const float viewCosines[] = { 0.95f, 0.5f, 0.1f };
+	const unsigned int caseCount = 1 + 4 * 3 + 2;
+
+	// Bonferroni correction, so all cases together falsely fail 1% of the time
+	const double significance = 0.01 / caseCount;
+	unsigned int failureCount = 0;
+
+	// 1) Cosine weighted hemisphere //
+	double pValue = ChiSquareTest("Cosine hemisphere", sampleCount, [&](PathSampler& pathSampler, glm::vec3& direction)
+	{
+		direction = CosineHemisphereDirection(pathSampler, normal);
+		return true;
+	}, 
+	[](const glm::vec3& direction)
+	{
+		return direction.z / PI;
+	});
+
+	failureCount += pValue < significance ? 1 : 0;
+
+	// 2) GGX through the visible normals, the reflection's PDF is G1(v) * D(h) / (4 * cos(v)) //
+	for(float roughness : roughnesses)
+	{
+		for(float viewCosine : viewCosines)
+		{
+			glm::vec3 view = glm::vec3(sqrtf(1.0f - viewCosine * viewCosine), 0.0f, viewCosine);
+			float alpha = roughness * roughness;
+
+			std::string name = "GGX VNDF, roughness " + std::to_string(roughness).substr(0, 3) 
+				+ ", cos(view) " + std::to_string(viewCosine).substr(0, 4);
+
+			pValue = ChiSquareTest(name, sampleCount, [&](PathSampler& pathSampler, glm::vec3& direction)
+			{
+				float weight;
+				direction = SampleGGXReflection(-view, normal, roughness, pathSampler, weight);
+				return weight > 0.0f;
+			}, 
+			[&](const glm::vec3& light)
+			{
+				glm::vec3 halfway = glm::normalize(view + light);
+				double maskingView = 1.0 / (1.0 + GGXLambda(view.z, alpha));
+				return maskingView * GGXDistribution(halfway.z, alpha) / (4.0 * view.z);
+			});
+
+			failureCount += pValue < significance ? 1 : 0;
+		}
+	}
+
+	// 3) Environment map, the bins only cover a hemisphere, so both halves of the sphere get a case of their own //
+	const unsigned int environmentWidth = 64;
+	const unsigned int environmentHeight = 32;
+	std::vector<float> environment = CreateTestEnvironment(environmentWidth, environmentHeight);
+	std::vector<float> distribution;
+	BuildEnvironmentDistribution(environment.data(), environmentWidth, environmentHeight, distribution);
+	std::vector<double> probabilities = GetTestEnvironmentProbabilities(environment, environmentWidth, environmentHeight);
+
+	// The PDF that comes with a sample has to be the one 'GetEnvironmentPDF' gives its direction, which MIS relies on
+	unsigned int pdfMismatchCount = 0;
+
+	for(float side : { 1.0f, -1.0f })
+	{
+		std::string name = side > 0.0f ? "Environment map, +z" : "Environment map, -z";
+		pValue = ChiSquareTest(name, sampleCount, [&](PathSampler& pathSampler, glm::vec3& direction)
+		{
+			float pdf;
+			direction = SampleEnvironment(distribution.data(), environmentWidth, environmentHeight, pathSampler, pdf);
+
+			// Close to the poles acos(y) loses too much precision for the PDFs to agree
+			float lookupPdf = GetEnvironmentPDF(distribution.data(), environmentWidth, environmentHeight, direction);
+			pdfMismatchCount += fabsf(direction.y) < 0.999f && fabsf(pdf - lookupPdf) > 1e-3f * pdf ? 1 : 0;
+
+			direction.z *= side;
+			return pdf > 0.0f;
+		},
+		[&](const glm::vec3& direction)
+		{
+			return GetTestEnvironmentPDF(probabilities, environmentWidth, environmentHeight, 
+				glm::vec3(direction.x, direction.y, direction.z * side));
+		});
+
+		failureCount += pValue < significance ? 1 : 0;
+	}
+
+	// Samples right on the edge of a pixel can be looked up in its neighbour
+	if(pdfMismatchCount > sampleCount / 10000)
+	{
+		LOG(Log::MessageType::Error, "The PDF of " + std::to_string(pdfMismatchCount) + " environment samples doesn't match 'GetEnvironmentPDF'");
+		failureCount++;
+	}
+
+	LOG(std::to_string(failureCount) + "/" + std::to_string(caseCount) + " sampling cases rejected at a p-value of " 
+		+ std::to_string(significance));
+
+	return failureCount;
+}
\ No newline at end of file
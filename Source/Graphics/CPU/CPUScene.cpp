@@ -0,0 +1,131 @@
+#include "Graphics/CPU/CPUScene.h"
+#include "Graphics/CPU/CPUModel.h"
+#include "Graphics/CPU/CPUMesh.h"
+#include "Graphics/CPU/CPUBottomLevelAS.h"
+#include "Graphics/CPU/CPUTexture.h"
+#include "Graphics/CPU/CPUTopLevelAS.h"
+#include "Graphics/EnvironmentDistribution.h"
+#include "Utilities/Logger.h"
+#include "Utilities/ThreadPool.h"
+
+#include <chrono>
+
+#include <cstdlib>
+#include <tinyexr.h>
+
+CPUScene::CPUScene(const SceneDescription& description)
+{
+	auto loadStart = std::chrono::high_resolution_clock::now();
+
+	// Models get loaded in parallel, each one in its own slot so the instance order stays the same //
+	models.resize(description.models.size());
+	ThreadPool::GetGlobalPool().ParallelFor(description.models.size(), [&](unsigned int index)
+	{
+		const SceneModelDescription& modelDescription = description.models[index];
+
+		CPUModel* model = new CPUModel(modelDescription.path);
+		model->transform.Position = modelDescription.position;
+		model->transform.Rotation = modelDescription.rotation;
+		model->transform.Scale = modelDescription.scale;
+
+		models[index] = model;
+	});
+
+	auto loadEnd = std::chrono::high_resolution_clock::now();
+	float loadTime = std::chrono::duration<float, std::milli>(loadEnd - loadStart).count();
+	LOG("Loaded " + std::to_string(models.size()) + " models in " + std::to_string(loadTime) + "ms");
+
+	// Environment Map, without one 'Miss' falls back on a gradient //
+	if(!description.environmentMapPath.empty())
+	{
+		LoadEnvironmentMap(description.environmentMapPath);
+	}
+
+	tlas = new CPUTopLevelAS(this);
+
+	// Report the total cost of the acceleration structures //
+	unsigned int triangleCount = 0;
+	unsigned int nodeCount = 0;
+	double buildTime = 0.0;
+
+	for(CPUModel* model : models)
+	{
+		for(CPUMesh* mesh : model->GetMeshes())
+		{
+			const BVHBuildStats& stats = mesh->GetBLAS()->GetBuildStats();
+			triangleCount += mesh->GetTriangleCount();
+			nodeCount += stats.nodeCount;
+			buildTime += stats.buildTime;
+		}
+	}
+
+	LOG("Built BLASes: " + std::to_string(triangleCount) + " triangles, " + std::to_string(nodeCount) 
+		+ " nodes in " + std::to_string(buildTime) + "ms");
+
+	LOG("Built TLAS: " + std::to_string(tlas->GetInstanceCount()) + " instances in " 
+		+ std::to_string(tlas->GetBuildTime()) + "us");
+}
+
+CPUScene::~CPUScene()
+{
+	delete tlas;
+	delete environmentMap;
+
+	for(CPUModel* model : models)
+	{
+		delete model;
+	}
+}
+
+void CPUScene::LoadEnvironmentMap(const std::string& path)
+{
+	const char* err = nullptr;
+	float* image = nullptr;
+	int width;
+	int height;
+
+	int result = LoadEXR(&image, &width, &height, path.c_str(), &err);
+	if(result != TINYEXR_SUCCESS)
+	{
+		LOG(Log::MessageType::Error, "Failed to load EXR: " + path);
+		if(err)
+		{
+			LOG(Log::MessageType::Error, err);
+			FreeEXRErrorMessage(err);
+		}
+	}
+	else
+	{
+		environmentMap = new CPUTexture(image, width, height);
+
+		auto distributionStart = std::chrono::high_resolution_clock::now();
+		BuildEnvironmentDistribution(image, width, height, environmentDistribution);
+		auto distributionEnd = std::chrono::high_resolution_clock::now();
+
+		float distributionTime = std::chrono::duration<float, std::milli>(distributionEnd - distributionStart).count();
+		LOG("Built environment distribution (" + std::to_string(width) + "x" + std::to_string(height) + ") in " 
+			+ std::to_string(distributionTime) + "ms");
+
+		free(image);
+	}
+}
+
+const std::vector<CPUModel*>& CPUScene::GetModels()
+{
+	return models;
+}
+
+CPUTopLevelAS* CPUScene::GetTLAS()
+{
+	return tlas;
+}
+
+CPUTexture* CPUScene::GetEnvironmentMap()
+{
+	return environmentMap;
+}
+
+const std::vector<float>& CPUScene::GetEnvironmentDistribution()
+{
+	return environmentDistribution;
+}
\ No newline at end of file
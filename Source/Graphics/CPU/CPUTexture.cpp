@@ -0,0 +1,128 @@
+#include "Graphics/CPU/CPUTexture.h"
+#include "Graphics/CookedTexture.h"
+#include "Utilities/Logger.h"
+
+#include <stb_image.h>
+#include <algorithm>
+#include <cassert>
+
+CPUTexture::CPUTexture(const unsigned char* data, int width, int height, MipGeneration mipGeneration) : width(width), height(height)
+{
+	GenerateMipChain(data, width, height, mipGeneration, data8, mipLevels);
+}
+
+CPUTexture::CPUTexture(const float* data, int width, int height) : width(width), height(height), isHDR(true)
+{
+	data32.assign(data, data + size_t(width) * height * 4);
+	mipLevels.push_back({ (unsigned int)width, (unsigned int)height, 0 });
+}
+
+CPUTexture::CPUTexture(const std::string& filePath, MipGeneration mipGeneration)
+{
+	int channels;
+	unsigned char* buffer = stbi_load(filePath.c_str(), &width, &height, &channels, 4);
+
+	if(buffer == NULL)
+	{
+		LOG(Log::MessageType::Error, "Unsuccesful with loading: " + filePath);
+		assert(false);
+		return;
+	}
+
+	GenerateMipChain(buffer, width, height, mipGeneration, data8, mipLevels);
+	stbi_image_free(buffer);
+}
+
+CPUTexture::CPUTexture(CookedTexture& cookedTexture) : width(cookedTexture.GetWidth()), height(cookedTexture.GetHeight())
+{
+	DecompressMipChain(cookedTexture.GetData(), cookedTexture.GetMipLevels(), cookedTexture.GetCompression(), data8, mipLevels);
+}
+
+glm::vec4 CPUTexture::Load(int x, int y)
+{
+	if(x < 0 || y < 0 || x >= width || y >= height)
+	{
+		return glm::vec4(0.0f);
+	}
+
+	return LoadTexel(0, x, y);
+}
+
+glm::vec4 CPUTexture::SampleLevel(const glm::vec2& uv, float lod)
+{
+	float maxLevel = float(mipLevels.size() - 1);
+	lod = glm::clamp(lod, 0.0f, maxLevel);
+
+	unsigned int level = (unsigned int)lod;
+	float blend = lod - float(level);
+
+	glm::vec4 sample = SampleBilinear(level, uv);
+	if(blend > 0.0f)
+	{
+		sample = glm::mix(sample, SampleBilinear(level + 1, uv), blend);
+	}
+
+	return sample;
+}
+
+int CPUTexture::GetWidth()
+{
+	return width;
+}
+
+int CPUTexture::GetHeight()
+{
+	return height;
+}
+
+unsigned int CPUTexture::GetMipLevels()
+{
+	return (unsigned int)mipLevels.size();
+}
+
+bool CPUTexture::IsHDR()
+{
+	return isHDR;
+}
+
+glm::vec4 CPUTexture::LoadTexel(unsigned int level, int x, int y)
+{
+	const MipLevel& mip = mipLevels[level];
+
+	if(isHDR)
+	{
+		size_t index = mip.offset / sizeof(float) + (size_t(y) * mip.width + x) * 4;
+		return glm::vec4(data32[index], data32[index + 1], data32[index + 2], data32[index + 3]);
+	}
+
+	size_t index = mip.offset + (size_t(y) * mip.width + x) * 4;
+	const float toUnorm = 1.0f / 255.0f;
+	return glm::vec4(data8[index], data8[index + 1], data8[index + 2], data8[index + 3]) * toUnorm;
+}
+
+glm::vec4 CPUTexture::SampleBilinear(unsigned int level, const glm::vec2& uv)
+{
+	const MipLevel& mip = mipLevels[level];
+	int levelWidth = int(mip.width);
+	int levelHeight = int(mip.height);
+
+	// Texel centers lie at half texel offsets, like D3D
+	float x = uv.x * levelWidth - 0.5f;
+	float y = uv.y * levelHeight - 0.5f;
+	float floorX = floorf(x);
+	float floorY = floorf(y);
+	float fractionX = x - floorX;
+	float fractionY = y - floorY;
+
+	// Wrap addressing, the modulo is done on floats first so large uvs don't overflow
+	int x0 = int(floorX - floorf(floorX / levelWidth) * levelWidth);
+	int y0 = int(floorY - floorf(floorY / levelHeight) * levelHeight);
+	x0 = std::min(x0, levelWidth - 1);
+	y0 = std::min(y0, levelHeight - 1);
+	int x1 = x0 + 1 < levelWidth ? x0 + 1 : 0;
+	int y1 = y0 + 1 < levelHeight ? y0 + 1 : 0;
+
+	glm::vec4 top = glm::mix(LoadTexel(level, x0, y0), LoadTexel(level, x1, y0), fractionX);
+	glm::vec4 bottom = glm::mix(LoadTexel(level, x0, y1), LoadTexel(level, x1, y1), fractionX);
+	return glm::mix(top, bottom, fractionY);
+}
\ No newline at end of file
@@ -0,0 +1,431 @@
+#include "Graphics/CPU/CPUTopLevelAS.h"
+#include "Graphics/CPU/CPURayPacket.h"
+#include "Graphics/CPU/CPUScene.h"
+#include "Graphics/CPU/CPUModel.h"
+#include "Graphics/CPU/CPUMesh.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cstring>
+
+CPUTopLevelAS::CPUTopLevelAS(CPUScene* scene) : activeScene(scene)
+{
+	BuildTLAS();
+}
+
+void CPUTopLevelAS::RebuildTLAS()
+{
+	instances.clear();
+	BuildTLAS();
+}
+
+void CPUTopLevelAS::UpdateTLAS()
+{
+	if(GetSceneInstanceCount() != instances.size())
+	{
+		RebuildTLAS();
+		return;
+	}
+
+	auto start = std::chrono::high_resolution_clock::now();
+
+	// 1) Update the instances whose transform changed //
+	std::vector<bool> movedInstances(instances.size(), false);
+	movedInstanceCount = 0;
+
+	unsigned int instanceIndex = 0;
+	for(CPUModel* model : activeScene->GetModels())
+	{
+		glm::mat4 transform = model->transform.GetModelMatrix();
+
+		for(const CPUMeshInstance& meshInstance : model->GetMeshInstances())
+		{
+			CPUInstance& instance = instances[instanceIndex];
+			glm::mat4 instanceTransform = transform * meshInstance.nodeTransform;
+
+			if(instanceTransform != instance.transform)
+			{
+				instance.transform = instanceTransform;
+				instance.inverseTransform = glm::inverse(instanceTransform);
+				UpdateInstanceBounds(instance);
+
+				movedInstances[instanceIndex] = true;
+				movedInstanceCount++;
+			}
+
+			instanceIndex++;
+		}
+	}
+
+	// 2) Refit bottom-up, children are always stored after their parent //
+	if(movedInstanceCount > 0)
+	{
+		std::vector<bool> movedNodes(nodesUsed, false);
+
+		for(int i = nodesUsed - 1; i >= 0; i--)
+		{
+			BVHNode& node = nodes[i];
+
+			if(node.triangleCount > 0)
+			{
+				for(unsigned int j = 0; j < node.triangleCount; j++)
+				{
+					if(movedInstances[instanceIndices[node.leftFirst + j]])
+					{
+						movedNodes[i] = true;
+						break;
+					}
+				}
+
+				if(movedNodes[i])
+				{
+					UpdateNodeBounds(node);
+				}
+			}
+			else if(movedNodes[node.leftFirst] || movedNodes[node.leftFirst + 1])
+			{
+				BVHNode& left = nodes[node.leftFirst];
+				BVHNode& right = nodes[node.leftFirst + 1];
+
+				node.boundsMin = glm::min(left.boundsMin, right.boundsMin);
+				node.boundsMax = glm::max(left.boundsMax, right.boundsMax);
+				movedNodes[i] = true;
+			}
+		}
+	}
+
+	auto end = std::chrono::high_resolution_clock::now();
+	updateTime = std::chrono::duration<double, std::micro>(end - start).count();
+}
+
+bool CPUTopLevelAS::Intersect(const Ray& ray, HitInfo& hit, bool acceptFirstHit)
+{
+	if(instances.empty())
+	{
+		return false;
+	}
+
+	glm::vec3 inverseDirection = 1.0f / ray.Direction;
+	bool hasHit = false;
+
+	unsigned int stack[64];
+	unsigned int stackPointer = 0;
+	stack[stackPointer++] = 0;
+
+	while(stackPointer > 0)
+	{
+		BVHNode& node = nodes[stack[--stackPointer]];
+
+		if(IntersectAABB(ray, inverseDirection, node.boundsMin, node.boundsMax, hit.t) == FLT_MAX)
+		{
+			continue;
+		}
+
+		if(node.triangleCount > 0)
+		{
+			for(unsigned int i = 0; i < node.triangleCount; i++)
+			{
+				unsigned int instanceIndex = instanceIndices[node.leftFirst + i];
+				CPUInstance& instance = instances[instanceIndex];
+
+				// The direction is deliberately not normalized, that way 't' stays the same in both spaces
+				Ray objectRay = ray;
+				objectRay.Origin = instance.inverseTransform * glm::vec4(ray.Origin, 1.0f);
+				objectRay.Direction = instance.inverseTransform * glm::vec4(ray.Direction, 0.0f);
+
+				if(instance.mesh->GetBLAS()->Intersect(objectRay, hit, acceptFirstHit))
+				{
+					hit.instanceIndex = instanceIndex;
+					hasHit = true;
+
+					if(acceptFirstHit)
+					{
+						return true;
+					}
+				}
+			}
+			continue;
+		}
+
+		stack[stackPointer++] = node.leftFirst + 1;
+		stack[stackPointer++] = node.leftFirst;
+	}
+
+	return hasHit;
+}
+
+uint64_t CPUTopLevelAS::IntersectPacket(RayPacket& packet)
+{
+#ifdef PACKET_AVX2
+	if(UsePacketAVX2())
+	{
+		return TraversePacketAVX2(packet);
+	}
+#endif
+
+	return TraversePacket<ScalarPacketTests>(packet);
+}
+
+#ifdef PACKET_AVX2
+PACKET_AVX2_KERNEL uint64_t CPUTopLevelAS::TraversePacketAVX2(RayPacket& packet)
+{
+	return TraversePacket<AVX2PacketTests>(packet);
+}
+#endif
+
+template<typename PacketTests>
+uint64_t CPUTopLevelAS::TraversePacket(RayPacket& packet)
+{
+	if(instances.empty())
+	{
+		return 0;
+	}
+
+	const unsigned int groupCount = (packet.rayCount + packetGroupSize - 1) / packetGroupSize;
+	uint64_t hitMask = 0;
+
+	// Reused for every instance that gets visited, it's too big to set up more often than needed //
+	RayPacket objectPacket;
+
+	unsigned int stack[64];
+	unsigned int stackPointer = 0;
+	stack[stackPointer++] = 0;
+
+	while(stackPointer > 0)
+	{
+		BVHNode& node = nodes[stack[--stackPointer]];
+
+		bool isEntered = false;
+		for(unsigned int group = 0; group < groupCount && !isEntered; group++)
+		{
+			isEntered = PacketTests::AABB(packet, group, node.boundsMin, node.boundsMax) != 0;
+		}
+
+		if(!isEntered)
+		{
+			continue;
+		}
+
+		if(node.triangleCount > 0)
+		{
+			for(unsigned int i = 0; i < node.triangleCount; i++)
+			{
+				unsigned int instanceIndex = instanceIndices[node.leftFirst + i];
+				CPUInstance& instance = instances[instanceIndex];
+
+				// Same transform as the single ray version, so the rays end up with the same object space directions
+				objectPacket.origin = instance.inverseTransform * glm::vec4(packet.origin, 1.0f);
+				objectPacket.tMin = packet.tMin;
+				objectPacket.rayCount = packet.rayCount;
+
+				for(unsigned int j = 0; j < packet.rayCount; j++)
+				{
+					objectPacket.SetDirection(j, instance.inverseTransform * glm::vec4(packet.GetDirection(j), 0.0f));
+				}
+
+				memcpy(objectPacket.t, packet.t, sizeof(packet.t));
+				objectPacket.Prepare();
+
+				uint64_t instanceMask = instance.mesh->GetBLAS()->IntersectPacket(objectPacket);
+				hitMask |= instanceMask;
+
+				for(; instanceMask != 0; instanceMask &= instanceMask - 1)
+				{
+					unsigned int ray = CountTrailingZeros(instanceMask);
+					packet.t[ray] = objectPacket.t[ray];
+					packet.u[ray] = objectPacket.u[ray];
+					packet.v[ray] = objectPacket.v[ray];
+					packet.primitiveIndex[ray] = objectPacket.primitiveIndex[ray];
+					packet.instanceIndex[ray] = instanceIndex;
+				}
+			}
+			continue;
+		}
+
+		BVHNode& left = nodes[node.leftFirst];
+		BVHNode& right = nodes[node.leftFirst + 1];
+		unsigned int childMask = PacketTests::Frustum(packet, left, right);
+
+		unsigned int nearIndex = node.leftFirst;
+		unsigned int farIndex = node.leftFirst + 1;
+		unsigned int nearBit = 1;
+		unsigned int farBit = 2;
+		if(glm::dot(left.boundsMin + left.boundsMax, packet.centralDirection) >
+			glm::dot(right.boundsMin + right.boundsMax, packet.centralDirection))
+		{
+			std::swap(nearIndex, farIndex);
+			std::swap(nearBit, farBit);
+		}
+
+		if(childMask & farBit)
+		{
+			stack[stackPointer++] = farIndex;
+		}
+
+		if(childMask & nearBit)
+		{
+			stack[stackPointer++] = nearIndex;
+		}
+	}
+
+	return hitMask;
+}
+
+CPUInstance& CPUTopLevelAS::GetInstance(unsigned int instanceIndex)
+{
+	return instances[instanceIndex];
+}
+
+unsigned int CPUTopLevelAS::GetInstanceCount()
+{
+	return instances.size();
+}
+
+double CPUTopLevelAS::GetBuildTime()
+{
+	return buildTime;
+}
+
+double CPUTopLevelAS::GetUpdateTime()
+{
+	return updateTime;
+}
+
+unsigned int CPUTopLevelAS::GetMovedInstanceCount()
+{
+	return movedInstanceCount;
+}
+
+void CPUTopLevelAS::BuildTLAS()
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	// 1) Iterate over meshes in the same order as 'DXTopLevelAS', so instance indices match //
+	for(CPUModel* model : activeScene->GetModels())
+	{
+		glm::mat4 transform = model->transform.GetModelMatrix();
+
+		for(const CPUMeshInstance& meshInstance : model->GetMeshInstances())
+		{
+			CPUInstance instance;
+			instance.mesh = meshInstance.mesh;
+			instance.model = model;
+			instance.transform = transform * meshInstance.nodeTransform;
+			instance.inverseTransform = glm::inverse(instance.transform);
+			UpdateInstanceBounds(instance);
+
+			instances.push_back(instance);
+		}
+	}
+
+	// 2) Build a BVH over the instances //
+	unsigned int instanceCount = instances.size();
+	instanceIndices.resize(instanceCount);
+	for(unsigned int i = 0; i < instanceCount; i++)
+	{
+		instanceIndices[i] = i;
+	}
+
+	nodes.resize(std::max(instanceCount * 2, 1u));
+	nodes[0].leftFirst = 0;
+	nodes[0].triangleCount = instanceCount;
+	nodesUsed = 1;
+
+	if(instanceCount > 0)
+	{
+		UpdateNodeBounds(nodes[0]);
+		Subdivide(0);
+	}
+
+	auto end = std::chrono::high_resolution_clock::now();
+	buildTime = std::chrono::duration<double, std::micro>(end - start).count();
+}
+
+void CPUTopLevelAS::UpdateInstanceBounds(CPUInstance& instance)
+{
+	glm::vec3 localMin = instance.mesh->GetBLAS()->GetBoundsMin();
+	glm::vec3 localMax = instance.mesh->GetBLAS()->GetBoundsMax();
+
+	instance.boundsMin = glm::vec3(FLT_MAX);
+	instance.boundsMax = glm::vec3(-FLT_MAX);
+
+	// Transform all corners of the box, the world space bounds have to contain all of them
+	for(int i = 0; i < 8; i++)
+	{
+		glm::vec3 corner = glm::vec3(i & 1 ? localMax.x : localMin.x,
+			i & 2 ? localMax.y : localMin.y, i & 4 ? localMax.z : localMin.z);
+
+		glm::vec3 worldCorner = instance.transform * glm::vec4(corner, 1.0f);
+		instance.boundsMin = glm::min(instance.boundsMin, worldCorner);
+		instance.boundsMax = glm::max(instance.boundsMax, worldCorner);
+	}
+}
+
+void CPUTopLevelAS::UpdateNodeBounds(BVHNode& node)
+{
+	node.boundsMin = glm::vec3(FLT_MAX);
+	node.boundsMax = glm::vec3(-FLT_MAX);
+
+	for(unsigned int i = 0; i < node.triangleCount; i++)
+	{
+		CPUInstance& instance = instances[instanceIndices[node.leftFirst + i]];
+		node.boundsMin = glm::min(node.boundsMin, instance.boundsMin);
+		node.boundsMax = glm::max(node.boundsMax, instance.boundsMax);
+	}
+}
+
+void CPUTopLevelAS::Subdivide(unsigned int nodeIndex)
+{
+	BVHNode& node = nodes[nodeIndex];
+	if(node.triangleCount <= 1)
+	{
+		return;
+	}
+
+	// Instance counts are low, a median split over the longest axis builds in 
+	// microseconds and keeps the tree balanced
+	glm::vec3 extent = node.boundsMax - node.boundsMin;
+	int axis = 0;
+	if(extent.y > extent.x) axis = 1;
+	if(extent.z > extent[axis]) axis = 2;
+
+	unsigned int first = node.leftFirst;
+	unsigned int count = node.triangleCount;
+	unsigned int leftCount = count / 2;
+
+	std::nth_element(instanceIndices.begin() + first, instanceIndices.begin() + first + leftCount, 
+		instanceIndices.begin() + first + count, [this, axis](unsigned int a, unsigned int b)
+	{
+		return (instances[a].boundsMin[axis] + instances[a].boundsMax[axis]) <
+			(instances[b].boundsMin[axis] + instances[b].boundsMax[axis]);
+	});
+
+	unsigned int leftChildIndex = nodesUsed++;
+	unsigned int rightChildIndex = nodesUsed++;
+
+	nodes[leftChildIndex].leftFirst = first;
+	nodes[leftChildIndex].triangleCount = leftCount;
+	nodes[rightChildIndex].leftFirst = first + leftCount;
+	nodes[rightChildIndex].triangleCount = count - leftCount;
+
+	node.leftFirst = leftChildIndex;
+	node.triangleCount = 0;
+
+	UpdateNodeBounds(nodes[leftChildIndex]);
+	UpdateNodeBounds(nodes[rightChildIndex]);
+
+	Subdivide(leftChildIndex);
+	Subdivide(rightChildIndex);
+}
+
+unsigned int CPUTopLevelAS::GetSceneInstanceCount()
+{
+	unsigned int instanceCount = 0;
+	for(CPUModel* model : activeScene->GetModels())
+	{
+		instanceCount += model->GetMeshInstances().size();
+	}
+
+	return instanceCount;
+}
\ No newline at end of file
@@ -0,0 +1,561 @@
+#include "Graphics/CookedModel.h"
+#include "Graphics/MeshProcessing.h"
+#include "Graphics/Extensions/Shared_TinyglTF.h"
+
+#include "Utilities/Hash.h"
+#include "Utilities/MappedFile.h"
+#include "Utilities/Logger.h"
+#include "Utilities/ThreadPool.h"
+
+#include <chrono>
+#include <fstream>
+
+#pragma region Cache Layout
+// Header | Meshes | Instances | Dependency strings | Image strings | String data | Vertices & Indices
+// Every table is directly usable from the memory mapped file, strings reference the string data.
+static const unsigned int cacheMagic = 0x4D5A4C42; // 'BLZM'
+static const unsigned int cacheVersion = 3; // Increment when the layout or the processing of meshes changes
+static const uint64_t cacheGeometryAlignment = 16;
+
+struct CacheHeader
+{
+	unsigned int magic;
+	unsigned int version;
+	uint64_t sourceHash;
+	unsigned int vertexSize;
+	unsigned int meshCount;
+	unsigned int instanceCount;
+	unsigned int dependencyCount;
+	unsigned int imageCount;
+	unsigned int stringDataSize;
+	uint64_t geometryOffset;
+};
+
+struct CacheString
+{
+	unsigned int offset;
+	unsigned int length;
+};
+
+struct CacheMesh
+{
+	uint64_t vertexOffset;
+	uint64_t indexOffset;
+	unsigned int vertexCount;
+	unsigned int indexCount;
+	CacheString name;
+	int imageIndices[3];
+	unsigned int padding;
+};
+
+struct CacheInstance
+{
+	unsigned int meshIndex;
+	float transform[16];
+};
+
+static uint64_t AlignGeometryOffset(uint64_t offset)
+{
+	return (offset + cacheGeometryAlignment - 1) & ~(cacheGeometryAlignment - 1);
+}
+#pragma endregion
+
+CookedModel::CookedModel(const std::string& filePath, bool useCache) : filePath(filePath)
+{
+	baseDirectory = filePath.substr(0, filePath.find_last_of("\\/") + 1);
+	auto loadStart = std::chrono::high_resolution_clock::now();
+
+	if(useCache && LoadCache())
+	{
+		isValid = true;
+		isLoadedFromCache = true;
+	}
+	else
+	{
+		isValid = Cook();
+
+		if(isValid && useCache)
+		{
+			WriteCache();
+		}
+	}
+
+	auto loadEnd = std::chrono::high_resolution_clock::now();
+	float loadTime = std::chrono::duration<float, std::milli>(loadEnd - loadStart).count();
+
+	std::string source = isLoadedFromCache ? "cache" : "glTF";
+	LOG(Log::MessageType::Debug, "Loaded '" + filePath + "' from " + source + " in " + std::to_string(loadTime) + "ms");
+}
+
+CookedModel::~CookedModel()
+{
+	delete cacheFile;
+	delete gltfFile;
+}
+
+bool CookedModel::IsValid()
+{
+	return isValid;
+}
+
+bool CookedModel::IsLoadedFromCache()
+{
+	return isLoadedFromCache;
+}
+
+const std::vector<CookedMesh>& CookedModel::GetMeshes()
+{
+	return meshes;
+}
+
+const std::vector<CookedMeshInstance>& CookedModel::GetInstances()
+{
+	return instances;
+}
+
+unsigned int CookedModel::GetImageCount()
+{
+	return imageURIs.size();
+}
+
+const std::string& CookedModel::GetImageURI(int imageIndex)
+{
+	return imageURIs[imageIndex];
+}
+
+std::string CookedModel::GetImagePath(int imageIndex)
+{
+	std::string decodedURI;
+	if(!tinygltf::URIDecode(imageURIs[imageIndex], &decodedURI, nullptr))
+	{
+		decodedURI = imageURIs[imageIndex];
+	}
+
+	return baseDirectory + decodedURI;
+}
+
+const tinygltf::Image* CookedModel::GetDecodedImage(int imageIndex)
+{
+	if(gltfFile == nullptr)
+	{
+		return nullptr;
+	}
+
+	return &gltfFile->model.images[imageIndex];
+}
+
+std::string CookedModel::GetCachePath(const std::string& filePath)
+{
+	return filePath.substr(0, filePath.find_last_of('.')) + ".blzmesh";
+}
+
+bool CookedModel::LoadCache()
+{
+	cacheFile = new MappedFile(GetCachePath(filePath));
+	if(!cacheFile->IsValid() || cacheFile->GetSize() < sizeof(CacheHeader))
+	{
+		delete cacheFile;
+		cacheFile = nullptr;
+		return false;
+	}
+
+	const unsigned char* data = cacheFile->GetData();
+	const size_t size = cacheFile->GetSize();
+	const CacheHeader* header = reinterpret_cast<const CacheHeader*>(data);
+
+	// 1. Validate the layout of the file //
+	size_t tablesSize = sizeof(CacheHeader) + header->meshCount * sizeof(CacheMesh) + header->instanceCount * sizeof(CacheInstance)
+		+ (header->dependencyCount + header->imageCount) * sizeof(CacheString) + header->stringDataSize;
+
+	bool isCompatible = header->magic == cacheMagic && header->version == cacheVersion && header->vertexSize == sizeof(Vertex);
+	if(!isCompatible || tablesSize > header->geometryOffset || header->geometryOffset > size)
+	{
+		LOG(Log::MessageType::Debug, "Outdated mesh cache for: " + filePath);
+		delete cacheFile;
+		cacheFile = nullptr;
+		return false;
+	}
+
+	const CacheMesh* cacheMeshes = reinterpret_cast<const CacheMesh*>(data + sizeof(CacheHeader));
+	const CacheInstance* cacheInstances = reinterpret_cast<const CacheInstance*>(cacheMeshes + header->meshCount);
+	const CacheString* cacheDependencies = reinterpret_cast<const CacheString*>(cacheInstances + header->instanceCount);
+	const CacheString* cacheImages = cacheDependencies + header->dependencyCount;
+	const char* stringData = reinterpret_cast<const char*>(cacheImages + header->imageCount);
+
+	auto readString = [&](const CacheString& string)
+	{
+		unsigned int length = string.offset + string.length <= header->stringDataSize ? string.length : 0;
+		return std::string(stringData + string.offset, length);
+	};
+
+	// 2. Check if the glTF files are still the same as the ones the cache was created from //
+	for(unsigned int i = 0; i < header->dependencyCount; i++)
+	{
+		dependencies.push_back(readString(cacheDependencies[i]));
+	}
+
+	uint64_t sourceHash;
+	if(!HashDependencies(sourceHash) || sourceHash != header->sourceHash)
+	{
+		LOG(Log::MessageType::Debug, "Stale mesh cache for: " + filePath);
+		dependencies.clear();
+		delete cacheFile;
+		cacheFile = nullptr;
+		return false;
+	}
+
+	// 3. Point the meshes directly into the mapped file //
+	for(unsigned int i = 0; i < header->imageCount; i++)
+	{
+		imageURIs.push_back(readString(cacheImages[i]));
+	}
+
+	for(unsigned int i = 0; i < header->meshCount; i++)
+	{
+		const CacheMesh& cacheMesh = cacheMeshes[i];
+
+		if(cacheMesh.vertexOffset + uint64_t(cacheMesh.vertexCount) * sizeof(Vertex) > size ||
+			cacheMesh.indexOffset + uint64_t(cacheMesh.indexCount) * sizeof(unsigned int) > size)
+		{
+			LOG(Log::MessageType::Error, "Corrupt mesh cache for: " + filePath);
+			meshes.clear();
+			imageURIs.clear();
+			dependencies.clear();
+			delete cacheFile;
+			cacheFile = nullptr;
+			return false;
+		}
+
+		CookedMesh mesh;
+		mesh.name = readString(cacheMesh.name);
+		mesh.vertices = reinterpret_cast<const Vertex*>(data + cacheMesh.vertexOffset);
+		mesh.vertexCount = cacheMesh.vertexCount;
+		mesh.indices = reinterpret_cast<const unsigned int*>(data + cacheMesh.indexOffset);
+		mesh.indexCount = cacheMesh.indexCount;
+
+		for(int t = 0; t < 3; t++)
+		{
+			mesh.imageIndices[t] = cacheMesh.imageIndices[t] < int(header->imageCount) ? cacheMesh.imageIndices[t] : -1;
+		}
+
+		meshes.push_back(mesh);
+	}
+
+	for(unsigned int i = 0; i < header->instanceCount; i++)
+	{
+		const CacheInstance& cacheInstance = cacheInstances[i];
+		if(cacheInstance.meshIndex < meshes.size())
+		{
+			instances.push_back({ cacheInstance.meshIndex, glm::make_mat4(cacheInstance.transform) });
+		}
+	}
+
+	return true;
+}
+
+bool CookedModel::Cook()
+{
+	gltfFile = new glTFFile();
+	if(!glTFLoadFile(*gltfFile, filePath))
+	{
+		return false;
+	}
+
+	tinygltf::Model& model = gltfFile->model;
+
+	for(tinygltf::Image& image : model.images)
+	{
+		imageURIs.push_back(image.uri);
+	}
+
+	// 1. Traverse the nodes, which determines which meshes get cooked, and their instances //
+	firstCookedMesh.resize(model.meshes.size(), -1);
+	TraverseRootNodes(model);
+
+	// 2. Decode & process all primitives in parallel, each one has its own slot //
+	cookedVertices.resize(meshes.size());
+	cookedIndices.resize(meshes.size());
+
+	std::vector<tinygltf::Primitive*> primitives(meshes.size(), nullptr);
+	for(unsigned int meshIndex = 0; meshIndex < model.meshes.size(); meshIndex++)
+	{
+		if(firstCookedMesh[meshIndex] == -1)
+		{
+			continue;
+		}
+
+		std::vector<tinygltf::Primitive>& meshPrimitives = model.meshes[meshIndex].primitives;
+		for(unsigned int i = 0; i < meshPrimitives.size(); i++)
+		{
+			primitives[firstCookedMesh[meshIndex] + i] = &meshPrimitives[i];
+		}
+	}
+
+	std::vector<MeshOptimizationStats> optimizationStats(meshes.size());
+	ThreadPool::GetGlobalPool().ParallelFor(meshes.size(), [&](unsigned int index)
+	{
+		tinygltf::Primitive& primitive = *primitives[index];
+		std::vector<Vertex>& vertices = cookedVertices[index];
+		std::vector<unsigned int>& indices = cookedIndices[index];
+
+		glTFLoadVertices(vertices, *gltfFile, primitive);
+		glTFLoadIndices(indices, *gltfFile, primitive);
+
+		optimizationStats[index] = OptimizeMesh(vertices, indices);
+
+		CookedMesh& mesh = meshes[index];
+		mesh.vertices = vertices.data();
+		mesh.vertexCount = vertices.size();
+		mesh.indices = indices.data();
+		mesh.indexCount = indices.size();
+
+		mesh.imageIndices[glTFTextureType::BaseColor] = glTFGetImageIndex(glTFTextureType::BaseColor, model, primitive);
+		mesh.imageIndices[glTFTextureType::Normal] = glTFGetImageIndex(glTFTextureType::Normal, model, primitive);
+		mesh.imageIndices[glTFTextureType::MetallicRoughness] = glTFGetImageIndex(glTFTextureType::MetallicRoughness, model, primitive);
+	});
+
+	firstCookedMesh.clear();
+
+	MeshOptimizationStats totalStats;
+	for(const MeshOptimizationStats& stats : optimizationStats)
+	{
+		totalStats.Add(stats);
+	}
+
+	LOG(Log::MessageType::Debug, "Optimized '" + filePath + "': " + std::to_string(totalStats.vertexCountBefore) + " -> " + 
+		std::to_string(totalStats.vertexCountAfter) + " vertices, ACMR " + std::to_string(totalStats.GetACMRBefore()) + 
+		" -> " + std::to_string(totalStats.GetACMRAfter()));
+
+	// 3. Files the cooked data depends on, the glTF file itself & its external buffers //
+	dependencies.push_back(filePath.substr(baseDirectory.size()));
+	dependencies.insert(dependencies.end(), gltfFile->mappedBufferURIs.begin(), gltfFile->mappedBufferURIs.end());
+
+	for(tinygltf::Buffer& buffer : model.buffers)
+	{
+		std::string decodedURI;
+		if(!buffer.uri.empty() && !tinygltf::IsDataURI(buffer.uri) && tinygltf::URIDecode(buffer.uri, &decodedURI, nullptr))
+		{
+			dependencies.push_back(decodedURI);
+		}
+	}
+
+	return true;
+}
+
+void CookedModel::WriteCache()
+{
+	// Embedded images can't be referenced by the cache, models using them always get loaded from glTF //
+	for(CookedMesh& mesh : meshes)
+	{
+		for(int imageIndex : mesh.imageIndices)
+		{
+			if(imageIndex >= 0 && imageURIs[imageIndex].empty())
+			{
+				LOG(Log::MessageType::Debug, "Model uses embedded images, skipping mesh cache for: " + filePath);
+				return;
+			}
+		}
+	}
+
+	uint64_t sourceHash;
+	if(!HashDependencies(sourceHash))
+	{
+		return;
+	}
+
+	// 1. Build all tables //
+	std::string stringData;
+	auto addString = [&stringData](const std::string& string)
+	{
+		CacheString cacheString = { static_cast<unsigned int>(stringData.size()), static_cast<unsigned int>(string.size()) };
+		stringData += string;
+		return cacheString;
+	};
+
+	std::vector<CacheString> cacheDependencies;
+	for(const std::string& dependency : dependencies)
+	{
+		cacheDependencies.push_back(addString(dependency));
+	}
+
+	std::vector<CacheString> cacheImages;
+	for(const std::string& uri : imageURIs)
+	{
+		cacheImages.push_back(addString(uri));
+	}
+
+	std::vector<CacheString> meshNames;
+	for(CookedMesh& mesh : meshes)
+	{
+		meshNames.push_back(addString(mesh.name));
+	}
+
+	CacheHeader header = {};
+	header.magic = cacheMagic;
+	header.version = cacheVersion;
+	header.sourceHash = sourceHash;
+	header.vertexSize = sizeof(Vertex);
+	header.meshCount = meshes.size();
+	header.instanceCount = instances.size();
+	header.dependencyCount = cacheDependencies.size();
+	header.imageCount = cacheImages.size();
+	header.stringDataSize = stringData.size();
+
+	uint64_t tablesSize = sizeof(CacheHeader) + meshes.size() * sizeof(CacheMesh) + instances.size() * sizeof(CacheInstance)
+		+ (cacheDependencies.size() + cacheImages.size()) * sizeof(CacheString) + stringData.size();
+	header.geometryOffset = AlignGeometryOffset(tablesSize);
+
+	std::vector<CacheMesh> cacheMeshes;
+	uint64_t geometryOffset = header.geometryOffset;
+
+	for(unsigned int i = 0; i < meshes.size(); i++)
+	{
+		CookedMesh& mesh = meshes[i];
+
+		CacheMesh cacheMesh = {};
+		cacheMesh.vertexCount = mesh.vertexCount;
+		cacheMesh.indexCount = mesh.indexCount;
+		cacheMesh.name = meshNames[i];
+		memcpy(cacheMesh.imageIndices, mesh.imageIndices, sizeof(cacheMesh.imageIndices));
+
+		cacheMesh.vertexOffset = geometryOffset;
+		geometryOffset += uint64_t(mesh.vertexCount) * sizeof(Vertex);
+		cacheMesh.indexOffset = geometryOffset;
+		geometryOffset = AlignGeometryOffset(geometryOffset + uint64_t(mesh.indexCount) * sizeof(unsigned int));
+
+		cacheMeshes.push_back(cacheMesh);
+	}
+
+	std::vector<CacheInstance> cacheInstances;
+	for(CookedMeshInstance& instance : instances)
+	{
+		CacheInstance cacheInstance;
+		cacheInstance.meshIndex = instance.meshIndex;
+		memcpy(cacheInstance.transform, glm::value_ptr(instance.transform), sizeof(cacheInstance.transform));
+		cacheInstances.push_back(cacheInstance);
+	}
+
+	// 2. Write everything in the order of the layout //
+	std::string cachePath = GetCachePath(filePath);
+	std::ofstream file(cachePath, std::ios::binary | std::ios::trunc);
+	if(!file.is_open())
+	{
+		LOG(Log::MessageType::Error, "Failed to write mesh cache: " + cachePath);
+		return;
+	}
+
+	const char padding[cacheGeometryAlignment] = {};
+	auto writePadding = [&]()
+	{
+		uint64_t position = uint64_t(file.tellp());
+		file.write(padding, AlignGeometryOffset(position) - position);
+	};
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(CacheHeader));
+	file.write(reinterpret_cast<const char*>(cacheMeshes.data()), cacheMeshes.size() * sizeof(CacheMesh));
+	file.write(reinterpret_cast<const char*>(cacheInstances.data()), cacheInstances.size() * sizeof(CacheInstance));
+	file.write(reinterpret_cast<const char*>(cacheDependencies.data()), cacheDependencies.size() * sizeof(CacheString));
+	file.write(reinterpret_cast<const char*>(cacheImages.data()), cacheImages.size() * sizeof(CacheString));
+	file.write(stringData.data(), stringData.size());
+	writePadding();
+
+	for(CookedMesh& mesh : meshes)
+	{
+		file.write(reinterpret_cast<const char*>(mesh.vertices), uint64_t(mesh.vertexCount) * sizeof(Vertex));
+		file.write(reinterpret_cast<const char*>(mesh.indices), uint64_t(mesh.indexCount) * sizeof(unsigned int));
+		writePadding();
+	}
+
+	if(!file.good())
+	{
+		LOG(Log::MessageType::Error, "Failed to write mesh cache: " + cachePath);
+		file.close();
+		std::remove(cachePath.c_str());
+	}
+}
+
+#pragma region Node Traversal
+void CookedModel::TraverseRootNodes(tinygltf::Model& model)
+{
+	auto scene = model.scenes[std::max(model.defaultScene, 0)];
+	glm::mat4 transform;
+
+	// Traverse the 'root' nodes from the scene
+	for(unsigned int i = 0; i < scene.nodes.size(); i++)
+	{
+		tinygltf::Node& rootNode = model.nodes[scene.nodes[i]];
+		transform = glTFGetNodeTransform(rootNode);
+
+		if(rootNode.mesh != -1)
+		{
+			AddMeshInstances(model, rootNode.mesh, transform);
+		}
+
+		// Process Child Nodes //
+		for(int noteID : rootNode.children)
+		{
+			TraverseChildNodes(model, model.nodes[noteID], transform);
+		}
+	}
+}
+
+void CookedModel::TraverseChildNodes(tinygltf::Model& model, tinygltf::Node& node, const glm::mat4& parentMatrix)
+{
+	// 1. Load matrix from node //
+	glm::mat4 transform = glTFGetNodeTransform(node);
+	glm::mat4 childNodeTransform = parentMatrix * transform;
+
+	// 2. Apply to meshes in note //
+	if(node.mesh != -1)
+	{
+		AddMeshInstances(model, node.mesh, childNodeTransform);
+	}
+
+	// 3. Loop for children //
+	for(int noteID : node.children)
+	{
+		TraverseChildNodes(model, model.nodes[noteID], childNodeTransform);
+	}
+}
+
+void CookedModel::AddMeshInstances(tinygltf::Model& model, int meshIndex, const glm::mat4& transform)
+{
+	tinygltf::Mesh& mesh = model.meshes[meshIndex];
+
+	// Only the first node referencing a glTF mesh cooks it, others instance the same cooked meshes
+	if(firstCookedMesh[meshIndex] == -1)
+	{
+		firstCookedMesh[meshIndex] = meshes.size();
+
+		for(unsigned int i = 0; i < mesh.primitives.size(); i++)
+		{
+			CookedMesh cookedMesh;
+			cookedMesh.name = mesh.name;
+			meshes.push_back(cookedMesh);
+		}
+	}
+
+	for(unsigned int i = 0; i < mesh.primitives.size(); i++)
+	{
+		instances.push_back({ static_cast<unsigned int>(firstCookedMesh[meshIndex] + i), transform });
+	}
+}
+#pragma endregion
+
+bool CookedModel::HashDependencies(uint64_t& hash)
+{
+	hash = cacheVersion;
+
+	for(const std::string& dependency : dependencies)
+	{
+		MappedFile file(baseDirectory + dependency);
+		if(!file.IsValid())
+		{
+			return false;
+		}
+
+		hash = HashBytes(file.GetData(), file.GetSize(), hash);
+	}
+
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,292 @@
+#include "Graphics/CookedTexture.h"
+
+#include "Utilities/Hash.h"
+#include "Utilities/MappedFile.h"
+#include "Utilities/Logger.h"
+
+#include <stb_image.h>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#pragma region Cache Layout
+// Header | Mip levels | Compressed data
+// The compressed data is stored exactly like 'GetData' returns it, so the mapped file can be uploaded as is.
+static const unsigned int textureCacheMagic = 0x545A4C42; // 'BLZT'
+static const unsigned int textureCacheVersion = 1; // Increment when the layout, the mip filtering or the encoders change
+static const uint64_t textureCacheDataAlignment = 16;
+
+struct TextureCacheHeader
+{
+	unsigned int magic;
+	unsigned int version;
+	uint64_t sourceHash;
+	unsigned int compression;
+	unsigned int width;
+	unsigned int height;
+	unsigned int levelCount;
+	float psnr;
+	unsigned int padding;
+	uint64_t dataOffset;
+	uint64_t dataSize;
+};
+
+struct TextureCacheLevel
+{
+	unsigned int width;
+	unsigned int height;
+	uint64_t offset;
+};
+#pragma endregion
+
+CookedTexture::CookedTexture(const std::string& imagePath, TextureCompression compression,
+	MipGeneration mipGeneration, bool useCache) : name(imagePath), cachePath(GetCachePath(imagePath, compression)),
+	compression(compression), mipGeneration(mipGeneration)
+{
+	auto loadStart = std::chrono::high_resolution_clock::now();
+
+	// The image file itself is hashed, so it only has to be decoded when the cache is missing or stale
+	MappedFile imageFile(imagePath);
+	if(!imageFile.IsValid())
+	{
+		LOG(Log::MessageType::Error, "Failed to load image: " + imagePath);
+		return;
+	}
+
+	uint64_t sourceHash = HashBytes(imageFile.GetData(), imageFile.GetSize(), GetHashSeed());
+
+	if(useCache && LoadCache(sourceHash))
+	{
+		isValid = true;
+		isLoadedFromCache = true;
+	}
+	else
+	{
+		int imageWidth, imageHeight, channels;
+		unsigned char* pixels = stbi_load_from_memory(imageFile.GetData(), int(imageFile.GetSize()),
+			&imageWidth, &imageHeight, &channels, 4);
+
+		if(pixels == nullptr)
+		{
+			LOG(Log::MessageType::Error, "Failed to load image: " + imagePath);
+			return;
+		}
+
+		Cook(pixels, imageWidth, imageHeight);
+		stbi_image_free(pixels);
+
+		if(useCache)
+		{
+			WriteCache(sourceHash);
+		}
+	}
+
+	auto loadEnd = std::chrono::high_resolution_clock::now();
+	float loadTime = std::chrono::duration<float, std::milli>(loadEnd - loadStart).count();
+
+	std::string source = isLoadedFromCache ? "cache" : "image";
+	LOG(Log::MessageType::Debug, "Loaded '" + imagePath + "' from " + source + " in " + std::to_string(loadTime) + "ms as "
+		+ GetCompressionName(this->compression) + ", PSNR: " + std::to_string(psnr) + "dB");
+}
+
+CookedTexture::CookedTexture(const unsigned char* pixels, int width, int height, TextureCompression compression,
+	MipGeneration mipGeneration, const std::string& cachePath) : name(cachePath), cachePath(cachePath),
+	compression(compression), mipGeneration(mipGeneration)
+{
+	uint64_t sourceHash = HashBytes(pixels, size_t(width) * height * 4, GetHashSeed() ^ HashMix(width));
+
+	if(!cachePath.empty() && LoadCache(sourceHash))
+	{
+		isValid = true;
+		isLoadedFromCache = true;
+		return;
+	}
+
+	Cook(pixels, width, height);
+
+	if(!cachePath.empty())
+	{
+		WriteCache(sourceHash);
+	}
+}
+
+CookedTexture::~CookedTexture()
+{
+	delete cacheFile;
+}
+
+bool CookedTexture::IsValid()
+{
+	return isValid;
+}
+
+bool CookedTexture::IsLoadedFromCache()
+{
+	return isLoadedFromCache;
+}
+
+TextureCompression CookedTexture::GetCompression()
+{
+	return compression;
+}
+
+unsigned int CookedTexture::GetWidth()
+{
+	return width;
+}
+
+unsigned int CookedTexture::GetHeight()
+{
+	return height;
+}
+
+const std::vector<MipLevel>& CookedTexture::GetMipLevels()
+{
+	return mipLevels;
+}
+
+const unsigned char* CookedTexture::GetData()
+{
+	return data;
+}
+
+size_t CookedTexture::GetDataSize()
+{
+	return dataSize;
+}
+
+float CookedTexture::GetPSNR()
+{
+	return psnr;
+}
+
+std::string CookedTexture::GetCachePath(const std::string& imagePath, TextureCompression compression)
+{
+	return imagePath.substr(0, imagePath.find_last_of('.')) + "_" + GetCompressionName(compression) + ".blztex";
+}
+
+bool CookedTexture::LoadCache(uint64_t sourceHash)
+{
+	cacheFile = new MappedFile(cachePath);
+	if(!cacheFile->IsValid() || cacheFile->GetSize() < sizeof(TextureCacheHeader))
+	{
+		delete cacheFile;
+		cacheFile = nullptr;
+		return false;
+	}
+
+	const unsigned char* fileData = cacheFile->GetData();
+	const size_t size = cacheFile->GetSize();
+	const TextureCacheHeader* header = reinterpret_cast<const TextureCacheHeader*>(fileData);
+
+	// 1. Validate the file against the image it was cooked from //
+	uint64_t tablesSize = sizeof(TextureCacheHeader) + uint64_t(header->levelCount) * sizeof(TextureCacheLevel);
+	bool isCompatible = header->magic == textureCacheMagic && header->version == textureCacheVersion;
+
+	if(!isCompatible || header->sourceHash != sourceHash || header->levelCount == 0 ||
+		tablesSize > header->dataOffset || header->dataOffset + header->dataSize > size)
+	{
+		LOG(Log::MessageType::Debug, "Stale texture cache for: " + name);
+		delete cacheFile;
+		cacheFile = nullptr;
+		return false;
+	}
+
+	// 2. Point the levels directly into the mapped file //
+	TextureCompression cachedCompression = TextureCompression(header->compression);
+	const TextureCacheLevel* cacheLevels = reinterpret_cast<const TextureCacheLevel*>(fileData + sizeof(TextureCacheHeader));
+
+	for(unsigned int i = 0; i < header->levelCount; i++)
+	{
+		const TextureCacheLevel& level = cacheLevels[i];
+		if(level.offset + GetCompressedLevelSize(cachedCompression, level.width, level.height) > header->dataSize)
+		{
+			LOG(Log::MessageType::Error, "Corrupt texture cache for: " + name);
+			mipLevels.clear();
+			delete cacheFile;
+			cacheFile = nullptr;
+			return false;
+		}
+
+		mipLevels.push_back({ level.width, level.height, size_t(level.offset) });
+	}
+
+	compression = cachedCompression;
+	width = header->width;
+	height = header->height;
+	psnr = header->psnr;
+	data = fileData + header->dataOffset;
+	dataSize = size_t(header->dataSize);
+	return true;
+}
+
+void CookedTexture::Cook(const unsigned char* pixels, int imageWidth, int imageHeight)
+{
+	width = imageWidth;
+	height = imageHeight;
+
+	if(compression != TextureCompression::None && (width % 4 != 0 || height % 4 != 0))
+	{
+		LOG(Log::MessageType::Debug, "Image isn't a multiple of 4 in size, cooking it without compression: " + name);
+		compression = TextureCompression::None;
+	}
+
+	std::vector<unsigned char> mipChain;
+	std::vector<MipLevel> levels;
+	GenerateMipChain(pixels, width, height, mipGeneration, mipChain, levels);
+	CompressMipChain(mipChain.data(), levels, compression, cookedData, mipLevels, &psnr);
+
+	data = cookedData.data();
+	dataSize = cookedData.size();
+	isValid = true;
+}
+
+void CookedTexture::WriteCache(uint64_t sourceHash)
+{
+	TextureCacheHeader header = {};
+	header.magic = textureCacheMagic;
+	header.version = textureCacheVersion;
+	header.sourceHash = sourceHash;
+	header.compression = (unsigned int)compression;
+	header.width = width;
+	header.height = height;
+	header.levelCount = mipLevels.size();
+	header.psnr = psnr;
+	header.dataSize = dataSize;
+
+	uint64_t tablesSize = sizeof(TextureCacheHeader) + mipLevels.size() * sizeof(TextureCacheLevel);
+	header.dataOffset = (tablesSize + textureCacheDataAlignment - 1) & ~(textureCacheDataAlignment - 1);
+
+	std::vector<TextureCacheLevel> cacheLevels;
+	for(const MipLevel& level : mipLevels)
+	{
+		cacheLevels.push_back({ level.width, level.height, uint64_t(level.offset) });
+	}
+
+	std::ofstream file(cachePath, std::ios::binary | std::ios::trunc);
+	if(!file.is_open())
+	{
+		LOG(Log::MessageType::Error, "Failed to write texture cache: " + cachePath);
+		return;
+	}
+
+	const char padding[textureCacheDataAlignment] = {};
+	file.write(reinterpret_cast<const char*>(&header), sizeof(TextureCacheHeader));
+	file.write(reinterpret_cast<const char*>(cacheLevels.data()), cacheLevels.size() * sizeof(TextureCacheLevel));
+	file.write(padding, header.dataOffset - tablesSize);
+	file.write(reinterpret_cast<const char*>(data), dataSize);
+
+	if(!file.good())
+	{
+		LOG(Log::MessageType::Error, "Failed to write texture cache: " + cachePath);
+		file.close();
+		std::remove(cachePath.c_str());
+	}
+}
+
+uint64_t CookedTexture::GetHashSeed()
+{
+	// Cooking the same image differently has to invalidate the cache as well //
+	return HashMix(textureCacheVersion | ((unsigned int)compression << 8) | ((unsigned int)mipGeneration << 16));
+}
\ No newline at end of file
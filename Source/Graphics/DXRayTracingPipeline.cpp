@@ -10,7 +10,8 @@ DXRayTracingPipeline::DXRayTracingPipeline(DXRayTracingPipelineSettings settings
 {
 	// Generate Root Signatures //
 	CreateRootSignature(rayGenRootSignature, settings.rayGenParameters, settings.rayGenParameterCount, true);
-	CreateRootSignature(hitRootSignature, settings.hitParameters, settings.hitParameterCount, true);
+	CreateRootSignature(hitRootSignature, settings.hitParameters, settings.hitParameterCount, true,
+		settings.hitSamplers, settings.hitSamplerCount);
 	CreateRootSignature(missRootSignature, settings.missParameters, settings.missParameterCount, true);
 	CreateRootSignature(globalDummyRootSignature, nullptr, 0, false);
 	CreateRootSignature(localDummyRootSignature, nullptr, 0, true);
@@ -91,11 +92,14 @@ void DXRayTracingPipeline::CreatePipeline()
 }
 
 void DXRayTracingPipeline::CreateRootSignature(ComPtr<ID3D12RootSignature>& rootSignature,
-	D3D12_ROOT_PARAMETER* parameterData, unsigned int parameterCount, bool isLocal)
+	D3D12_ROOT_PARAMETER* parameterData, unsigned int parameterCount, bool isLocal,
+	D3D12_STATIC_SAMPLER_DESC* samplerData, unsigned int samplerCount)
 {
 	D3D12_ROOT_SIGNATURE_DESC rootDesc = {};
 	rootDesc.pParameters = parameterData;
 	rootDesc.NumParameters = parameterCount;
+	rootDesc.pStaticSamplers = samplerData;
+	rootDesc.NumStaticSamplers = samplerCount;
 	rootDesc.Flags = isLocal ? D3D12_ROOT_SIGNATURE_FLAG_LOCAL_ROOT_SIGNATURE : D3D12_ROOT_SIGNATURE_FLAG_NONE; 
 
 	ID3DBlob* pSigBlob;
@@ -24,7 +24,7 @@ void DXStructuredBuffer::UpdateData(const void* data)
 	subresource.RowPitch = bufferSize;
 
 	ComPtr<ID3D12Resource> intermediate;
-	UploadPixelShaderResource(structuredBuffer, intermediate, description, subresource);
+	UploadPixelShaderResource(structuredBuffer, intermediate, description, &subresource);
 
 	// Create SRV //
 	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
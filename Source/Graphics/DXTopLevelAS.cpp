@@ -9,6 +9,8 @@
 #include "Framework/Scene.h"
 #include "Framework/Mathematics.h"
 
+#include <chrono>
+
 DXTopLevelAS::DXTopLevelAS(Scene* scene) : activeScene(scene)
 {
 	BuildTLAS();
@@ -27,26 +29,62 @@ void DXTopLevelAS::RebuildTLAS()
 	BuildTLAS();
 }
 
+bool DXTopLevelAS::UpdateTLAS(ComPtr<ID3D12GraphicsCommandList4> commandList)
+{
+	// A refit has to use the same 'NumDescs' as the build, and the instance buffers only fit that many.
+	// Rebuilding can't happen here, it records on the direct command list which is in use right now
+	if(!CanUpdate())
+	{
+		return false;
+	}
+
+	auto start = std::chrono::high_resolution_clock::now();
+
+	// 1) Write the latest transforms into the instance buffer of this frame //
+	UpdateInstanceTransforms();
+
+	ComPtr<ID3D12Resource>& instanceBuffer = tlasInstanceDescs[DXAccess::GetCurrentBackBufferIndex()];
+	unsigned int dataSize = sizeof(D3D12_RAYTRACING_INSTANCE_DESC) * instances.size();
+	UpdateUploadHeapResource(instanceBuffer, instances.data(), dataSize);
+
+	// 2) Refit the existing TLAS in place, instead of building a new one from scratch //
+	D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_DESC description = {};
+	description.Inputs = inputs;
+	description.Inputs.InstanceDescs = instanceBuffer->GetGPUVirtualAddress();
+	description.Inputs.Flags |= D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_PERFORM_UPDATE;
+	description.SourceAccelerationStructureData = tlasResult->GetGPUVirtualAddress();
+	description.DestAccelerationStructureData = tlasResult->GetGPUVirtualAddress();
+	description.ScratchAccelerationStructureData = tlasScratch->GetGPUVirtualAddress();
+
+	commandList->BuildRaytracingAccelerationStructure(&description, 0, nullptr);
+
+	// Rays traced after this need to wait till the refit is done
+	CD3DX12_RESOURCE_BARRIER barrier = CD3DX12_RESOURCE_BARRIER::UAV(tlasResult.Get());
+	commandList->ResourceBarrier(1, &barrier);
+
+	auto end = std::chrono::high_resolution_clock::now();
+	updateTime = std::chrono::duration<float, std::micro>(end - start).count();
+	return true;
+}
+
+bool DXTopLevelAS::CanUpdate()
+{
+	return GetSceneInstanceCount() == inputs.NumDescs;
+}
+
 void DXTopLevelAS::BuildTLAS()
 {
 	// 1) Figure out how many instances we wanna have 
-	int instanceCount = 0;
-	
+	int instanceCount = GetSceneInstanceCount();
 	auto models = activeScene->GetModels();
-	for(Model* model : models)
-	{
-		instanceCount += model->GetMeshCount();
-	}
 
 	ComPtr<ID3D12Device5> device = DXAccess::GetDevice();
-	std::vector<D3D12_RAYTRACING_INSTANCE_DESC> instances(instanceCount);
+	instances.resize(instanceCount);
 
 	// 2) Iterate over meshes, create a instance description for each 
 	int instanceIndex = 0;
 	for(Model* model : models)
 	{
-		glm::mat4 transform = model->transform.GetModelMatrix();
-
 		const std::vector<Mesh*>& meshes = model->GetMeshes();
 		for(Mesh* mesh : meshes)
 		{
@@ -56,34 +94,67 @@ void DXTopLevelAS::BuildTLAS()
 			instanceDesc.InstanceMask = 0xFF;
 			instanceDesc.AccelerationStructure = mesh->GetBLAS()->GetGPUVirtualAddress();
 
-			for(int x = 0; x < 3; x++)
-			{
-				for(int y = 0; y < 4; y++)
-				{
-					instanceDesc.Transform[x][y] = transform[y][x];
-				}
-			}
-
 			instances[instanceIndex] = instanceDesc;
 			instanceIndex++;
 		}
 	}
 
-	// 3) Allocate a buffer to map all the instance data to & Build the TLAS 
+	UpdateInstanceTransforms();
+
+	// 3) Allocate buffers to map all the instance data to & Build the TLAS 
 	unsigned int dataSize = sizeof(D3D12_RAYTRACING_INSTANCE_DESC) * instances.size();
-	AllocateAndMapResource(tlasInstanceDesc, instances.data(), dataSize);
+	for(int i = 0; i < Window::BackBufferCount; i++)
+	{
+		AllocateAndMapResource(tlasInstanceDescs[i], instances.data(), dataSize);
+	}
 
-	D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS inputs = {};
+	inputs = {};
 	inputs.Type = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL;
 	inputs.DescsLayout = D3D12_ELEMENTS_LAYOUT_ARRAY;
-	inputs.InstanceDescs = tlasInstanceDesc->GetGPUVirtualAddress();
+	inputs.InstanceDescs = tlasInstanceDescs[0]->GetGPUVirtualAddress();
 	inputs.NumDescs = instances.size();
-	inputs.Flags = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_PREFER_FAST_TRACE;
+	inputs.Flags = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_PREFER_FAST_TRACE |
+		D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_ALLOW_UPDATE;
 
 	AllocateAccelerationStructureMemory(inputs, tlasScratch.GetAddressOf(), tlasResult.GetAddressOf());
 	BuildAccelerationStructure(inputs, tlasScratch, tlasResult);
 }
 
+void DXTopLevelAS::UpdateInstanceTransforms()
+{
+	int instanceIndex = 0;
+	for(Model* model : activeScene->GetModels())
+	{
+		glm::mat4 transform = model->transform.GetModelMatrix();
+
+		for(unsigned int i = 0; i < model->GetMeshCount(); i++)
+		{
+			D3D12_RAYTRACING_INSTANCE_DESC& instanceDesc = instances[instanceIndex];
+
+			for(int x = 0; x < 3; x++)
+			{
+				for(int y = 0; y < 4; y++)
+				{
+					instanceDesc.Transform[x][y] = transform[y][x];
+				}
+			}
+
+			instanceIndex++;
+		}
+	}
+}
+
+unsigned int DXTopLevelAS::GetSceneInstanceCount()
+{
+	unsigned int instanceCount = 0;
+	for(Model* model : activeScene->GetModels())
+	{
+		instanceCount += model->GetMeshCount();
+	}
+
+	return instanceCount;
+}
+
 void DXTopLevelAS::SetScene(Scene* scene)
 {
 	activeScene = scene;
@@ -93,4 +164,9 @@ void DXTopLevelAS::SetScene(Scene* scene)
 D3D12_GPU_VIRTUAL_ADDRESS DXTopLevelAS::GetGPUVirtualAddress()
 {
 	return tlasResult->GetGPUVirtualAddress();
+}
+
+float DXTopLevelAS::GetUpdateTime()
+{
+	return updateTime;
 }
\ No newline at end of file
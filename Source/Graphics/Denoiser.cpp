@@ -0,0 +1,461 @@
+#include "Graphics/Denoiser.h"
+#include "Utilities/ThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__)
+#define DENOISER_SSE2
+#include <emmintrin.h>
+
+// Flush-to-zero & denormals-are-zero bits of the MXCSR register //
+static const unsigned int flushDenormals = 0x8040;
+#endif
+
+// 1D B3-spline kernel, indexed by the distance to the center tap //
+static const float kernel[3] = { 3.0f / 8.0f, 1.0f / 4.0f, 1.0f / 16.0f };
+
+// Albedo below this would blow up the noise when it gets divided out //
+static const float minAlbedo = 0.001f;
+
+// Pixels with a (filtered) variance this high get no luminance weight, e.g. when they only got a single sample //
+static const float maxVariance = 1e8f;
+
+// Image planes, kept separately so 4 neighbouring pixels fit a single SSE register //
+struct FilterPlanes
+{
+	std::vector<float> r;
+	std::vector<float> g;
+	std::vector<float> b;
+	std::vector<float> variance;
+
+	void Resize(size_t size)
+	{
+		r.resize(size);
+		g.resize(size);
+		b.resize(size);
+		variance.resize(size);
+	}
+};
+
+struct GuidePlanes
+{
+	std::vector<float> nx;
+	std::vector<float> ny;
+	std::vector<float> nz;
+	std::vector<float> depth;
+	std::vector<uint8_t> isEnvironment;
+};
+
+// Parameters of a single iteration, the same for every pixel //
+struct FilterPass
+{
+	unsigned int width;
+	unsigned int height;
+	int step;
+	float colorPhi;
+	float normalPhi;
+	float depthPhi;
+
+	// 1 / the distance of every tap to the center, in pixels //
+	float inverseDistance[25];
+};
+
+static inline float GetLuminance(float r, float g, float b)
+{
+	return 0.2126f * r + 0.7152f * g + 0.0722f * b;
+}
+
+// exp(x) for x <= 0, as 2^x split into an integer power (through the exponent bits) & a polynomial for the fraction.
+// Accurate to ~1e-4 relative, which is plenty for filter weights, and the SSE2 version computes exactly the same
+static inline float FastExp(float x)
+{
+	float t = std::max(x * 1.442695041f, -126.0f);
+	float whole = floorf(t);
+	float fraction = t - whole;
+
+	float p = 1.0f + fraction * (0.6931472f + fraction * (0.2402265f + fraction * (0.05550411f +
+		fraction * (0.009618129f + fraction * 0.001333355f))));
+
+	int32_t bits = (int32_t(whole) + 127) << 23;
+	float scale;
+	memcpy(&scale, &bits, sizeof(float));
+
+	return p * scale;
+}
+
+// Filters a single pixel, taps outside of the image get skipped //
+static void FilterPixel(const FilterPass& pass, const FilterPlanes& source, const std::vector<float>& filteredVariance,
+	const GuidePlanes& guides, FilterPlanes& destination, int x, int y)
+{
+	const int width = int(pass.width);
+	const int height = int(pass.height);
+	const size_t index = size_t(y) * width + x;
+
+	if(guides.isEnvironment[index])
+	{
+		destination.r[index] = source.r[index];
+		destination.g[index] = source.g[index];
+		destination.b[index] = source.b[index];
+		destination.variance[index] = source.variance[index];
+		return;
+	}
+
+	const float luminance = GetLuminance(source.r[index], source.g[index], source.b[index]);
+	const float luminanceScale = 1.0f / (pass.colorPhi * sqrtf(filteredVariance[index]) + 1e-6f);
+	const float depthScale = 1.0f / (pass.depthPhi * guides.depth[index] + 1e-6f);
+	const float nx = guides.nx[index];
+	const float ny = guides.ny[index];
+	const float nz = guides.nz[index];
+	const float depth = guides.depth[index];
+
+	float weightSum = 0.0f;
+	float squaredWeightSum = 0.0f;
+	float r = 0.0f;
+	float g = 0.0f;
+	float b = 0.0f;
+
+	for(int dy = -2; dy <= 2; dy++)
+	{
+		const int qy = y + dy * pass.step;
+		if(qy < 0 || qy >= height)
+		{
+			continue;
+		}
+
+		for(int dx = -2; dx <= 2; dx++)
+		{
+			const int qx = x + dx * pass.step;
+			if(qx < 0 || qx >= width)
+			{
+				continue;
+			}
+
+			const size_t q = size_t(qy) * width + qx;
+			float weight = kernel[std::abs(dx)] * kernel[std::abs(dy)];
+
+			if(dx != 0 || dy != 0)
+			{
+				float luminanceDistance = fabsf(luminance - GetLuminance(source.r[q], source.g[q], source.b[q])) * luminanceScale;
+				float normalDistance = std::max(1.0f - (nx * guides.nx[q] + ny * guides.ny[q] + nz * guides.nz[q]), 0.0f) * pass.normalPhi;
+				float depthDistance = fabsf(depth - guides.depth[q]) * depthScale * pass.inverseDistance[(dy + 2) * 5 + dx + 2];
+
+				weight *= FastExp(-(luminanceDistance + normalDistance + depthDistance));
+			}
+
+			weightSum += weight;
+			squaredWeightSum += weight * weight * source.variance[q];
+			r += weight * source.r[q];
+			g += weight * source.g[q];
+			b += weight * source.b[q];
+		}
+	}
+
+	// Weights are normalized, so the variance of the weighted average scales with their squares //
+	const float inverseWeightSum = 1.0f / weightSum;
+	destination.r[index] = r * inverseWeightSum;
+	destination.g[index] = g * inverseWeightSum;
+	destination.b[index] = b * inverseWeightSum;
+	destination.variance[index] = squaredWeightSum * inverseWeightSum * inverseWeightSum;
+}
+
+#ifdef DENOISER_SSE2
+static inline __m128 FastExp4(__m128 x)
+{
+	__m128 t = _mm_max_ps(_mm_mul_ps(x, _mm_set1_ps(1.442695041f)), _mm_set1_ps(-126.0f));
+
+	// Truncation rounds negative values up, those get moved down by one //
+	__m128i truncated = _mm_cvttps_epi32(t);
+	__m128 whole = _mm_cvtepi32_ps(truncated);
+	__m128 roundedUp = _mm_cmplt_ps(t, whole);
+	whole = _mm_sub_ps(whole, _mm_and_ps(roundedUp, _mm_set1_ps(1.0f)));
+	truncated = _mm_add_epi32(truncated, _mm_castps_si128(roundedUp));
+
+	__m128 fraction = _mm_sub_ps(t, whole);
+	__m128 p = _mm_add_ps(_mm_set1_ps(0.009618129f), _mm_mul_ps(fraction, _mm_set1_ps(0.001333355f)));
+	p = _mm_add_ps(_mm_set1_ps(0.05550411f), _mm_mul_ps(fraction, p));
+	p = _mm_add_ps(_mm_set1_ps(0.2402265f), _mm_mul_ps(fraction, p));
+	p = _mm_add_ps(_mm_set1_ps(0.6931472f), _mm_mul_ps(fraction, p));
+	p = _mm_add_ps(_mm_set1_ps(1.0f), _mm_mul_ps(fraction, p));
+
+	__m128 scale = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(truncated, _mm_set1_epi32(127)), 23));
+	return _mm_mul_ps(p, scale);
+}
+
+static inline __m128 GetLuminance4(__m128 r, __m128 g, __m128 b)
+{
+	return _mm_add_ps(_mm_add_ps(_mm_mul_ps(r, _mm_set1_ps(0.2126f)), _mm_mul_ps(g, _mm_set1_ps(0.7152f))),
+		_mm_mul_ps(b, _mm_set1_ps(0.0722f)));
+}
+
+// Filters 4 pixels starting at 'x', all of their taps have to be within the image horizontally //
+static void FilterPixels4(const FilterPass& pass, const FilterPlanes& source, const std::vector<float>& filteredVariance,
+	const GuidePlanes& guides, FilterPlanes& destination, int x, int y)
+{
+	const int width = int(pass.width);
+	const int height = int(pass.height);
+	const size_t index = size_t(y) * width + x;
+
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 epsilon = _mm_set1_ps(1e-6f);
+	const __m128 normalPhi = _mm_set1_ps(pass.normalPhi);
+
+	const __m128 sourceR = _mm_loadu_ps(&source.r[index]);
+	const __m128 sourceG = _mm_loadu_ps(&source.g[index]);
+	const __m128 sourceB = _mm_loadu_ps(&source.b[index]);
+	const __m128 sourceVariance = _mm_loadu_ps(&source.variance[index]);
+
+	const __m128 luminance = GetLuminance4(sourceR, sourceG, sourceB);
+	const __m128 luminanceScale = _mm_div_ps(one, _mm_add_ps(_mm_mul_ps(_mm_set1_ps(pass.colorPhi),
+		_mm_sqrt_ps(_mm_loadu_ps(&filteredVariance[index]))), epsilon));
+	const __m128 depth = _mm_loadu_ps(&guides.depth[index]);
+	const __m128 depthScale = _mm_div_ps(one, _mm_add_ps(_mm_mul_ps(_mm_set1_ps(pass.depthPhi), depth), epsilon));
+	const __m128 nx = _mm_loadu_ps(&guides.nx[index]);
+	const __m128 ny = _mm_loadu_ps(&guides.ny[index]);
+	const __m128 nz = _mm_loadu_ps(&guides.nz[index]);
+
+	__m128 weightSum = zero;
+	__m128 squaredWeightSum = zero;
+	__m128 r = zero;
+	__m128 g = zero;
+	__m128 b = zero;
+
+	for(int dy = -2; dy <= 2; dy++)
+	{
+		const int qy = y + dy * pass.step;
+		if(qy < 0 || qy >= height)
+		{
+			continue;
+		}
+
+		for(int dx = -2; dx <= 2; dx++)
+		{
+			const size_t q = size_t(qy) * width + x + dx * pass.step;
+			const __m128 tapR = _mm_loadu_ps(&source.r[q]);
+			const __m128 tapG = _mm_loadu_ps(&source.g[q]);
+			const __m128 tapB = _mm_loadu_ps(&source.b[q]);
+			__m128 weight = _mm_set1_ps(kernel[std::abs(dx)] * kernel[std::abs(dy)]);
+
+			if(dx != 0 || dy != 0)
+			{
+				__m128 luminanceDistance = _mm_mul_ps(_mm_andnot_ps(signMask,
+					_mm_sub_ps(luminance, GetLuminance4(tapR, tapG, tapB))), luminanceScale);
+
+				__m128 cosine = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, _mm_loadu_ps(&guides.nx[q])),
+					_mm_mul_ps(ny, _mm_loadu_ps(&guides.ny[q]))), _mm_mul_ps(nz, _mm_loadu_ps(&guides.nz[q])));
+				__m128 normalDistance = _mm_mul_ps(_mm_max_ps(_mm_sub_ps(one, cosine), zero), normalPhi);
+
+				__m128 depthDistance = _mm_mul_ps(_mm_mul_ps(_mm_andnot_ps(signMask,
+					_mm_sub_ps(depth, _mm_loadu_ps(&guides.depth[q]))), depthScale),
+					_mm_set1_ps(pass.inverseDistance[(dy + 2) * 5 + dx + 2]));
+
+				__m128 distance = _mm_add_ps(_mm_add_ps(luminanceDistance, normalDistance), depthDistance);
+				weight = _mm_mul_ps(weight, FastExp4(_mm_xor_ps(distance, signMask)));
+			}
+
+			weightSum = _mm_add_ps(weightSum, weight);
+			squaredWeightSum = _mm_add_ps(squaredWeightSum, _mm_mul_ps(_mm_mul_ps(weight, weight), _mm_loadu_ps(&source.variance[q])));
+			r = _mm_add_ps(r, _mm_mul_ps(weight, tapR));
+			g = _mm_add_ps(g, _mm_mul_ps(weight, tapG));
+			b = _mm_add_ps(b, _mm_mul_ps(weight, tapB));
+		}
+	}
+
+	const __m128 inverseWeightSum = _mm_div_ps(one, weightSum);
+	__m128 filteredR = _mm_mul_ps(r, inverseWeightSum);
+	__m128 filteredG = _mm_mul_ps(g, inverseWeightSum);
+	__m128 filteredB = _mm_mul_ps(b, inverseWeightSum);
+	__m128 filteredVarianceOut = _mm_mul_ps(_mm_mul_ps(squaredWeightSum, inverseWeightSum), inverseWeightSum);
+
+	// Environment pixels keep their value, the filtered result just gets thrown away //
+	int32_t flags;
+	memcpy(&flags, &guides.isEnvironment[index], sizeof(int32_t));
+	__m128i environmentBytes = _mm_cvtsi32_si128(flags);
+	environmentBytes = _mm_unpacklo_epi8(environmentBytes, environmentBytes);
+	environmentBytes = _mm_unpacklo_epi16(environmentBytes, environmentBytes);
+	__m128 isEnvironment = _mm_castsi128_ps(_mm_cmpgt_epi32(environmentBytes, _mm_setzero_si128()));
+
+	_mm_storeu_ps(&destination.r[index], _mm_or_ps(_mm_and_ps(isEnvironment, sourceR), _mm_andnot_ps(isEnvironment, filteredR)));
+	_mm_storeu_ps(&destination.g[index], _mm_or_ps(_mm_and_ps(isEnvironment, sourceG), _mm_andnot_ps(isEnvironment, filteredG)));
+	_mm_storeu_ps(&destination.b[index], _mm_or_ps(_mm_and_ps(isEnvironment, sourceB), _mm_andnot_ps(isEnvironment, filteredB)));
+	_mm_storeu_ps(&destination.variance[index], _mm_or_ps(_mm_and_ps(isEnvironment, sourceVariance),
+		_mm_andnot_ps(isEnvironment, filteredVarianceOut)));
+}
+#endif
+
+// The luminance weight uses a 3x3 blurred variance, a single pixel's estimate is too noisy by itself.
+// The Gaussian is separable, taps outside of the image are left out of both passes //
+static void FilterVariance(unsigned int width, unsigned int height, const std::vector<float>& variance,
+	std::vector<float>& horizontal, std::vector<float>& filteredVariance)
+{
+	ThreadPool::GetGlobalPool().ParallelFor(height, [&](unsigned int y)
+	{
+		const float* row = &variance[size_t(y) * width];
+		float* result = &horizontal[size_t(y) * width];
+
+		if(width == 1)
+		{
+			result[0] = row[0];
+			return;
+		}
+
+		result[0] = (row[0] * 0.5f + row[1] * 0.25f) / 0.75f;
+		for(unsigned int x = 1; x + 1 < width; x++)
+		{
+			result[x] = row[x - 1] * 0.25f + row[x] * 0.5f + row[x + 1] * 0.25f;
+		}
+		result[width - 1] = (row[width - 2] * 0.25f + row[width - 1] * 0.5f) / 0.75f;
+	}, 8);
+
+	ThreadPool::GetGlobalPool().ParallelFor(height, [&](unsigned int y)
+	{
+		const float* center = &horizontal[size_t(y) * width];
+		const float* above = y > 0 ? center - width : nullptr;
+		const float* below = y + 1 < height ? center + width : nullptr;
+		float* result = &filteredVariance[size_t(y) * width];
+
+		const float weightSum = 0.5f + (above ? 0.25f : 0.0f) + (below ? 0.25f : 0.0f);
+		const float centerWeight = 0.5f / weightSum;
+		const float aboveWeight = above ? 0.25f / weightSum : 0.0f;
+		const float belowWeight = below ? 0.25f / weightSum : 0.0f;
+		above = above ? above : center;
+		below = below ? below : center;
+
+		for(unsigned int x = 0; x < width; x++)
+		{
+			result[x] = above[x] * aboveWeight + center[x] * centerWeight + below[x] * belowWeight;
+		}
+	}, 8);
+}
+
+void DenoiseImage(const DenoiserInput& input, const DenoiserSettings& settings, float* output)
+{
+	const unsigned int width = input.width;
+	const unsigned int height = input.height;
+	const size_t pixelCount = size_t(width) * height;
+
+	FilterPlanes planes[2];
+	planes[0].Resize(pixelCount);
+	planes[1].Resize(pixelCount);
+
+	GuidePlanes guides;
+	guides.nx.resize(pixelCount);
+	guides.ny.resize(pixelCount);
+	guides.nz.resize(pixelCount);
+	guides.depth.resize(pixelCount);
+
+	// Padded, so the last pixels can still load 4 flags at once //
+	guides.isEnvironment.resize(pixelCount + 3, 0);
+
+	std::vector<float> albedo(pixelCount * 3);
+	std::vector<float> horizontalVariance(pixelCount);
+	std::vector<float> filteredVariance(pixelCount);
+
+	// 1. Divide out the albedo, what's left is the (much smoother) irradiance //
+	ThreadPool::GetGlobalPool().ParallelFor(height, [&](unsigned int y)
+	{
+		for(size_t i = size_t(y) * width; i < size_t(y + 1) * width; i++)
+		{
+			float r = std::max(input.albedo[i * 3], minAlbedo);
+			float g = std::max(input.albedo[i * 3 + 1], minAlbedo);
+			float b = std::max(input.albedo[i * 3 + 2], minAlbedo);
+			float albedoLuminance = GetLuminance(r, g, b);
+
+			albedo[i * 3] = r;
+			albedo[i * 3 + 1] = g;
+			albedo[i * 3 + 2] = b;
+
+			planes[0].r[i] = input.color[i * 3] / r;
+			planes[0].g[i] = input.color[i * 3 + 1] / g;
+			planes[0].b[i] = input.color[i * 3 + 2] / b;
+			planes[0].variance[i] = std::min(input.variance[i] / (albedoLuminance * albedoLuminance), maxVariance);
+
+			guides.nx[i] = input.normal[i * 3];
+			guides.ny[i] = input.normal[i * 3 + 1];
+			guides.nz[i] = input.normal[i * 3 + 2];
+			guides.depth[i] = input.depth[i];
+
+			// Normals are averaged over the samples, a (near) zero one means (nearly) every sample missed //
+			float normalLength = guides.nx[i] * guides.nx[i] + guides.ny[i] * guides.ny[i] + guides.nz[i] * guides.nz[i];
+			guides.isEnvironment[i] = normalLength < 1e-4f ? 1 : 0;
+		}
+	}, 8);
+
+	// 2. A-trous iterations, every one spreads its taps twice as far apart //
+	unsigned int current = 0;
+	for(unsigned int iteration = 0; iteration < settings.iterationCount; iteration++)
+	{
+		FilterPass pass;
+		pass.width = width;
+		pass.height = height;
+		pass.step = 1 << iteration;
+		pass.colorPhi = settings.colorPhi;
+		pass.normalPhi = settings.normalPhi;
+		pass.depthPhi = settings.depthPhi;
+
+		for(int dy = -2; dy <= 2; dy++)
+		{
+			for(int dx = -2; dx <= 2; dx++)
+			{
+				float distance = sqrtf(float(dx * dx + dy * dy)) * pass.step;
+				pass.inverseDistance[(dy + 2) * 5 + dx + 2] = distance > 0.0f ? 1.0f / distance : 0.0f;
+			}
+		}
+
+		FilterVariance(width, height, planes[current].variance, horizontalVariance, filteredVariance);
+
+		const FilterPlanes& source = planes[current];
+		FilterPlanes& destination = planes[1 - current];
+
+		ThreadPool::GetGlobalPool().ParallelFor(height, [&](unsigned int y)
+		{
+			int x = 0;
+
+#ifdef DENOISER_SSE2
+			// Weights of dissimilar taps get tiny, denormals would slow every operation on them down a lot //
+			const unsigned int controlState = _mm_getcsr();
+			_mm_setcsr(controlState | flushDenormals);
+
+			// Only pixels of which all taps are within the image go 4 at a time, the borders are done one by one //
+			const int border = 2 * pass.step;
+			for(; x < border && x < int(width); x++)
+			{
+				FilterPixel(pass, source, filteredVariance, guides, destination, x, y);
+			}
+
+			for(; x + 3 + border < int(width); x += 4)
+			{
+				FilterPixels4(pass, source, filteredVariance, guides, destination, x, y);
+			}
+#endif
+
+			for(; x < int(width); x++)
+			{
+				FilterPixel(pass, source, filteredVariance, guides, destination, x, y);
+			}
+
+#ifdef DENOISER_SSE2
+			_mm_setcsr(controlState);
+#endif
+		}, 4);
+
+		current = 1 - current;
+	}
+
+	// 3. Multiply the albedo back in //
+	const FilterPlanes& result = planes[current];
+	ThreadPool::GetGlobalPool().ParallelFor(height, [&](unsigned int y)
+	{
+		for(size_t i = size_t(y) * width; i < size_t(y + 1) * width; i++)
+		{
+			output[i * 3] = result.r[i] * albedo[i * 3];
+			output[i * 3 + 1] = result.g[i] * albedo[i * 3 + 1];
+			output[i * 3 + 2] = result.b[i] * albedo[i * 3 + 2];
+		}
+	}, 8);
+}
\ No newline at end of file
@@ -0,0 +1,64 @@
+#include "Graphics/EnvironmentDistribution.h"
+#include "Utilities/ThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Radiance of the environment gets clamped by the 'Miss' shader, the distribution follows that //
+static const float maxEnvironmentRadiance = 100.0f;
+
+void BuildEnvironmentDistribution(const float* data, unsigned int width, unsigned int height, std::vector<float>& distribution)
+{
+	distribution.resize(GetEnvironmentDistributionSize(width, height));
+	float* marginal = distribution.data();
+	float* conditionals = distribution.data() + height + 1;
+
+	// 1. Every row builds its own conditional CDF, and keeps its total as the function value of the marginal //
+	std::vector<double> rowSums(height);
+
+	ThreadPool::GetGlobalPool().ParallelFor(height, [&](unsigned int y)
+	{
+		const float* row = &data[size_t(y) * width * 4];
+		float* conditional = &conditionals[size_t(y) * (width + 1)];
+
+		// Rows near the poles cover a smaller part of the sphere //
+		double sinTheta = sin((y + 0.5) / height * 3.14159265358979);
+		double sum = 0.0;
+
+		conditional[0] = 0.0f;
+		for(unsigned int x = 0; x < width; x++)
+		{
+			const float* pixel = &row[x * 4];
+			double luminance = 0.2126 * std::min(pixel[0], maxEnvironmentRadiance) +
+				0.7152 * std::min(pixel[1], maxEnvironmentRadiance) + 0.0722 * std::min(pixel[2], maxEnvironmentRadiance);
+
+			sum += std::max(luminance, 0.0) * sinTheta;
+			conditional[x + 1] = float(sum);
+		}
+
+		// Rows without any light get sampled uniformly, the marginal never picks them anyway //
+		for(unsigned int x = 1; x <= width; x++)
+		{
+			conditional[x] = sum > 0.0 ? float(conditional[x] / sum) : float(x) / width;
+		}
+		conditional[width] = 1.0f;
+
+		rowSums[y] = sum;
+	}, 16);
+
+	// 2. The marginal CDF picks a row, proportional to the total of the row //
+	double total = 0.0;
+	marginal[0] = 0.0f;
+
+	for(unsigned int y = 0; y < height; y++)
+	{
+		total += rowSums[y];
+		marginal[y + 1] = float(total);
+	}
+
+	for(unsigned int y = 1; y <= height; y++)
+	{
+		marginal[y] = total > 0.0 ? float(marginal[y] / total) : float(y) / height;
+	}
+	marginal[height] = 1.0f;
+}
\ No newline at end of file
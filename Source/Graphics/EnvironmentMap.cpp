@@ -1,11 +1,30 @@
 #include "Graphics/EnvironmentMap.h"
 #include "Graphics/Texture.h"
+#include "Graphics/DXStructuredBuffer.h"
+#include "Graphics/EnvironmentDistribution.h"
 #include "Utilities/Logger.h"
 
 #include <assert.h>
+#include <chrono>
+#include <vector>
 #include <tinyexr.h>
 
-EnvironmentMap::EnvironmentMap(const std::string& filePath)
+static DXGI_FORMAT GetHDRTextureFormat(HDRFormat format)
+{
+	switch(format)
+	{
+	case HDRFormat::RGBA16F:
+		return DXGI_FORMAT_R16G16B16A16_FLOAT;
+	case HDRFormat::RGB9E5:
+		return DXGI_FORMAT_R9G9B9E5_SHAREDEXP;
+	case HDRFormat::RGBA32F:
+		break;
+	}
+
+	return DXGI_FORMAT_R32G32B32A32_FLOAT;
+}
+
+EnvironmentMap::EnvironmentMap(const std::string& filePath, HDRFormat format, unsigned int levelCount)
 {
 	const char* err = nullptr;
 	float* image;
@@ -20,8 +39,60 @@ EnvironmentMap::EnvironmentMap(const std::string& filePath)
 		assert(false);
 	}
 
-	environmentTexture = new Texture(image, width, height, DXGI_FORMAT_R32G32B32A32_FLOAT, sizeof(float) * 4);
-	delete image;
+	// 1. Prefilter the levels at full precision, then convert all of them into the stored format //
+	auto conversionStart = std::chrono::high_resolution_clock::now();
+
+	std::vector<float> mipChain;
+	std::vector<MipLevel> levels;
+	const float* chainData = image;
+
+	if(levelCount > 1)
+	{
+		GenerateHDRMipChain(image, width, height, levelCount, mipChain, levels);
+		chainData = mipChain.data();
+	}
+	else
+	{
+		levels.push_back({ (unsigned int)width, (unsigned int)height, 0 });
+	}
+
+	const MipLevel& lastLevel = levels.back();
+	size_t pixelCount = lastLevel.offset / (sizeof(float) * 4) + size_t(lastLevel.width) * lastLevel.height;
+
+	unsigned int pixelSize = GetHDRPixelSize(format);
+	std::vector<unsigned char> convertedChain(pixelCount * pixelSize);
+	ConvertHDRPixels(chainData, pixelCount, format, convertedChain.data());
+
+	for(MipLevel& level : levels)
+	{
+		level.offset = level.offset / (sizeof(float) * 4) * pixelSize;
+	}
+
+	auto conversionEnd = std::chrono::high_resolution_clock::now();
+	float conversionTime = std::chrono::duration<float, std::milli>(conversionEnd - conversionStart).count();
+
+	float originalSize = float(width) * height * sizeof(float) * 4 / (1024.0f * 1024.0f);
+	float storedSize = float(convertedChain.size()) / (1024.0f * 1024.0f);
+	LOG("Environment map (" + std::to_string(width) + "x" + std::to_string(height) + ") stored as " + 
+		GetHDRFormatName(format) + " with " + std::to_string(levels.size()) + " levels: " + std::to_string(storedSize) + 
+		"MB instead of " + std::to_string(originalSize) + "MB, converted in " + std::to_string(conversionTime) + "ms");
+
+	environmentTexture = new Texture(convertedChain.data(), levels, GetHDRTextureFormat(format), pixelSize);
+
+	// 2. Importance sampling uses the brightness of the original image //
+	auto distributionStart = std::chrono::high_resolution_clock::now();
+	std::vector<float> distribution;
+	BuildEnvironmentDistribution(image, width, height, distribution);
+	auto distributionEnd = std::chrono::high_resolution_clock::now();
+
+	float distributionTime = std::chrono::duration<float, std::milli>(distributionEnd - distributionStart).count();
+	LOG("Built environment distribution (" + std::to_string(width) + "x" + std::to_string(height) + ") in "
+		+ std::to_string(distributionTime) + "ms");
+
+	distributionBuffer = new DXStructuredBuffer(distribution.data(), distribution.size(), sizeof(float));
+
+	// tinyexr allocates with malloc //
+	free(image);
 }
 
 Texture* EnvironmentMap::GetTexture()
@@ -29,6 +100,16 @@ Texture* EnvironmentMap::GetTexture()
 	return environmentTexture;
 }
 
+DXStructuredBuffer* EnvironmentMap::GetDistributionBuffer()
+{
+	return distributionBuffer;
+}
+
+D3D12_GPU_VIRTUAL_ADDRESS EnvironmentMap::GetDistributionGPUAddress()
+{
+	return distributionBuffer->GetResource()->GetGPUVirtualAddress();
+}
+
 DXGI_FORMAT EnvironmentMap::GetFormat()
 {
 	return environmentTexture->GetFormat();
@@ -0,0 +1,711 @@
+#include "Graphics/Extensions/Shared_TinyglTF.h"
+#include <json.hpp>
+#include <algorithm>
+#include <cfloat>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__)
+#define GLTF_DECODE_SSE2
+#include <emmintrin.h>
+#endif
+
+// Binary glTF layout: a 12 byte header followed by a JSON chunk and an optional BIN chunk
+static const unsigned int glbMagic = 0x46546C67; // 'glTF'
+static const unsigned int glbChunkJSON = 0x4E4F534A; // 'JSON'
+static const unsigned int glbChunkBIN = 0x004E4942; // 'BIN\0'
+
+// Smallest buffer tinyglTF accepts, replaces the 'uri' of a buffer that is mapped by us instead
+static const char* placeholderBufferURI = "data:application/octet-stream;base64,AA==";
+
+static void glTFLogParseResult(const std::string& error, const std::string& warning)
+{
+	if(!warning.empty())
+	{
+		LOG(Log::MessageType::Debug, warning);
+	}
+
+	if(!error.empty())
+	{
+		LOG(Log::MessageType::Error, error);
+	}
+}
+
+static bool glTFReadGLBChunks(MappedFile* source, const char** json, size_t* jsonSize,
+	const unsigned char** binChunk, size_t* binSize)
+{
+	const unsigned char* data = source->GetData();
+	size_t size = source->GetSize();
+
+	unsigned int header[3];
+	if(size < 20)
+	{
+		return false;
+	}
+
+	memcpy(header, data, sizeof(header));
+	if(header[0] != glbMagic || header[1] != 2 || header[2] > size)
+	{
+		return false;
+	}
+
+	unsigned int chunkHeader[2];
+	memcpy(chunkHeader, data + 12, sizeof(chunkHeader));
+	if(chunkHeader[1] != glbChunkJSON || 20 + size_t(chunkHeader[0]) > size)
+	{
+		return false;
+	}
+
+	*json = reinterpret_cast<const char*>(data + 20);
+	*jsonSize = chunkHeader[0];
+
+	// Chunks are 4 byte aligned //
+	size_t binChunkStart = 20 + ((size_t(chunkHeader[0]) + 3) & ~size_t(3));
+	if(binChunkStart + 8 <= size)
+	{
+		memcpy(chunkHeader, data + binChunkStart, sizeof(chunkHeader));
+		if(chunkHeader[1] == glbChunkBIN && binChunkStart + 8 + chunkHeader[0] <= size)
+		{
+			*binChunk = data + binChunkStart + 8;
+			*binSize = chunkHeader[0];
+		}
+	}
+
+	return true;
+}
+
+static bool glTFLoadMappedFile(glTFFile& file, const std::string& filePath, bool isBinary,
+	std::string& error, std::string& warning)
+{
+	tinygltf::TinyGLTF loader;
+	std::string baseDirectory = filePath.substr(0, filePath.find_last_of("\\/") + 1);
+
+	MappedFile* source = new MappedFile(filePath);
+	file.mappedFiles.push_back(source);
+
+	if(!source->IsValid())
+	{
+		error = "Failed to map glTF file: " + filePath;
+		return false;
+	}
+
+	// 1. Find the JSON, for a .glb it's stored as the first chunk //
+	const char* json = reinterpret_cast<const char*>(source->GetData());
+	size_t jsonSize = source->GetSize();
+	const unsigned char* binChunk = nullptr;
+	size_t binSize = 0;
+
+	if(isBinary && !glTFReadGLBChunks(source, &json, &jsonSize, &binChunk, &binSize))
+	{
+		error = "Invalid binary glTF file: " + filePath;
+		return false;
+	}
+
+	nlohmann::json document = nlohmann::json::parse(json, json + jsonSize, nullptr, false);
+	if(document.is_discarded() || !document.contains("buffers"))
+	{
+		// Let tinyglTF deal with (and report on) anything unusual
+		return isBinary ? loader.LoadBinaryFromMemory(&file.model, &error, &warning, source->GetData(), source->GetSize(), baseDirectory)
+			: loader.LoadASCIIFromString(&file.model, &error, &warning, json, jsonSize, baseDirectory);
+	}
+
+	nlohmann::json& buffers = document["buffers"];
+	std::vector<const unsigned char*> mappedBuffers(buffers.size(), nullptr);
+
+	// 2. Images get decoded by tinyglTF while parsing, so their buffers have to stay in memory //
+	std::vector<bool> isImageBuffer(buffers.size(), false);
+	if(document.contains("images") && document.contains("bufferViews"))
+	{
+		for(nlohmann::json& image : document["images"])
+		{
+			if(image.contains("bufferView"))
+			{
+				int buffer = document["bufferViews"][image["bufferView"].get<int>()]["buffer"].get<int>();
+				isImageBuffer[buffer] = true;
+			}
+		}
+	}
+
+	// 3. Map the remaining binary buffers, and replace them with a placeholder for tinyglTF //
+	bool isBinChunkMapped = false;
+
+	for(size_t i = 0; i < buffers.size(); i++)
+	{
+		nlohmann::json& buffer = buffers[i];
+		size_t byteLength = buffer.value("byteLength", size_t(0));
+
+		if(isImageBuffer[i])
+		{
+			continue;
+		}
+
+		if(!buffer.contains("uri"))
+		{
+			// Buffer without 'uri' refers to the BIN chunk of the .glb
+			if(binChunk != nullptr && byteLength <= binSize)
+			{
+				mappedBuffers[i] = binChunk;
+				isBinChunkMapped = true;
+			}
+		}
+		else
+		{
+			std::string uri = buffer["uri"].get<std::string>();
+			std::string decodedURI;
+
+			if(tinygltf::IsDataURI(uri) || !tinygltf::URIDecode(uri, &decodedURI, nullptr))
+			{
+				continue;
+			}
+
+			MappedFile* bin = new MappedFile(baseDirectory + decodedURI);
+			if(!bin->IsValid() || bin->GetSize() < byteLength)
+			{
+				// tinyglTF will report the missing or incomplete file
+				delete bin;
+				continue;
+			}
+
+			file.mappedFiles.push_back(bin);
+			file.mappedBufferURIs.push_back(decodedURI);
+			mappedBuffers[i] = bin->GetData();
+		}
+
+		if(mappedBuffers[i] != nullptr)
+		{
+			buffer["uri"] = placeholderBufferURI;
+			buffer["byteLength"] = 1;
+		}
+	}
+
+	// When the BIN chunk still has to be read by tinyglTF the whole .glb is handed over,
+	// this still avoids reading the file into memory first.
+	if(isBinary && binChunk != nullptr && !isBinChunkMapped)
+	{
+		file.mappedBuffers.clear();
+		file.mappedBufferURIs.clear();
+		return loader.LoadBinaryFromMemory(&file.model, &error, &warning, source->GetData(), source->GetSize(), baseDirectory);
+	}
+
+	std::string patchedJSON = document.dump();
+	file.mappedBuffers = mappedBuffers;
+
+	return loader.LoadASCIIFromString(&file.model, &error, &warning, patchedJSON.c_str(),
+		patchedJSON.size(), baseDirectory);
+}
+
+bool glTFLoadFile(glTFFile& file, const std::string& filePath, bool mapBuffers)
+{
+	std::string extension = filePath.substr(filePath.find_last_of('.') + 1);
+	bool isBinary = extension == "glb" || extension == "GLB";
+
+	std::string error;
+	std::string warning;
+	bool result;
+
+	if(mapBuffers)
+	{
+		result = glTFLoadMappedFile(file, filePath, isBinary, error, warning);
+	}
+	else
+	{
+		tinygltf::TinyGLTF loader;
+		result = isBinary ? loader.LoadBinaryFromFile(&file.model, &error, &warning, filePath)
+			: loader.LoadASCIIFromFile(&file.model, &error, &warning, filePath);
+	}
+
+	glTFLogParseResult(error, warning);
+	return result;
+}
+
+#pragma region Attribute Decoding
+// Where a glTF attribute ends up in 'Vertex', and how many components it occupies there
+struct glTFAttributeTarget
+{
+	size_t offset;
+	unsigned int componentCount;
+};
+
+static bool glTFGetAttributeTarget(const std::string& attributeType, glTFAttributeTarget& target)
+{
+	if(attributeType == "POSITION")
+	{
+		target = { offsetof(Vertex, Position), 3 };
+	}
+	else if(attributeType == "NORMAL")
+	{
+		target = { offsetof(Vertex, Normal), 3 };
+	}
+	else if(attributeType == "TANGENT")
+	{
+		// Tangents are stored as float4, the 'w' component holds the sign of the bitangent
+		target = { offsetof(Vertex, Tangent), 4 };
+	}
+	else if(attributeType == "TEXCOORD_0")
+	{
+		target = { offsetof(Vertex, TextureCoord0), 2 };
+	}
+	else
+	{
+		return false;
+	}
+
+	return true;
+}
+
+template<unsigned int ComponentCount>
+static void glTFCopyFloats(unsigned char* destination, const unsigned char* source, size_t sourceStride, size_t count)
+{
+	// Fixed size copies, compiled into plain (vector) moves instead of memcpy calls
+	for(size_t i = 0; i < count; i++)
+	{
+		memcpy(destination + i * sizeof(Vertex), source + i * sourceStride, sizeof(float) * ComponentCount);
+	}
+}
+
+#ifdef GLTF_DECODE_SSE2
+// Writes the first 'ComponentCount' lanes, never touching the 'Vertex' member that follows
+template<unsigned int ComponentCount>
+static inline void glTFStoreFloats(unsigned char* destination, __m128 values)
+{
+	float* output = reinterpret_cast<float*>(destination);
+
+	if(ComponentCount == 4)
+	{
+		_mm_storeu_ps(output, values);
+	}
+	else if(ComponentCount >= 2)
+	{
+		_mm_storel_pi(reinterpret_cast<__m64*>(output), values);
+		if(ComponentCount == 3)
+		{
+			_mm_store_ss(output + 2, _mm_movehl_ps(values, values));
+		}
+	}
+	else
+	{
+		_mm_store_ss(output, values);
+	}
+}
+
+// Sign or zero extends the low half of the lanes to twice their size
+template<bool IsSigned>
+static inline __m128i glTFWidenLow8(__m128i packed)
+{
+	return IsSigned ? _mm_srai_epi16(_mm_unpacklo_epi8(packed, packed), 8) : _mm_unpacklo_epi8(packed, _mm_setzero_si128());
+}
+
+template<bool IsSigned>
+static inline __m128i glTFWidenHigh8(__m128i packed)
+{
+	return IsSigned ? _mm_srai_epi16(_mm_unpackhi_epi8(packed, packed), 8) : _mm_unpackhi_epi8(packed, _mm_setzero_si128());
+}
+
+template<bool IsSigned>
+static inline __m128i glTFWidenLow16(__m128i packed)
+{
+	return IsSigned ? _mm_srai_epi32(_mm_unpacklo_epi16(packed, packed), 16) : _mm_unpacklo_epi16(packed, _mm_setzero_si128());
+}
+
+template<bool IsSigned>
+static inline __m128i glTFWidenHigh16(__m128i packed)
+{
+	return IsSigned ? _mm_srai_epi32(_mm_unpackhi_epi16(packed, packed), 16) : _mm_unpackhi_epi16(packed, _mm_setzero_si128());
+}
+#endif
+
+// Converts integer components to floats, normalized integers get mapped to [0, 1] or [-1, 1] as described by the glTF spec
+template<typename ComponentType, unsigned int ComponentCount>
+static void glTFConvertIntegers(unsigned char* destination, const unsigned char* source, size_t sourceStride, 
+	size_t count, bool normalized)
+{
+	const bool isSigned = ComponentType(-1) < ComponentType(0);
+	const float scale = normalized ? 1.0f / float(std::numeric_limits<ComponentType>::max()) : 1.0f;
+	const float minimum = normalized && isSigned ? -1.0f : -FLT_MAX;
+	size_t i = 0;
+
+#ifdef GLTF_DECODE_SSE2
+	static_assert(sizeof(ComponentType) <= 2, "Only 8 & 16-bit components get converted");
+
+	// Every element is gathered with a single 4 (8-bit) or 8 (16-bit) byte load, which can read past a smaller element.
+	// Only elements of which that load stays within the accessor take this path, the rest gets converted one by one.
+	const size_t loadSize = sizeof(ComponentType) * 4;
+	const size_t elementSize = sizeof(ComponentType) * ComponentCount;
+	const size_t accessorSize = count > 0 ? (count - 1) * sourceStride + elementSize : 0;
+	const size_t loadableCount = accessorSize >= loadSize ? std::min(count, (accessorSize - loadSize) / sourceStride + 1) : 0;
+
+	const __m128 scale4 = _mm_set1_ps(scale);
+	const __m128 minimum4 = _mm_set1_ps(minimum);
+
+	// Four elements at a time: gathered into registers, widened to 32-bit integers & converted together
+	for(; i + 4 <= loadableCount; i += 4)
+	{
+		const unsigned char* elements = source + i * sourceStride;
+		__m128i widened[4];
+
+		if(sizeof(ComponentType) == 1)
+		{
+			uint32_t loaded[4];
+			for(unsigned int e = 0; e < 4; e++)
+			{
+				memcpy(&loaded[e], elements + e * sourceStride, sizeof(uint32_t));
+			}
+
+			__m128i packed = _mm_setr_epi32(int(loaded[0]), int(loaded[1]), int(loaded[2]), int(loaded[3]));
+			__m128i low = glTFWidenLow8<isSigned>(packed);
+			__m128i high = glTFWidenHigh8<isSigned>(packed);
+
+			widened[0] = glTFWidenLow16<isSigned>(low);
+			widened[1] = glTFWidenHigh16<isSigned>(low);
+			widened[2] = glTFWidenLow16<isSigned>(high);
+			widened[3] = glTFWidenHigh16<isSigned>(high);
+		}
+		else
+		{
+			uint64_t loaded[4];
+			for(unsigned int e = 0; e < 4; e++)
+			{
+				memcpy(&loaded[e], elements + e * sourceStride, sizeof(uint64_t));
+			}
+
+			__m128i first = _mm_set_epi64x(int64_t(loaded[1]), int64_t(loaded[0]));
+			__m128i second = _mm_set_epi64x(int64_t(loaded[3]), int64_t(loaded[2]));
+
+			widened[0] = glTFWidenLow16<isSigned>(first);
+			widened[1] = glTFWidenHigh16<isSigned>(first);
+			widened[2] = glTFWidenLow16<isSigned>(second);
+			widened[3] = glTFWidenHigh16<isSigned>(second);
+		}
+
+		for(unsigned int e = 0; e < 4; e++)
+		{
+			__m128 values = _mm_mul_ps(_mm_cvtepi32_ps(widened[e]), scale4);
+			glTFStoreFloats<ComponentCount>(destination + (i + e) * sizeof(Vertex), _mm_max_ps(values, minimum4));
+		}
+	}
+#endif
+
+	// Same math as above, so the remaining elements round the same way
+	for(; i < count; i++)
+	{
+		ComponentType components[ComponentCount];
+		memcpy(components, source + i * sourceStride, sizeof(components));
+
+		float converted[ComponentCount];
+		for(unsigned int c = 0; c < ComponentCount; c++)
+		{
+			converted[c] = std::max(float(components[c]) * scale, minimum);
+		}
+
+		memcpy(destination + i * sizeof(Vertex), converted, sizeof(converted));
+	}
+}
+
+template<typename ComponentType>
+static void glTFConvertIntegers(unsigned char* destination, const unsigned char* source, size_t sourceStride,
+	size_t count, unsigned int componentCount, bool normalized)
+{
+	if(componentCount == 2)
+	{
+		glTFConvertIntegers<ComponentType, 2>(destination, source, sourceStride, count, normalized);
+	}
+	else if(componentCount == 3)
+	{
+		glTFConvertIntegers<ComponentType, 3>(destination, source, sourceStride, count, normalized);
+	}
+	else if(componentCount == 4)
+	{
+		glTFConvertIntegers<ComponentType, 4>(destination, source, sourceStride, count, normalized);
+	}
+	else
+	{
+		glTFConvertIntegers<ComponentType, 1>(destination, source, sourceStride, count, normalized);
+	}
+}
+
+// A vertex attribute with its accessor, buffer view & destination resolved, ready to be decoded in bulk
+struct glTFAttributeSource
+{
+	const unsigned char* data;
+	size_t stride;
+	size_t count;
+	size_t destinationOffset;
+	unsigned int componentCount;
+	int componentType;
+	bool normalized;
+};
+
+static bool glTFResolveVertexAttribute(const std::string& attributeType, glTFFile& file,
+	tinygltf::Primitive& primitive, glTFAttributeSource& source)
+{
+	tinygltf::Model& model = file.model;
+	auto attribute = primitive.attributes.find(attributeType);
+
+	// Check if within the primitives's attributes the type is present. For example 'Normals'
+	// If not, return here, since there is no data to load in. 
+	if(attribute == primitive.attributes.end())
+	{
+		std::string message = "Attribute Type: '" + attributeType + "' missing from this mesh.";
+		LOG(Log::MessageType::Debug, message);
+		return false;
+	}
+
+	glTFAttributeTarget target;
+	if(!glTFGetAttributeTarget(attributeType, target))
+	{
+		return false;
+	}
+
+	// Accessor: Tells use which view we need, what type of data is in it, and the amount/count of data.
+	// BufferView: Tells which buffer we need, and where we need to be in the buffer
+	// Buffer: Binary data of our mesh
+	tinygltf::Accessor& accessor = model.accessors[attribute->second];
+	if(accessor.bufferView < 0)
+	{
+		return false;
+	}
+
+	switch(accessor.componentType)
+	{
+	case TINYGLTF_COMPONENT_TYPE_FLOAT:
+	case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+	case TINYGLTF_COMPONENT_TYPE_BYTE:
+	case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+	case TINYGLTF_COMPONENT_TYPE_SHORT:
+		break;
+
+	default:
+		LOG(Log::MessageType::Error, "Unsupported component type for attribute: " + attributeType);
+		return false;
+	}
+
+	tinygltf::BufferView& view = model.bufferViews[accessor.bufferView];
+	const unsigned char* buffer = glTFGetBufferData(file, view.buffer);
+
+	// Accessor byteoffset: Offset to first element of type
+	// BufferView byteoffset: Offset to get to this primitives buffer data in the overall buffer
+	source.data = buffer + accessor.byteOffset + view.byteOffset;
+
+	// Stride: Distance in buffer till next element occurs
+	source.stride = accessor.ByteStride(view);
+	source.count = accessor.count;
+	source.destinationOffset = target.offset;
+
+	// Type: a structure made out of components, e.g VEC2 ( 2x float ), only the components 'Vertex' stores get loaded
+	source.componentCount = std::min(static_cast<unsigned int>(tinygltf::GetNumComponentsInType(accessor.type)), target.componentCount);
+	source.componentType = accessor.componentType;
+	source.normalized = accessor.normalized;
+	return true;
+}
+
+// Decodes the elements [first, first + count) of an attribute into the matching vertices
+static void glTFDecodeVertexAttribute(const glTFAttributeSource& attribute, Vertex* vertices, size_t first, size_t count)
+{
+	unsigned char* destination = reinterpret_cast<unsigned char*>(vertices + first) + attribute.destinationOffset;
+	const unsigned char* source = attribute.data + first * attribute.stride;
+	size_t stride = attribute.stride;
+	unsigned int componentCount = attribute.componentCount;
+	bool normalized = attribute.normalized;
+
+	switch(attribute.componentType)
+	{
+	case TINYGLTF_COMPONENT_TYPE_FLOAT:
+		if(componentCount == 2)
+		{
+			glTFCopyFloats<2>(destination, source, stride, count);
+		}
+		else if(componentCount == 3)
+		{
+			glTFCopyFloats<3>(destination, source, stride, count);
+		}
+		else if(componentCount == 4)
+		{
+			glTFCopyFloats<4>(destination, source, stride, count);
+		}
+		else
+		{
+			glTFCopyFloats<1>(destination, source, stride, count);
+		}
+		break;
+
+	case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+		glTFConvertIntegers<uint8_t>(destination, source, stride, count, componentCount, normalized);
+		break;
+
+	case TINYGLTF_COMPONENT_TYPE_BYTE:
+		glTFConvertIntegers<int8_t>(destination, source, stride, count, componentCount, normalized);
+		break;
+
+	case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+		glTFConvertIntegers<uint16_t>(destination, source, stride, count, componentCount, normalized);
+		break;
+
+	case TINYGLTF_COMPONENT_TYPE_SHORT:
+		glTFConvertIntegers<int16_t>(destination, source, stride, count, componentCount, normalized);
+		break;
+	}
+}
+
+void glTFLoadVertexAttribute(std::vector<Vertex>& vertices, const std::string& attributeType,
+	glTFFile& file, tinygltf::Primitive& primitive)
+{
+	glTFAttributeSource attribute;
+	if(!glTFResolveVertexAttribute(attributeType, file, primitive, attribute))
+	{
+		return;
+	}
+
+	// In case it hasn't happened, resize the vertex buffer since we're 
+	// going to directly write the data into an already existing buffer
+	if(vertices.size() < attribute.count)
+	{
+		vertices.resize(attribute.count);
+	}
+
+	glTFDecodeVertexAttribute(attribute, vertices.data(), 0, attribute.count);
+}
+
+void glTFLoadVertices(std::vector<Vertex>& vertices, glTFFile& file, tinygltf::Primitive& primitive)
+{
+	const char* attributeTypes[] = { "POSITION", "NORMAL", "TANGENT", "TEXCOORD_0" };
+
+	glTFAttributeSource attributes[4];
+	unsigned int attributeCount = 0;
+	size_t vertexCount = 0;
+
+	for(const char* attributeType : attributeTypes)
+	{
+		if(glTFResolveVertexAttribute(attributeType, file, primitive, attributes[attributeCount]))
+		{
+			vertexCount = std::max(vertexCount, attributes[attributeCount].count);
+			attributeCount++;
+		}
+	}
+
+	// All attributes are known up front, so the vertices only get allocated once
+	vertices.resize(vertexCount);
+
+	// Decoding happens in blocks small enough to stay in cache, so every attribute writes into
+	// vertices that are still cached, instead of each attribute streaming over the whole array again
+	const size_t blockSize = 2048;
+	for(size_t first = 0; first < vertexCount; first += blockSize)
+	{
+		for(unsigned int i = 0; i < attributeCount; i++)
+		{
+			const glTFAttributeSource& attribute = attributes[i];
+			if(first < attribute.count)
+			{
+				size_t count = std::min(blockSize, attribute.count - first);
+				glTFDecodeVertexAttribute(attribute, vertices.data(), first, count);
+			}
+		}
+	}
+}
+#pragma endregion
+
+#pragma region Index Decoding
+template<typename IndexType>
+static void glTFWidenIndices(unsigned int* destination, const unsigned char* source, size_t stride, size_t count)
+{
+	size_t i = 0;
+
+#ifdef GLTF_DECODE_SSE2
+	// Tightly packed indices get widened 16 bytes at a time
+	if(stride == sizeof(IndexType) && sizeof(IndexType) < sizeof(unsigned int))
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const size_t indicesPerStep = 16 / sizeof(IndexType);
+
+		for(; i + indicesPerStep <= count; i += indicesPerStep)
+		{
+			__m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * sizeof(IndexType)));
+			__m128i* output = reinterpret_cast<__m128i*>(destination + i);
+
+			if(sizeof(IndexType) == 1)
+			{
+				__m128i low = _mm_unpacklo_epi8(packed, zero);
+				__m128i high = _mm_unpackhi_epi8(packed, zero);
+
+				_mm_storeu_si128(output + 0, _mm_unpacklo_epi16(low, zero));
+				_mm_storeu_si128(output + 1, _mm_unpackhi_epi16(low, zero));
+				_mm_storeu_si128(output + 2, _mm_unpacklo_epi16(high, zero));
+				_mm_storeu_si128(output + 3, _mm_unpackhi_epi16(high, zero));
+			}
+			else
+			{
+				_mm_storeu_si128(output + 0, _mm_unpacklo_epi16(packed, zero));
+				_mm_storeu_si128(output + 1, _mm_unpackhi_epi16(packed, zero));
+			}
+		}
+	}
+#endif
+
+	if(stride == sizeof(IndexType) && sizeof(IndexType) == sizeof(unsigned int))
+	{
+		memcpy(destination, source, count * sizeof(unsigned int));
+		return;
+	}
+
+	for(; i < count; i++)
+	{
+		IndexType index;
+		memcpy(&index, source + i * stride, sizeof(IndexType));
+		destination[i] = index;
+	}
+}
+
+void glTFLoadIndices(std::vector<unsigned int>& indices, glTFFile& file, tinygltf::Primitive& primitive)
+{
+	tinygltf::Model& model = file.model;
+	size_t start = indices.size();
+
+	// Non-indexed geometry, every vertex is only used once //
+	if(primitive.indices < 0)
+	{
+		auto position = primitive.attributes.find("POSITION");
+		if(position != primitive.attributes.end())
+		{
+			size_t vertexCount = model.accessors[position->second].count;
+			indices.resize(start + vertexCount);
+
+			for(size_t i = 0; i < vertexCount; i++)
+			{
+				indices[start + i] = static_cast<unsigned int>(i);
+			}
+		}
+
+		return;
+	}
+
+	tinygltf::Accessor& accessor = model.accessors[primitive.indices];
+	tinygltf::BufferView& view = model.bufferViews[accessor.bufferView];
+	const unsigned char* buffer = glTFGetBufferData(file, view.buffer);
+
+	const unsigned char* source = buffer + accessor.byteOffset + view.byteOffset;
+	size_t stride = accessor.ByteStride(view);
+
+	indices.resize(start + accessor.count);
+	unsigned int* destination = indices.data() + start;
+
+	switch(accessor.componentType)
+	{
+	case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+		glTFWidenIndices<uint8_t>(destination, source, stride, accessor.count);
+		break;
+
+	case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+		glTFWidenIndices<uint16_t>(destination, source, stride, accessor.count);
+		break;
+
+	case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+		glTFWidenIndices<uint32_t>(destination, source, stride, accessor.count);
+		break;
+
+	default:
+		LOG(Log::MessageType::Error, "Unsupported index component type in primitive.");
+		indices.resize(start);
+		break;
+	}
+}
+#pragma endregion
\ No newline at end of file
@@ -4,38 +4,24 @@
 #include "Graphics/DXRayTracingUtilities.h"
 #include "Graphics/DXUploadBuffer.h"
 #include "Graphics/Texture.h"
+#include "Graphics/TextureManager.h"
 #include "Graphics/DXCommands.h"
+#include "Graphics/CookedModel.h"
+#include "Graphics/MeshProcessing.h"
 #include "Framework/Mathematics.h"
 #include <cassert>
+#include <cstring>
 
 #include "Graphics/Extensions/Mesh_TinyglTF.h"
 
-Mesh::Mesh(tinygltf::Model& model, tinygltf::Primitive& primitive, glm::mat4& transform, bool isRayTracingGeometry)
+Mesh::Mesh(const CookedMesh& cookedMesh, const glm::mat4& transform, bool isRayTracingGeometry, bool usePackedVertices) 
+	: usePackedVertices(usePackedVertices), isRayTracingGeometry(isRayTracingGeometry)
 {
 	// Geometry Data //
-	glTFLoadVertexAttribute(vertices, "POSITION", model, primitive);
-	glTFLoadVertexAttribute(vertices, "NORMAL", model, primitive);
-	glTFLoadVertexAttribute(vertices, "TANGENT", model, primitive);
-	glTFLoadVertexAttribute(vertices, "TEXCOORD_0", model, primitive);
-	glTFLoadIndices(indices, model, primitive);
+	vertices.assign(cookedMesh.vertices, cookedMesh.vertices + cookedMesh.vertexCount);
+	indices.assign(cookedMesh.indices, cookedMesh.indices + cookedMesh.indexCount);
 
-	GenerateTangents();
 	glTFApplyNodeTransform(vertices, transform);
-
-	UploadGeometryBuffers();
-
-	if(isRayTracingGeometry)
-	{
-		SetupGeometryDescription();
-		BuildBLAS();
-	}
-
-	// Material & Texture Data //
-	material.hasDiffuse = glTFLoadTextureByType(&diffuseTexture, glTFTextureType::BaseColor, model, primitive);
-	material.hasNormal = glTFLoadTextureByType(&normalTexture, glTFTextureType::Normal, model, primitive);
-	material.hasORM = glTFLoadTextureByType(&ORMTexture, glTFTextureType::MetallicRoughness, model, primitive);
-
-	materialBuffer = new DXUploadBuffer(&material, sizeof(Material));
 }
 
 Mesh::Mesh(Vertex* verts, unsigned int vertexCount, unsigned int* indi,
@@ -60,41 +46,92 @@ Mesh::Mesh(Vertex* verts, unsigned int vertexCount, unsigned int* indi,
 	}
 }
 
+Mesh::~Mesh()
+{
+	// Textures are shared between meshes, the TextureManager deletes them once they're no longer used //
+	TextureManager::ReleaseTexture(diffuseTexture);
+	TextureManager::ReleaseTexture(normalTexture);
+	TextureManager::ReleaseTexture(ORMTexture);
+
+	delete materialBuffer;
+	delete geometryInfoBuffer;
+}
+
 void Mesh::UpdateMaterial()
 {
 	materialBuffer->UpdateData(&material);
 }
 
-void Mesh::UploadGeometryBuffers()
+void Mesh::RecordGeometryUpload(ComPtr<ID3D12GraphicsCommandList4> commandList,
+	std::vector<ComPtr<ID3D12Resource>>& intermediateBuffers)
 {
-	DXCommands* copyCommands = DXAccess::GetCommands(D3D12_COMMAND_LIST_TYPE_COPY);
-	ComPtr<ID3D12GraphicsCommandList4> copyCommandList = copyCommands->GetGraphicsCommandList();
-	copyCommands->ResetCommandList();
+	// 1. Optionally pack the geometry, which gets decoded again in the hit shader //
+	const void* vertexData = vertices.data();
+	const void* indexData = indices.data();
+	unsigned int indexSize = sizeof(unsigned int);
+	unsigned int uploadedIndexCount = indices.size();
 
-	// 1. Record commands to upload vertex & index buffers //
+	std::vector<PackedVertex> packedVertices;
+	std::vector<uint16_t> shortIndices;
+
+	if(usePackedVertices)
+	{
+		PackedVertexQuantization quantization = ComputePackedVertexQuantization(vertices);
+		PackVertices(vertices, quantization, packedVertices);
+
+		vertexData = packedVertices.data();
+		vertexStride = sizeof(PackedVertex);
+
+		// Row major 3x4: position = offset + scale * snorm
+		float transform[12] = { quantization.scale.x, 0.0f, 0.0f, quantization.offset.x,
+								0.0f, quantization.scale.y, 0.0f, quantization.offset.y,
+								0.0f, 0.0f, quantization.scale.z, quantization.offset.z };
+		memcpy(geometryInfo.positionTransform, transform, sizeof(transform));
+		geometryInfo.isPacked = true;
+
+		if(vertices.size() <= 65536)
+		{
+			shortIndices.assign(indices.begin(), indices.end());
+
+			// Padded to a multiple of 4 bytes, the shader reads the indices in aligned pairs
+			if(shortIndices.size() % 2 != 0)
+			{
+				shortIndices.push_back(0);
+			}
+
+			indexData = shortIndices.data();
+			uploadedIndexCount = shortIndices.size();
+			indexSize = sizeof(uint16_t);
+			indexFormat = DXGI_FORMAT_R16_UINT;
+			geometryInfo.hasShortIndices = true;
+		}
+	}
+
+	geometryInfoBuffer = new DXUploadBuffer(&geometryInfo, sizeof(GeometryInfo));
+
+	// 2. Record commands to upload vertex & index buffers //
+	// The intermediate buffers have to stay alive until the commands have been executed
 	ComPtr<ID3D12Resource> intermediateVertexBuffer;
-	UpdateBufferResource(copyCommandList, &vertexBuffer, &intermediateVertexBuffer, vertices.size(),
-						 sizeof(Vertex), vertices.data(), D3D12_RESOURCE_FLAG_NONE);
+	UpdateBufferResource(commandList, &vertexBuffer, &intermediateVertexBuffer, vertices.size(),
+						 vertexStride, vertexData, D3D12_RESOURCE_FLAG_NONE);
 
 	ComPtr<ID3D12Resource> intermediateIndexBuffer;
-	UpdateBufferResource(copyCommandList, &indexBuffer, &intermediateIndexBuffer, indices.size(),
-						 sizeof(unsigned int), indices.data(), D3D12_RESOURCE_FLAG_NONE);
+	UpdateBufferResource(commandList, &indexBuffer, &intermediateIndexBuffer, uploadedIndexCount,
+						 indexSize, indexData, D3D12_RESOURCE_FLAG_NONE);
 
-	// 2. Retrieve info about from the buffers to create Views  // 
+	intermediateBuffers.push_back(intermediateVertexBuffer);
+	intermediateBuffers.push_back(intermediateIndexBuffer);
+
+	// 3. Retrieve info about from the buffers to create Views  // 
 	vertexBufferView.BufferLocation = vertexBuffer->GetGPUVirtualAddress();
-	vertexBufferView.SizeInBytes = vertices.size() * sizeof(Vertex);
-	vertexBufferView.StrideInBytes = sizeof(Vertex);
+	vertexBufferView.SizeInBytes = vertices.size() * vertexStride;
+	vertexBufferView.StrideInBytes = vertexStride;
 
 	indexBufferView.BufferLocation = indexBuffer->GetGPUVirtualAddress();
-	indexBufferView.SizeInBytes = indices.size() * sizeof(unsigned int);
-	indexBufferView.Format = DXGI_FORMAT_R32_UINT;
-
-	// 3.Execute the copying on the command queue & wait until it's done // 
-	copyCommands->ExecuteCommandList(DXAccess::GetCurrentBackBufferIndex());
-	copyCommands->Signal();
-	copyCommands->WaitForFenceValue(DXAccess::GetCurrentBackBufferIndex());
+	indexBufferView.SizeInBytes = indices.size() * indexSize;
+	indexBufferView.Format = indexFormat;
 
-	// 4. Clear CPU data // 
+	// 4. Clear CPU data, it already got copied into the intermediate buffers // 
 	verticesCount = vertices.size();
 	indicesCount = indices.size();
 
@@ -102,6 +139,43 @@ void Mesh::UploadGeometryBuffers()
 	indices.clear();
 }
 
+void Mesh::RecordBLASBuild(ComPtr<ID3D12GraphicsCommandList4> commandList)
+{
+	SetupGeometryDescription();
+
+	D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS inputs = GetBLASInputs();
+	AllocateAccelerationStructureMemory(inputs, blasScratch.GetAddressOf(), blasResult.GetAddressOf());
+	RecordAccelerationStructureBuild(commandList, inputs, blasScratch, blasResult);
+}
+
+void Mesh::LoadMaterial(CookedModel& model, const CookedMesh& cookedMesh)
+{
+	// Material & Texture Data //
+	material.hasDiffuse = glTFLoadTexture(&diffuseTexture, model, cookedMesh.imageIndices[glTFTextureType::BaseColor], 
+		glTFTextureType::BaseColor);
+	material.hasNormal = glTFLoadTexture(&normalTexture, model, cookedMesh.imageIndices[glTFTextureType::Normal], 
+		glTFTextureType::Normal);
+	material.hasORM = glTFLoadTexture(&ORMTexture, model, cookedMesh.imageIndices[glTFTextureType::MetallicRoughness], 
+		glTFTextureType::MetallicRoughness);
+
+	materialBuffer = new DXUploadBuffer(&material, sizeof(Material));
+}
+
+void Mesh::UploadGeometryBuffers()
+{
+	DXCommands* copyCommands = DXAccess::GetCommands(D3D12_COMMAND_LIST_TYPE_COPY);
+	ComPtr<ID3D12GraphicsCommandList4> copyCommandList = copyCommands->GetGraphicsCommandList();
+	copyCommands->ResetCommandList();
+
+	std::vector<ComPtr<ID3D12Resource>> intermediateBuffers;
+	RecordGeometryUpload(copyCommandList, intermediateBuffers);
+
+	// Execute the copying on the command queue & wait until it's done // 
+	copyCommands->ExecuteCommandList(DXAccess::GetCurrentBackBufferIndex());
+	copyCommands->Signal();
+	copyCommands->WaitForFenceValue(DXAccess::GetCurrentBackBufferIndex());
+}
+
 void Mesh::SetupGeometryDescription()
 {
 	ComPtr<ID3D12Device5> device = DXAccess::GetDevice();
@@ -111,17 +185,31 @@ void Mesh::SetupGeometryDescription()
 
 	// Vertex Buffer //
 	geometryDescription.Triangles.VertexBuffer.StartAddress = vertexBuffer->GetGPUVirtualAddress();
-	geometryDescription.Triangles.VertexBuffer.StrideInBytes = sizeof(Vertex);
+	geometryDescription.Triangles.VertexBuffer.StrideInBytes = vertexStride;
 	geometryDescription.Triangles.VertexFormat = DXGI_FORMAT_R32G32B32_FLOAT;
 	geometryDescription.Triangles.VertexCount = verticesCount;
 
+	// Packed positions are read directly as snorm, the transform maps them back to the mesh bounds
+	if(usePackedVertices)
+	{
+		geometryDescription.Triangles.VertexFormat = DXGI_FORMAT_R16G16B16A16_SNORM;
+		geometryDescription.Triangles.Transform3x4 = geometryInfoBuffer->GetGPUVirtualAddress();
+	}
+
 	// Index Buffer //
 	geometryDescription.Triangles.IndexBuffer = indexBuffer->GetGPUVirtualAddress();
-	geometryDescription.Triangles.IndexFormat = DXGI_FORMAT_R32_UINT;
+	geometryDescription.Triangles.IndexFormat = indexFormat;
 	geometryDescription.Triangles.IndexCount = indicesCount;
 }
 
 void Mesh::BuildBLAS()
+{
+	D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS inputs = GetBLASInputs();
+	AllocateAccelerationStructureMemory(inputs, blasScratch.GetAddressOf(), blasResult.GetAddressOf());
+	BuildAccelerationStructure(inputs, blasScratch, blasResult);
+}
+
+D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS Mesh::GetBLASInputs()
 {
 	D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS inputs = {};
 	inputs.Type = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL;
@@ -131,51 +219,9 @@ void Mesh::BuildBLAS()
 	inputs.NumDescs = 1;
 	inputs.Flags = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_PREFER_FAST_TRACE; // there are also other options like 'Fast Build'
 
-	AllocateAccelerationStructureMemory(inputs, blasScratch.GetAddressOf(), blasResult.GetAddressOf());
-	BuildAccelerationStructure(inputs, blasScratch, blasResult);
+	return inputs;
 }
 
-void Mesh::GenerateTangents()
-{
-	Vertex& vertex = vertices[0];
-
-	// Incase the vertex doesn't have the default value of a zero-vector
-	// it means that the Tangent attribute was present for the model
-	// if not, we need to generate them.
-	if(vertex.Tangent != glm::vec3(0.0f))
-	{
-		return;
-	}
-
-	// Grab the average tangent of all triangles in the model //
-	for(unsigned int i = 0; i < indices.size(); i += 3)
-	{
-		Vertex& v0 = vertices[indices[i]];
-		Vertex& v1 = vertices[indices[i + 1]];
-		Vertex& v2 = vertices[indices[i + 2]];
-
-		glm::vec3 tangent;
-
-		// Edges of triangles //
-		glm::vec3 edge1 = v1.Position - v0.Position;
-		glm::vec3 edge2 = v2.Position - v0.Position;
-
-		// UV deltas //
-		glm::vec2 deltaUV1 = v1.TextureCoord0 - v0.TextureCoord0;
-		glm::vec2 deltaUV2 = v2.TextureCoord0 - v0.TextureCoord0;
-
-		float f = 1.0f / (deltaUV1.x * deltaUV2.y - deltaUV2.x * deltaUV1.y);
-		tangent = (edge1 * deltaUV2.y - edge2 * deltaUV1.y) * f;
-
-		v0.Tangent += tangent;
-		v1.Tangent += tangent;
-		v2.Tangent += tangent;
-
-		v0.Tangent = glm::normalize(v0.Tangent);
-		v1.Tangent = glm::normalize(v1.Tangent);
-		v2.Tangent = glm::normalize(v2.Tangent);
-	}
-}
 #pragma endregion
 
 #pragma region Getters
@@ -209,6 +255,11 @@ D3D12_GPU_VIRTUAL_ADDRESS Mesh::GetMaterialGPUAddress()
 	return materialBuffer->GetGPUVirtualAddress();
 }
 
+D3D12_GPU_VIRTUAL_ADDRESS Mesh::GetGeometryInfoGPUAddress()
+{
+	return geometryInfoBuffer->GetGPUVirtualAddress();
+}
+
 D3D12_RAYTRACING_GEOMETRY_DESC Mesh::GetGeometryDescription()
 {
 	return geometryDescription;
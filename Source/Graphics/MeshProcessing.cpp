@@ -0,0 +1,626 @@
+#include "Graphics/MeshProcessing.h"
+#include "Framework/Mathematics.h"
+#include "Utilities/Hash.h"
+#include "Utilities/ThreadPool.h"
+
+#include <gtc/packing.hpp>
+
+#include <cfloat>
+#include <climits>
+#include <cstring>
+
+// Tangent frame of a single triangle, its corner angles are used to weight it per vertex
+struct TriangleTangent
+{
+	glm::vec3 tangent;	// Unit length, or zero when the triangle is degenerate
+	float handedness;	// -1.0 when the bitangent is mirrored, 1.0 otherwise
+	float angles[3];
+};
+
+// Approximation of acos, accurate up to ~7e-5 radians, which is plenty for weights
+static float FastAcos(float x)
+{
+	float absX = fabsf(x);
+	float angle = sqrtf(1.0f - absX) * (1.5707288f + absX * (-0.2121144f + absX * (0.0742610f - 0.0187293f * absX)));
+	return x < 0.0f ? float(PI) - angle : angle;
+}
+
+static void ComputeTriangleTangent(const Vertex& v0, const Vertex& v1, const Vertex& v2, TriangleTangent& triangle)
+{
+	triangle.tangent = glm::vec3(0.0f);
+	triangle.handedness = 0.0f;
+	triangle.angles[0] = triangle.angles[1] = triangle.angles[2] = 0.0f;
+
+	// Edges of triangles //
+	glm::vec3 edge1 = v1.Position - v0.Position;
+	glm::vec3 edge2 = v2.Position - v0.Position;
+	glm::vec3 edge3 = v2.Position - v1.Position;
+
+	// UV deltas //
+	glm::vec2 deltaUV1 = v1.TextureCoord0 - v0.TextureCoord0;
+	glm::vec2 deltaUV2 = v2.TextureCoord0 - v0.TextureCoord0;
+
+	// The direction of the tangents doesn't depend on the scale of the UVs, only the sign of the determinant matters
+	float determinant = deltaUV1.x * deltaUV2.y - deltaUV2.x * deltaUV1.y;
+	glm::vec3 tangent = (edge1 * deltaUV2.y - edge2 * deltaUV1.y) * determinant;
+	glm::vec3 bitangent = (edge2 * deltaUV1.x - edge1 * deltaUV2.x) * determinant;
+
+	float tangentLengthSquared = glm::dot(tangent, tangent);
+	float lengthSquared1 = glm::dot(edge1, edge1);
+	float lengthSquared2 = glm::dot(edge2, edge2);
+	float lengthSquared3 = glm::dot(edge3, edge3);
+
+	// Degenerate triangles (zero area or without UV mapping) don't contribute
+	if(!(tangentLengthSquared > 0.0f) || !(lengthSquared1 > 0.0f && lengthSquared2 > 0.0f && lengthSquared3 > 0.0f))
+	{
+		return;
+	}
+
+	glm::vec3 faceNormal = glm::cross(edge1, edge2);
+	triangle.tangent = tangent / sqrtf(tangentLengthSquared);
+	triangle.handedness = glm::dot(glm::cross(faceNormal, tangent), bitangent) < 0.0f ? -1.0f : 1.0f;
+
+	triangle.angles[0] = FastAcos(glm::clamp(glm::dot(edge1, edge2) / sqrtf(lengthSquared1 * lengthSquared2), -1.0f, 1.0f));
+	triangle.angles[1] = FastAcos(glm::clamp(-glm::dot(edge1, edge3) / sqrtf(lengthSquared1 * lengthSquared3), -1.0f, 1.0f));
+	triangle.angles[2] = std::max(float(PI) - triangle.angles[0] - triangle.angles[1], 0.0f);
+}
+
+// Angle weighting, so that the tessellation of a surface doesn't bias the tangents of its vertices
+static void AccumulateTangent(glm::vec4& sum, const TriangleTangent& triangle, unsigned int corner)
+{
+	float weight = triangle.angles[corner];
+	sum += glm::vec4(triangle.tangent * weight, triangle.handedness * weight);
+}
+
+// Gram-Schmidt against the normal, since the summed tangent generally isn't in the tangent plane
+static void OrthonormalizeTangent(Vertex& vertex)
+{
+	glm::vec3 tangent = glm::vec3(vertex.Tangent);
+	glm::vec3 normal = vertex.Normal;
+	float normalLength = glm::length(normal);
+
+	if(normalLength > 0.0f)
+	{
+		normal /= normalLength;
+		tangent -= normal * glm::dot(normal, tangent);
+	}
+
+	float tangentLength = glm::length(tangent);
+	if(tangentLength > 1e-6f)
+	{
+		tangent /= tangentLength;
+	}
+	else
+	{
+		// Vertex without any usable UV mapping, any tangent perpendicular to the normal will do
+		glm::vec3 axis = fabsf(normal.x) < 0.9f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+		tangent = normalLength > 0.0f ? glm::normalize(glm::cross(axis, normal)) : axis;
+	}
+
+	vertex.Tangent = glm::vec4(tangent, vertex.Tangent.w < 0.0f ? -1.0f : 1.0f);
+}
+
+void GenerateTangents(std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices)
+{
+	if(vertices.empty() || indices.size() < 3)
+	{
+		return;
+	}
+
+	// Incase the vertex doesn't have the default value of a zero-vector
+	// it means that the Tangent attribute was present for the model
+	// if not, we need to generate them.
+	if(glm::vec3(vertices[0].Tangent) != glm::vec3(0.0f))
+	{
+		return;
+	}
+
+	ThreadPool& threadPool = ThreadPool::GetGlobalPool();
+	const unsigned int triangleCount = indices.size() / 3;
+	const unsigned int cornerCount = triangleCount * 3;
+	const unsigned int vertexCount = vertices.size();
+	const unsigned int batchSize = 4096;
+
+	for(Vertex& vertex : vertices)
+	{
+		vertex.Tangent = glm::vec4(0.0f);
+	}
+
+	// Every vertex sums its triangles in index order. Whether that happens with a single thread scattering
+	// into the vertices, or in parallel by gathering per vertex, the result is identical and deterministic.
+	if(threadPool.GetThreadCount() <= 1 || triangleCount < batchSize)
+	{
+		for(unsigned int i = 0; i < cornerCount; i += 3)
+		{
+			Vertex& v0 = vertices[indices[i]];
+			Vertex& v1 = vertices[indices[i + 1]];
+			Vertex& v2 = vertices[indices[i + 2]];
+
+			TriangleTangent triangle;
+			ComputeTriangleTangent(v0, v1, v2, triangle);
+
+			AccumulateTangent(v0.Tangent, triangle, 0);
+			AccumulateTangent(v1.Tangent, triangle, 1);
+			AccumulateTangent(v2.Tangent, triangle, 2);
+		}
+
+		for(Vertex& vertex : vertices)
+		{
+			OrthonormalizeTangent(vertex);
+		}
+
+		return;
+	}
+
+	// 1. Tangent frame of every triangle, each triangle only writes its own entry //
+	std::vector<TriangleTangent> triangles(triangleCount);
+	threadPool.ParallelFor(triangleCount, [&](unsigned int index)
+	{
+		const unsigned int* corners = &indices[index * 3];
+		ComputeTriangleTangent(vertices[corners[0]], vertices[corners[1]], vertices[corners[2]], triangles[index]);
+	}, batchSize);
+
+	// 2. Group the corners by vertex (counting sort), keeping them in ascending order //
+	std::vector<unsigned int> vertexCornerStart(vertexCount + 1, 0);
+	for(unsigned int corner = 0; corner < cornerCount; corner++)
+	{
+		vertexCornerStart[indices[corner] + 1]++;
+	}
+
+	for(unsigned int i = 0; i < vertexCount; i++)
+	{
+		vertexCornerStart[i + 1] += vertexCornerStart[i];
+	}
+
+	std::vector<unsigned int> vertexCorners(cornerCount);
+	std::vector<unsigned int> writePosition(vertexCornerStart.begin(), vertexCornerStart.end() - 1);
+	for(unsigned int corner = 0; corner < cornerCount; corner++)
+	{
+		vertexCorners[writePosition[indices[corner]]++] = corner;
+	}
+
+	// 3. Every vertex gathers its corners, so no two tasks ever write to the same vertex //
+	threadPool.ParallelFor(vertexCount, [&](unsigned int index)
+	{
+		Vertex& vertex = vertices[index];
+		for(unsigned int i = vertexCornerStart[index]; i < vertexCornerStart[index + 1]; i++)
+		{
+			unsigned int corner = vertexCorners[i];
+			AccumulateTangent(vertex.Tangent, triangles[corner / 3], corner % 3);
+		}
+
+		OrthonormalizeTangent(vertex);
+	}, batchSize);
+}
+
+#pragma region Mesh Optimization
+void MeshOptimizationStats::Add(const MeshOptimizationStats& stats)
+{
+	triangleCount += stats.triangleCount;
+	vertexCountBefore += stats.vertexCountBefore;
+	vertexCountAfter += stats.vertexCountAfter;
+	cacheMissesBefore += stats.cacheMissesBefore;
+	cacheMissesAfter += stats.cacheMissesAfter;
+}
+
+float MeshOptimizationStats::GetACMRBefore() const
+{
+	return triangleCount > 0 ? float(cacheMissesBefore) / float(triangleCount) : 0.0f;
+}
+
+float MeshOptimizationStats::GetACMRAfter() const
+{
+	return triangleCount > 0 ? float(cacheMissesAfter) / float(triangleCount) : 0.0f;
+}
+
+void WeldVertices(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+{
+	if(vertices.empty())
+	{
+		return;
+	}
+
+	// Open addressing table with a power of two size, at most half full //
+	unsigned int tableSize = 1;
+	while(tableSize < vertices.size() * 2)
+	{
+		tableSize *= 2;
+	}
+
+	std::vector<unsigned int> table(tableSize, UINT_MAX);
+	std::vector<unsigned int> remap(vertices.size());
+	unsigned int uniqueCount = 0;
+
+	for(unsigned int i = 0; i < vertices.size(); i++)
+	{
+		const Vertex& vertex = vertices[i];
+		unsigned int slot = static_cast<unsigned int>(HashBytes(&vertex, sizeof(Vertex))) & (tableSize - 1);
+
+		// Unique vertices get compacted to the front in place, which only overwrites vertices already visited
+		while(table[slot] != UINT_MAX && memcmp(&vertices[table[slot]], &vertex, sizeof(Vertex)) != 0)
+		{
+			slot = (slot + 1) & (tableSize - 1);
+		}
+
+		if(table[slot] == UINT_MAX)
+		{
+			vertices[uniqueCount] = vertex;
+			table[slot] = uniqueCount;
+			uniqueCount++;
+		}
+
+		remap[i] = table[slot];
+	}
+
+	vertices.resize(uniqueCount);
+
+	for(unsigned int& index : indices)
+	{
+		index = remap[index];
+	}
+}
+
+// Scoring as described by Tom Forsyth, vertices that are in the cache (especially the
+// most recent ones), or that have few triangles left score higher.
+static const unsigned int forsythCacheSize = 32;
+static const unsigned int forsythMaxValence = 64;
+
+static float ForsythVertexScore(int cachePosition, unsigned int remainingTriangles)
+{
+	static struct ScoreTables
+	{
+		float cache[forsythCacheSize];
+		float valence[forsythMaxValence];
+
+		ScoreTables()
+		{
+			for(unsigned int i = 0; i < forsythCacheSize; i++)
+			{
+				// The last triangle's vertices get a fixed score, so it doesn't matter in which order they get used
+				cache[i] = i < 3 ? 0.75f : powf(1.0f - float(i - 3) / float(forsythCacheSize - 3), 1.5f);
+			}
+
+			valence[0] = 0.0f;
+			for(unsigned int i = 1; i < forsythMaxValence; i++)
+			{
+				valence[i] = 2.0f / sqrtf(float(i));
+			}
+		}
+	} tables;
+
+	if(remainingTriangles == 0)
+	{
+		return -1.0f;
+	}
+
+	float score = cachePosition >= 0 ? tables.cache[cachePosition] : 0.0f;
+	score += remainingTriangles < forsythMaxValence ? tables.valence[remainingTriangles] : 2.0f / sqrtf(float(remainingTriangles));
+	return score;
+}
+
+void OptimizeVertexCache(std::vector<unsigned int>& indices, unsigned int vertexCount)
+{
+	const unsigned int triangleCount = indices.size() / 3;
+	if(triangleCount == 0)
+	{
+		return;
+	}
+
+	// Triangles per vertex, the first 'remainingTriangles' of each range are the ones not emitted yet //
+	std::vector<unsigned int> remainingTriangles(vertexCount, 0);
+	for(unsigned int i = 0; i < triangleCount * 3; i++)
+	{
+		remainingTriangles[indices[i]]++;
+	}
+
+	std::vector<unsigned int> vertexTriangleStart(vertexCount + 1, 0);
+	for(unsigned int i = 0; i < vertexCount; i++)
+	{
+		vertexTriangleStart[i + 1] = vertexTriangleStart[i] + remainingTriangles[i];
+	}
+
+	std::vector<unsigned int> vertexTriangles(triangleCount * 3);
+	std::vector<unsigned int> writePosition(vertexTriangleStart.begin(), vertexTriangleStart.end() - 1);
+	for(unsigned int i = 0; i < triangleCount * 3; i++)
+	{
+		vertexTriangles[writePosition[indices[i]]++] = i / 3;
+	}
+
+	std::vector<int> cachePosition(vertexCount, -1);
+	std::vector<float> vertexScore(vertexCount);
+	for(unsigned int i = 0; i < vertexCount; i++)
+	{
+		vertexScore[i] = ForsythVertexScore(-1, remainingTriangles[i]);
+	}
+
+	std::vector<bool> isEmitted(triangleCount, false);
+
+	std::vector<unsigned int> optimized(triangleCount * 3);
+	std::vector<unsigned int> cache;
+	std::vector<unsigned int> nextCache;
+	cache.reserve(forsythCacheSize + 3);
+	nextCache.reserve(forsythCacheSize + 3);
+
+	unsigned int bestTriangle = 0;
+	unsigned int searchCursor = 0;
+
+	for(unsigned int emitted = 0; emitted < triangleCount; emitted++)
+	{
+		// When no triangle touches the cache anymore, continue with the next one in the original order //
+		if(bestTriangle == UINT_MAX)
+		{
+			while(isEmitted[searchCursor])
+			{
+				searchCursor++;
+			}
+
+			bestTriangle = searchCursor;
+		}
+
+		const unsigned int* triangle = &indices[bestTriangle * 3];
+		memcpy(&optimized[emitted * 3], triangle, sizeof(unsigned int) * 3);
+		isEmitted[bestTriangle] = true;
+
+		// Remove the triangle from the ranges of its vertices //
+		for(unsigned int i = 0; i < 3; i++)
+		{
+			unsigned int vertex = triangle[i];
+			unsigned int* triangles = &vertexTriangles[vertexTriangleStart[vertex]];
+			unsigned int& remaining = remainingTriangles[vertex];
+
+			for(unsigned int j = 0; j < remaining; j++)
+			{
+				if(triangles[j] == bestTriangle)
+				{
+					triangles[j] = triangles[remaining - 1];
+					triangles[remaining - 1] = bestTriangle;
+					remaining--;
+					break;
+				}
+			}
+		}
+
+		// The triangle's vertices move to the front of the (LRU) cache, the rest shifts back //
+		nextCache.assign(triangle, triangle + 3);
+		for(unsigned int vertex : cache)
+		{
+			if(vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2])
+			{
+				nextCache.push_back(vertex);
+			}
+		}
+
+		for(unsigned int i = 0; i < nextCache.size(); i++)
+		{
+			unsigned int vertex = nextCache[i];
+			cachePosition[vertex] = i < forsythCacheSize ? int(i) : -1;
+			vertexScore[vertex] = ForsythVertexScore(cachePosition[vertex], remainingTriangles[vertex]);
+		}
+
+		// Rescore the triangles of every vertex whose score changed, the best one gets emitted next //
+		float bestScore = -FLT_MAX;
+		bestTriangle = UINT_MAX;
+
+		for(unsigned int vertex : nextCache)
+		{
+			const unsigned int* triangles = &vertexTriangles[vertexTriangleStart[vertex]];
+			for(unsigned int j = 0; j < remainingTriangles[vertex]; j++)
+			{
+				const unsigned int* corners = &indices[triangles[j] * 3];
+				float score = vertexScore[corners[0]] + vertexScore[corners[1]] + vertexScore[corners[2]];
+
+				if(score > bestScore)
+				{
+					bestScore = score;
+					bestTriangle = triangles[j];
+				}
+			}
+		}
+
+		if(nextCache.size() > forsythCacheSize)
+		{
+			nextCache.resize(forsythCacheSize);
+		}
+
+		cache.swap(nextCache);
+	}
+
+	indices.swap(optimized);
+}
+
+void OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+{
+	std::vector<unsigned int> remap(vertices.size(), UINT_MAX);
+	std::vector<Vertex> ordered;
+	ordered.reserve(vertices.size());
+
+	for(unsigned int& index : indices)
+	{
+		if(remap[index] == UINT_MAX)
+		{
+			remap[index] = ordered.size();
+			ordered.push_back(vertices[index]);
+		}
+
+		index = remap[index];
+	}
+
+	vertices.swap(ordered);
+}
+
+unsigned int SimulateVertexCacheMisses(const std::vector<unsigned int>& indices, unsigned int vertexCount, unsigned int cacheSize)
+{
+	// A vertex is still in the FIFO when less than 'cacheSize' other vertices got inserted since it was
+	std::vector<unsigned int> insertionTime(vertexCount, 0);
+	unsigned int time = cacheSize + 1;
+	unsigned int misses = 0;
+
+	for(unsigned int index : indices)
+	{
+		if(time - insertionTime[index] > cacheSize)
+		{
+			insertionTime[index] = time;
+			time++;
+			misses++;
+		}
+	}
+
+	return misses;
+}
+
+MeshOptimizationStats OptimizeMesh(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+{
+	MeshOptimizationStats stats;
+	stats.triangleCount = indices.size() / 3;
+	stats.vertexCountBefore = vertices.size();
+	stats.cacheMissesBefore = SimulateVertexCacheMisses(indices, vertices.size());
+
+	// Welding happens before the tangents get generated, so duplicates share a single tangent, instead of each getting a partial sum
+	WeldVertices(vertices, indices);
+	GenerateTangents(vertices, indices);
+
+	OptimizeVertexCache(indices, vertices.size());
+	OptimizeVertexFetch(vertices, indices);
+
+	stats.vertexCountAfter = vertices.size();
+	stats.cacheMissesAfter = SimulateVertexCacheMisses(indices, vertices.size());
+	return stats;
+}
+#pragma endregion
+
+#pragma region Vertex Packing
+static int16_t EncodeSnorm16(float value)
+{
+	return static_cast<int16_t>(roundf(glm::clamp(value, -1.0f, 1.0f) * 32767.0f));
+}
+
+static float DecodeSnorm16(int16_t value)
+{
+	return std::max(float(value) / 32767.0f, -1.0f);
+}
+
+// Octahedral mapping of unit vectors, as described in 'A Survey of Efficient Representations for Independent Unit Vectors'
+static glm::vec2 OctahedralEncode(glm::vec3 direction)
+{
+	direction /= fabsf(direction.x) + fabsf(direction.y) + fabsf(direction.z);
+	glm::vec2 encoded = glm::vec2(direction.x, direction.y);
+
+	// The lower hemisphere gets folded over the diagonals
+	if(direction.z < 0.0f)
+	{
+		encoded.x = (1.0f - fabsf(direction.y)) * (direction.x >= 0.0f ? 1.0f : -1.0f);
+		encoded.y = (1.0f - fabsf(direction.x)) * (direction.y >= 0.0f ? 1.0f : -1.0f);
+	}
+
+	return encoded;
+}
+
+static glm::vec3 OctahedralDecode(const glm::vec2& encoded)
+{
+	glm::vec3 direction = glm::vec3(encoded.x, encoded.y, 1.0f - fabsf(encoded.x) - fabsf(encoded.y));
+	float fold = std::max(-direction.z, 0.0f);
+	direction.x += direction.x >= 0.0f ? -fold : fold;
+	direction.y += direction.y >= 0.0f ? -fold : fold;
+	return glm::normalize(direction);
+}
+
+static void EncodeDirection(const glm::vec3& direction, int16_t* encoded)
+{
+	if(glm::dot(direction, direction) <= 0.0f)
+	{
+		encoded[0] = encoded[1] = 0;
+		return;
+	}
+
+	glm::vec2 octahedral = OctahedralEncode(direction);
+	glm::vec2 base = glm::floor(octahedral * 32767.0f);
+	float bestError = FLT_MAX;
+
+	// Rounding each component separately isn't always the closest, so all 4 neighbours get tried
+	for(unsigned int i = 0; i < 4; i++)
+	{
+		glm::vec2 candidate = glm::clamp(base + glm::vec2(float(i & 1), float(i >> 1)), -32767.0f, 32767.0f);
+		glm::vec3 decoded = OctahedralDecode(candidate / 32767.0f);
+		float error = glm::length(decoded - direction);
+
+		if(error < bestError)
+		{
+			bestError = error;
+			encoded[0] = static_cast<int16_t>(candidate.x);
+			encoded[1] = static_cast<int16_t>(candidate.y);
+		}
+	}
+}
+
+static glm::vec3 DecodeDirection(const int16_t* encoded)
+{
+	return OctahedralDecode(glm::vec2(DecodeSnorm16(encoded[0]), DecodeSnorm16(encoded[1])));
+}
+
+PackedVertexQuantization ComputePackedVertexQuantization(const std::vector<Vertex>& vertices)
+{
+	PackedVertexQuantization quantization;
+	if(vertices.empty())
+	{
+		return quantization;
+	}
+
+	glm::vec3 boundsMin = glm::vec3(FLT_MAX);
+	glm::vec3 boundsMax = glm::vec3(-FLT_MAX);
+	for(const Vertex& vertex : vertices)
+	{
+		boundsMin = glm::min(boundsMin, vertex.Position);
+		boundsMax = glm::max(boundsMax, vertex.Position);
+	}
+
+	quantization.offset = (boundsMin + boundsMax) * 0.5f;
+	quantization.scale = (boundsMax - boundsMin) * 0.5f;
+
+	// Flat axes can't be divided by, but any scale reproduces them exactly
+	for(int i = 0; i < 3; i++)
+	{
+		if(!(quantization.scale[i] > 0.0f))
+		{
+			quantization.scale[i] = 1.0f;
+		}
+	}
+
+	return quantization;
+}
+
+void PackVertices(const std::vector<Vertex>& vertices, const PackedVertexQuantization& quantization,
+	std::vector<PackedVertex>& packedVertices)
+{
+	packedVertices.resize(vertices.size());
+	glm::vec3 inverseScale = 1.0f / quantization.scale;
+
+	ThreadPool::GetGlobalPool().ParallelFor(vertices.size(), [&](unsigned int index)
+	{
+		const Vertex& vertex = vertices[index];
+		PackedVertex& packed = packedVertices[index];
+
+		glm::vec3 position = (vertex.Position - quantization.offset) * inverseScale;
+		packed.Position[0] = EncodeSnorm16(position.x);
+		packed.Position[1] = EncodeSnorm16(position.y);
+		packed.Position[2] = EncodeSnorm16(position.z);
+		packed.Position[3] = vertex.Tangent.w < 0.0f ? -32767 : 32767;
+
+		EncodeDirection(vertex.Normal, packed.Normal);
+		EncodeDirection(glm::vec3(vertex.Tangent), packed.Tangent);
+		packed.TextureCoord0 = glm::packHalf2x16(vertex.TextureCoord0);
+	}, 4096);
+}
+
+Vertex UnpackVertex(const PackedVertex& packed, const PackedVertexQuantization& quantization)
+{
+	Vertex vertex;
+
+	glm::vec3 position = glm::vec3(DecodeSnorm16(packed.Position[0]), DecodeSnorm16(packed.Position[1]), DecodeSnorm16(packed.Position[2]));
+	vertex.Position = quantization.offset + quantization.scale * position;
+
+	vertex.Normal = DecodeDirection(packed.Normal);
+	vertex.Tangent = glm::vec4(DecodeDirection(packed.Tangent), packed.Position[3] < 0 ? -1.0f : 1.0f);
+	vertex.TextureCoord0 = glm::unpackHalf2x16(packed.TextureCoord0);
+	return vertex;
+}
+#pragma endregion
\ No newline at end of file
@@ -2,35 +2,44 @@
 #include "Graphics/Mesh.h"
 #include "Graphics/DXRayTracingUtilities.h"
 #include "Graphics/DXUploadBuffer.h"
+#include "Graphics/CookedModel.h"
 
+#include "Graphics/DXAccess.h"
+#include "Graphics/DXCommands.h"
 #include "Utilities/Logger.h"
+#include "Utilities/ThreadPool.h"
 
-Model::Model(const std::string& filePath, bool isRayTracingGeometry) : isRayTracingGeometry(isRayTracingGeometry)
+Model::Model(const std::string& filePath, bool isRayTracingGeometry, bool deferGPUResources, bool usePackedVertices) 
+	: isRayTracingGeometry(isRayTracingGeometry)
 {
 	Name = filePath.substr(filePath.find_last_of('\\') + 1);
 
-	tinygltf::Model model;
-	tinygltf::TinyGLTF loader;
-	std::string error;
-	std::string warning;
-
-	bool result = loader.LoadASCIIFromFile(&model, &error, &warning, filePath);
-	if(!warning.empty())
+	cookedModel = new CookedModel(filePath);
+	if(!cookedModel->IsValid())
 	{
-		LOG(Log::MessageType::Debug, warning);
+		assert(false && "Failed to parse model.");
 	}
 
-	if(!error.empty())
+	// Every instance of a cooked mesh becomes its own mesh, with the node transform baked into its vertices.
+	// Copying & transforming happens in parallel, each mesh has its own slot so the order stays the same
+	const std::vector<CookedMeshInstance>& instances = cookedModel->GetInstances();
+	meshes.resize(instances.size());
+	cookedMeshIndices.resize(instances.size());
+
+	ThreadPool::GetGlobalPool().ParallelFor(instances.size(), [&](unsigned int index)
 	{
-		LOG(Log::MessageType::Error, error);
-	}
+		const CookedMesh& cookedMesh = cookedModel->GetMeshes()[instances[index].meshIndex];
 
-	if(!result)
+		Mesh* mesh = new Mesh(cookedMesh, instances[index].transform, this->isRayTracingGeometry, usePackedVertices);
+		mesh->Name = cookedMesh.name;
+		meshes[index] = mesh;
+		cookedMeshIndices[index] = instances[index].meshIndex;
+	});
+
+	if(!deferGPUResources)
 	{
-		assert(false && "Failed to parse model.");
+		CreateGPUResources({ this });
 	}
-
-	TraverseRootNodes(model);
 }
 
 Model::Model(Vertex* vertices, unsigned int vertexCount, unsigned int* indices, unsigned int indexCount, bool isRayTracingGeometry)
@@ -39,6 +48,16 @@ Model::Model(Vertex* vertices, unsigned int vertexCount, unsigned int* indices,
 	meshes.push_back(mesh);
 }
 
+Model::~Model()
+{
+	for(Mesh* mesh : meshes)
+	{
+		delete mesh;
+	}
+
+	delete cookedModel;
+}
+
 Mesh* Model::GetMesh(int index)
 {
 	return meshes[index];
@@ -54,127 +73,69 @@ unsigned int Model::GetMeshCount()
 	return meshes.size();
 }
 
-void Model::TraverseRootNodes(tinygltf::Model& model)
+void Model::CreateGPUResources(const std::vector<Model*>& models)
 {
-	auto scene = model.scenes[model.defaultScene];
-	glm::mat4 transform;
-
-	// Traverse the 'root' nodes from the scene
-	for(int i = 0; i < scene.nodes.size(); i++)
-	{
-		tinygltf::Node& rootNode = model.nodes[scene.nodes[i]];
-
-		if(rootNode.matrix.size() > 0)
-		{
-			std::vector<float> matrix;
-			for(int j = 0; j < 16; j++)
-			{
-				matrix.push_back(static_cast<float>(rootNode.matrix[j]));
-			}
-
-			transform = glm::make_mat4(matrix.data());
-		}
-		else
-		{
-			transform = GetTransformFromNode(rootNode);
-		}
-
-		if(rootNode.mesh != -1)
-		{
-			tinygltf::Mesh& mesh = model.meshes[rootNode.mesh];
-
-			for(tinygltf::Primitive& primitive : mesh.primitives)
-			{
-				Mesh* m = new Mesh(model, primitive, transform, isRayTracingGeometry);
-				m->Name = mesh.name;
-				meshes.push_back(m);
-			}
-		}
+	// 1. Record the geometry uploads of all meshes & execute them at once //
+	DXCommands* copyCommands = DXAccess::GetCommands(D3D12_COMMAND_LIST_TYPE_COPY);
+	ComPtr<ID3D12GraphicsCommandList4> copyCommandList = copyCommands->GetGraphicsCommandList();
+	copyCommands->ResetCommandList();
 
-		// Process Child Nodes //
-		for(int noteID : rootNode.children)
-		{
-			TraverseChildNodes(model, model.nodes[noteID], transform);
-		}
-	}
-}
-
-void Model::TraverseChildNodes(tinygltf::Model& model, tinygltf::Node& node, const glm::mat4& parentMatrix)
-{
-	glm::mat4 transform;
+	std::vector<ComPtr<ID3D12Resource>> intermediateBuffers;
+	bool hasRayTracingGeometry = false;
 
-	// 1. Load matrix from node //
-	if(node.matrix.size() > 0)
+	for(Model* model : models)
 	{
-		std::vector<float> matrix;
-		for(int i = 0; i < 16; i++)
+		for(Mesh* mesh : model->meshes)
 		{
-			matrix.push_back(static_cast<float>(node.matrix[i]));
+			mesh->RecordGeometryUpload(copyCommandList, intermediateBuffers);
 		}
 
-		transform = glm::make_mat4(matrix.data());
-	}
-	else
-	{
-		// 1b. incase matrix data doesn't exist,
-		// its assumed transform data is either Identity or 
-		// stored as vectors Position, Rotation, Scale )
-		transform = GetTransformFromNode(node);
+		hasRayTracingGeometry |= model->isRayTracingGeometry;
 	}
 
-	glm::mat4 childNodeTransform = parentMatrix * transform;
+	copyCommands->ExecuteCommandList(DXAccess::GetCurrentBackBufferIndex());
+	copyCommands->Signal();
+	copyCommands->WaitForFenceValue(DXAccess::GetCurrentBackBufferIndex());
+	intermediateBuffers.clear();
 
-	// 2. Apply to meshes in note //
-	if(node.mesh != -1)
+	// 2. Build the BLASes of all meshes in a single submission //
+	if(hasRayTracingGeometry)
 	{
-		tinygltf::Mesh& mesh = model.meshes[node.mesh];
+		DXCommands* commands = DXAccess::GetCommands(D3D12_COMMAND_LIST_TYPE_DIRECT);
+		ComPtr<ID3D12GraphicsCommandList4> commandList = commands->GetGraphicsCommandList();
 
-		for(tinygltf::Primitive& primitive : mesh.primitives)
-		{
-			Mesh* m = new Mesh(model, primitive, childNodeTransform, isRayTracingGeometry);
-			m->Name = mesh.name;
-			meshes.push_back(m);
-		}
-	}
+		commands->Flush();
+		commands->ResetCommandList();
 
-	// 3. Loop for children // 
-	for(int noteID : node.children)
-	{
-		TraverseChildNodes(model, model.nodes[noteID], childNodeTransform);
-	}
-}
+		for(Model* model : models)
+		{
+			if(!model->isRayTracingGeometry)
+			{
+				continue;
+			}
 
-glm::mat4 Model::GetTransformFromNode(tinygltf::Node& node)
-{
-	::Transform transform;
+			for(Mesh* mesh : model->meshes)
+			{
+				mesh->RecordBLASBuild(commandList);
+			}
+		}
 
-	// The size of any type of transformation data defaults to 0.
-	// When a vector isn't 0, it means it contains data
-	if(node.translation.size() > 0)
-	{
-		transform.Position.x = node.translation[0];
-		transform.Position.y = node.translation[1];
-		transform.Position.z = node.translation[2];
+		commands->ExecuteCommandList();
+		commands->Signal();
+		commands->WaitForFenceValue();
 	}
 
-	if(node.rotation.size() > 0)
+	// 3. Textures & Materials, these go through the TextureManager so they stay on this thread //
+	for(Model* model : models)
 	{
-		glm::quat rotation;
-		rotation.x = node.rotation[0];
-		rotation.y = node.rotation[1];
-		rotation.z = node.rotation[2];
-		rotation.w = node.rotation[3];
-
-		glm::vec3 euler = glm::eulerAngles(rotation) * 180.0f / 3.14159265f;
-		transform.Rotation = euler;
-	}
+		for(int i = 0; i < model->meshes.size(); i++)
+		{
+			const CookedMesh& cookedMesh = model->cookedModel->GetMeshes()[model->cookedMeshIndices[i]];
+			model->meshes[i]->LoadMaterial(*model->cookedModel, cookedMesh);
+		}
 
-	if(node.scale.size() > 0)
-	{
-		transform.Scale.x = node.scale[0];
-		transform.Scale.y = node.scale[1];
-		transform.Scale.z = node.scale[2];
+		delete model->cookedModel;
+		model->cookedModel = nullptr;
+		model->cookedMeshIndices.clear();
 	}
-
-	return transform.GetModelMatrix();
 }
\ No newline at end of file
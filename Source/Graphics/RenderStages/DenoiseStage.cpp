@@ -0,0 +1,141 @@
+#include "Graphics/RenderStages/DenoiseStage.h"
+#include "Graphics/RenderStages/RayTraceStage.h"
+#include "Graphics/DXComputePipeline.h"
+#include "Graphics/DXRootSignature.h"
+
+#include "Graphics/DXUtilities.h"
+#include "Graphics/Texture.h"
+
+// Matches the thread group size of 'Denoise.hlsl' //
+static const unsigned int groupSize = 8;
+
+DenoiseStage::DenoiseStage(RayTraceStage* rayTraceStage) : rayTraceStage(rayTraceStage)
+{
+	CreateShaderResources();
+	InitializePipeline();
+}
+
+void DenoiseStage::RecordStage(ComPtr<ID3D12GraphicsCommandList4> commandList)
+{
+	if(!isEnabled)
+	{
+		return;
+	}
+
+	ComPtr<ID3D12Resource> renderTargetBuffer = DXAccess::GetWindow()->GetCurrentScreenBuffer();
+	ID3D12Resource* const output = outputBuffer->GetAddress();
+
+	// 1) Bind the pipeline & the buffers of the RayTraceStage, which every pass reads //
+	TransitionResource(irradianceBuffers[0]->GetAddress(), D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+	TransitionResource(irradianceBuffers[1]->GetAddress(), D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+	TransitionResource(output, D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+
+	commandList->SetComputeRootSignature(rootSignature->GetAddress());
+	commandList->SetPipelineState(computePipeline->GetAddress());
+	commandList->SetComputeRootDescriptorTable(1, rayTraceStage->GetAccumulationBuffer()->GetUAV());
+	commandList->SetComputeRootDescriptorTable(2, rayTraceStage->GetMomentBuffer()->GetUAV());
+	commandList->SetComputeRootDescriptorTable(3, rayTraceStage->GetAlbedoBuffer()->GetUAV());
+	commandList->SetComputeRootDescriptorTable(4, rayTraceStage->GetNormalBuffer()->GetUAV());
+	commandList->SetComputeRootDescriptorTable(7, outputBuffer->GetUAV());
+
+	// The samples of this frame have to be written before they get read //
+	CD3DX12_RESOURCE_BARRIER rayTraceBarrier = CD3DX12_RESOURCE_BARRIER::UAV(nullptr);
+	commandList->ResourceBarrier(1, &rayTraceBarrier);
+
+	// 2) Divide out the albedo, filter back & forth between both irradiance buffers, then multiply the albedo back in //
+	DispatchPass(commandList, 0, 0, irradianceBuffers[1], irradianceBuffers[0]);
+
+	unsigned int current = 0;
+	for(unsigned int iteration = 0; iteration < settings.iterationCount; iteration++)
+	{
+		DispatchPass(commandList, 1, 1 << iteration, irradianceBuffers[current], irradianceBuffers[1 - current]);
+		current = 1 - current;
+	}
+
+	DispatchPass(commandList, 2, 0, irradianceBuffers[current], irradianceBuffers[1 - current]);
+
+	TransitionResource(irradianceBuffers[0]->GetAddress(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_COPY_SOURCE);
+	TransitionResource(irradianceBuffers[1]->GetAddress(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_COPY_SOURCE);
+	TransitionResource(output, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_COPY_SOURCE);
+
+	// 3) Copy the denoised output over what the RayTraceStage copied to the screen buffer //
+	TransitionResource(renderTargetBuffer.Get(), D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_COPY_DEST);
+	commandList->CopyResource(renderTargetBuffer.Get(), output);
+	TransitionResource(renderTargetBuffer.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_RENDER_TARGET);
+}
+
+bool DenoiseStage::IsEnabled()
+{
+	return isEnabled;
+}
+
+void DenoiseStage::SetEnabled(bool isEnabled)
+{
+	this->isEnabled = isEnabled;
+}
+
+const DenoiserSettings& DenoiseStage::GetSettings()
+{
+	return settings;
+}
+
+void DenoiseStage::SetSettings(const DenoiserSettings& settings)
+{
+	this->settings = settings;
+}
+
+void DenoiseStage::CreateShaderResources()
+{
+	int width = DXAccess::GetWindow()->GetWindowWidth();
+	int height = DXAccess::GetWindow()->GetWindowHeight();
+
+	irradianceBuffers[0] = new Texture(width, height, DXGI_FORMAT_R32G32B32A32_FLOAT);
+	irradianceBuffers[1] = new Texture(width, height, DXGI_FORMAT_R32G32B32A32_FLOAT);
+	outputBuffer = new Texture(width, height, DXGI_FORMAT_R8G8B8A8_UNORM);
+}
+
+void DenoiseStage::InitializePipeline()
+{
+	// Every buffer gets its own table, so the irradiance buffers can swap places between the passes //
+	CD3DX12_DESCRIPTOR_RANGE1 ranges[7];
+	for(unsigned int i = 0; i < _countof(ranges); i++)
+	{
+		ranges[i].Init(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, 1, i);
+	}
+
+	CD3DX12_ROOT_PARAMETER1 rootParameters[8];
+	rootParameters[0].InitAsConstants(sizeof(DenoisePass) / sizeof(unsigned int), 0);
+	rootParameters[1].InitAsDescriptorTable(1, &ranges[0]); // Accumulation Buffer
+	rootParameters[2].InitAsDescriptorTable(1, &ranges[1]); // Moment Buffer
+	rootParameters[3].InitAsDescriptorTable(1, &ranges[2]); // Albedo Buffer
+	rootParameters[4].InitAsDescriptorTable(1, &ranges[3]); // Normal Buffer
+	rootParameters[5].InitAsDescriptorTable(1, &ranges[4]); // Source Irradiance
+	rootParameters[6].InitAsDescriptorTable(1, &ranges[5]); // Destination Irradiance
+	rootParameters[7].InitAsDescriptorTable(1, &ranges[6]); // Output
+
+	rootSignature = new DXRootSignature(rootParameters, _countof(rootParameters));
+	computePipeline = new DXComputePipeline(rootSignature, "Source/Shaders/Denoise.hlsl");
+}
+
+void DenoiseStage::DispatchPass(ComPtr<ID3D12GraphicsCommandList4> commandList, unsigned int pass, int step,
+	Texture* source, Texture* destination)
+{
+	DenoisePass constants;
+	constants.pass = pass;
+	constants.step = step;
+	constants.colorPhi = settings.colorPhi;
+	constants.normalPhi = settings.normalPhi;
+	constants.depthPhi = settings.depthPhi;
+
+	commandList->SetComputeRoot32BitConstants(0, sizeof(DenoisePass) / sizeof(unsigned int), &constants, 0);
+	commandList->SetComputeRootDescriptorTable(5, source->GetUAV());
+	commandList->SetComputeRootDescriptorTable(6, destination->GetUAV());
+
+	unsigned int width = DXAccess::GetWindow()->GetWindowWidth();
+	unsigned int height = DXAccess::GetWindow()->GetWindowHeight();
+	commandList->Dispatch((width + groupSize - 1) / groupSize, (height + groupSize - 1) / groupSize, 1);
+
+	// The next pass reads what this one wrote //
+	CD3DX12_RESOURCE_BARRIER barrier = CD3DX12_RESOURCE_BARRIER::UAV(destination->GetAddress());
+	commandList->ResourceBarrier(1, &barrier);
+}
\ No newline at end of file
@@ -6,10 +6,12 @@
 
 #include "Graphics/DXUtilities.h"
 #include "Graphics/DXUploadBuffer.h"
+#include "Graphics/DXStructuredBuffer.h"
 #include "Graphics/Model.h"
 #include "Graphics/Mesh.h"
 #include "Graphics/Texture.h"
 #include "Graphics/EnvironmentMap.h"
+#include <algorithm>
 #include <vector>
 
 RayTraceStage::RayTraceStage(Scene* scene) : activeScene(scene)
@@ -30,7 +32,7 @@ void RayTraceStage::Update(float deltaTime)
 	// The RayTraceStage has a buffer of relevant information about the application
 	// Things like time, frame count, and some settings like that it needs to clear the screen.
 	// Based on the information of the scene & app, we adjust the pipeline accordingly 
-	if(activeScene->HasGeometryMoved)
+	if(activeScene->HasNewGeometry || (activeScene->HasGeometryMoved && !TLAS->CanUpdate()))
 	{
 		// TODO: Even though this works, we need to find a proper place to fit this in, for example
 		// how resizing is handled within Nova 
@@ -38,7 +40,42 @@ void RayTraceStage::Update(float deltaTime)
 		shaderTable->ClearShaderTable();
 		InitializeShaderBindingTable();
 
+		activeScene->HasNewGeometry = false;
 		activeScene->HasGeometryMoved = false;
+		activeScene->HasMaterialChanged = false;
+		activeScene->HasNewTextures = false;
+		settings.frameCount = 0;
+		settings.clearBuffers = true;
+	}
+	else if(activeScene->HasGeometryMoved)
+	{
+		// Instances only moved, the TLAS gets refitted when recording this frame.
+		// Its address stays the same, so the shader table can be kept as is.
+		updateTLAS = true;
+
+		activeScene->HasGeometryMoved = false;
+		activeScene->HasMaterialChanged = false;
+		activeScene->HasNewTextures = false;
+		settings.frameCount = 0;
+		settings.clearBuffers = true;
+	}
+	else if(activeScene->HasMaterialChanged)
+	{
+		// Materials get written straight into their buffers, the TLAS & shader table are still valid
+		activeScene->HasMaterialChanged = false;
+		activeScene->HasNewTextures = false;
+		settings.frameCount = 0;
+		settings.clearBuffers = true;
+	}
+	else if(activeScene->HasNewTextures)
+	{
+		// Streamed textures kept their descriptors, only the accumulated samples are outdated
+		activeScene->HasNewTextures = false;
+		settings.frameCount = 0;
+		settings.clearBuffers = true;
+	}
+	else if(resetAccumulation)
+	{
 		settings.frameCount = 0;
 		settings.clearBuffers = true;
 	}
@@ -47,6 +84,8 @@ void RayTraceStage::Update(float deltaTime)
 		settings.clearBuffers = false;
 	}
 
+	resetAccumulation = false;
+
 	settingsBuffer->UpdateData(&settings);
 }
 
@@ -56,6 +95,17 @@ void RayTraceStage::RecordStage(ComPtr<ID3D12GraphicsCommandList4> commandList)
 	ID3D12Resource* const output = outputBuffer->GetAddress();
 
 	// 1) Prepare render buffer & Run the ray tracing pipeline // 
+	if(updateTLAS)
+	{
+		// Instances changed after 'Update', the next frame rebuilds instead
+		if(!TLAS->UpdateTLAS(commandList))
+		{
+			activeScene->HasNewGeometry = true;
+		}
+
+		updateTLAS = false;
+	}
+
 	TransitionResource(output, D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
 
 	commandList->SetPipelineState1(rayTracePipeline->GetPipelineState());
@@ -69,6 +119,58 @@ void RayTraceStage::RecordStage(ComPtr<ID3D12GraphicsCommandList4> commandList)
 	TransitionResource(renderTargetBuffer.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_RENDER_TARGET);
 }
 
+DXTopLevelAS* RayTraceStage::GetTLAS()
+{
+	return TLAS;
+}
+
+Texture* RayTraceStage::GetAccumulationBuffer()
+{
+	return accumalationBuffer;
+}
+
+Texture* RayTraceStage::GetMomentBuffer()
+{
+	return momentBuffer;
+}
+
+Texture* RayTraceStage::GetAlbedoBuffer()
+{
+	return albedoBuffer;
+}
+
+Texture* RayTraceStage::GetNormalBuffer()
+{
+	return normalBuffer;
+}
+
+const PipelineSettings& RayTraceStage::GetSettings()
+{
+	return settings;
+}
+
+void RayTraceStage::SetIntegratorSettings(bool useIterativeIntegrator, unsigned int minDepth, unsigned int maxDepth)
+{
+	settings.useIterativeIntegrator = useIterativeIntegrator;
+	settings.maxDepth = std::max(maxDepth, 1u);
+	settings.minDepth = std::min(std::max(minDepth, 1u), settings.maxDepth);
+
+	resetAccumulation = true;
+}
+
+void RayTraceStage::SetAdaptiveTargetError(float targetError)
+{
+	// The accumulated samples stay valid, converged pixels simply continue or stop sampling
+	settings.adaptiveTargetError = std::max(targetError, 0.0f);
+}
+
+void RayTraceStage::SetSamplerType(SamplerType samplerType)
+{
+	// The accumulated samples came from other sequences
+	settings.samplerType = samplerType;
+	resetAccumulation = true;
+}
+
 void RayTraceStage::CreateShaderResources()
 {
 	int width = DXAccess::GetWindow()->GetWindowWidth();
@@ -76,8 +178,12 @@ void RayTraceStage::CreateShaderResources()
 
 	outputBuffer = new Texture(width, height, DXGI_FORMAT_R8G8B8A8_UNORM);
 	accumalationBuffer = new Texture(width, height, DXGI_FORMAT_R32G32B32A32_FLOAT);
+	momentBuffer = new Texture(width, height, DXGI_FORMAT_R32_FLOAT);
+	albedoBuffer = new Texture(width, height, DXGI_FORMAT_R32G32B32A32_FLOAT);
+	normalBuffer = new Texture(width, height, DXGI_FORMAT_R32G32B32A32_FLOAT);
 
 	settingsBuffer = new DXUploadBuffer(&settings, sizeof(PipelineSettings));
+	blueNoiseBuffer = new DXStructuredBuffer(GetBlueNoiseRanks(), blueNoiseSize * blueNoiseSize, sizeof(unsigned int));
 }
 
 void RayTraceStage::CreateShaderDescriptors()
@@ -101,22 +207,43 @@ void RayTraceStage::CreateShaderDescriptors()
 	device->CreateUnorderedAccessView(accumalationBuffer->GetAddress(), nullptr, &colorBufferDescription, handle);
 
 	handle = heap->GetCPUHandleAt(heap->GetNextAvailableIndex());
+
+	D3D12_UNORDERED_ACCESS_VIEW_DESC momentBufferDescription = {};
+	momentBufferDescription.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE2D;
+	device->CreateUnorderedAccessView(momentBuffer->GetAddress(), nullptr, &momentBufferDescription, handle);
+
+	handle = heap->GetCPUHandleAt(heap->GetNextAvailableIndex());
+
+	D3D12_UNORDERED_ACCESS_VIEW_DESC albedoBufferDescription = {};
+	albedoBufferDescription.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE2D;
+	device->CreateUnorderedAccessView(albedoBuffer->GetAddress(), nullptr, &albedoBufferDescription, handle);
+
+	handle = heap->GetCPUHandleAt(heap->GetNextAvailableIndex());
+
+	D3D12_UNORDERED_ACCESS_VIEW_DESC normalBufferDescription = {};
+	normalBufferDescription.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE2D;
+	device->CreateUnorderedAccessView(normalBuffer->GetAddress(), nullptr, &normalBufferDescription, handle);
 }
 
 void RayTraceStage::InitializePipeline()
 {
 	DXRayTracingPipelineSettings settings;
-	settings.maxRayRecursionDepth = 16;
+	// Deep enough for the ray trees of 'ClosestHit', the iterative integrator only needs 2 (paths & shadow rays)
+	settings.maxRayRecursionDepth = 6;
 
 	// RayGen Root //
-	CD3DX12_DESCRIPTOR_RANGE rayGenRanges[2];
+	CD3DX12_DESCRIPTOR_RANGE rayGenRanges[5];
 	rayGenRanges[0].Init(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, 1, 0, 0); // Screen 
 	rayGenRanges[1].Init(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, 1, 1, 0); // Accumalation Buffer 
+	rayGenRanges[2].Init(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, 1, 2, 0); // Moment Buffer 
+	rayGenRanges[3].Init(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, 1, 3, 0); // Albedo Buffer 
+	rayGenRanges[4].Init(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, 1, 4, 0); // Normal Buffer 
 
-	CD3DX12_ROOT_PARAMETER rayGenParameters[3];
+	CD3DX12_ROOT_PARAMETER rayGenParameters[4];
 	rayGenParameters[0].InitAsDescriptorTable(_countof(rayGenRanges), &rayGenRanges[0]);
 	rayGenParameters[1].InitAsConstantBufferView(0, 0);
 	rayGenParameters[2].InitAsShaderResourceView(0, 0);
+	rayGenParameters[3].InitAsShaderResourceView(8, 0); // Blue-Noise Ranks
 
 	settings.rayGenParameters = &rayGenParameters[0];
 	settings.rayGenParameterCount = _countof(rayGenParameters);
@@ -131,7 +258,10 @@ void RayTraceStage::InitializePipeline()
 	CD3DX12_DESCRIPTOR_RANGE hitORMRange[1];
 	hitORMRange[0].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 5, 0); // Normal 
 
-	CD3DX12_ROOT_PARAMETER hitParameters[7];
+	CD3DX12_DESCRIPTOR_RANGE hitEnvironmentRange[1];
+	hitEnvironmentRange[0].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 6, 0); // Environment Map
+
+	CD3DX12_ROOT_PARAMETER hitParameters[11];
 	hitParameters[0].InitAsShaderResourceView(0, 0); // Vertex buffer
 	hitParameters[1].InitAsShaderResourceView(1, 0); // Index buffer
 	hitParameters[2].InitAsShaderResourceView(2, 0); // TLAS Scene 
@@ -139,21 +269,33 @@ void RayTraceStage::InitializePipeline()
 	hitParameters[4].InitAsDescriptorTable(_countof(hitTextureRanges), &hitTextureRanges[0]); 
 	hitParameters[5].InitAsDescriptorTable(_countof(hitNormalRange), &hitNormalRange[0]);  
 	hitParameters[6].InitAsDescriptorTable(_countof(hitORMRange), &hitORMRange[0]);
+	hitParameters[7].InitAsConstantBufferView(1, 0); // Geometry Info
+	hitParameters[8].InitAsDescriptorTable(_countof(hitEnvironmentRange), &hitEnvironmentRange[0]);
+	hitParameters[9].InitAsShaderResourceView(7, 0); // Environment Distribution
+	hitParameters[10].InitAsShaderResourceView(8, 0); // Blue-Noise Ranks
 
 	settings.hitParameters = &hitParameters[0];
 	settings.hitParameterCount = _countof(hitParameters);
 
+	// Trilinear & wrapping, the closest hit picks the mip level itself through 'SampleLevel'
+	CD3DX12_STATIC_SAMPLER_DESC hitSamplers[1];
+	hitSamplers[0].Init(0, D3D12_FILTER_MIN_MAG_MIP_LINEAR);
+
+	settings.hitSamplers = &hitSamplers[0];
+	settings.hitSamplerCount = _countof(hitSamplers);
+
 	// Miss Root //
 	CD3DX12_DESCRIPTOR_RANGE missRanges[1];
 	missRanges[0].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 0, 0); // Screen 
 
-	CD3DX12_ROOT_PARAMETER missParameters[1];
+	CD3DX12_ROOT_PARAMETER missParameters[2];
 	missParameters[0].InitAsDescriptorTable(_countof(missRanges), &missRanges[0]);
+	missParameters[1].InitAsShaderResourceView(1, 0); // Environment Distribution
 
 	settings.missParameters = &missParameters[0];
 	settings.missParameterCount = _countof(missParameters);
 
-	settings.payLoadSize = sizeof(float) * 5; // RGB, Depth, Seed
+	settings.payLoadSize = sizeof(float) * 29; // RGB, Depth, Sampler, BSDF PDF, Iterative, Throughput, Next Origin & Direction, Albedo, Normal, Hit Distance & Ray Cone
 	rayTracePipeline = new DXRayTracingPipeline(settings);
 }
 
@@ -169,11 +311,13 @@ void RayTraceStage::InitializeShaderBindingTable()
 	auto tlasPtr = reinterpret_cast<UINT64*>(TLAS->GetGPUVirtualAddress());
 	auto rayGenTable = reinterpret_cast<UINT64*>(heap->GetGPUHandleAt(rayGenTableIndex).ptr);
 	auto settingsPtr = reinterpret_cast<UINT64*>(settingsBuffer->GetGPUVirtualAddress());
-	shaderTable->AddRayGenerationProgram(L"RayGen", { rayGenTable, settingsPtr, tlasPtr });
+	auto blueNoisePtr = reinterpret_cast<UINT64*>(blueNoiseBuffer->GetResource()->GetGPUVirtualAddress());
+	shaderTable->AddRayGenerationProgram(L"RayGen", { rayGenTable, settingsPtr, tlasPtr, blueNoisePtr });
 
 	// Mis Entry //
 	auto exrPtr = reinterpret_cast<UINT64*>(activeScene->GetEnvironementMap()->GetTexture()->GetSRV().ptr);
-	shaderTable->AddMissProgram(L"Miss", { exrPtr });
+	auto distributionPtr = reinterpret_cast<UINT64*>(activeScene->GetEnvironementMap()->GetDistributionGPUAddress());
+	shaderTable->AddMissProgram(L"Miss", { exrPtr, distributionPtr });
 
 	// Hit Entries //
 	const std::vector<Model*>& models = activeScene->GetModels();
@@ -195,9 +339,10 @@ void RayTraceStage::InitializeShaderBindingTable()
 			auto diffuseTex = reinterpret_cast<UINT64*>(mesh->diffuseTexture->GetSRV().ptr);
 			auto normalTex = reinterpret_cast<UINT64*>(mesh->normalTexture->GetSRV().ptr);
 			auto ormTex = reinterpret_cast<UINT64*>(mesh->ORMTexture->GetSRV().ptr);
+			auto geometryInfo = reinterpret_cast<UINT64*>(mesh->GetGeometryInfoGPUAddress());
 
 			shaderTable->AddHitProgram(L"HitGroup", { vertex, index, tlasPtr, material, 
-				diffuseTex, normalTex, ormTex });
+				diffuseTex, normalTex, ormTex, geometryInfo, exrPtr, distributionPtr, blueNoisePtr });
 		}
 	}
 
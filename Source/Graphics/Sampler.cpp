@@ -0,0 +1,155 @@
+#include "Graphics/Sampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Width of the Gaussian that measures how clustered the pixels are, as suggested by Ulichney //
+static const float energySigma = 1.9f;
+
+// Part of the pixels that make up the initial pattern //
+static const float initialDensity = 0.1f;
+
+static unsigned int HashRank(unsigned int x)
+{
+	x ^= x >> 16;
+	x *= 0x7feb352du;
+	x ^= x >> 15;
+	x *= 0x846ca68bu;
+	x ^= x >> 16;
+	return x;
+}
+
+struct VoidAndCluster
+{
+	VoidAndCluster() : energy(pixelCount, 0.0f), isSet(pixelCount, false)
+	{
+		// Energy a pixel adds to every other pixel, the mask wraps around //
+		kernel.resize(pixelCount);
+		for(unsigned int y = 0; y < blueNoiseSize; y++)
+		{
+			for(unsigned int x = 0; x < blueNoiseSize; x++)
+			{
+				float dx = float(std::min(x, blueNoiseSize - x));
+				float dy = float(std::min(y, blueNoiseSize - y));
+				kernel[x + y * blueNoiseSize] = expf(-(dx * dx + dy * dy) / (2.0f * energySigma * energySigma));
+			}
+		}
+	}
+
+	void Set(unsigned int pixel, bool value)
+	{
+		isSet[pixel] = value;
+		float sign = value ? 1.0f : -1.0f;
+
+		unsigned int px = pixel % blueNoiseSize;
+		unsigned int py = pixel / blueNoiseSize;
+		for(unsigned int y = 0; y < blueNoiseSize; y++)
+		{
+			const float* kernelRow = &kernel[((y - py) & (blueNoiseSize - 1)) * blueNoiseSize];
+			float* energyRow = &energy[y * blueNoiseSize];
+
+			for(unsigned int x = 0; x < blueNoiseSize; x++)
+			{
+				energyRow[x] += sign * kernelRow[(x - px) & (blueNoiseSize - 1)];
+			}
+		}
+	}
+
+	// Set pixel with the most energy around it
+	unsigned int FindTightestCluster()
+	{
+		unsigned int cluster = 0;
+		float maxEnergy = -1.0f;
+		for(unsigned int i = 0; i < pixelCount; i++)
+		{
+			if(isSet[i] && energy[i] > maxEnergy)
+			{
+				maxEnergy = energy[i];
+				cluster = i;
+			}
+		}
+		return cluster;
+	}
+
+	// Empty pixel with the least energy around it
+	unsigned int FindLargestVoid()
+	{
+		unsigned int largestVoid = 0;
+		float minEnergy = INFINITY;
+		for(unsigned int i = 0; i < pixelCount; i++)
+		{
+			if(!isSet[i] && energy[i] < minEnergy)
+			{
+				minEnergy = energy[i];
+				largestVoid = i;
+			}
+		}
+		return largestVoid;
+	}
+
+	static const unsigned int pixelCount = blueNoiseSize * blueNoiseSize;
+
+	std::vector<float> kernel;
+	std::vector<float> energy;
+	std::vector<bool> isSet;
+};
+
+static std::vector<unsigned int> BuildBlueNoiseRanks()
+{
+	const unsigned int pixelCount = VoidAndCluster::pixelCount;
+	const unsigned int initialCount = (unsigned int)(pixelCount * initialDensity);
+	std::vector<unsigned int> ranks(pixelCount);
+
+	// 1. A random initial pattern, which gets evened out by moving its tightest cluster into its largest void //
+	VoidAndCluster pattern;
+	unsigned int placedCount = 0;
+	for(unsigned int i = 0; placedCount < initialCount; i++)
+	{
+		unsigned int pixel = HashRank(i) % pixelCount;
+		if(!pattern.isSet[pixel])
+		{
+			pattern.Set(pixel, true);
+			placedCount++;
+		}
+	}
+
+	for(unsigned int i = 0; i < pixelCount; i++)
+	{
+		unsigned int cluster = pattern.FindTightestCluster();
+		pattern.Set(cluster, false);
+
+		unsigned int largestVoid = pattern.FindLargestVoid();
+		pattern.Set(largestVoid, true);
+
+		if(largestVoid == cluster)
+		{
+			break;
+		}
+	}
+
+	// 2. The ranks below the initial pattern empty it, tightest cluster first //
+	VoidAndCluster clusters = pattern;
+	for(unsigned int rank = initialCount; rank-- > 0;)
+	{
+		unsigned int cluster = clusters.FindTightestCluster();
+		clusters.Set(cluster, false);
+		ranks[cluster] = rank;
+	}
+
+	// 3. The ranks above it fill the largest void, until every pixel is set //
+	for(unsigned int rank = initialCount; rank < pixelCount; rank++)
+	{
+		unsigned int largestVoid = pattern.FindLargestVoid();
+		pattern.Set(largestVoid, true);
+		ranks[largestVoid] = rank;
+	}
+
+	return ranks;
+}
+
+const unsigned int* GetBlueNoiseRanks()
+{
+	static const std::vector<unsigned int> ranks = BuildBlueNoiseRanks();
+	return ranks.data();
+}
\ No newline at end of file
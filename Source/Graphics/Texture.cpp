@@ -1,8 +1,26 @@
 #include "Graphics/Texture.h"
 #include "Graphics/DXUtilities.h"
 #include "Graphics/DXAccess.h"
+#include "Graphics/CookedTexture.h"
 #include <stb_image.h>
 
+static DXGI_FORMAT GetCompressedFormat(TextureCompression compression)
+{
+	switch(compression)
+	{
+	case TextureCompression::BC1:
+		return DXGI_FORMAT_BC1_UNORM;
+	case TextureCompression::BC5:
+		return DXGI_FORMAT_BC5_UNORM;
+	case TextureCompression::BC7:
+		return DXGI_FORMAT_BC7_UNORM;
+	case TextureCompression::None:
+		break;
+	}
+
+	return DXGI_FORMAT_R8G8B8A8_UNORM;
+}
+
 Texture::Texture(int width, int height, DXGI_FORMAT format) : width(width), height(height), format(format)
 {
 	// Main purpose is allocating buffers without necessarily allocating data to it directly
@@ -11,14 +29,14 @@ Texture::Texture(int width, int height, DXGI_FORMAT format) : width(width), heig
 	CreateDescriptors();
 }
 
-Texture::Texture(void* data, int width, int height, DXGI_FORMAT format, unsigned int formatSizeInBytes)
+Texture::Texture(void* data, int width, int height, DXGI_FORMAT format, unsigned int formatSizeInBytes, MipGeneration mipGeneration)
 	: width(width), height(height), format(format), formatSizeInBytes(formatSizeInBytes)
 {
-	UploadData(data);
+	UploadData(data, mipGeneration);
 	CreateDescriptors();
 }
 
-Texture::Texture(const std::string& filePath)
+Texture::Texture(const std::string& filePath, MipGeneration mipGeneration)
 {
 	int width;
 	int height;
@@ -36,11 +54,40 @@ Texture::Texture(const std::string& filePath)
 		assert(false);
 	}
 
-	UploadData(buffer);
+	UploadData(buffer, mipGeneration);
 	CreateDescriptors();
 	stbi_image_free(buffer);
 }
 
+Texture::Texture(CookedTexture& cookedTexture) : width(cookedTexture.GetWidth()), height(cookedTexture.GetHeight())
+{
+	compression = cookedTexture.GetCompression();
+	format = GetCompressedFormat(compression);
+	formatSizeInBytes = 4;
+
+	UploadMipChain(cookedTexture.GetData(), cookedTexture.GetMipLevels());
+	CreateDescriptors();
+}
+
+Texture::Texture(const unsigned char* mipChain, const std::vector<MipLevel>& levels, DXGI_FORMAT format, 
+	unsigned int formatSizeInBytes) : width(levels[0].width), height(levels[0].height), format(format), 
+	formatSizeInBytes(formatSizeInBytes)
+{
+	UploadMipChain(mipChain, levels);
+	CreateDescriptors();
+}
+
+Texture::Texture(Texture& placeholder) : width(placeholder.width), height(placeholder.height), 
+	format(placeholder.format), formatSizeInBytes(placeholder.formatSizeInBytes)
+{
+	textureResource = placeholder.textureResource;
+	mipLevels = placeholder.mipLevels;
+	compression = placeholder.compression;
+
+	srvIndex = DXAccess::GetDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV)->GetNextAvailableIndex();
+	CreateSRV();
+}
+
 Texture::~Texture()
 {
 	textureResource.Reset();
@@ -56,6 +103,11 @@ int Texture::GetHeight()
 	return height;
 }
 
+unsigned int Texture::GetMipLevels()
+{
+	return mipLevels;
+}
+
 int Texture::GetSRVIndex()
 {
 	return srvIndex;
@@ -84,6 +136,20 @@ D3D12_GPU_VIRTUAL_ADDRESS Texture::GetGPUVirtualAddress()
 	return textureResource->GetGPUVirtualAddress();
 }
 
+void Texture::Refine(CookedTexture& cookedTexture)
+{
+	width = cookedTexture.GetWidth();
+	height = cookedTexture.GetHeight();
+	compression = cookedTexture.GetCompression();
+	format = GetCompressedFormat(compression);
+	formatSizeInBytes = 4;
+
+	// The placeholder's resource only gets released by this texture, other textures can still be viewing it //
+	textureResource.Reset();
+	UploadMipChain(cookedTexture.GetData(), cookedTexture.GetMipLevels());
+	CreateSRV();
+}
+
 void Texture::AllocateTexture()
 {
 	D3D12_RESOURCE_DESC textureDescription = {};
@@ -94,7 +160,7 @@ void Texture::AllocateTexture()
 	textureDescription.Height = height;
 
 	textureDescription.DepthOrArraySize = 1;
-	textureDescription.MipLevels = 1;
+	textureDescription.MipLevels = mipLevels;
 	textureDescription.SampleDesc.Count = 1;
 	textureDescription.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
 
@@ -118,18 +184,46 @@ ComPtr<ID3D12Resource> Texture::GetResource()
 	return textureResource;
 }
 
-void Texture::UploadData(void* data)
+void Texture::UploadData(void* data, MipGeneration mipGeneration)
 {
+	// Mips are only generated for 8-bit RGBA, other formats (e.g. HDR) keep a single level //
+	std::vector<unsigned char> mipChain;
+	std::vector<MipLevel> levels;
+
+	if(mipGeneration != MipGeneration::None && format == DXGI_FORMAT_R8G8B8A8_UNORM)
+	{
+		GenerateMipChain((unsigned char*)data, width, height, mipGeneration, mipChain, levels);
+	}
+	else
+	{
+		levels.push_back({ (unsigned int)width, (unsigned int)height, 0 });
+	}
+
+	UploadMipChain(mipChain.empty() ? (unsigned char*)data : mipChain.data(), levels);
+}
+
+void Texture::UploadMipChain(const unsigned char* data, const std::vector<MipLevel>& levels)
+{
+	mipLevels = levels.size();
+
 	D3D12_RESOURCE_DESC description = CD3DX12_RESOURCE_DESC::Tex2D(
-		format, width, height);
-	description.Flags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
+		format, width, height, 1, mipLevels);
+	description.Flags = IsWritable() ? 
+		D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS : D3D12_RESOURCE_FLAG_NONE;
+
+	std::vector<D3D12_SUBRESOURCE_DATA> subresources(mipLevels);
+	for(unsigned int i = 0; i < mipLevels; i++)
+	{
+		bool isCompressed = compression != TextureCompression::None;
+		unsigned int rows = isCompressed ? (levels[i].height + 3) / 4 : levels[i].height;
 
-	D3D12_SUBRESOURCE_DATA subresource;
-	subresource.pData = data;
-	subresource.RowPitch = width * formatSizeInBytes;
+		subresources[i].pData = &data[levels[i].offset];
+		subresources[i].RowPitch = isCompressed ? GetCompressedRowPitch(compression, levels[i].width) : levels[i].width * formatSizeInBytes;
+		subresources[i].SlicePitch = subresources[i].RowPitch * rows;
+	}
 
 	ComPtr<ID3D12Resource> intermediateTexture;
-	UploadPixelShaderResource(textureResource, intermediateTexture, description, subresource);
+	UploadPixelShaderResource(textureResource, intermediateTexture, description, subresources.data(), mipLevels);
 }
 
 void Texture::CreateDescriptors()
@@ -137,14 +231,13 @@ void Texture::CreateDescriptors()
 	DXDescriptorHeap* heap = DXAccess::GetDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
 
 	// Create SRV //
-	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
-	srvDesc.Format = format;
-	srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
-	srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-	srvDesc.Texture2D.MipLevels = 1;
-
 	srvIndex = heap->GetNextAvailableIndex();
-	DXAccess::GetDevice()->CreateShaderResourceView(textureResource.Get(), &srvDesc, heap->GetCPUHandleAt(srvIndex));
+	CreateSRV();
+
+	if(!IsWritable())
+	{
+		return;
+	}
 
 	// Create UAV //
 	D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
@@ -153,4 +246,23 @@ void Texture::CreateDescriptors()
 
 	uavIndex = heap->GetNextAvailableIndex();
 	DXAccess::GetDevice()->CreateUnorderedAccessView(textureResource.Get(), nullptr, &uavDesc, heap->GetCPUHandleAt(uavIndex));
+}
+
+void Texture::CreateSRV()
+{
+	DXDescriptorHeap* heap = DXAccess::GetDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+
+	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+	srvDesc.Format = format;
+	srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+	srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+	srvDesc.Texture2D.MipLevels = mipLevels;
+
+	DXAccess::GetDevice()->CreateShaderResourceView(textureResource.Get(), &srvDesc, heap->GetCPUHandleAt(srvIndex));
+}
+
+bool Texture::IsWritable()
+{
+	// Block compressed & shared exponent formats can't be written to by the GPU //
+	return compression == TextureCompression::None && format != DXGI_FORMAT_R9G9B9E5_SHAREDEXP;
 }
\ No newline at end of file
@@ -0,0 +1,850 @@
+#include "Graphics/TextureCompression.h"
+#include "Utilities/ThreadPool.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// Weights of the second endpoint for the 4-bit BC7 indices, out of 64
+static const int bc7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+// Weights of the second endpoint ('c1') for the BC1 indices, in 4 color mode
+static const float bc1Weights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+
+#pragma region Helpers
+static unsigned int GetBlockSize(TextureCompression compression)
+{
+	return compression == TextureCompression::BC1 ? 8 : 16;
+}
+
+// Gathers a block of pixels, repeating the edges of levels that aren't a multiple of 4
+static void LoadBlock(const unsigned char* level, unsigned int width, unsigned int height,
+	unsigned int blockX, unsigned int blockY, float pixels[16][4])
+{
+	for(unsigned int y = 0; y < 4; y++)
+	{
+		unsigned int pixelY = std::min(blockY * 4 + y, height - 1);
+
+		for(unsigned int x = 0; x < 4; x++)
+		{
+			unsigned int pixelX = std::min(blockX * 4 + x, width - 1);
+			const unsigned char* pixel = &level[(size_t(pixelY) * width + pixelX) * 4];
+
+			for(int c = 0; c < 4; c++)
+			{
+				pixels[y * 4 + x][c] = float(pixel[c]);
+			}
+		}
+	}
+}
+
+// Counterpart of 'LoadBlock', pixels outside of the level get dropped
+static void StoreBlock(const uint8_t pixels[16][4], unsigned char* level, unsigned int width, unsigned int height,
+	unsigned int blockX, unsigned int blockY)
+{
+	for(unsigned int y = 0; y < 4 && blockY * 4 + y < height; y++)
+	{
+		for(unsigned int x = 0; x < 4 && blockX * 4 + x < width; x++)
+		{
+			size_t index = (size_t(blockY * 4 + y) * width + blockX * 4 + x) * 4;
+			memcpy(&level[index], pixels[y * 4 + x], 4);
+		}
+	}
+}
+
+// Direction of the largest variance within the block, found with power iterations on the covariance matrix
+template<int Channels>
+static void ComputePrincipalAxis(const float pixels[16][4], float mean[4], float axis[4])
+{
+	for(int c = 0; c < Channels; c++)
+	{
+		mean[c] = 0.0f;
+		for(int i = 0; i < 16; i++)
+		{
+			mean[c] += pixels[i][c];
+		}
+		mean[c] *= 1.0f / 16.0f;
+	}
+
+	float covariance[Channels][Channels] = {};
+	for(int i = 0; i < 16; i++)
+	{
+		for(int a = 0; a < Channels; a++)
+		{
+			for(int b = 0; b < Channels; b++)
+			{
+				covariance[a][b] += (pixels[i][a] - mean[a]) * (pixels[i][b] - mean[b]);
+			}
+		}
+	}
+
+	// Starting along the channel with the largest spread converges in a few iterations for most blocks
+	int largest = 0;
+	for(int c = 0; c < Channels; c++)
+	{
+		axis[c] = 0.0f;
+		largest = covariance[c][c] > covariance[largest][largest] ? c : largest;
+	}
+	axis[largest] = 1.0f;
+
+	for(int iteration = 0; iteration < 8; iteration++)
+	{
+		float next[Channels] = {};
+		float lengthSquared = 0.0f;
+
+		for(int a = 0; a < Channels; a++)
+		{
+			for(int b = 0; b < Channels; b++)
+			{
+				next[a] += covariance[a][b] * axis[b];
+			}
+			lengthSquared += next[a] * next[a];
+		}
+
+		if(lengthSquared < 1e-12f)
+		{
+			break;
+		}
+
+		float inverseLength = 1.0f / sqrtf(lengthSquared);
+		for(int c = 0; c < Channels; c++)
+		{
+			axis[c] = next[c] * inverseLength;
+		}
+	}
+}
+
+// Extent of the block along the axis, as the two endpoints of a line through the mean
+template<int Channels>
+static void ComputeAxisEndpoints(const float pixels[16][4], const float mean[4], const float axis[4], float e0[4], float e1[4])
+{
+	float minimum = FLT_MAX;
+	float maximum = -FLT_MAX;
+
+	for(int i = 0; i < 16; i++)
+	{
+		float t = 0.0f;
+		for(int c = 0; c < Channels; c++)
+		{
+			t += (pixels[i][c] - mean[c]) * axis[c];
+		}
+
+		minimum = std::min(minimum, t);
+		maximum = std::max(maximum, t);
+	}
+
+	for(int c = 0; c < Channels; c++)
+	{
+		e0[c] = std::min(std::max(mean[c] + axis[c] * minimum, 0.0f), 255.0f);
+		e1[c] = std::min(std::max(mean[c] + axis[c] * maximum, 0.0f), 255.0f);
+	}
+}
+
+// Least squares fit of both endpoints, given how much each pixel is weighted towards 'e1'
+template<int Channels>
+static bool FitEndpoints(const float pixels[16][4], const float weights[16], float e0[4], float e1[4])
+{
+	float aa = 0.0f;
+	float ab = 0.0f;
+	float bb = 0.0f;
+	float ax[4] = {};
+	float bx[4] = {};
+
+	for(int i = 0; i < 16; i++)
+	{
+		float b = weights[i];
+		float a = 1.0f - b;
+
+		aa += a * a;
+		ab += a * b;
+		bb += b * b;
+
+		for(int c = 0; c < Channels; c++)
+		{
+			ax[c] += a * pixels[i][c];
+			bx[c] += b * pixels[i][c];
+		}
+	}
+
+	float determinant = aa * bb - ab * ab;
+	if(fabsf(determinant) < 1e-6f)
+	{
+		return false;
+	}
+
+	float inverseDeterminant = 1.0f / determinant;
+	for(int c = 0; c < Channels; c++)
+	{
+		e0[c] = std::min(std::max((bb * ax[c] - ab * bx[c]) * inverseDeterminant, 0.0f), 255.0f);
+		e1[c] = std::min(std::max((aa * bx[c] - ab * ax[c]) * inverseDeterminant, 0.0f), 255.0f);
+	}
+
+	return true;
+}
+
+// Sequential access to the bits of a 128-bit block, starting at the least significant bit
+struct BlockBits
+{
+	uint64_t bits[2] = { 0, 0 };
+	unsigned int position = 0;
+
+	void Write(unsigned int value, unsigned int count)
+	{
+		for(unsigned int i = 0; i < count; i++, position++)
+		{
+			bits[position >> 6] |= uint64_t((value >> i) & 1) << (position & 63);
+		}
+	}
+
+	unsigned int Read(unsigned int count)
+	{
+		unsigned int value = 0;
+		for(unsigned int i = 0; i < count; i++, position++)
+		{
+			value |= (unsigned int)((bits[position >> 6] >> (position & 63)) & 1) << i;
+		}
+		return value;
+	}
+};
+#pragma endregion
+
+#pragma region BC1
+static uint16_t QuantizeRGB565(const float color[4])
+{
+	int r = int(color[0] * (31.0f / 255.0f) + 0.5f);
+	int g = int(color[1] * (63.0f / 255.0f) + 0.5f);
+	int b = int(color[2] * (31.0f / 255.0f) + 0.5f);
+	return uint16_t((r << 11) | (g << 5) | b);
+}
+
+static void GetBC1Palette(uint16_t c0, uint16_t c1, int palette[4][4])
+{
+	uint16_t colors[2] = { c0, c1 };
+	for(int i = 0; i < 2; i++)
+	{
+		int r = colors[i] >> 11;
+		int g = (colors[i] >> 5) & 63;
+		int b = colors[i] & 31;
+
+		palette[i][0] = (r << 3) | (r >> 2);
+		palette[i][1] = (g << 2) | (g >> 4);
+		palette[i][2] = (b << 3) | (b >> 2);
+		palette[i][3] = 255;
+	}
+
+	for(int c = 0; c < 3; c++)
+	{
+		if(c0 > c1)
+		{
+			palette[2][c] = (2 * palette[0][c] + palette[1][c] + 1) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c] + 1) / 3;
+		}
+		else
+		{
+			// 3 color mode, only written by the encoder for blocks of a single color
+			palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+			palette[3][c] = 0;
+		}
+	}
+
+	palette[2][3] = 255;
+	palette[3][3] = c0 > c1 ? 255 : 0;
+}
+
+static void EncodeBC1(const float pixels[16][4], unsigned char* output)
+{
+	float mean[4];
+	float axis[4];
+	float e0[4];
+	float e1[4];
+
+	ComputePrincipalAxis<3>(pixels, mean, axis);
+	ComputeAxisEndpoints<3>(pixels, mean, axis, e1, e0);
+
+	uint16_t bestColors[2] = { 0, 0 };
+	uint32_t bestIndices = 0;
+	int bestError = INT32_MAX;
+
+	for(int iteration = 0; iteration < 3; iteration++)
+	{
+		// 4 color mode requires 'c0' to be larger, the order doesn't matter for the fit below
+		uint16_t c0 = QuantizeRGB565(e0);
+		uint16_t c1 = QuantizeRGB565(e1);
+		if(c0 < c1)
+		{
+			std::swap(c0, c1);
+		}
+
+		int palette[4][4];
+		GetBC1Palette(c0, c1, palette);
+
+		uint32_t indices = 0;
+		int error = 0;
+		float weights[16];
+
+		for(int i = 0; i < 16; i++)
+		{
+			int bestIndex = 0;
+			int bestDistance = INT32_MAX;
+
+			for(int p = 0; p < (c0 == c1 ? 1 : 4); p++)
+			{
+				int distance = 0;
+				for(int c = 0; c < 3; c++)
+				{
+					int difference = int(pixels[i][c]) - palette[p][c];
+					distance += difference * difference;
+				}
+
+				if(distance < bestDistance)
+				{
+					bestDistance = distance;
+					bestIndex = p;
+				}
+			}
+
+			indices |= uint32_t(bestIndex) << (i * 2);
+			error += bestDistance;
+			weights[i] = bc1Weights[bestIndex];
+		}
+
+		if(error < bestError)
+		{
+			bestError = error;
+			bestColors[0] = c0;
+			bestColors[1] = c1;
+			bestIndices = indices;
+		}
+
+		if(error == 0 || c0 == c1 || !FitEndpoints<3>(pixels, weights, e0, e1))
+		{
+			break;
+		}
+	}
+
+	memcpy(output, bestColors, sizeof(bestColors));
+	memcpy(output + 4, &bestIndices, sizeof(bestIndices));
+}
+
+static void DecodeBC1(const unsigned char* input, uint8_t pixels[16][4])
+{
+	uint16_t colors[2];
+	uint32_t indices;
+	memcpy(colors, input, sizeof(colors));
+	memcpy(&indices, input + 4, sizeof(indices));
+
+	int palette[4][4];
+	GetBC1Palette(colors[0], colors[1], palette);
+
+	for(int i = 0; i < 16; i++)
+	{
+		int index = (indices >> (i * 2)) & 3;
+		for(int c = 0; c < 4; c++)
+		{
+			pixels[i][c] = uint8_t(palette[index][c]);
+		}
+	}
+}
+#pragma endregion
+
+#pragma region BC4 & BC5
+static void GetBC4Palette(int r0, int r1, int palette[8])
+{
+	palette[0] = r0;
+	palette[1] = r1;
+
+	if(r0 > r1)
+	{
+		for(int i = 2; i < 8; i++)
+		{
+			palette[i] = ((8 - i) * r0 + (i - 1) * r1 + 3) / 7;
+		}
+	}
+	else
+	{
+		for(int i = 2; i < 6; i++)
+		{
+			palette[i] = ((6 - i) * r0 + (i - 1) * r1 + 2) / 5;
+		}
+		palette[6] = 0;
+		palette[7] = 255;
+	}
+}
+
+// A single channel, BC5 stores two of these blocks for red & green
+static void EncodeBC4(const float pixels[16][4], int channel, unsigned char* output)
+{
+	int minimum = 255;
+	int maximum = 0;
+	for(int i = 0; i < 16; i++)
+	{
+		minimum = std::min(minimum, int(pixels[i][channel]));
+		maximum = std::max(maximum, int(pixels[i][channel]));
+	}
+
+	// Always the 8 value mode, blocks of a single value only use index 0
+	int palette[8];
+	GetBC4Palette(maximum, minimum, palette);
+
+	uint64_t indices = 0;
+
+	for(int i = 0; i < 16; i++)
+	{
+		int value = int(pixels[i][channel]);
+		int bestIndex = 0;
+		int bestDistance = INT32_MAX;
+
+		for(int p = 0; p < (maximum > minimum ? 8 : 1); p++)
+		{
+			int distance = abs(value - palette[p]);
+			if(distance < bestDistance)
+			{
+				bestDistance = distance;
+				bestIndex = p;
+			}
+		}
+
+		indices |= uint64_t(bestIndex) << (i * 3);
+	}
+
+	output[0] = uint8_t(maximum);
+	output[1] = uint8_t(minimum);
+	memcpy(output + 2, &indices, 6);
+}
+
+static void DecodeBC4(const unsigned char* input, int channel, uint8_t pixels[16][4])
+{
+	uint64_t indices = 0;
+	memcpy(&indices, input + 2, 6);
+
+	int palette[8];
+	GetBC4Palette(input[0], input[1], palette);
+
+	for(int i = 0; i < 16; i++)
+	{
+		pixels[i][channel] = uint8_t(palette[(indices >> (i * 3)) & 7]);
+	}
+}
+#pragma endregion
+
+#pragma region BC7
+// Closest 8-bit endpoint that has 'pBit' as its lowest bit, as mode 6 stores 7 bits plus a shared p-bit
+static int QuantizeBC7Endpoint(float value, int pBit)
+{
+	int quantized = int((value - pBit) * 0.5f + 0.5f);
+	return (std::min(std::max(quantized, 0), 127) << 1) | pBit;
+}
+
+// Picks the p-bit that keeps the endpoint closest to its unquantized value
+static void QuantizeBC7Endpoints(const float endpoint[4], int quantized[4])
+{
+	float bestError = FLT_MAX;
+	for(int pBit = 0; pBit < 2; pBit++)
+	{
+		int candidate[4];
+		float error = 0.0f;
+
+		for(int c = 0; c < 4; c++)
+		{
+			candidate[c] = QuantizeBC7Endpoint(endpoint[c], pBit);
+			error += (candidate[c] - endpoint[c]) * (candidate[c] - endpoint[c]);
+		}
+
+		if(error < bestError)
+		{
+			bestError = error;
+			memcpy(quantized, candidate, sizeof(candidate));
+		}
+	}
+}
+
+static int FindBC7Indices(const float pixels[16][4], const int endpoints[2][4], int indices[16])
+{
+	int palette[16][4];
+	for(int i = 0; i < 16; i++)
+	{
+		for(int c = 0; c < 4; c++)
+		{
+			palette[i][c] = ((64 - bc7Weights[i]) * endpoints[0][c] + bc7Weights[i] * endpoints[1][c] + 32) >> 6;
+		}
+	}
+
+	int direction[4];
+	int lengthSquared = 0;
+	for(int c = 0; c < 4; c++)
+	{
+		direction[c] = endpoints[1][c] - endpoints[0][c];
+		lengthSquared += direction[c] * direction[c];
+	}
+
+	// Project onto the line between the endpoints, then pick the best of the nearest indices
+	float scale = lengthSquared > 0 ? 15.0f / float(lengthSquared) : 0.0f;
+	int error = 0;
+
+	for(int i = 0; i < 16; i++)
+	{
+		float t = 0.0f;
+		for(int c = 0; c < 4; c++)
+		{
+			t += (pixels[i][c] - endpoints[0][c]) * direction[c];
+		}
+
+		int estimate = std::min(std::max(int(t * scale + 0.5f), 0), 15);
+		int bestDistance = INT32_MAX;
+
+		for(int index = std::max(estimate - 1, 0); index <= std::min(estimate + 1, 15); index++)
+		{
+			int distance = 0;
+			for(int c = 0; c < 4; c++)
+			{
+				int difference = int(pixels[i][c]) - palette[index][c];
+				distance += difference * difference;
+			}
+
+			if(distance < bestDistance)
+			{
+				bestDistance = distance;
+				indices[i] = index;
+			}
+		}
+
+		error += bestDistance;
+	}
+
+	return error;
+}
+
+static void EncodeBC7(const float pixels[16][4], unsigned char* output)
+{
+	float mean[4];
+	float axis[4];
+	float e0[4];
+	float e1[4];
+
+	ComputePrincipalAxis<4>(pixels, mean, axis);
+	ComputeAxisEndpoints<4>(pixels, mean, axis, e0, e1);
+
+	int bestEndpoints[2][4] = {};
+	int bestIndices[16] = {};
+	int bestError = INT32_MAX;
+
+	for(int iteration = 0; iteration < 3; iteration++)
+	{
+		int endpoints[2][4];
+		int indices[16];
+		QuantizeBC7Endpoints(e0, endpoints[0]);
+		QuantizeBC7Endpoints(e1, endpoints[1]);
+
+		int error = FindBC7Indices(pixels, endpoints, indices);
+		if(error < bestError)
+		{
+			bestError = error;
+			memcpy(bestEndpoints, endpoints, sizeof(endpoints));
+			memcpy(bestIndices, indices, sizeof(indices));
+		}
+
+		float weights[16];
+		for(int i = 0; i < 16; i++)
+		{
+			weights[i] = bc7Weights[bestIndices[i]] / 64.0f;
+		}
+
+		if(bestError == 0 || !FitEndpoints<4>(pixels, weights, e0, e1))
+		{
+			break;
+		}
+	}
+
+	// The first index is stored without its highest bit, so it has to be below 8 //
+	if(bestIndices[0] >= 8)
+	{
+		for(int c = 0; c < 4; c++)
+		{
+			std::swap(bestEndpoints[0][c], bestEndpoints[1][c]);
+		}
+
+		for(int i = 0; i < 16; i++)
+		{
+			bestIndices[i] = 15 - bestIndices[i];
+		}
+	}
+
+	// Mode 6: mode bits, RGBA endpoint pairs of 7 bits, p-bits, indices //
+	BlockBits block;
+	block.Write(1 << 6, 7);
+
+	for(int c = 0; c < 4; c++)
+	{
+		block.Write(bestEndpoints[0][c] >> 1, 7);
+		block.Write(bestEndpoints[1][c] >> 1, 7);
+	}
+
+	block.Write(bestEndpoints[0][0] & 1, 1);
+	block.Write(bestEndpoints[1][0] & 1, 1);
+
+	block.Write(bestIndices[0], 3);
+	for(int i = 1; i < 16; i++)
+	{
+		block.Write(bestIndices[i], 4);
+	}
+
+	memcpy(output, block.bits, sizeof(block.bits));
+}
+
+// Only decodes mode 6, which is the only mode 'EncodeBC7' writes
+static void DecodeBC7(const unsigned char* input, uint8_t pixels[16][4])
+{
+	BlockBits block;
+	memcpy(block.bits, input, sizeof(block.bits));
+
+	if(block.Read(7) != (1 << 6))
+	{
+		assert(false && "Only BC7 mode 6 blocks are supported");
+		memset(pixels, 0, sizeof(uint8_t) * 16 * 4);
+		return;
+	}
+
+	int endpoints[2][4];
+	for(int c = 0; c < 4; c++)
+	{
+		endpoints[0][c] = block.Read(7) << 1;
+		endpoints[1][c] = block.Read(7) << 1;
+	}
+
+	int p0 = block.Read(1);
+	int p1 = block.Read(1);
+	for(int c = 0; c < 4; c++)
+	{
+		endpoints[0][c] |= p0;
+		endpoints[1][c] |= p1;
+	}
+
+	for(int i = 0; i < 16; i++)
+	{
+		int weight = bc7Weights[block.Read(i == 0 ? 3 : 4)];
+		for(int c = 0; c < 4; c++)
+		{
+			pixels[i][c] = uint8_t(((64 - weight) * endpoints[0][c] + weight * endpoints[1][c] + 32) >> 6);
+		}
+	}
+}
+#pragma endregion
+
+static void EncodeBlock(TextureCompression compression, const float pixels[16][4], unsigned char* output)
+{
+	switch(compression)
+	{
+	case TextureCompression::BC1:
+		EncodeBC1(pixels, output);
+		break;
+	case TextureCompression::BC5:
+		EncodeBC4(pixels, 0, output);
+		EncodeBC4(pixels, 1, output + 8);
+		break;
+	case TextureCompression::BC7:
+		EncodeBC7(pixels, output);
+		break;
+	case TextureCompression::None:
+		break;
+	}
+}
+
+static void DecodeBlock(TextureCompression compression, const unsigned char* input, uint8_t pixels[16][4])
+{
+	switch(compression)
+	{
+	case TextureCompression::BC1:
+		DecodeBC1(input, pixels);
+		break;
+	case TextureCompression::BC5:
+		DecodeBC4(input, 0, pixels);
+		DecodeBC4(input + 8, 1, pixels);
+		for(int i = 0; i < 16; i++)
+		{
+			pixels[i][2] = 0;
+			pixels[i][3] = 255;
+		}
+		break;
+	case TextureCompression::BC7:
+		DecodeBC7(input, pixels);
+		break;
+	case TextureCompression::None:
+		break;
+	}
+}
+
+const char* GetCompressionName(TextureCompression compression)
+{
+	switch(compression)
+	{
+	case TextureCompression::BC1:
+		return "BC1";
+	case TextureCompression::BC5:
+		return "BC5";
+	case TextureCompression::BC7:
+		return "BC7";
+	case TextureCompression::None:
+		break;
+	}
+
+	return "RGBA8";
+}
+
+size_t GetCompressedRowPitch(TextureCompression compression, unsigned int width)
+{
+	if(compression == TextureCompression::None)
+	{
+		return size_t(width) * 4;
+	}
+
+	return size_t((width + 3) / 4) * GetBlockSize(compression);
+}
+
+size_t GetCompressedLevelSize(TextureCompression compression, unsigned int width, unsigned int height)
+{
+	unsigned int rows = compression == TextureCompression::None ? height : (height + 3) / 4;
+	return GetCompressedRowPitch(compression, width) * rows;
+}
+
+void CompressMipChain(const unsigned char* mipChain, const std::vector<MipLevel>& mipLevels, TextureCompression compression,
+	std::vector<unsigned char>& compressedData, std::vector<MipLevel>& compressedLevels, float* psnr)
+{
+	// 1. Lay out all levels //
+	compressedLevels = mipLevels;
+
+	size_t dataSize = 0;
+	for(MipLevel& level : compressedLevels)
+	{
+		level.offset = dataSize;
+		dataSize += GetCompressedLevelSize(compression, level.width, level.height);
+	}
+
+	compressedData.resize(dataSize);
+
+	if(compression == TextureCompression::None)
+	{
+		for(unsigned int i = 0; i < mipLevels.size(); i++)
+		{
+			memcpy(&compressedData[compressedLevels[i].offset], &mipChain[mipLevels[i].offset],
+				GetCompressedLevelSize(compression, mipLevels[i].width, mipLevels[i].height));
+		}
+
+		if(psnr)
+		{
+			*psnr = 100.0f;
+		}
+		return;
+	}
+
+	// 2. Compress every level, in parallel over rows of blocks //
+	// The error of the first level is summed per row, so the PSNR doesn't depend on the thread count
+	unsigned int blockSize = GetBlockSize(compression);
+	int errorChannels = compression == TextureCompression::BC5 ? 2 : 3;
+	std::vector<uint64_t> rowErrors;
+
+	for(unsigned int i = 0; i < mipLevels.size(); i++)
+	{
+		const MipLevel& level = mipLevels[i];
+		const unsigned char* levelData = &mipChain[level.offset];
+		unsigned char* compressedLevel = &compressedData[compressedLevels[i].offset];
+
+		unsigned int blocksWide = (level.width + 3) / 4;
+		unsigned int blocksHigh = (level.height + 3) / 4;
+		size_t rowPitch = GetCompressedRowPitch(compression, level.width);
+
+		bool measureError = i == 0 && psnr != nullptr;
+		rowErrors.assign(blocksHigh, 0);
+
+		ThreadPool::GetGlobalPool().ParallelFor(blocksHigh, [&](unsigned int blockY)
+		{
+			float pixels[16][4];
+			uint8_t decoded[16][4];
+
+			for(unsigned int blockX = 0; blockX < blocksWide; blockX++)
+			{
+				unsigned char* block = &compressedLevel[blockY * rowPitch + blockX * blockSize];
+
+				LoadBlock(levelData, level.width, level.height, blockX, blockY, pixels);
+				EncodeBlock(compression, pixels, block);
+
+				if(!measureError)
+				{
+					continue;
+				}
+
+				// Only the pixels within the level count, not the repeated edges //
+				DecodeBlock(compression, block, decoded);
+				for(unsigned int y = 0; y < 4 && blockY * 4 + y < level.height; y++)
+				{
+					for(unsigned int x = 0; x < 4 && blockX * 4 + x < level.width; x++)
+					{
+						for(int c = 0; c < errorChannels; c++)
+						{
+							int difference = int(pixels[y * 4 + x][c]) - decoded[y * 4 + x][c];
+							rowErrors[blockY] += uint64_t(difference * difference);
+						}
+					}
+				}
+			}
+		});
+
+		if(measureError)
+		{
+			uint64_t squaredError = 0;
+			for(uint64_t rowError : rowErrors)
+			{
+				squaredError += rowError;
+			}
+
+			// Identical images would have an infinite PSNR, which gets reported as 100 dB
+			double meanSquaredError = double(squaredError) / (double(level.width) * level.height * errorChannels);
+			*psnr = meanSquaredError > 0.0 ? float(10.0 * log10(255.0 * 255.0 / meanSquaredError)) : 100.0f;
+		}
+	}
+}
+
+void DecompressMipChain(const unsigned char* compressedData, const std::vector<MipLevel>& compressedLevels,
+	TextureCompression compression, std::vector<unsigned char>& mipChain, std::vector<MipLevel>& mipLevels)
+{
+	mipLevels = compressedLevels;
+
+	size_t chainSize = 0;
+	for(MipLevel& level : mipLevels)
+	{
+		level.offset = chainSize;
+		chainSize += size_t(level.width) * level.height * 4;
+	}
+
+	mipChain.resize(chainSize);
+
+	for(unsigned int i = 0; i < mipLevels.size(); i++)
+	{
+		const MipLevel& level = mipLevels[i];
+		const unsigned char* compressedLevel = &compressedData[compressedLevels[i].offset];
+		unsigned char* levelData = &mipChain[level.offset];
+
+		if(compression == TextureCompression::None)
+		{
+			memcpy(levelData, compressedLevel, size_t(level.width) * level.height * 4);
+			continue;
+		}
+
+		unsigned int blockSize = GetBlockSize(compression);
+		unsigned int blocksWide = (level.width + 3) / 4;
+		unsigned int blocksHigh = (level.height + 3) / 4;
+		size_t rowPitch = GetCompressedRowPitch(compression, level.width);
+
+		ThreadPool::GetGlobalPool().ParallelFor(blocksHigh, [&](unsigned int blockY)
+		{
+			uint8_t pixels[16][4];
+			for(unsigned int blockX = 0; blockX < blocksWide; blockX++)
+			{
+				DecodeBlock(compression, &compressedLevel[blockY * rowPitch + blockX * blockSize], pixels);
+				StoreBlock(pixels, levelData, level.width, level.height, blockX, blockY);
+			}
+		});
+	}
+}
\ No newline at end of file
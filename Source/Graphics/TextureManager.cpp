@@ -1,32 +1,131 @@
 #include "Graphics/TextureManager.h"
 #include "Graphics/Texture.h"
+#include "Graphics/TextureStreamer.h"
+#include "Utilities/Hash.h"
+#include "Utilities/MappedFile.h"
+#include "Utilities/Logger.h"
 
-std::unordered_map<std::string, Texture*> TextureManager::textureAssets; 
+#include <cassert>
 
-Texture* TextureManager::LoadTexture(const std::string& path)
+std::unordered_map<uint64_t, TextureManager::TextureEntry> TextureManager::textureAssets;
+std::unordered_map<Texture*, uint64_t> TextureManager::textureKeys;
+std::unordered_map<std::string, uint64_t> TextureManager::fileHashes;
+
+// The same image cooked differently results in a different texture //
+static uint64_t GetCookingSeed(TextureCompression compression, MipGeneration mipGeneration)
+{
+	return HashMix(((uint64_t)compression << 8) | (uint64_t)mipGeneration);
+}
+
+uint64_t TextureManager::GetImageKey(const std::string& imagePath, TextureCompression compression, MipGeneration mipGeneration)
 {
-	if(IsStored(path))
+	// Materials often share images, so every file only gets hashed once //
+	auto fileHash = fileHashes.find(imagePath);
+	if(fileHash == fileHashes.end())
 	{
-		return textureAssets[path];
+		MappedFile imageFile(imagePath);
+		if(!imageFile.IsValid())
+		{
+			return 0;
+		}
+
+		fileHash = fileHashes.insert(std::make_pair(imagePath, HashBytes(imageFile.GetData(), imageFile.GetSize()))).first;
 	}
 
-	Texture* newTexture = new Texture(path);
-	textureAssets.insert(std::make_pair(path, newTexture));
-	
-	return newTexture;
+	return HashMix(fileHash->second ^ GetCookingSeed(compression, mipGeneration));
 }
 
-void TextureManager::AddTexture(const std::string& path, Texture* texture)
+uint64_t TextureManager::GetImageKey(const unsigned char* pixels, int width, int height, TextureCompression compression,
+	MipGeneration mipGeneration)
 {
-	textureAssets.insert(std::make_pair(path, texture));
+	uint64_t seed = GetCookingSeed(compression, mipGeneration) ^ HashMix(width);
+	return HashBytes(pixels, size_t(width) * height * 4, seed);
+}
+
+void TextureManager::AddTexture(uint64_t key, Texture* texture)
+{
+	if(IsStored(key))
+	{
+		LOG(Log::MessageType::Error, "A texture with the same key has already been stored!");
+		assert(false);
+		return;
+	}
+
+	textureAssets.insert(std::make_pair(key, TextureEntry{ texture, 1 }));
+	textureKeys.insert(std::make_pair(texture, key));
 }
 
-Texture* TextureManager::GetTexture(const std::string& path)
+Texture* TextureManager::AcquireTexture(uint64_t key)
 {
-	return textureAssets[path];
+	auto entry = textureAssets.find(key);
+	if(entry == textureAssets.end())
+	{
+		return nullptr;
+	}
+
+	entry->second.referenceCount++;
+	return entry->second.texture;
+}
+
+void TextureManager::AddReference(Texture* texture)
+{
+	auto key = textureKeys.find(texture);
+	assert(key != textureKeys.end() && "Texture isn't stored in the TextureManager");
+
+	textureAssets[key->second].referenceCount++;
+}
+
+void TextureManager::ReleaseTexture(Texture* texture)
+{
+	if(texture == nullptr)
+	{
+		return;
+	}
+
+	auto key = textureKeys.find(texture);
+	assert(key != textureKeys.end() && "Texture isn't stored in the TextureManager");
+
+	TextureEntry& entry = textureAssets[key->second];
+	entry.referenceCount--;
+
+	if(entry.referenceCount == 0)
+	{
+		textureAssets.erase(key->second);
+		textureKeys.erase(key);
+
+		// Textures that are still streaming in get deleted once their cooking finished //
+		TextureStreamer::DeleteTexture(texture);
+	}
+}
+
+Texture* TextureManager::GetTexture(uint64_t key)
+{
+	auto entry = textureAssets.find(key);
+	return entry != textureAssets.end() ? entry->second.texture : nullptr;
+}
+
+bool TextureManager::IsStored(uint64_t key)
+{
+	return textureAssets.find(key) != textureAssets.end();
+}
+
+Texture* TextureManager::LoadTexture(const std::string& path)
+{
+	uint64_t key = GetImageKey(path, TextureCompression::None, MipGeneration::SRGB);
+
+	Texture* texture = AcquireTexture(key);
+	if(texture != nullptr)
+	{
+		return texture;
+	}
+
+	texture = new Texture(path);
+	AddTexture(key, texture);
+
+	return texture;
 }
 
-bool TextureManager::IsStored(const std::string& path)
+unsigned int TextureManager::GetTextureCount()
 {
-	return textureAssets.find(path) != textureAssets.end();
+	return textureAssets.size();
 }
\ No newline at end of file
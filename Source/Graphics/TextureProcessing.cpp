@@ -0,0 +1,474 @@
+#include "Graphics/TextureProcessing.h"
+#include "Utilities/ThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__)
+#define TEXTURE_PROCESSING_SSE2
+#include <emmintrin.h>
+#endif
+
+// Pixels get averaged as 16-bit linear values, which keeps enough precision
+// in the darks of sRGB data, while 8 channels still fit a single SSE register
+struct MipConversionTables
+{
+	uint16_t srgbToLinear[256];
+	uint16_t unormToLinear[256];
+	uint8_t linearToSRGB[65536];
+	uint8_t linearToUnorm[65536];
+
+	MipConversionTables()
+	{
+		for(int i = 0; i < 256; i++)
+		{
+			srgbToLinear[i] = uint16_t(SRGBToLinear(i / 255.0) * 65535.0 + 0.5);
+			unormToLinear[i] = uint16_t(i * 257);
+		}
+
+		// Every 8-bit value covers the linear values up to the midpoint (in sRGB space) with the next one,
+		// so encoding rounds to the nearest sRGB value, without evaluating the curve 64K times
+		unsigned int value = 0;
+		for(int i = 0; i < 256; i++)
+		{
+			double threshold = i < 255 ? SRGBToLinear((i + 0.5) / 255.0) * 65535.0 : 65536.0;
+			while(value < 65536 && value < threshold)
+			{
+				linearToSRGB[value++] = uint8_t(i);
+			}
+		}
+
+		for(unsigned int i = 0; i < 65536; i++)
+		{
+			linearToUnorm[i] = uint8_t((i * 255 + 32767) / 65535);
+		}
+	}
+
+	static double SRGBToLinear(double value)
+	{
+		return value <= 0.04045 ? value / 12.92 : pow((value + 0.055) / 1.055, 2.4);
+	}
+};
+
+static const MipConversionTables& GetConversionTables()
+{
+	static MipConversionTables tables;
+	return tables;
+}
+
+static void DecodeRow(const unsigned char* source, uint16_t* destination, unsigned int width, const uint16_t* const decode[4])
+{
+	for(unsigned int x = 0; x < width * 4; x += 4)
+	{
+		destination[x] = decode[0][source[x]];
+		destination[x + 1] = decode[1][source[x + 1]];
+		destination[x + 2] = decode[2][source[x + 2]];
+		destination[x + 3] = decode[3][source[x + 3]];
+	}
+}
+
+// Averages a 2x2 block of each output pixel, from two decoded rows of the previous level
+static void DownsampleRow(const uint16_t* row0, const uint16_t* row1, unsigned int sourceWidth,
+	unsigned char* destination, unsigned int width, const uint8_t* const encode[4])
+{
+	if(sourceWidth == 1)
+	{
+		for(int c = 0; c < 4; c++)
+		{
+			destination[c] = encode[c][(row0[c] + row1[c] + 1) >> 1];
+		}
+		return;
+	}
+
+	// Output pixel 'x' always covers source pixels '2x' & '2x + 1', a dropped odd column lies past them
+	for(unsigned int x = 0; x < width; x++)
+	{
+		const uint16_t* top = &row0[x * 8];
+		const uint16_t* bottom = &row1[x * 8];
+		uint16_t average[8];
+
+#ifdef TEXTURE_PROCESSING_SSE2
+		__m128i vertical = _mm_avg_epu16(_mm_loadu_si128((const __m128i*)top), _mm_loadu_si128((const __m128i*)bottom));
+		__m128i horizontal = _mm_avg_epu16(vertical, _mm_srli_si128(vertical, 8));
+		_mm_storeu_si128((__m128i*)average, horizontal);
+#else
+		for(int c = 0; c < 4; c++)
+		{
+			average[c] = uint16_t((top[c] + top[c + 4] + bottom[c] + bottom[c + 4] + 2) >> 2);
+		}
+#endif
+
+		unsigned char* pixel = &destination[x * 4];
+		pixel[0] = encode[0][average[0]];
+		pixel[1] = encode[1][average[1]];
+		pixel[2] = encode[2][average[2]];
+		pixel[3] = encode[3][average[3]];
+	}
+}
+
+unsigned int GetMipLevelCount(unsigned int width, unsigned int height)
+{
+	unsigned int count = 1;
+	unsigned int size = std::max(width, height);
+
+	while(size > 1)
+	{
+		size >>= 1;
+		count++;
+	}
+
+	return count;
+}
+
+void GenerateMipChain(const unsigned char* data, unsigned int width, unsigned int height, MipGeneration generation,
+	std::vector<unsigned char>& mipChain, std::vector<MipLevel>& levels)
+{
+	// 1. Lay out all levels, so they can be written in place //
+	unsigned int levelCount = generation == MipGeneration::None ? 1 : GetMipLevelCount(width, height);
+	levels.resize(levelCount);
+
+	size_t chainSize = 0;
+	for(unsigned int i = 0; i < levelCount; i++)
+	{
+		levels[i].width = std::max(width >> i, 1u);
+		levels[i].height = std::max(height >> i, 1u);
+		levels[i].offset = chainSize;
+		chainSize += size_t(levels[i].width) * levels[i].height * 4;
+	}
+
+	mipChain.resize(chainSize);
+	memcpy(mipChain.data(), data, size_t(width) * height * 4);
+
+	if(levelCount == 1)
+	{
+		return;
+	}
+
+	const MipConversionTables& tables = GetConversionTables();
+	bool isSRGB = generation == MipGeneration::SRGB;
+	const uint16_t* colorDecode = isSRGB ? tables.srgbToLinear : tables.unormToLinear;
+	const uint8_t* colorEncode = isSRGB ? tables.linearToSRGB : tables.linearToUnorm;
+
+	const uint16_t* const decode[4] = { colorDecode, colorDecode, colorDecode, tables.unormToLinear };
+	const uint8_t* const encode[4] = { colorEncode, colorEncode, colorEncode, tables.linearToUnorm };
+
+	// 2. Every level is filtered from the previous one, in parallel over blocks of rows //
+	const unsigned int pixelsPerBlock = 64 * 1024;
+
+	for(unsigned int i = 1; i < levelCount; i++)
+	{
+		const MipLevel& source = levels[i - 1];
+		const MipLevel& level = levels[i];
+		const unsigned char* sourceData = &mipChain[source.offset];
+		unsigned char* levelData = &mipChain[level.offset];
+
+		unsigned int rowsPerBlock = std::max(pixelsPerBlock / level.width, 1u);
+		unsigned int blockCount = (level.height + rowsPerBlock - 1) / rowsPerBlock;
+
+		ThreadPool::GetGlobalPool().ParallelFor(blockCount, [&](unsigned int block)
+		{
+			std::vector<uint16_t> row0(size_t(source.width) * 4);
+			std::vector<uint16_t> row1(size_t(source.width) * 4);
+			size_t sourcePitch = size_t(source.width) * 4;
+
+			unsigned int firstRow = block * rowsPerBlock;
+			unsigned int lastRow = std::min(firstRow + rowsPerBlock, level.height);
+
+			for(unsigned int y = firstRow; y < lastRow; y++)
+			{
+				unsigned int sourceY0 = y * 2;
+				unsigned int sourceY1 = std::min(sourceY0 + 1, source.height - 1);
+
+				DecodeRow(&sourceData[sourceY0 * sourcePitch], row0.data(), source.width, decode);
+				DecodeRow(&sourceData[sourceY1 * sourcePitch], row1.data(), source.width, decode);
+
+				DownsampleRow(row0.data(), row1.data(), source.width,
+					&levelData[size_t(y) * level.width * 4], level.width, encode);
+			}
+		});
+	}
+}
+
+#pragma region HDR
+// Largest values the formats can hold, RGB9E5 has no sign //
+static const float maxHalfValue = 65504.0f;
+static const float maxSharedExponentValue = 65408.0f;
+
+// Round to nearest even, with the denormals rounded by the FPU through adding a 'magic' 0.5 //
+static const uint32_t halfDenormalMagic = 126u << 23;
+static const uint32_t halfNormalMinimum = 113u << 23;
+
+static uint16_t FloatToHalf(float value)
+{
+	value = value == value ? std::min(std::max(value, -maxHalfValue), maxHalfValue) : 0.0f;
+
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(float));
+
+	uint32_t sign = (bits >> 16) & 0x8000;
+	bits &= 0x7FFFFFFF;
+
+	if(bits < halfNormalMinimum)
+	{
+		float magic;
+		memcpy(&magic, &halfDenormalMagic, sizeof(float));
+
+		float denormal;
+		memcpy(&denormal, &bits, sizeof(float));
+		denormal += magic;
+
+		memcpy(&bits, &denormal, sizeof(float));
+		return uint16_t(sign | (bits - halfDenormalMagic));
+	}
+
+	// Rebias the exponent from 127 to 15, a carry out of the mantissa correctly increments it //
+	uint32_t mantissaOdd = (bits >> 13) & 1;
+	bits = bits - (112u << 23) + 0xFFF + mantissaOdd;
+	return uint16_t(sign | (bits >> 13));
+}
+
+// Shared exponent encoding, as described by the D3D spec (and EXT_texture_shared_exponent) //
+static uint32_t FloatToRGB9E5(const float* pixel)
+{
+	float rgb[3];
+	for(int c = 0; c < 3; c++)
+	{
+		rgb[c] = pixel[c] > 0.0f ? std::min(pixel[c], maxSharedExponentValue) : 0.0f;
+	}
+
+	// The exponent of the largest channel, biased by 15, lets it keep all 9 bits //
+	float maxChannel = std::max(std::max(rgb[0], rgb[1]), rgb[2]);
+
+	uint32_t bits;
+	memcpy(&bits, &maxChannel, sizeof(float));
+	uint32_t exponent = std::max(bits >> 23, 111u) - 111;
+
+	// Scale is 2^(24 - exponent), which maps the largest channel to [256, 512) //
+	uint32_t scaleBits = (151 - exponent) << 23;
+	float scale;
+	memcpy(&scale, &scaleBits, sizeof(float));
+
+	if(uint32_t(maxChannel * scale + 0.5f) == 512)
+	{
+		exponent++;
+		scale *= 0.5f;
+	}
+
+	uint32_t r = uint32_t(rgb[0] * scale + 0.5f);
+	uint32_t g = uint32_t(rgb[1] * scale + 0.5f);
+	uint32_t b = uint32_t(rgb[2] * scale + 0.5f);
+	return r | (g << 9) | (b << 18) | (exponent << 27);
+}
+
+#ifdef TEXTURE_PROCESSING_SSE2
+static __m128i FloatToHalf4(__m128 value)
+{
+	value = _mm_and_ps(value, _mm_cmpord_ps(value, value));
+	value = _mm_min_ps(_mm_max_ps(value, _mm_set1_ps(-maxHalfValue)), _mm_set1_ps(maxHalfValue));
+
+	__m128i bits = _mm_castps_si128(value);
+	__m128i sign = _mm_and_si128(bits, _mm_set1_epi32(0x80000000));
+	bits = _mm_xor_si128(bits, sign);
+
+	__m128 magic = _mm_castsi128_ps(_mm_set1_epi32(halfDenormalMagic));
+	__m128i denormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(bits), magic)), _mm_castps_si128(magic));
+
+	__m128i mantissaOdd = _mm_and_si128(_mm_srli_epi32(bits, 13), _mm_set1_epi32(1));
+	__m128i normal = _mm_add_epi32(bits, _mm_set1_epi32(0xFFF - int(112u << 23)));
+	normal = _mm_srli_epi32(_mm_add_epi32(normal, mantissaOdd), 13);
+
+	__m128i isDenormal = _mm_cmplt_epi32(bits, _mm_set1_epi32(halfNormalMinimum));
+	__m128i half = _mm_or_si128(_mm_and_si128(isDenormal, denormal), _mm_andnot_si128(isDenormal, normal));
+	half = _mm_or_si128(half, _mm_srli_epi32(sign, 16));
+
+	// Sign extend, so packing with signed saturation leaves the 16 bits untouched //
+	return _mm_srai_epi32(_mm_slli_epi32(half, 16), 16);
+}
+
+static __m128i FloatToRGB9E5x4(const float* pixels)
+{
+	__m128 r = _mm_loadu_ps(&pixels[0]);
+	__m128 g = _mm_loadu_ps(&pixels[4]);
+	__m128 b = _mm_loadu_ps(&pixels[8]);
+	__m128 a = _mm_loadu_ps(&pixels[12]);
+	_MM_TRANSPOSE4_PS(r, g, b, a);
+
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 maxValue = _mm_set1_ps(maxSharedExponentValue);
+	r = _mm_min_ps(_mm_max_ps(r, zero), maxValue);
+	g = _mm_min_ps(_mm_max_ps(g, zero), maxValue);
+	b = _mm_min_ps(_mm_max_ps(b, zero), maxValue);
+
+	__m128 maxChannel = _mm_max_ps(_mm_max_ps(r, g), b);
+	__m128i biasedExponent = _mm_srli_epi32(_mm_castps_si128(maxChannel), 23);
+
+	// SSE2 has no 32-bit max, the lowest biased exponent is 111 //
+	__m128i isTiny = _mm_cmplt_epi32(biasedExponent, _mm_set1_epi32(111));
+	biasedExponent = _mm_or_si128(_mm_andnot_si128(isTiny, biasedExponent), _mm_and_si128(isTiny, _mm_set1_epi32(111)));
+	__m128i exponent = _mm_sub_epi32(biasedExponent, _mm_set1_epi32(111));
+
+	const __m128 half = _mm_set1_ps(0.5f);
+	__m128 scale = _mm_castsi128_ps(_mm_slli_epi32(_mm_sub_epi32(_mm_set1_epi32(151), exponent), 23));
+	__m128i maxMantissa = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(maxChannel, scale), half));
+
+	// Rounding up to 512 needs the next exponent, the comparison yields -1 //
+	__m128i overflow = _mm_cmpeq_epi32(maxMantissa, _mm_set1_epi32(512));
+	exponent = _mm_sub_epi32(exponent, overflow);
+	scale = _mm_castsi128_ps(_mm_slli_epi32(_mm_sub_epi32(_mm_set1_epi32(151), exponent), 23));
+
+	__m128i rm = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(r, scale), half));
+	__m128i gm = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(g, scale), half));
+	__m128i bm = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(b, scale), half));
+
+	__m128i packed = _mm_or_si128(rm, _mm_slli_epi32(gm, 9));
+	packed = _mm_or_si128(packed, _mm_slli_epi32(bm, 18));
+	return _mm_or_si128(packed, _mm_slli_epi32(exponent, 27));
+}
+#endif
+
+static void ConvertHDRBlock(const float* pixels, size_t pixelCount, HDRFormat format, unsigned char* destination)
+{
+	size_t i = 0;
+
+	if(format == HDRFormat::RGBA16F)
+	{
+		uint16_t* halfs = (uint16_t*)destination;
+
+#ifdef TEXTURE_PROCESSING_SSE2
+		for(; i + 2 <= pixelCount; i += 2)
+		{
+			__m128i first = FloatToHalf4(_mm_loadu_ps(&pixels[i * 4]));
+			__m128i second = FloatToHalf4(_mm_loadu_ps(&pixels[i * 4 + 4]));
+			_mm_storeu_si128((__m128i*)&halfs[i * 4], _mm_packs_epi32(first, second));
+		}
+#endif
+
+		for(; i < pixelCount; i++)
+		{
+			for(int c = 0; c < 4; c++)
+			{
+				halfs[i * 4 + c] = FloatToHalf(pixels[i * 4 + c]);
+			}
+		}
+	}
+	else if(format == HDRFormat::RGB9E5)
+	{
+		uint32_t* packed = (uint32_t*)destination;
+
+#ifdef TEXTURE_PROCESSING_SSE2
+		for(; i + 4 <= pixelCount; i += 4)
+		{
+			_mm_storeu_si128((__m128i*)&packed[i], FloatToRGB9E5x4(&pixels[i * 4]));
+		}
+#endif
+
+		for(; i < pixelCount; i++)
+		{
+			packed[i] = FloatToRGB9E5(&pixels[i * 4]);
+		}
+	}
+	else
+	{
+		memcpy(destination, pixels, pixelCount * sizeof(float) * 4);
+	}
+}
+
+const char* GetHDRFormatName(HDRFormat format)
+{
+	switch(format)
+	{
+	case HDRFormat::RGBA32F:
+		return "RGBA32F";
+	case HDRFormat::RGBA16F:
+		return "RGBA16F";
+	case HDRFormat::RGB9E5:
+		return "RGB9E5";
+	}
+
+	return "Unknown";
+}
+
+unsigned int GetHDRPixelSize(HDRFormat format)
+{
+	switch(format)
+	{
+	case HDRFormat::RGBA32F:
+		return 16;
+	case HDRFormat::RGBA16F:
+		return 8;
+	case HDRFormat::RGB9E5:
+		return 4;
+	}
+
+	return 16;
+}
+
+void GenerateHDRMipChain(const float* data, unsigned int width, unsigned int height, unsigned int levelCount,
+	std::vector<float>& mipChain, std::vector<MipLevel>& levels)
+{
+	// 1. Lay out all levels, so they can be written in place //
+	levelCount = std::min(std::max(levelCount, 1u), GetMipLevelCount(width, height));
+	levels.resize(levelCount);
+
+	size_t chainSize = 0;
+	for(unsigned int i = 0; i < levelCount; i++)
+	{
+		levels[i].width = std::max(width >> i, 1u);
+		levels[i].height = std::max(height >> i, 1u);
+		levels[i].offset = chainSize;
+		chainSize += size_t(levels[i].width) * levels[i].height * 4 * sizeof(float);
+	}
+
+	mipChain.resize(chainSize / sizeof(float));
+	memcpy(mipChain.data(), data, size_t(width) * height * 4 * sizeof(float));
+
+	// 2. Every level is filtered from the previous one, in parallel over rows //
+	for(unsigned int i = 1; i < levelCount; i++)
+	{
+		const MipLevel& source = levels[i - 1];
+		const MipLevel& level = levels[i];
+		const float* sourceData = &mipChain[source.offset / sizeof(float)];
+		float* levelData = &mipChain[level.offset / sizeof(float)];
+
+		ThreadPool::GetGlobalPool().ParallelFor(level.height, [&](unsigned int y)
+		{
+			const float* row0 = &sourceData[size_t(y * 2) * source.width * 4];
+			const float* row1 = &sourceData[size_t(std::min(y * 2 + 1, source.height - 1)) * source.width * 4];
+
+			for(unsigned int x = 0; x < level.width; x++)
+			{
+				unsigned int x0 = x * 2 * 4;
+				unsigned int x1 = std::min(x * 2 + 1, source.width - 1) * 4;
+				float* pixel = &levelData[(size_t(y) * level.width + x) * 4];
+
+#ifdef TEXTURE_PROCESSING_SSE2
+				__m128 sum = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(&row0[x0]), _mm_loadu_ps(&row0[x1])),
+					_mm_add_ps(_mm_loadu_ps(&row1[x0]), _mm_loadu_ps(&row1[x1])));
+				_mm_storeu_ps(pixel, _mm_mul_ps(sum, _mm_set1_ps(0.25f)));
+#else
+				for(int c = 0; c < 4; c++)
+				{
+					pixel[c] = (row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c]) * 0.25f;
+				}
+#endif
+			}
+		}, 16);
+	}
+}
+
+void ConvertHDRPixels(const float* pixels, size_t pixelCount, HDRFormat format, void* destination)
+{
+	const size_t pixelsPerBlock = 64 * 1024;
+	unsigned int blockCount = (unsigned int)((pixelCount + pixelsPerBlock - 1) / pixelsPerBlock);
+	unsigned int pixelSize = GetHDRPixelSize(format);
+
+	ThreadPool::GetGlobalPool().ParallelFor(blockCount, [&](unsigned int block)
+	{
+		size_t first = size_t(block) * pixelsPerBlock;
+		size_t count = std::min(pixelsPerBlock, pixelCount - first);
+		ConvertHDRBlock(&pixels[first * 4], count, format, &((unsigned char*)destination)[first * pixelSize]);
+	});
+}
+#pragma endregion
\ No newline at end of file
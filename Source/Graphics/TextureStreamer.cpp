@@ -0,0 +1,158 @@
+#include "Graphics/TextureStreamer.h"
+#include "Graphics/Texture.h"
+#include "Graphics/CookedTexture.h"
+#include "Graphics/DXAccess.h"
+#include "Graphics/DXCommands.h"
+#include "Utilities/Logger.h"
+
+#include <cstdint>
+
+// Finished textures get swapped in together, every swap has to wait for the frames in flight to finish
+static const unsigned int swapBatchSize = 16;
+static const std::chrono::milliseconds maxSwapDelay(250);
+
+TaskGroup TextureStreamer::streamingTasks;
+std::mutex TextureStreamer::finishedLock;
+std::vector<TextureStreamer::StreamRequest> TextureStreamer::finishedRequests;
+std::atomic<unsigned int> TextureStreamer::pendingCount{ 0 };
+std::chrono::high_resolution_clock::time_point TextureStreamer::streamStart;
+std::unordered_set<Texture*> TextureStreamer::streamingTextures;
+std::unordered_set<Texture*> TextureStreamer::deletedTextures;
+
+Texture* TextureStreamer::StreamTexture(const std::string& imagePath, TextureCompression compression,
+	MipGeneration mipGeneration, Texture* placeholder)
+{
+	Texture* texture = new Texture(*placeholder);
+	Submit(texture, [imagePath, compression, mipGeneration]()
+	{
+		return new CookedTexture(imagePath, compression, mipGeneration);
+	});
+
+	return texture;
+}
+
+Texture* TextureStreamer::StreamTexture(const unsigned char* pixels, int width, int height, TextureCompression compression,
+	MipGeneration mipGeneration, Texture* placeholder)
+{
+	std::vector<unsigned char> pixelData(pixels, pixels + size_t(width) * height * 4);
+
+	Texture* texture = new Texture(*placeholder);
+	Submit(texture, [pixelData = std::move(pixelData), width, height, compression, mipGeneration]()
+	{
+		return new CookedTexture(pixelData.data(), width, height, compression, mipGeneration);
+	});
+
+	return texture;
+}
+
+bool TextureStreamer::Update(size_t uploadBudget)
+{
+	// 1. Take the finished textures that fit in this frame's budget //
+	std::vector<StreamRequest> requests;
+	{
+		std::lock_guard<std::mutex> lock(finishedLock);
+
+		if(finishedRequests.empty())
+		{
+			return false;
+		}
+
+		bool isBatchReady = finishedRequests.size() >= swapBatchSize || finishedRequests.size() == pendingCount ||
+			std::chrono::high_resolution_clock::now() - finishedRequests.front().finishTime >= maxSwapDelay;
+
+		if(!isBatchReady)
+		{
+			return false;
+		}
+
+		size_t uploadSize = 0;
+		unsigned int requestCount = 0;
+		while(requestCount < finishedRequests.size() && (requestCount == 0 || uploadSize < uploadBudget))
+		{
+			uploadSize += finishedRequests[requestCount].cookedTexture->GetDataSize();
+			requestCount++;
+		}
+
+		requests.assign(finishedRequests.begin(), finishedRequests.begin() + requestCount);
+		finishedRequests.erase(finishedRequests.begin(), finishedRequests.begin() + requestCount);
+	}
+
+	if(requests.empty())
+	{
+		return false;
+	}
+
+	// 2. Frames in flight might still read the descriptors that get rewritten, one flush covers the whole batch //
+	DXAccess::GetCommands(D3D12_COMMAND_LIST_TYPE_DIRECT)->Flush();
+
+	for(StreamRequest& request : requests)
+	{
+		streamingTextures.erase(request.texture);
+
+		// Textures that got released while streaming are no longer used, and
+		// textures that failed to cook keep showing their placeholder //
+		if(deletedTextures.erase(request.texture) > 0)
+		{
+			delete request.texture;
+		}
+		else if(request.cookedTexture->IsValid())
+		{
+			request.texture->Refine(*request.cookedTexture);
+		}
+
+		delete request.cookedTexture;
+		pendingCount--;
+	}
+
+	if(pendingCount == 0)
+	{
+		auto streamEnd = std::chrono::high_resolution_clock::now();
+		float streamTime = std::chrono::duration<float, std::milli>(streamEnd - streamStart).count();
+		LOG("Finished streaming textures in " + std::to_string(streamTime) + "ms");
+	}
+
+	return true;
+}
+
+void TextureStreamer::Flush()
+{
+	while(pendingCount > 0)
+	{
+		ThreadPool::GetGlobalPool().Wait(streamingTasks);
+		Update(SIZE_MAX);
+	}
+}
+
+void TextureStreamer::DeleteTexture(Texture* texture)
+{
+	if(streamingTextures.count(texture) > 0)
+	{
+		deletedTextures.insert(texture);
+		return;
+	}
+
+	delete texture;
+}
+
+unsigned int TextureStreamer::GetPendingCount()
+{
+	return pendingCount;
+}
+
+void TextureStreamer::Submit(Texture* texture, std::function<CookedTexture*()> cook)
+{
+	if(pendingCount++ == 0)
+	{
+		streamStart = std::chrono::high_resolution_clock::now();
+	}
+
+	streamingTextures.insert(texture);
+
+	ThreadPool::GetGlobalPool().Submit(streamingTasks, [texture, cook]()
+	{
+		CookedTexture* cookedTexture = cook();
+
+		std::lock_guard<std::mutex> lock(finishedLock);
+		finishedRequests.push_back({ texture, cookedTexture, std::chrono::high_resolution_clock::now() });
+	});
+}
\ No newline at end of file
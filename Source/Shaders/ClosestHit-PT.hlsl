@@ -4,15 +4,20 @@ struct Vertex
 {
     float3 position;
     float3 normal;
-    float3 tangent;
+    float4 tangent; // 'w' holds the sign of the bitangent
     float2 texCoord0;
 };
-StructuredBuffer<Vertex> VertexData : register(t0);
-StructuredBuffer<int> indices : register(t1);
+
+// Both buffers are read raw, since their layout depends on 'GeometryInfo'
+ByteAddressBuffer VertexData : register(t0);
+ByteAddressBuffer IndexData : register(t1);
 RaytracingAccelerationStructure SceneBVH : register(t2);
 Texture2D<float4> diffuseTexture : register(t3);
 Texture2D<float4> normalTexture : register(t4);
 Texture2D<float4> ormTexture : register(t5);
+Texture2D<float4> environmentMap : register(t6);
+StructuredBuffer<float> environmentDistribution : register(t7);
+SamplerState textureSampler : register(s0);
 
 struct Material
 {
@@ -27,17 +32,133 @@ struct Material
 };
 ConstantBuffer<Material> material : register(b0);
 
+struct GeometryInfo
+{
+    row_major float3x4 positionTransform;
+    bool isPacked;
+    bool hasShortIndices;
+};
+ConstantBuffer<GeometryInfo> geometryInfo : register(b1);
+
+// REGION - Vertex Decoding //
+// Mirrors 'UnpackVertex' in MeshProcessing.cpp
+float2 DecodeSnorm16x2(uint packed)
+{
+    int2 values = int2(int(packed << 16) >> 16, int(packed) >> 16);
+    return max(float2(values) / 32767.0f, -1.0f);
+}
+
+float3 OctahedralDecode(float2 encoded)
+{
+    float3 direction = float3(encoded.x, encoded.y, 1.0f - abs(encoded.x) - abs(encoded.y));
+    float fold = saturate(-direction.z);
+    direction.x += direction.x >= 0.0f ? -fold : fold;
+    direction.y += direction.y >= 0.0f ? -fold : fold;
+    return normalize(direction);
+}
+
+uint3 LoadTriangleIndices(uint primitiveIndex)
+{
+    if(geometryInfo.hasShortIndices)
+    {
+        // Three 16-bit indices, starting at either a 4-byte boundary or halfway one
+        uint address = primitiveIndex * 6;
+        uint alignedAddress = address & ~3;
+        uint2 words = IndexData.Load2(alignedAddress);
+
+        if(address == alignedAddress)
+        {
+            return uint3(words.x & 0xFFFF, words.x >> 16, words.y & 0xFFFF);
+        }
+        
+        return uint3(words.x >> 16, words.y & 0xFFFF, words.y >> 16);
+    }
+
+    return IndexData.Load3(primitiveIndex * 12);
+}
+
+Vertex LoadVertex(uint index)
+{
+    Vertex vertex;
+
+    if(geometryInfo.isPacked)
+    {
+        // 20 bytes: position (4x snorm16), normal & tangent (2x snorm16 octahedral), uv (2x half)
+        uint2 position = VertexData.Load2(index * 20);
+        uint3 attributes = VertexData.Load3(index * 20 + 8);
+
+        float2 xy = DecodeSnorm16x2(position.x);
+        float2 zw = DecodeSnorm16x2(position.y);
+        vertex.position = mul(geometryInfo.positionTransform, float4(xy, zw.x, 1.0f));
+
+        vertex.normal = OctahedralDecode(DecodeSnorm16x2(attributes.x));
+        vertex.tangent = float4(OctahedralDecode(DecodeSnorm16x2(attributes.y)), zw.y < 0.0f ? -1.0f : 1.0f);
+        vertex.texCoord0 = f16tof32(uint2(attributes.z & 0xFFFF, attributes.z >> 16));
+        return vertex;
+    }
+
+    // 48 bytes: the full precision layout of 'Vertex'
+    uint address = index * 48;
+    vertex.position = asfloat(VertexData.Load3(address));
+    vertex.normal = asfloat(VertexData.Load3(address + 12));
+    vertex.tangent = asfloat(VertexData.Load4(address + 24));
+    vertex.texCoord0 = asfloat(VertexData.Load2(address + 40));
+    return vertex;
+}
+
+// Next event estimation, a shadow ray goes towards a point on the environment map picked by its brightness
+float3 SampleEnvironmentLight(float3 position, float3 normal, float3 BRDF, inout PathSampler pathSampler)
+{
+    uint width;
+    uint height;
+    environmentMap.GetDimensions(width, height);
+    
+    float lightPdf;
+    float3 direction = SampleEnvironment(environmentDistribution, width, height, pathSampler, lightPdf);
+    
+    float cosI = dot(normal, direction);
+    if(cosI <= 0.0f || lightPdf <= 0.0f)
+    {
+        return float3(0.0f, 0.0f, 0.0f);
+    }
+    
+    RayDesc ray;
+    ray.Origin = position;
+    ray.Direction = direction;
+    ray.TMin = 0.001f;
+    ray.TMax = 100000;
+    
+    // Only 'Miss' runs, it fills in the radiance of the environment when nothing blocks the ray //
+    HitInfo shadowLoad;
+    shadowLoad.color = float3(0.0f, 0.0f, 0.0f);
+    shadowLoad.pathSampler = pathSampler;
+    shadowLoad.depth = 0;
+    shadowLoad.bsdfPdf = 0.0f;
+    shadowLoad.isIterative = false;
+    
+    TraceRay(SceneBVH, RAY_FLAG_ACCEPT_FIRST_HIT_AND_END_SEARCH | RAY_FLAG_SKIP_CLOSEST_HIT_SHADER, 
+        0xFF, 0, 0, 0, ray, shadowLoad);
+    
+    // The cosine weighted sampling of the diffuse BSDF could've picked this direction as well //
+    float weight = PowerHeuristic(lightPdf, cosI / PI);
+    return shadowLoad.color * BRDF * cosI * weight / lightPdf;
+}
+
 float3 ComputeConductorRadiance(float3 albedo, float3 normal, float roughness, in HitInfo payload)
 {
     float3 radiance = 0.0f;
     
     float3 intersection = WorldRayOrigin() + WorldRayDirection() * RayTCurrent();
     float3 direction = reflect(WorldRayDirection(), normal);
+    float weight = 1.0f;
     
     if(roughness > 0.0f)
     {
-        float3 offset = RandomUnitVector(payload.seed) * roughness;
-        direction = normalize(direction + offset);
+        direction = SampleGGXReflection(WorldRayDirection(), normal, roughness, payload.pathSampler, weight);
+        if(weight <= 0.0f)
+        {
+            return radiance;
+        }
     }
         
     RayDesc ray;
@@ -47,11 +168,14 @@ float3 ComputeConductorRadiance(float3 albedo, float3 normal, float roughness, i
     ray.TMax = 100000;
         
     HitInfo reflectLoad;
-    reflectLoad.seed = payload.seed;
+    reflectLoad.pathSampler = payload.pathSampler;
     reflectLoad.depth = payload.depth;
+    reflectLoad.bsdfPdf = 0.0f;
+    reflectLoad.isIterative = false;
+    reflectLoad.rayCone = ScatterRayCone(payload.rayCone, roughness);
         
     TraceRay(SceneBVH, RAY_FLAG_NONE, 0xFF, 0, 0, 0, ray, reflectLoad);
-    radiance += reflectLoad.color * albedo;
+    radiance += reflectLoad.color * albedo * weight;
     
     return radiance;
 }
@@ -75,8 +199,11 @@ float3 ComputeTransmissionRadiance(float3 albedo, float3 normal, in HitInfo payl
         ray.TMax = 100000;
         
         HitInfo reflectLoad;
-        reflectLoad.seed = payload.seed;
+        reflectLoad.pathSampler = payload.pathSampler;
         reflectLoad.depth = payload.depth;
+        reflectLoad.bsdfPdf = 0.0f;
+        reflectLoad.isIterative = false;
+        reflectLoad.rayCone = payload.rayCone;
         
         TraceRay(SceneBVH, RAY_FLAG_NONE, 0xFF, 0, 0, 0, ray, reflectLoad);
         radiance += reflectLoad.color * albedo * reflectance;
@@ -93,8 +220,11 @@ float3 ComputeTransmissionRadiance(float3 albedo, float3 normal, in HitInfo payl
         ray.TMax = 100000;
         
         HitInfo refractLoad;
-        refractLoad.seed = payload.seed;
+        refractLoad.pathSampler = payload.pathSampler;
         refractLoad.depth = payload.depth;
+        refractLoad.bsdfPdf = 0.0f;
+        refractLoad.isIterative = false;
+        refractLoad.rayCone = payload.rayCone;
         
         TraceRay(SceneBVH, RAY_FLAG_NONE, 0xFF, 0, 0, 0, ray, refractLoad);
         radiance += refractLoad.color * albedo * transmittance;
@@ -119,14 +249,9 @@ float3 ComputeDielectricRadiance(float3 albedo, float3 normal, float roughness,
     if (diffuseFactor > 0.01)
     {
         float3 BRDF = albedo / PI;
+        radiance += SampleEnvironmentLight(intersection, normal, BRDF, payload.pathSampler) * diffuseFactor;
     
-        float3 direction = RandomUnitVector(payload.seed);
-        if (dot(normal, direction) < 0.0f)
-        {
-            // Normal is facing inwards //
-            direction *= -1.0f;
-        }
-    
+        float3 direction = CosineHemisphereDirection(payload.pathSampler, normal);
         float cosI = saturate(dot(normal, direction));
     
         RayDesc ray;
@@ -136,38 +261,45 @@ float3 ComputeDielectricRadiance(float3 albedo, float3 normal, float roughness,
         ray.TMax = 100000;
     
         HitInfo diffuseLoad;
-        diffuseLoad.seed = payload.seed;
+        diffuseLoad.pathSampler = payload.pathSampler;
         diffuseLoad.depth = payload.depth;
+        diffuseLoad.bsdfPdf = cosI / PI;
+        diffuseLoad.isIterative = false;
+        diffuseLoad.rayCone = ScatterRayCone(payload.rayCone, 1.0f);
         
+        // The PDF of cosine weighted sampling cancels the BRDF & cosine, only the albedo is left //
         TraceRay(SceneBVH, RAY_FLAG_NONE, 0xFF, 0, 0, 0, ray, diffuseLoad);
-        float3 irradiance = diffuseLoad.color * cosI;
-    
-        float3 diffuse = (PI * 2.0f * BRDF * irradiance) * diffuseFactor;
-        radiance += diffuse;
+        radiance += diffuseLoad.color * albedo * diffuseFactor;
     }
     
     if(specularFactor > 0.01)
     {
         float3 direction = reflect(WorldRayDirection(), normal);
+        float weight = 1.0f;
         
         if(roughness > 0.0f)
         {
-            float3 offset = RandomUnitVector(payload.seed) * roughness;
-            direction = normalize(direction + offset);
+            direction = SampleGGXReflection(WorldRayDirection(), normal, roughness, payload.pathSampler, weight);
         }
         
-        RayDesc ray;
-        ray.Origin = intersection;
-        ray.Direction = direction;
-        ray.TMin = 0.001f;
-        ray.TMax = 100000;
-        
-        HitInfo reflectLoad;
-        reflectLoad.seed = payload.seed;
-        reflectLoad.depth = payload.depth;
-        
-        TraceRay(SceneBVH, RAY_FLAG_NONE, 0xFF, 0, 0, 0, ray, reflectLoad);
-        radiance += reflectLoad.color * albedo * specularFactor;
+        if(weight > 0.0f)
+        {
+            RayDesc ray;
+            ray.Origin = intersection;
+            ray.Direction = direction;
+            ray.TMin = 0.001f;
+            ray.TMax = 100000;
+            
+            HitInfo reflectLoad;
+            reflectLoad.pathSampler = payload.pathSampler;
+            reflectLoad.depth = payload.depth;
+            reflectLoad.bsdfPdf = 0.0f;
+            reflectLoad.isIterative = false;
+            reflectLoad.rayCone = ScatterRayCone(payload.rayCone, roughness);
+            
+            TraceRay(SceneBVH, RAY_FLAG_NONE, 0xFF, 0, 0, 0, ray, reflectLoad);
+            radiance += reflectLoad.color * albedo * specularFactor * weight;
+        }
     }
     
     return radiance;
@@ -177,16 +309,11 @@ float3 ComputePureDiffuse(float3 albedo, float3 normal, in HitInfo payload)
 {
     float3 radiance;
     float3 BRDF = albedo / PI;
+    float3 intersection = WorldRayOrigin() + WorldRayDirection() * RayTCurrent();
+    radiance = SampleEnvironmentLight(intersection, normal, BRDF, payload.pathSampler);
     
-    float3 direction = RandomUnitVector(payload.seed);
-    if(dot(normal, direction) < 0.0f)
-    {
-            // Normal is facing inwards //
-        direction *= -1.0f;
-    }
-    
+    float3 direction = CosineHemisphereDirection(payload.pathSampler, normal);
     float cosI = dot(normal, direction);
-    float3 intersection = WorldRayOrigin() + WorldRayDirection() * RayTCurrent();
     
     RayDesc ray;
     ray.Origin = intersection;
@@ -195,70 +322,197 @@ float3 ComputePureDiffuse(float3 albedo, float3 normal, in HitInfo payload)
     ray.TMax = 100000;
     
     HitInfo diffuseLoad;
-    diffuseLoad.seed = payload.seed;
+    diffuseLoad.pathSampler = payload.pathSampler;
     diffuseLoad.depth = payload.depth;
+    diffuseLoad.bsdfPdf = cosI / PI;
+    diffuseLoad.isIterative = false;
+    diffuseLoad.rayCone = ScatterRayCone(payload.rayCone, 1.0f);
         
+    // The PDF of cosine weighted sampling cancels the BRDF & cosine, only the albedo is left //
     TraceRay(SceneBVH, RAY_FLAG_NONE, 0xFF, 0, 0, 0, ray, diffuseLoad);
-    float3 irradiance = diffuseLoad.color * cosI;
-    
-    float3 diffuse = (PI * 2.0f * BRDF * irradiance);
-    radiance = diffuse;
+    radiance += diffuseLoad.color * albedo;
     return radiance;
 }
 
+// REGION - Iterative Integrator //
+// Instead of tracing every lobe, one gets picked and handed back to 'RayGen' as the next ray of the path.
+// Dividing by the odds of picking it keeps the estimate unbiased. Mirrors 'SampleSurface' in CPUPathTracer.cpp
+void SampleSurface(float3 albedo, float3 normal, float roughness, inout HitInfo payload)
+{
+    float3 intersection = WorldRayOrigin() + WorldRayDirection() * RayTCurrent();
+    
+    payload.color = float3(0.0f, 0.0f, 0.0f);
+    payload.throughput = float3(0.0f, 0.0f, 0.0f);
+    payload.bsdfPdf = 0.0f;
+    payload.nextOrigin = intersection;
+    payload.nextDirection = normal;
+    
+    switch(material.materialType)
+    {
+        case 0: // Pure Diffuse
+        {
+            payload.color = SampleEnvironmentLight(intersection, normal, albedo / PI, payload.pathSampler);
+            
+            payload.nextDirection = CosineHemisphereDirection(payload.pathSampler, normal);
+            payload.bsdfPdf = dot(normal, payload.nextDirection) / PI;
+            payload.throughput = albedo;
+            payload.rayCone = ScatterRayCone(payload.rayCone, 1.0f);
+            break;
+        }
+        case 1: // Dielectric
+        {
+            float fresnel = Fresnel(WorldRayDirection(), normal, material.IOR);
+            float specularFactor = clamp(material.specularity + fresnel, material.specularity, 1);
+            float diffuseFactor = 1.0 - specularFactor;
+            
+            // Lobes the ray trees skip are never picked either //
+            float diffuseWeight = diffuseFactor > 0.01 ? diffuseFactor : 0.0f;
+            float specularWeight = specularFactor > 0.01 ? specularFactor : 0.0f;
+            if(diffuseWeight + specularWeight <= 0.0f)
+            {
+                break;
+            }
+            
+            float diffuseProbability = diffuseWeight / (diffuseWeight + specularWeight);
+            if(diffuseWeight > 0.0f)
+            {
+                payload.color = SampleEnvironmentLight(intersection, normal, albedo / PI, payload.pathSampler) * diffuseFactor;
+            }
+            
+            if(Random01(payload.pathSampler) < diffuseProbability)
+            {
+                payload.nextDirection = CosineHemisphereDirection(payload.pathSampler, normal);
+                payload.bsdfPdf = saturate(dot(normal, payload.nextDirection)) / PI;
+                payload.throughput = albedo * diffuseFactor / diffuseProbability;
+                payload.rayCone = ScatterRayCone(payload.rayCone, 1.0f);
+            }
+            else
+            {
+                float weight = 1.0f;
+                payload.nextDirection = reflect(WorldRayDirection(), normal);
+                
+                if(roughness > 0.0f)
+                {
+                    payload.nextDirection = SampleGGXReflection(WorldRayDirection(), normal, roughness, payload.pathSampler, weight);
+                }
+                
+                payload.throughput = albedo * specularFactor * weight / (1.0f - diffuseProbability);
+                payload.rayCone = ScatterRayCone(payload.rayCone, roughness);
+            }
+            break;
+        }
+        case 2: // Conductor
+        {
+            float weight = 1.0f;
+            payload.nextDirection = reflect(WorldRayDirection(), normal);
+            
+            if(roughness > 0.0f)
+            {
+                payload.nextDirection = SampleGGXReflection(WorldRayDirection(), normal, roughness, payload.pathSampler, weight);
+            }
+            
+            payload.throughput = albedo * weight;
+            payload.rayCone = ScatterRayCone(payload.rayCone, roughness);
+            break;
+        }
+        case 3: // Transmissive (Glass)
+        {
+            float reflectance = Fresnel(WorldRayDirection(), normal, material.IOR);
+            if(reflectance >= 1.0f || Random01(payload.pathSampler) < reflectance)
+            {
+                payload.nextDirection = reflect(WorldRayDirection(), normal);
+            }
+            else
+            {
+                // Refracted rays start further along, the same as a 'TMin' of 0.01 //
+                payload.nextDirection = refract2(WorldRayDirection(), normal, material.IOR);
+                payload.nextOrigin = intersection + payload.nextDirection * 0.009f;
+            }
+            
+            payload.throughput = albedo;
+            break;
+        }
+        case 4: // Emissive
+            payload.color = albedo;
+            break;
+    }
+}
+
 [shader("closesthit")]
 void ClosestHit(inout HitInfo payload, Attributes attrib)
 {
-    // Handle ray-tree depth //
-    payload.depth += 1;
-    const uint maxDepth = 6;
-
-    if (payload.depth >= maxDepth)
+    // Handle ray-tree depth, the iterative integrator limits its paths in 'RayGen' //
+    if(!payload.isIterative)
     {
-        payload.color = float3(0.0f, 0.0f, 0.0f);
-        return;
+        payload.depth += 1;
+        const uint maxDepth = 6;
+        
+        if (payload.depth >= maxDepth)
+        {
+            payload.color = float3(0.0f, 0.0f, 0.0f);
+            return;
+        }
     }
     
     // Vertex Data //
-    uint vertID = PrimitiveIndex() * 3;
-    Vertex a = VertexData[indices[vertID]];
-    Vertex b = VertexData[indices[vertID + 1]];
-    Vertex c = VertexData[indices[vertID + 2]];
+    uint3 triangleIndices = LoadTriangleIndices(PrimitiveIndex());
+    Vertex a = LoadVertex(triangleIndices.x);
+    Vertex b = LoadVertex(triangleIndices.y);
+    Vertex c = LoadVertex(triangleIndices.z);
     
     float3 baryCoords = float3(1.0f - attrib.bary.x - attrib.bary.y, attrib.bary.x, attrib.bary.y);
     
     float3 normal = a.normal * baryCoords.x + b.normal * baryCoords.y + c.normal * baryCoords.z;
-    float3 tangent = a.tangent * baryCoords.x + b.tangent * baryCoords.y + c.tangent * baryCoords.z;
-    float2 uv = frac((a.texCoord0 * baryCoords.x) + (b.texCoord0 * baryCoords.y) + (c.texCoord0 * baryCoords.z));
+    float3 tangent = a.tangent.xyz * baryCoords.x + b.tangent.xyz * baryCoords.y + c.tangent.xyz * baryCoords.z;
+    float bitangentSign = a.tangent.w;
+    float2 uv = (a.texCoord0 * baryCoords.x) + (b.texCoord0 * baryCoords.y) + (c.texCoord0 * baryCoords.z);
     
     normal = normalize(mul(ObjectToWorld3x4(), float4(normal, 0.0f)).xyz);
     tangent = normalize(mul(ObjectToWorld3x4(), float4(tangent, 0.0f)).xyz);
     
-    // Texture 
-    int width;
-    int height;
-    diffuseTexture.GetDimensions(width, height);
-    uint2 textureSampleLocation = uint2(uv.x * width, uv.y * height);
+    // Texture LOD, from the footprint the path has at this hit. The rays spawned here start from it //
+    payload.rayCone = PropagateRayCone(payload.rayCone, RayTCurrent());
+    float rayConeLOD = ComputeRayConeLOD(mul(ObjectToWorld3x4(), float4(a.position, 1.0f)), 
+        mul(ObjectToWorld3x4(), float4(b.position, 1.0f)), mul(ObjectToWorld3x4(), float4(c.position, 1.0f)), 
+        a.texCoord0, b.texCoord0, c.texCoord0, WorldRayDirection(), payload.rayCone.width);
+    
+    float width;
+    float height;
     
     float3 albedo = material.color;
     if (material.hasDiffuse)
     {
-        albedo = diffuseTexture[textureSampleLocation].rgb * material.color;
+        diffuseTexture.GetDimensions(width, height);
+        albedo = diffuseTexture.SampleLevel(textureSampler, uv, GetTextureLOD(rayConeLOD, width, height)).rgb * material.color;
     }
     
     if (material.hasNormal)
     {
-        float3 biTangent = cross(normal, tangent);
+        float3 biTangent = cross(normal, tangent) * bitangentSign;
         float3x3 TBN = float3x3(tangent, biTangent, normal);
         
-        float3 n = (normalTexture[textureSampleLocation].rgb * 2.0) - float3(1.0, 1.0, 1.0);
+        // Normal maps are stored as BC5, which only keeps X & Y //
+        normalTexture.GetDimensions(width, height);
+        float2 xy = (normalTexture.SampleLevel(textureSampler, uv, GetTextureLOD(rayConeLOD, width, height)).rg * 2.0) - float2(1.0, 1.0);
+        float3 n = float3(xy, sqrt(saturate(1.0 - dot(xy, xy))));
         normal = normalize(mul(n, TBN));
     }
     
     float roughness = material.roughness;
     if(material.hasORM)
     {
-        roughness = clamp(ormTexture[textureSampleLocation].g, material.roughness, 1.0);
+        ormTexture.GetDimensions(width, height);
+        roughness = clamp(ormTexture.SampleLevel(textureSampler, uv, GetTextureLOD(rayConeLOD, width, height)).g, material.roughness, 1.0);
+    }
+    
+    payload.albedo = albedo;
+    payload.normal = normal;
+    payload.hitDistance = RayTCurrent();
+    
+    if(payload.isIterative)
+    {
+        SampleSurface(albedo, normal, roughness, payload);
+        return;
     }
     
     // Calculate Radiance //
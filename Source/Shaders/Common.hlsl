@@ -1,9 +1,41 @@
 // REGION - Buffers & Materials //
+// Mirrors 'PathSampler' in CPUCommon.h. Every call to 'Random01' or 'Random2D' draws the next dimension of the sample
+struct PathSampler
+{
+    uint type; // 'SAMPLER_' below
+    uint seed; // Scrambles the sequence, or the state of XorShift32 for 'SAMPLER_RANDOM'
+    uint index; // Sample of the pixel, starting at 0
+    uint dimension;
+    uint pixel; // x | (y << 16)
+};
+
+// Mirrors 'RayCone' in CPUCommon.h. The footprint of a pixel, carried along the whole path
+struct RayCone
+{
+    float width; // At the origin of the ray
+    float spreadAngle; // Growth of the width per unit of distance
+};
+
 struct HitInfo
 {
     float3 color;
     float depth;
-    uint seed;
+    PathSampler pathSampler;
+    float bsdfPdf; // PDF of the BSDF sample that spawned the ray, 0 when the environment isn't sampled as a light for it
+    
+    // Iterative integrator, the hit shader hands the next ray of the path back to 'RayGen' instead of tracing it //
+    bool isIterative;
+    float3 throughput; // Weight of the next ray, 0 ends the path
+    float3 nextOrigin;
+    float3 nextDirection;
+    
+    // Surface that got hit, 'RayGen' keeps the first one as a guide for the denoiser //
+    float3 albedo;
+    float3 normal;
+    float hitDistance;
+    
+    // Cone of the ray that got traced, the hit shader replaces it with the cone of the next ray //
+    RayCone rayCone;
 };
 
 // Attributes output by the raytracing when hitting a surface,
@@ -14,29 +46,261 @@ struct Attributes
 };
 static float PI = 3.14159265;
 
-// REGION - Randomness //
-float Random01(inout uint seed)
+// REGION - Sampling //
+// Mirrors CPUCommon.h, the types match 'SamplerType' in Sampler.h
+static const uint SAMPLER_RANDOM = 0;
+static const uint SAMPLER_SOBOL = 1;
+static const uint SAMPLER_BLUE_NOISE = 2;
+
+// Ranks of the blue-noise mask from 'GetBlueNoiseRanks', tiled over the screen //
+StructuredBuffer<uint> blueNoiseRanks : register(t8);
+static const uint blueNoiseSize = 64;
+
+// The camera draws dimension 0, every bounce of a path starts at its own dimension after it. 
+// Keeps the dimensions of the samples lined up, even when some draw more numbers than others.
+static const uint dimensionsPerBounce = 8;
+
+uint HashUInt(uint x)
+{
+    // 'lowbias32' by Chris Wellons
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+// Every bit gets flipped depending on the bits below it
+uint LaineKarrasPermutation(uint x, uint seed)
+{
+    x += seed;
+    x ^= x * 0x6c50b47cu;
+    x ^= x * 0xb82f1e52u;
+    x ^= x * 0xc7afe638u;
+    x ^= x * 0x8d22f6e6u;
+    return x;
+}
+
+// Owen scrambling through hashing (Burley 2020), every bit gets flipped depending on the bits above it
+uint NestedUniformScramble(uint x, uint seed)
+{
+    return reversebits(LaineKarrasPermutation(reversebits(x), seed));
+}
+
+// Second dimension of Sobol, the first is the van der Corput sequence: 'reversebits(index)'
+uint SobolSecondDimension(uint index)
+{
+    uint result = 0;
+    for(uint direction = 0x80000000u; index; index >>= 1, direction ^= direction >> 1)
+    {
+        if(index & 1)
+        {
+            result ^= direction;
+        }
+    }
+    return result;
+}
+
+// 24 bits, so the result stays below 1
+float ToUnitFloat(uint x)
+{
+    return float(x >> 8) * 5.96046448e-8f;
+}
+
+// Sets up the sampler for sample 'index' of pixel (x, y). 'SAMPLER_RANDOM' seeds XorShift32 from the pixel & sample.
+// 'SAMPLER_SOBOL' scrambles per pixel, so every pixel gets its own well stratified sequence. 'SAMPLER_BLUE_NOISE' shares
+// the scramble over a tile of 'blueNoiseSize' pixels & scrambles it further by the ranks, see 'GetBlueNoiseScramble'.
+PathSampler InitializeSampler(uint type, uint2 pixel, uint width, uint index)
+{
+    PathSampler pathSampler;
+    pathSampler.type = type;
+    pathSampler.index = index;
+    pathSampler.dimension = 0;
+    pathSampler.pixel = pixel.x | (pixel.y << 16);
+    
+    if(type == SAMPLER_RANDOM)
+    {
+        pathSampler.seed = ((index + 1) * 26927) + ((pixel.x + pixel.y * width) * 78713);
+    }
+    else if(type == SAMPLER_SOBOL)
+    {
+        pathSampler.seed = HashUInt(pathSampler.pixel);
+    }
+    else
+    {
+        pathSampler.seed = HashUInt((pixel.x / blueNoiseSize) | ((pixel.y / blueNoiseSize) << 16) | 0x80008000u);
+    }
+    
+    return pathSampler;
+}
+
+void SetBounceDimension(inout PathSampler pathSampler, uint depth)
+{
+    pathSampler.dimension = 1 + depth * dimensionsPerBounce;
+}
+
+// Digital shift of a dimension, the top bits of the sample get flipped by the rank of the pixel, at an offset
+// of the dimension's own. Unlike adding it, XOR keeps the pixel's own points stratified. Neighbouring pixels
+// land in different strata instead, while the dimensions stay unrelated on screen.
+uint GetBlueNoiseScramble(PathSampler pathSampler, uint component)
+{
+    uint offset = HashUInt(pathSampler.dimension * 2 + component);
+    uint x = ((pathSampler.pixel & 0xFFFF) + offset) % blueNoiseSize;
+    uint y = ((pathSampler.pixel >> 16) + (offset >> 16)) % blueNoiseSize;
+    
+    // The ranks have 12 bits
+    return blueNoiseRanks[x + y * blueNoiseSize] << 20;
+}
+
+float Random01(inout PathSampler pathSampler)
+{
+    if(pathSampler.type == SAMPLER_RANDOM)
+    {
+        // XorShift32
+        pathSampler.seed ^= (pathSampler.seed << 13);
+        pathSampler.seed ^= (pathSampler.seed >> 17);
+        pathSampler.seed ^= (pathSampler.seed << 5);
+        return pathSampler.seed / 4294967296.0;
+    }
+    
+    // Every dimension shuffles the order of the samples & scrambles them with its own seed (padding).
+    // Scrambling van der Corput 'reversebits(index)' is the same as permuting the index before reversing it
+    uint dimensionSeed = HashUInt(pathSampler.seed ^ HashUInt(pathSampler.dimension));
+    uint index = NestedUniformScramble(pathSampler.index, dimensionSeed);
+    uint value = reversebits(LaineKarrasPermutation(index, HashUInt(dimensionSeed + 1)));
+    
+    if(pathSampler.type == SAMPLER_BLUE_NOISE)
+    {
+        value ^= GetBlueNoiseScramble(pathSampler, 0);
+    }
+    
+    pathSampler.dimension++;
+    return ToUnitFloat(value);
+}
+
+// Both numbers come from the same 2D Sobol points, so they're stratified together rather than each on their own
+float2 Random2D(inout PathSampler pathSampler)
+{
+    if(pathSampler.type == SAMPLER_RANDOM)
+    {
+        float u1 = Random01(pathSampler);
+        float u2 = Random01(pathSampler);
+        return float2(u1, u2);
+    }
+    
+    uint dimensionSeed = HashUInt(pathSampler.seed ^ HashUInt(pathSampler.dimension));
+    uint index = NestedUniformScramble(pathSampler.index, dimensionSeed);
+    uint x = reversebits(LaineKarrasPermutation(index, HashUInt(dimensionSeed + 1)));
+    uint y = NestedUniformScramble(SobolSecondDimension(index), HashUInt(dimensionSeed + 2));
+    
+    if(pathSampler.type == SAMPLER_BLUE_NOISE)
+    {
+        x ^= GetBlueNoiseScramble(pathSampler, 0);
+        y ^= GetBlueNoiseScramble(pathSampler, 1);
+    }
+    
+    pathSampler.dimension++;
+    return float2(ToUnitFloat(x), ToUnitFloat(y));
+}
+
+float RandomInRange(inout PathSampler pathSampler, float min, float max)
+{
+    return min + (max - min) * Random01(pathSampler);
+}
+
+// REGION - BSDF Sampling //
+// Mirrors CPUCommon.h
+// Tangent & bitangent around 'normal', without any branches or singularities (Duff et al. 2017)
+void BuildOrthonormalBasis(float3 normal, out float3 tangent, out float3 bitangent)
 {
-    // XorShift32
-    seed ^= (seed << 13);
-    seed ^= (seed >> 17);
-    seed ^= (seed << 5);
-    return seed / 4294967296.0;
+    float signZ = normal.z >= 0.0f ? 1.0f : -1.0f;
+    float a = -1.0f / (signZ + normal.z);
+    float b = normal.x * normal.y * a;
+    
+    tangent = float3(1.0f + signZ * normal.x * normal.x * a, signZ * b, -signZ * normal.x);
+    bitangent = float3(b, signZ + normal.y * normal.y * a, -normal.y);
+}
+
+// Cosine weighted over the hemisphere around 'normal', its PDF is cos(theta) / PI.
+// With a Lambertian BRDF (albedo / PI), the sample's weight is the albedo.
+float3 CosineHemisphereDirection(inout PathSampler pathSampler, float3 normal)
+{
+    float2 u = Random2D(pathSampler);
+    float r = sqrt(u.x);
+    float phi = u.y * 2.0f * PI;
+    float z = sqrt(max(1.0f - r * r, 0.0f));
+    
+    float3 tangent;
+    float3 bitangent;
+    BuildOrthonormalBasis(normal, tangent, bitangent);
+    
+    return normalize(tangent * (r * cos(phi)) + bitangent * (r * sin(phi)) + normal * z);
+}
+
+// Smith's Lambda for GGX, with 'cosTheta' the angle between a direction and the normal
+float GGXLambda(float cosTheta, float alpha)
+{
+    float cos2 = cosTheta * cosTheta;
+    float tan2 = max(1.0f - cos2, 0.0f) / max(cos2, 1e-8f);
+    return (sqrt(1.0f + alpha * alpha * tan2) - 1.0f) * 0.5f;
 }
 
-float RandomInRange(inout uint seed, float min, float max)
+// Microfacet normal from the GGX normals visible from 'view' (Heitz 2018), both in the basis of the normal
+float3 SampleGGXVNDF(float3 view, float alpha, float u1, float u2)
 {
-    return min + (max - min) * Random01(seed);
+    // 1. Stretch the view, so the distribution becomes a hemisphere //
+    float3 stretchedView = normalize(float3(alpha * view.x, alpha * view.y, view.z));
+    
+    float lengthSquared = stretchedView.x * stretchedView.x + stretchedView.y * stretchedView.y;
+    float3 T1 = lengthSquared > 0.0f ? float3(-stretchedView.y, stretchedView.x, 0.0f) / sqrt(lengthSquared) 
+        : float3(1.0f, 0.0f, 0.0f);
+    float3 T2 = cross(stretchedView, T1);
+    
+    // 2. Sample the projected area of the hemisphere, a disk with the part hidden from the view folded away //
+    float r = sqrt(u1);
+    float phi = u2 * 2.0f * PI;
+    float t1 = r * cos(phi);
+    float t2 = r * sin(phi);
+    float s = 0.5f * (1.0f + stretchedView.z);
+    t2 = (1.0f - s) * sqrt(max(1.0f - t1 * t1, 0.0f)) + s * t2;
+    
+    float3 hemisphereNormal = t1 * T1 + t2 * T2 + sqrt(max(1.0f - t1 * t1 - t2 * t2, 0.0f)) * stretchedView;
+    
+    // 3. Unstretch back into the GGX distribution //
+    return normalize(float3(alpha * hemisphereNormal.x, alpha * hemisphereNormal.y, max(hemisphereNormal.z, 0.0f)));
 }
 
-float3 RandomUnitVector(inout uint seed)
+// Reflects 'incoming' off a GGX microfacet, sampled through the normals visible to it. 'roughness' is
+// perceptual, alpha is its square. 'weight' receives BRDF * cos / PDF without the Fresnel term, 
+// which for this sampling is G2 / G1 (height correlated Smith). It's 0 when the reflection goes below the surface.
+float3 SampleGGXReflection(float3 incoming, float3 normal, float roughness, inout PathSampler pathSampler, out float weight)
 {
-    float x = RandomInRange(seed, -1.0f, 1.0f);
-    float y = RandomInRange(seed, -1.0f, 1.0f);
-    float z = RandomInRange(seed, -1.0f, 1.0f);
+    float alpha = max(roughness * roughness, 1e-4f);
+    
+    float3 tangent;
+    float3 bitangent;
+    BuildOrthonormalBasis(normal, tangent, bitangent);
+    
+    // Normal maps can turn the shading normal away from the view, which then grazes the surface //
+    float3 view = -incoming;
+    view = normalize(float3(dot(view, tangent), dot(view, bitangent), max(dot(view, normal), 1e-4f)));
+    
+    float2 u = Random2D(pathSampler);
+    float3 microfacetNormal = SampleGGXVNDF(view, alpha, u.x, u.y);
+    float3 light = microfacetNormal * (2.0f * dot(view, microfacetNormal)) - view;
+    
+    if(light.z <= 0.0f)
+    {
+        weight = 0.0f;
+        return normal;
+    }
+    
+    float lambdaView = GGXLambda(view.z, alpha);
+    float lambdaLight = GGXLambda(light.z, alpha);
+    weight = (1.0f + lambdaView) / (1.0f + lambdaView + lambdaLight);
     
-    float3 vec = tan(float3(x, y, z));
-    return normalize(vec);
+    return normalize(tangent * light.x + bitangent * light.y + normal * light.z);
 }
 
 // REGION - Utility Functions //
@@ -102,4 +366,152 @@ float3 refract2(float3 incoming, float3 normal, float IoR)
     float3 b = (norm * -1.0f) * sqrt(k);
 
     return a + b;
+}
+
+// REGION - Texture LOD //
+// The camera is a pinhole, every pixel starts out as a point. The screen plane is 1 unit high at a distance of 2 units
+RayCone GetPrimaryRayCone(float imageHeight)
+{
+    RayCone cone;
+    cone.width = 0.0f;
+    cone.spreadAngle = 1.0f / (2.0f * imageHeight);
+    return cone;
+}
+
+// The cone at the end of a segment of length 't', which is where the next segment starts
+RayCone PropagateRayCone(RayCone cone, float t)
+{
+    cone.width += cone.spreadAngle * t;
+    return cone;
+}
+
+// Bounces scatter the footprint over the lobe they sample. Its width is about the GGX alpha, so
+// perfect mirrors & refractions keep the incoming spread, diffuse bounces (roughness 1) widen it the most
+RayCone ScatterRayCone(RayCone cone, float roughness)
+{
+    cone.spreadAngle += roughness * roughness;
+    return cone;
+}
+
+// Ray cones (Akenine-Moller et al. 2019), 'coneWidth' is the width of a pixel's footprint at the hit.
+// Returns the mip level for a texture of 1x1, 'GetTextureLOD' adds the size of the actual texture.
+float ComputeRayConeLOD(float3 p0, float3 p1, float3 p2, float2 uv0, float2 uv1, float2 uv2,
+    float3 rayDirection, float coneWidth)
+{
+    float3 triangleNormal = cross(p1 - p0, p2 - p0);
+    float worldArea = max(length(triangleNormal), 1e-20f);
+    float uvArea = max(abs((uv1.x - uv0.x) * (uv2.y - uv0.y) - (uv2.x - uv0.x) * (uv1.y - uv0.y)), 1e-20f);
+    
+    // Grazing angles stretch the footprint of the cone over the surface
+    float cosine = max(abs(dot(rayDirection, triangleNormal)) / worldArea, 1e-4f);
+    return 0.5f * log2(uvArea / worldArea) + log2(coneWidth / cosine);
+}
+
+float GetTextureLOD(float rayConeLOD, float width, float height)
+{
+    return max(rayConeLOD + 0.5f * log2(width * height), 0.0f);
+}
+
+// REGION - Environment Sampling //
+// Mirrors CPUCommon.h, reads the distribution made by 'BuildEnvironmentDistribution'.
+// The environment map uses the same mapping as 'Miss'.
+uint FindCDFInterval(StructuredBuffer<float> distribution, uint offset, uint count, float u)
+{
+    uint low = 0;
+    uint high = count - 1;
+    
+    while(low < high)
+    {
+        uint middle = (low + high + 1) / 2;
+        if(distribution[offset + middle] <= u)
+        {
+            low = middle;
+        }
+        else
+        {
+            high = middle - 1;
+        }
+    }
+    
+    return low;
+}
+
+// Returns the direction towards a point of the environment map, proportional to its brightness
+float3 SampleEnvironment(StructuredBuffer<float> distribution, uint width, uint height, inout PathSampler pathSampler, out float pdf)
+{
+    float2 random = Random2D(pathSampler);
+    float u1 = min(random.x, 0.99999994f);
+    float u2 = min(random.y, 0.99999994f);
+    
+    // 1. Pick a row through the marginal CDF, then a column through the conditional CDF of that row //
+    uint y = FindCDFInterval(distribution, 0, height, u2);
+    float rowPdf = distribution[y + 1] - distribution[y];
+    float v = (y + (u2 - distribution[y]) / rowPdf) / height;
+    
+    uint rowOffset = height + 1 + y * (width + 1);
+    uint x = FindCDFInterval(distribution, rowOffset, width, u1);
+    float columnPdf = distribution[rowOffset + x + 1] - distribution[rowOffset + x];
+    float u = (x + (u1 - distribution[rowOffset + x]) / columnPdf) / width;
+    
+    // 2. Convert to a direction, the PDF goes from the image to the sphere //
+    float theta = v * PI;
+    float phi = u * 2.0f * PI - PI;
+    float sinTheta = sin(theta);
+    
+    pdf = sinTheta > 0.0f ? (rowPdf * height * columnPdf * width) / (2.0f * PI * PI * sinTheta) : 0.0f;
+    return float3(sinTheta * cos(phi), cos(theta), sinTheta * sin(phi));
+}
+
+// PDF (over solid angle) of 'SampleEnvironment' returning 'direction'
+float GetEnvironmentPDF(StructuredBuffer<float> distribution, uint width, uint height, float3 direction)
+{
+    float theta = acos(clamp(direction.y, -1.0f, 1.0f));
+    float phi = atan2(direction.z, direction.x) + PI;
+    float sinTheta = sin(theta);
+    
+    if(sinTheta <= 0.0f)
+    {
+        return 0.0f;
+    }
+    
+    uint x = (uint)(phi / (2.0f * PI) * width) % width;
+    uint y = (uint)(theta / PI * height) % height;
+    uint rowOffset = height + 1 + y * (width + 1);
+    
+    float rowPdf = distribution[y + 1] - distribution[y];
+    float columnPdf = distribution[rowOffset + x + 1] - distribution[rowOffset + x];
+    return (rowPdf * height * columnPdf * width) / (2.0f * PI * PI * sinTheta);
+}
+
+// Weight of a sample with 'pdf' when another strategy could've sampled it with 'otherPdf'
+float PowerHeuristic(float pdf, float otherPdf)
+{
+    float a = pdf * pdf;
+    float b = otherPdf * otherPdf;
+    return a + b > 0.0f ? a / (a + b) : 0.0f;
+}
+
+// REGION - Adaptive Sampling //
+// Pixels need this many samples before their variance is trusted
+static const uint minAdaptiveSampleCount = 32;
+
+float Luminance(float3 color)
+{
+    return dot(color, float3(0.2126f, 0.7152f, 0.0722f));
+}
+
+// Relative standard error of a pixel's mean luminance. 'accumulated' holds the summed radiance & sample count,
+// 'moment' the summed squared luminance. Near-black pixels are measured against a floor, otherwise their
+// noise would never count as converged, even though it can't be seen.
+float GetRelativeError(float4 accumulated, float moment)
+{
+    float sampleCount = accumulated.a;
+    if(sampleCount < float(minAdaptiveSampleCount))
+    {
+        return 3.402823466e+38f;
+    }
+    
+    float mean = Luminance(accumulated.rgb) / sampleCount;
+    float variance = max(moment / sampleCount - mean * mean, 0.0f) * sampleCount / (sampleCount - 1.0f);
+    return sqrt(variance / sampleCount) / (mean + 0.01f);
 }
\ No newline at end of file
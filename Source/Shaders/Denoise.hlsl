@@ -0,0 +1,189 @@
+// Edge-avoiding a-trous wavelet filter, guided by the first hits of 'RayGen'. Mirrors 'DenoiseImage' in Denoiser.cpp.
+// Every dispatch runs a single pass, 0: divides out the albedo, 1: one filter iteration, 2: multiplies the albedo back in & tonemaps
+
+RWTexture2D<float4> colorBuffer : register(u0);
+RWTexture2D<float> momentBuffer : register(u1);
+RWTexture2D<float4> albedoBuffer : register(u2); // RGB: summed albedo, A: summed distance
+RWTexture2D<float4> normalBuffer : register(u3);
+RWTexture2D<float4> sourceBuffer : register(u4); // RGB: irradiance, A: variance of its luminance
+RWTexture2D<float4> destinationBuffer : register(u5);
+RWTexture2D<float4> outputBuffer : register(u6);
+
+struct DenoiseSettings
+{
+    uint pass;
+    int step; // Distance between the taps of this iteration
+    float colorPhi;
+    float normalPhi;
+    float depthPhi;
+};
+ConstantBuffer<DenoiseSettings> settings : register(b0);
+
+static const float kernel[3] = { 3.0f / 8.0f, 1.0f / 4.0f, 1.0f / 16.0f };
+static const float minAlbedo = 0.001f;
+static const float maxVariance = 1e8f;
+
+struct Guides
+{
+    float3 albedo;
+    float3 normal;
+    float depth;
+};
+
+float Luminance(float3 color)
+{
+    return dot(color, float3(0.2126f, 0.7152f, 0.0722f));
+}
+
+Guides LoadGuides(int2 pixel)
+{
+    float sampleCount = max(colorBuffer[pixel].a, 1.0f);
+    float4 albedoDepth = albedoBuffer[pixel] / sampleCount;
+    
+    Guides guides;
+    guides.albedo = max(albedoDepth.rgb, float3(minAlbedo, minAlbedo, minAlbedo));
+    guides.normal = normalBuffer[pixel].xyz / sampleCount;
+    guides.depth = albedoDepth.a;
+    return guides;
+}
+
+float3 Tonemap(float3 color)
+{
+    // Matches the tonemapping & gamma correction at the end of 'RayGen'
+    color *= 0.545;
+    float a = 2.51f;
+    float b = 0.03f;
+    float c = 2.43f;
+    float d = 0.59f;
+    float e = 0.14f;
+    color = (color * (a * color + b)) / (color * (c * color + d) + e);
+    
+    float gammaInverse = 1.0f / 2.4f;
+    return pow(saturate(color), gammaInverse);
+}
+
+// REGION - Passes //
+void Demodulate(int2 pixel)
+{
+    float4 accumulated = colorBuffer[pixel];
+    float sampleCount = max(accumulated.a, 1.0f);
+    float3 mean = accumulated.rgb / sampleCount;
+    
+    // Variance of the mean luminance, not of a single sample //
+    float luminance = Luminance(mean);
+    float variance = maxVariance;
+    if(sampleCount > 1.0f)
+    {
+        variance = max(momentBuffer[pixel] / sampleCount - luminance * luminance, 0.0f) / (sampleCount - 1.0f);
+    }
+    
+    Guides guides = LoadGuides(pixel);
+    float albedoLuminance = Luminance(guides.albedo);
+    
+    destinationBuffer[pixel] = float4(mean / guides.albedo, min(variance / (albedoLuminance * albedoLuminance), maxVariance));
+}
+
+void Filter(int2 pixel, int2 dimensions)
+{
+    float4 center = sourceBuffer[pixel];
+    Guides guides = LoadGuides(pixel);
+    
+    // The environment has no surface, it's kept as it is //
+    if(dot(guides.normal, guides.normal) < 1e-4f)
+    {
+        destinationBuffer[pixel] = center;
+        return;
+    }
+    
+    // The luminance weight uses a 3x3 blurred variance, a single pixel's estimate is too noisy by itself //
+    float filteredVariance = 0.0f;
+    float varianceWeightSum = 0.0f;
+    for(int vy = -1; vy <= 1; vy++)
+    {
+        for(int vx = -1; vx <= 1; vx++)
+        {
+            int2 q = pixel + int2(vx, vy);
+            if(all(q >= 0) && all(q < dimensions))
+            {
+                float weight = (vx == 0 ? 0.5f : 0.25f) * (vy == 0 ? 0.5f : 0.25f);
+                filteredVariance += weight * sourceBuffer[q].a;
+                varianceWeightSum += weight;
+            }
+        }
+    }
+    filteredVariance /= varianceWeightSum;
+    
+    float luminance = Luminance(center.rgb);
+    float luminanceScale = 1.0f / (settings.colorPhi * sqrt(filteredVariance) + 1e-6f);
+    float depthScale = 1.0f / (settings.depthPhi * guides.depth + 1e-6f);
+    
+    float weightSum = 0.0f;
+    float squaredWeightSum = 0.0f;
+    float3 irradiance = float3(0.0f, 0.0f, 0.0f);
+    
+    for(int dy = -2; dy <= 2; dy++)
+    {
+        for(int dx = -2; dx <= 2; dx++)
+        {
+            int2 q = pixel + int2(dx, dy) * settings.step;
+            if(any(q < 0) || any(q >= dimensions))
+            {
+                continue;
+            }
+            
+            float4 tap = sourceBuffer[q];
+            float weight = kernel[abs(dx)] * kernel[abs(dy)];
+            
+            if(dx != 0 || dy != 0)
+            {
+                Guides tapGuides = LoadGuides(q);
+                float luminanceDistance = abs(luminance - Luminance(tap.rgb)) * luminanceScale;
+                float normalDistance = max(1.0f - dot(guides.normal, tapGuides.normal), 0.0f) * settings.normalPhi;
+                float depthDistance = abs(guides.depth - tapGuides.depth) * depthScale / (length(float2(dx, dy)) * settings.step);
+                
+                weight *= exp(-(luminanceDistance + normalDistance + depthDistance));
+            }
+            
+            weightSum += weight;
+            squaredWeightSum += weight * weight * tap.a;
+            irradiance += weight * tap.rgb;
+        }
+    }
+    
+    // Weights are normalized, so the variance of the weighted average scales with their squares //
+    destinationBuffer[pixel] = float4(irradiance / weightSum, squaredWeightSum / (weightSum * weightSum));
+}
+
+void Remodulate(int2 pixel)
+{
+    Guides guides = LoadGuides(pixel);
+    outputBuffer[pixel] = float4(Tonemap(sourceBuffer[pixel].rgb * guides.albedo), 1.0f);
+}
+
+[numthreads(8, 8, 1)]
+void main(uint3 dispatchID : SV_DispatchThreadID)
+{
+    uint width;
+    uint height;
+    colorBuffer.GetDimensions(width, height);
+    
+    int2 pixel = int2(dispatchID.xy);
+    int2 dimensions = int2(width, height);
+    if(any(pixel >= dimensions))
+    {
+        return;
+    }
+    
+    switch(settings.pass)
+    {
+        case 0:
+            Demodulate(pixel);
+            break;
+        case 1:
+            Filter(pixel, dimensions);
+            break;
+        case 2:
+            Remodulate(pixel);
+            break;
+    }
+}
\ No newline at end of file
@@ -3,6 +3,11 @@
 // Raytracing output texture, accessed as a UAV
 RWTexture2D<float4> gOutput : register(u0);
 RWTexture2D<float4> colorBuffer : register(u1);
+RWTexture2D<float> momentBuffer : register(u2); // Summed squared luminance, for the variance of every pixel
+
+// First hits summed over the samples, which guide the denoiser //
+RWTexture2D<float4> albedoBuffer : register(u3); // RGB: albedo, A: distance
+RWTexture2D<float4> normalBuffer : register(u4);
 
 // Raytracing acceleration structure, accessed as a SRV
 RaytracingAccelerationStructure SceneBVH : register(t0);
@@ -12,25 +17,26 @@ struct Settings
     bool clearBuffers;
     float time;
     uint frameCount;
+    bool useIterativeIntegrator;
+    uint minDepth; // Rays a path always traces before Russian roulette can end it
+    uint maxDepth;
+    float adaptiveTargetError; // Pixels below this relative error stop sampling, 0 samples every pixel
+    uint samplerType; // 'SAMPLER_' in Common.hlsl
 };
 ConstantBuffer<Settings> settings : register(b0);
 
-uint GetSeed(uint2 launchIndex)
+PathSampler GetSampler(uint2 launchIndex, uint sampleIndex)
 {
-    float2 dims = float2(DispatchRaysDimensions().xy);
-    
-    uint pixelIndex = launchIndex.x + launchIndex.y * dims.x;
-    return (settings.frameCount * 26927) + (pixelIndex * 78713);
+    return InitializeSampler(settings.samplerType, launchIndex, DispatchRaysDimensions().x, sampleIndex);
 }
 
-float3 GetRayDirection(inout uint seed, uint2 launchIndex, float3 cameraPosition)
+float3 GetRayDirection(inout PathSampler pathSampler, uint2 launchIndex, float3 cameraPosition)
 {
     // 1) Get a random location within a given pixel //
-    float stochasticX = Random01(seed);
-    float stochasticY = Random01(seed);
+    float2 stochastic = Random2D(pathSampler);
     
     float2 dimensions = float2(DispatchRaysDimensions().xy);
-    float2 uv = (launchIndex.xy + float2(stochasticX, stochasticY)) / dimensions.xy;
+    float2 uv = (launchIndex.xy + stochastic) / dimensions.xy;
     
     // 2) Setup virtual screen plane //
     float aspectRatio = dimensions.x / dimensions.y;
@@ -55,20 +61,106 @@ float3 GetRayDirection(inout uint seed, uint2 launchIndex, float3 cameraPosition
     return rayDirection;
 }
 
+// The environment has no surface, the denoiser leaves it as it is //
+void ResetGuides(inout HitInfo payload, RayDesc ray)
+{
+    payload.albedo = float3(1.0f, 1.0f, 1.0f);
+    payload.normal = float3(0.0f, 0.0f, 0.0f);
+    payload.hitDistance = ray.TMax;
+}
+
+// Every hit samples a single lobe & hands back the next ray, so a path traces at most 'maxDepth' rays,
+// instead of the ray trees 'ClosestHit' grows when it traces every lobe itself. Mirrors 'TracePath' in CPUPathTracer.cpp
+float3 TracePath(RayDesc ray, PathSampler pathSampler, inout HitInfo firstHit)
+{
+    float3 radiance = float3(0.0f, 0.0f, 0.0f);
+    float3 throughput = float3(1.0f, 1.0f, 1.0f);
+    
+    HitInfo payload;
+    payload.pathSampler = pathSampler;
+    payload.bsdfPdf = 0.0f;
+    payload.isIterative = true;
+    payload.rayCone = GetPrimaryRayCone(DispatchRaysDimensions().y);
+    ResetGuides(payload, ray);
+    
+    for(uint depth = 0; depth < settings.maxDepth; depth++)
+    {
+        payload.depth = depth;
+        
+        // The last ray of a path only looks for the environment, like the deepest rays of the ray trees //
+        if(depth + 1 >= settings.maxDepth)
+        {
+            payload.color = float3(0.0f, 0.0f, 0.0f);
+            TraceRay(SceneBVH, RAY_FLAG_SKIP_CLOSEST_HIT_SHADER, 0xFF, 0, 0, 0, ray, payload);
+            
+            radiance += throughput * payload.color;
+            break;
+        }
+        
+        SetBounceDimension(payload.pathSampler, depth);
+        TraceRay(SceneBVH, RAY_FLAG_NONE, 0xFF, 0, 0, 0, ray, payload);
+        
+        if(depth == 0)
+        {
+            firstHit = payload;
+        }
+        
+        radiance += throughput * payload.color;
+        throughput *= payload.throughput;
+        
+        float survivalProbability = min(max(throughput.x, max(throughput.y, throughput.z)), 1.0f);
+        if(survivalProbability <= 0.0f)
+        {
+            break;
+        }
+        
+        // Russian roulette, dim paths get ended early once they traced 'minDepth' rays. 
+        // The survivors make up for them through a higher weight //
+        if(depth + 1 >= settings.minDepth)
+        {
+            if(Random01(payload.pathSampler) >= survivalProbability)
+            {
+                break;
+            }
+            
+            throughput /= survivalProbability;
+        }
+        
+        ray.Origin = payload.nextOrigin;
+        ray.Direction = payload.nextDirection;
+    }
+    
+    return radiance;
+}
+
 [shader("raygeneration")]
 void RayGen()
 {
     uint2 launchIndex = DispatchRaysIndex().xy;
-    uint seed = GetSeed(launchIndex);
     
     if(settings.clearBuffers)
     {
         colorBuffer[launchIndex] = float4(0.0f, 0.0f, 0.0f, 0.0f);
+        momentBuffer[launchIndex] = 0.0f;
+        albedoBuffer[launchIndex] = float4(0.0f, 0.0f, 0.0f, 0.0f);
+        normalBuffer[launchIndex] = float4(0.0f, 0.0f, 0.0f, 0.0f);
         gOutput[launchIndex] = float4(0.0f, 0.0f, 0.0f, 0.0f);
     }
+    
+    // Adaptive sampling, converged pixels keep their output & skip the frame. Unlike the tiles of 
+    // 'CPUPathTracer::RenderAdaptive' this works per pixel, a tile's error would need a reduction pass first
+    float4 accumulated = colorBuffer[launchIndex];
+    if(settings.adaptiveTargetError > 0.0f && 
+        GetRelativeError(accumulated, momentBuffer[launchIndex]) < settings.adaptiveTargetError)
+    {
+        return;
+    }
+    
+    // Pixels count their own samples, since adaptive sampling skips converged ones //
+    PathSampler pathSampler = GetSampler(launchIndex, uint(accumulated.a));
 
     float3 position = float3(0.0f, 0.0f, 7.5f);
-    float3 rayDir = GetRayDirection(seed, launchIndex, position);
+    float3 rayDir = GetRayDirection(pathSampler, launchIndex, position);
     
     RayDesc ray;
     ray.Origin = position;
@@ -76,13 +168,31 @@ void RayGen()
     ray.TMin = 0.001f;
     ray.TMax = 100000;
     
-    HitInfo payload;
-    payload.depth = 0;
-    payload.seed = seed;
+    HitInfo firstHit;
+    ResetGuides(firstHit, ray);
     
-    TraceRay(SceneBVH, RAY_FLAG_NONE, 0xFF, 0, 0, 0, ray, payload);
+    float3 sampleColor;
+    if(settings.useIterativeIntegrator)
+    {
+        sampleColor = TracePath(ray, pathSampler, firstHit);
+    }
+    else
+    {
+        firstHit.depth = 0;
+        firstHit.pathSampler = pathSampler;
+        firstHit.bsdfPdf = 0.0f;
+        firstHit.isIterative = false;
+        firstHit.rayCone = GetPrimaryRayCone(DispatchRaysDimensions().y);
+        
+        TraceRay(SceneBVH, RAY_FLAG_NONE, 0xFF, 0, 0, 0, ray, firstHit);
+        sampleColor = firstHit.color;
+    }
     
-    colorBuffer[launchIndex] += float4(payload.color, 1.0f);
+    float luminance = Luminance(sampleColor);
+    colorBuffer[launchIndex] += float4(sampleColor, 1.0f);
+    momentBuffer[launchIndex] += luminance * luminance;
+    albedoBuffer[launchIndex] += float4(firstHit.albedo, firstHit.hitDistance);
+    normalBuffer[launchIndex] += float4(firstHit.normal, 0.0f);
     int sampleCount = colorBuffer[launchIndex].a;
     
     // TODO: Reread back into HDR -> LDR ( Tonemapping / Gamma Correction ) 
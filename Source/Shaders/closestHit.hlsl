@@ -4,7 +4,7 @@ struct Vertex
 {
     float3 position;
     float3 normal;
-    float3 tangent;
+    float4 tangent;
     float2 texCoord0;
 };
 StructuredBuffer<Vertex> VertexData : register(t0);
@@ -55,8 +55,8 @@ void ClosestHit(inout HitInfo payload, Attributes attrib)
     
     for(int i = 0; i < shadowRayCount; i++)
     {
-        float sampleSunX = RandomInRange(payload.seed, -sunDiskSize, sunDiskSize);
-        float sampleSunY = RandomInRange(payload.seed, -sunDiskSize, sunDiskSize);
+        float sampleSunX = RandomInRange(payload.pathSampler, -sunDiskSize, sunDiskSize);
+        float sampleSunY = RandomInRange(payload.pathSampler, -sunDiskSize, sunDiskSize);
         float3 rayD = normalize(sunDirection + float3(sampleSunX, sampleSunY, 0.0f));
         
         RayDesc shadowRay;
@@ -1,6 +1,7 @@
 #include "Common.hlsl"
 
 Texture2D<float4> environmentMap : register(t0);
+StructuredBuffer<float> environmentDistribution : register(t1);
 
 [shader("miss")]
 void Miss(inout HitInfo payload : SV_RayPayload)
@@ -33,6 +34,14 @@ void Miss(inout HitInfo payload : SV_RayPayload)
     
     environmentSample = clamp(environmentSample, float3(0.0f, 0.0f, 0.0f), float3(100.0f, 100.0f, 100.0f));
     
+    // BSDF samples share the environment with 'SampleEnvironmentLight', so they get weighted through MIS //
+    if(payload.bsdfPdf > 0.0f)
+    {
+        float lightPdf = GetEnvironmentPDF(environmentDistribution, width, height, rayDirection);
+        environmentSample *= PowerHeuristic(payload.bsdfPdf, lightPdf);
+    }
+    
     payload.color = float3(environmentSample);
     payload.depth = 0.0f;
+    payload.throughput = float3(0.0f, 0.0f, 0.0f);
 }
\ No newline at end of file
@@ -0,0 +1,108 @@
+#include "Utilities/MappedFile.h"
+#include "Utilities/Logger.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string& filePath)
+{
+#ifdef _WIN32
+	HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+	if(file == INVALID_HANDLE_VALUE)
+	{
+		// Missing files are reported by the caller, it's not always an error (e.g. caches)
+		return;
+	}
+
+	LARGE_INTEGER fileSize;
+	if(!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+	{
+		CloseHandle(file);
+		return;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if(mapping == nullptr)
+	{
+		LOG(Log::MessageType::Error, "Failed to create file mapping: " + filePath);
+		CloseHandle(file);
+		return;
+	}
+
+	data = static_cast<const unsigned char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	if(data == nullptr)
+	{
+		LOG(Log::MessageType::Error, "Failed to map view of file: " + filePath);
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return;
+	}
+
+	size = size_t(fileSize.QuadPart);
+	fileHandle = file;
+	mappingHandle = mapping;
+#else
+	int file = open(filePath.c_str(), O_RDONLY);
+	if(file < 0)
+	{
+		// Missing files are reported by the caller, it's not always an error (e.g. caches)
+		return;
+	}
+
+	struct stat fileStats;
+	if(fstat(file, &fileStats) != 0 || fileStats.st_size == 0)
+	{
+		close(file);
+		return;
+	}
+
+	void* mapping = mmap(nullptr, size_t(fileStats.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+
+	if(mapping == MAP_FAILED)
+	{
+		LOG(Log::MessageType::Error, "Failed to map file: " + filePath);
+		return;
+	}
+
+	data = static_cast<const unsigned char*>(mapping);
+	size = size_t(fileStats.st_size);
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+	if(data == nullptr)
+	{
+		return;
+	}
+
+#ifdef _WIN32
+	UnmapViewOfFile(data);
+	CloseHandle(mappingHandle);
+	CloseHandle(fileHandle);
+#else
+	munmap(const_cast<unsigned char*>(data), size);
+#endif
+}
+
+bool MappedFile::IsValid()
+{
+	return data != nullptr;
+}
+
+const unsigned char* MappedFile::GetData()
+{
+	return data;
+}
+
+size_t MappedFile::GetSize()
+{
+	return size;
+}
\ No newline at end of file
@@ -0,0 +1,234 @@
+#include "Utilities/ThreadPool.h"
+#include <algorithm>
+
+namespace ThreadPoolInternal
+{
+	// Allows tasks to figure out if they're running on a worker, and on which one
+	thread_local ThreadPool* workerPool = nullptr;
+	thread_local int workerIndex = -1;
+
+	unsigned int globalThreadCount = 0;
+}
+using namespace ThreadPoolInternal;
+
+bool TaskGroup::IsFinished()
+{
+	return pendingTasks.load() == 0;
+}
+
+ThreadPool::ThreadPool(unsigned int threadCount)
+{
+	if(threadCount == 0)
+	{
+		threadCount = std::thread::hardware_concurrency();
+	}
+
+	if(threadCount == 0)
+	{
+		threadCount = 1;
+	}
+
+	for(unsigned int i = 0; i < threadCount; i++)
+	{
+		queues.push_back(new WorkQueue());
+	}
+
+	for(unsigned int i = 0; i < threadCount; i++)
+	{
+		workers.push_back(std::thread(&ThreadPool::WorkerLoop, this, i));
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> guard(sleepLock);
+		isRunning = false;
+	}
+
+	sleepCondition.notify_all();
+
+	for(std::thread& worker : workers)
+	{
+		worker.join();
+	}
+
+	for(WorkQueue* queue : queues)
+	{
+		delete queue;
+	}
+}
+
+void ThreadPool::Submit(TaskGroup& group, std::function<void()> task)
+{
+	group.pendingTasks++;
+
+	// Workers push onto their own queue to keep nested work local,
+	// any other thread spreads its tasks over all the workers
+	unsigned int queueIndex;
+	if(workerPool == this)
+	{
+		queueIndex = workerIndex;
+	}
+	else
+	{
+		queueIndex = nextQueue.fetch_add(1) % queues.size();
+	}
+
+	{
+		std::lock_guard<std::mutex> guard(queues[queueIndex]->lock);
+		queues[queueIndex]->tasks.push_back({ std::move(task), &group });
+	}
+
+	{
+		std::lock_guard<std::mutex> guard(sleepLock);
+		queuedTaskCount++;
+	}
+
+	sleepCondition.notify_one();
+}
+
+void ThreadPool::Wait(TaskGroup& group)
+{
+	int index = workerPool == this ? workerIndex : -1;
+
+	// Threads outside of the pool stick to their own group, otherwise the main thread could
+	// end up running an unrelated long task, such as cooking a streamed texture
+	TaskGroup* helpGroup = index >= 0 ? nullptr : &group;
+
+	while(!group.IsFinished())
+	{
+		// Instead of blocking, help out with any work that's left
+		if(!TryRunTask(index, helpGroup))
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+void ThreadPool::ParallelFor(unsigned int count, const std::function<void(unsigned int index)>& task, unsigned int batchSize)
+{
+	if(batchSize == 0)
+	{
+		batchSize = 1;
+	}
+
+	TaskGroup group;
+	for(unsigned int start = 0; start < count; start += batchSize)
+	{
+		unsigned int end = std::min(start + batchSize, count);
+
+		Submit(group, [start, end, &task]()
+		{
+			for(unsigned int i = start; i < end; i++)
+			{
+				task(i);
+			}
+		});
+	}
+
+	Wait(group);
+}
+
+unsigned int ThreadPool::GetThreadCount()
+{
+	return workers.size();
+}
+
+ThreadPool& ThreadPool::GetGlobalPool()
+{
+	static ThreadPool globalPool(globalThreadCount);
+	return globalPool;
+}
+
+void ThreadPool::SetGlobalThreadCount(unsigned int threadCount)
+{
+	globalThreadCount = threadCount;
+}
+
+void ThreadPool::WorkerLoop(unsigned int index)
+{
+	workerPool = this;
+	workerIndex = index;
+
+	while(true)
+	{
+		if(TryRunTask(index))
+		{
+			continue;
+		}
+
+		std::unique_lock<std::mutex> guard(sleepLock);
+		sleepCondition.wait(guard, [this]() { return !isRunning || queuedTaskCount.load() > 0; });
+
+		if(!isRunning)
+		{
+			return;
+		}
+	}
+}
+
+bool ThreadPool::TryRunTask(int index, TaskGroup* group)
+{
+	Task task;
+	bool foundTask = false;
+
+	// 1) Own work first, newest task since its data is likely still in cache //
+	if(index >= 0)
+	{
+		foundTask = PopTask(index, task);
+	}
+
+	// 2) Otherwise steal the oldest task of another worker //
+	unsigned int startQueue = index >= 0 ? index + 1 : 0;
+	for(unsigned int i = 0; i < queues.size() && !foundTask; i++)
+	{
+		unsigned int queueIndex = (startQueue + i) % queues.size();
+		foundTask = StealTask(queueIndex, task, group);
+	}
+
+	if(!foundTask)
+	{
+		return false;
+	}
+
+	queuedTaskCount--;
+	task.function();
+	task.group->pendingTasks--;
+
+	return true;
+}
+
+bool ThreadPool::PopTask(unsigned int queueIndex, Task& task)
+{
+	WorkQueue* queue = queues[queueIndex];
+	std::lock_guard<std::mutex> guard(queue->lock);
+
+	if(queue->tasks.empty())
+	{
+		return false;
+	}
+
+	task = std::move(queue->tasks.back());
+	queue->tasks.pop_back();
+	return true;
+}
+
+bool ThreadPool::StealTask(unsigned int queueIndex, Task& task, TaskGroup* group)
+{
+	WorkQueue* queue = queues[queueIndex];
+	std::lock_guard<std::mutex> guard(queue->lock);
+
+	// Oldest task first, or the oldest one of 'group' when given //
+	for(auto it = queue->tasks.begin(); it != queue->tasks.end(); it++)
+	{
+		if(!group || it->group == group)
+		{
+			task = std::move(*it);
+			queue->tasks.erase(it);
+			return true;
+		}
+	}
+
+	return false;
+}
\ No newline at end of file
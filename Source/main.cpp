@@ -1,4 +1,9 @@
+#ifndef BLAZE_HEADLESS
 #include "Framework/Blaze.h"
+#endif
+#include "Framework/BlazeHeadless.h"
+
+#include <cstring>
 
 // TODO Summary:
 // I want to turn Blaze from a Path Tracer to more of a DXR Engine, similary to snowdrop.
@@ -16,10 +21,19 @@
 // Probability density functions
 // Denoising Techniques (Reprojection?)
 
-int main()
+int main(int argc, char** argv)
 {
-	Blaze app;
-	app.Run();
+	// Builds without the DirectX backend always run headless
+#ifndef BLAZE_HEADLESS
+	if(argc < 2 || strcmp(argv[1], "--headless") != 0)
+	{
+		Blaze app;
+		app.Run();
+
+		return 0;
+	}
+#endif
 
-	return 0;
+	BlazeHeadless app(argc, argv);
+	return app.Run();
 }
\ No newline at end of file